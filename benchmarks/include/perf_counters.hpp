@@ -0,0 +1,317 @@
+// This file is part of PIQP.
+//
+// Copyright (c) 2024 EPFL
+//
+// This source code is licensed under the BSD 2-Clause License found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef PIQP_BENCHMARKS_PERF_COUNTERS_HPP
+#define PIQP_BENCHMARKS_PERF_COUNTERS_HPP
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include <benchmark/benchmark.h>
+
+#include "piqp/tracing.hpp"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define PIQP_BENCHMARK_HAS_PERF_EVENT
+#endif
+
+namespace piqp
+{
+
+namespace benchmark_utils
+{
+
+enum PerfCounter
+{
+    PERF_CYCLES = 0,
+    PERF_INSTRUCTIONS,
+    PERF_CACHE_MISSES,
+    PERF_BRANCH_MISSES,
+    PERF_N_COUNTERS
+};
+
+static constexpr const char* perf_counter_names[PERF_N_COUNTERS] = {
+    "cycles", "instructions", "cache_misses", "branch_misses"
+};
+
+using PerfValues = std::array<std::uint64_t, PERF_N_COUNTERS>;
+
+// Group of hardware performance counters of the calling thread using perf_event_open.
+// Counters which are not supported by the hardware or kernel (or not permitted,
+// see /proc/sys/kernel/perf_event_paranoid) are reported as not available.
+class PerfCounters
+{
+protected:
+    std::array<int, PERF_N_COUNTERS> m_fd;
+    std::array<int, PERF_N_COUNTERS> m_group_idx; // position in group read, -1 if not available
+    int m_n_open = 0;
+
+public:
+    PerfCounters()
+    {
+        m_fd.fill(-1);
+        m_group_idx.fill(-1);
+#ifdef PIQP_BENCHMARK_HAS_PERF_EVENT
+        const std::uint64_t configs[PERF_N_COUNTERS] = {
+            PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_MISSES,
+            PERF_COUNT_HW_BRANCH_MISSES
+        };
+        int leader = -1;
+        for (int i = 0; i < PERF_N_COUNTERS; i++)
+        {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof(attr);
+            attr.config = configs[i];
+            attr.disabled = leader == -1 ? 1 : 0;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP;
+            int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0));
+            if (fd == -1) continue;
+            if (leader == -1) leader = fd;
+            m_fd[i] = fd;
+            m_group_idx[i] = m_n_open++;
+        }
+        if (leader != -1)
+        {
+            ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+#endif
+    }
+
+    ~PerfCounters()
+    {
+#ifdef PIQP_BENCHMARK_HAS_PERF_EVENT
+        for (int fd : m_fd)
+        {
+            if (fd != -1) close(fd);
+        }
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool available(PerfCounter counter) const { return m_group_idx[counter] != -1; }
+
+    bool any_available() const { return m_n_open > 0; }
+
+    // reads all counters with a single system call, unavailable counters are zero
+    void read(PerfValues& values) const
+    {
+        values.fill(0);
+#ifdef PIQP_BENCHMARK_HAS_PERF_EVENT
+        if (m_n_open == 0) return;
+        // layout for PERF_FORMAT_GROUP: { u64 nr; u64 values[nr]; }
+        std::uint64_t buffer[1 + PERF_N_COUNTERS];
+        int leader = m_fd[first_open()];
+        if (::read(leader, buffer, sizeof(buffer)) <= 0) return;
+        for (int i = 0; i < PERF_N_COUNTERS; i++)
+        {
+            if (m_group_idx[i] != -1 && std::uint64_t(m_group_idx[i]) < buffer[0])
+            {
+                values[i] = buffer[1 + m_group_idx[i]];
+            }
+        }
+#endif
+    }
+
+protected:
+    int first_open() const
+    {
+        for (int i = 0; i < PERF_N_COUNTERS; i++)
+        {
+            if (m_fd[i] != -1) return i;
+        }
+        return -1;
+    }
+};
+
+// Attributes hardware performance counters to the solver phases
+// factorization, KKT solve and residual update using the tracing hooks.
+// The solver has to be compiled with PIQP_WITH_TRACING, otherwise only
+// the total counts are available. Only the outermost span of a phase on the
+// thread calling start() is counted, spans of nested or parallel sub-problems
+// are part of it.
+class PhaseCounters
+{
+public:
+    enum Phase
+    {
+        PHASE_FACTORIZE = 0,
+        PHASE_KKT_SOLVE,
+        PHASE_RESIDUALS,
+        PHASE_TOTAL,
+        N_PHASES
+    };
+
+protected:
+    PerfCounters m_counters;
+    std::array<PerfValues, N_PHASES> m_start;
+    std::array<PerfValues, N_PHASES> m_sum;
+    std::array<std::int64_t, N_PHASES> m_calls;
+    std::array<int, N_PHASES> m_depth;
+    std::thread::id m_thread;
+    bool m_running = false;
+    bool m_was_recording = false;
+
+public:
+    PhaseCounters()
+    {
+        for (int p = 0; p < N_PHASES; p++)
+        {
+            m_start[p].fill(0);
+            m_sum[p].fill(0);
+            m_calls[p] = 0;
+            m_depth[p] = 0;
+        }
+    }
+
+    ~PhaseCounters()
+    {
+        stop();
+    }
+
+    void start()
+    {
+        m_thread = std::this_thread::get_id();
+#ifdef PIQP_WITH_TRACING
+        tracing::Recorder& recorder = tracing::Recorder::instance();
+        // we are only interested in the hooks, recording all events would distort the measurements
+        m_was_recording = recorder.recording();
+        recorder.set_recording(false);
+        tracing::Hooks hooks;
+        hooks.begin = &PhaseCounters::begin_hook;
+        hooks.end = &PhaseCounters::end_hook;
+        hooks.user_data = this;
+        recorder.set_hooks(hooks);
+#endif
+        m_running = true;
+        begin_phase(PHASE_TOTAL);
+    }
+
+    void stop()
+    {
+#ifdef PIQP_WITH_TRACING
+        tracing::Recorder& recorder = tracing::Recorder::instance();
+        if (recorder.hooks().user_data == this)
+        {
+            recorder.set_hooks(tracing::Hooks());
+            recorder.set_recording(m_was_recording);
+        }
+#endif
+        if (m_running)
+        {
+            end_phase(PHASE_TOTAL);
+            m_running = false;
+        }
+    }
+
+    std::int64_t calls(Phase phase) const { return m_calls[phase]; }
+
+    // adds the counters as average per benchmark iteration to the benchmark state,
+    // factor_flops are the predicted flops of a single factorization (Info::factor_flops)
+    void report(benchmark::State& state, double factor_flops = 0) const
+    {
+        if (!m_counters.any_available())
+        {
+            state.SetLabel("perf counters not available");
+        }
+        for (int p = 0; p < N_PHASES; p++)
+        {
+            if (p != PHASE_TOTAL && m_calls[p] == 0) continue;
+            for (int c = 0; c < PERF_N_COUNTERS; c++)
+            {
+                if (!m_counters.available(PerfCounter(c))) continue;
+                state.counters[std::string(phase_name(p)) + "_" + perf_counter_names[c]] =
+                    benchmark::Counter(double(m_sum[p][c]), benchmark::Counter::kAvgIterations);
+            }
+            if (m_counters.available(PERF_CYCLES) && m_counters.available(PERF_INSTRUCTIONS) && m_sum[p][PERF_CYCLES] > 0)
+            {
+                state.counters[std::string(phase_name(p)) + "_ipc"] =
+                    double(m_sum[p][PERF_INSTRUCTIONS]) / double(m_sum[p][PERF_CYCLES]);
+            }
+        }
+        if (factor_flops > 0 && m_calls[PHASE_FACTORIZE] > 0)
+        {
+            // hardware flop counters are not portable, hence we use the flop count of the symbolic analysis
+            state.counters["factorize_flops"] =
+                benchmark::Counter(factor_flops * double(m_calls[PHASE_FACTORIZE]), benchmark::Counter::kAvgIterations);
+            if (m_counters.available(PERF_CYCLES) && m_sum[PHASE_FACTORIZE][PERF_CYCLES] > 0)
+            {
+                state.counters["factorize_flops_per_cycle"] =
+                    factor_flops * double(m_calls[PHASE_FACTORIZE]) / double(m_sum[PHASE_FACTORIZE][PERF_CYCLES]);
+            }
+        }
+    }
+
+protected:
+    static const char* phase_name(int phase)
+    {
+        static const char* names[N_PHASES] = {"factorize", "kkt_solve", "residuals", "total"};
+        return names[phase];
+    }
+
+    void begin_phase(int phase)
+    {
+        m_counters.read(m_start[phase]);
+    }
+
+    void end_phase(int phase)
+    {
+        PerfValues values;
+        m_counters.read(values);
+        for (int c = 0; c < PERF_N_COUNTERS; c++)
+        {
+            m_sum[phase][c] += values[c] - m_start[phase][c];
+        }
+        m_calls[phase]++;
+    }
+
+    static int phase_from_span(const char* name)
+    {
+        // iterative refinement is part of the KKT solve
+        if (std::strcmp(name, "factorize") == 0) return PHASE_FACTORIZE;
+        if (std::strcmp(name, "kkt_solve") == 0) return PHASE_KKT_SOLVE;
+        if (std::strcmp(name, "update_nr_residuals") == 0) return PHASE_RESIDUALS;
+        return -1;
+    }
+
+    static void begin_hook(const char* name, void* user_data)
+    {
+        PhaseCounters* self = static_cast<PhaseCounters*>(user_data);
+        int phase = phase_from_span(name);
+        if (phase < 0 || std::this_thread::get_id() != self->m_thread) return;
+        if (self->m_depth[phase]++ == 0) self->begin_phase(phase);
+    }
+
+    static void end_hook(const char* name, void* user_data)
+    {
+        PhaseCounters* self = static_cast<PhaseCounters*>(user_data);
+        int phase = phase_from_span(name);
+        if (phase < 0 || std::this_thread::get_id() != self->m_thread) return;
+        if (--self->m_depth[phase] == 0) self->end_phase(phase);
+    }
+};
+
+} // namespace benchmark_utils
+
+} // namespace piqp
+
+#endif //PIQP_BENCHMARKS_PERF_COUNTERS_HPP
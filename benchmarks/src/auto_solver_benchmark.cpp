@@ -0,0 +1,115 @@
+// This file is part of PIQP.
+//
+// Copyright (c) 2024 EPFL
+//
+// This source code is licensed under the BSD 2-Clause License found in the
+// LICENSE file in the root directory of this source tree.
+
+// Sweeps the problem size and density to validate the crossover between the
+// dense and the sparse backend predicted by the cost model of AutoSolver.
+// The benchmarks are named BM_<BACKEND>/<dim>/<density in percent>, and the
+// AUTO benchmarks are labeled with the chosen backend. Comparing the time per
+// iteration (t_iter) with the predictions (t_dense, t_sparse) shows how well
+// the cost model is calibrated.
+
+#include <benchmark/benchmark.h>
+
+#include "piqp/auto_solver.hpp"
+#include "piqp/utils/random_utils.hpp"
+
+using namespace piqp;
+
+using T = double;
+using I = int;
+
+static sparse::Model<T, I> problem(benchmark::State& state)
+{
+    isize dim = state.range(0);
+    T sparsity_factor = T(state.range(1)) / T(100);
+    return rand::sparse_strongly_convex_qp<T, I>(dim, dim / 2, dim / 2, sparsity_factor);
+}
+
+template<typename Solver>
+static void report(benchmark::State& state, const Solver& solver)
+{
+    const Info<T>& info = solver.result().info;
+    state.counters["iter"] = double(info.iter);
+    state.counters["t_iter"] = benchmark::Counter(double(std::max(info.iter, isize(1))),
+                                                  benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+}
+
+static void BM_DENSE(benchmark::State& state)
+{
+    dense::Model<T> model = problem(state).dense_model();
+
+    DenseSolver<T> solver;
+    solver.setup(model.P, model.c, model.A, model.b, model.G, model.h, model.x_lb, model.x_ub);
+
+    for (auto _ : state)
+    {
+        solver.solve();
+    }
+    report(state, solver);
+}
+
+static void BM_SPARSE(benchmark::State& state)
+{
+    sparse::Model<T, I> model = problem(state);
+
+    SparseSolver<T, I> solver;
+    solver.setup(model.P, model.c, model.A, model.b, model.G, model.h, model.x_lb, model.x_ub);
+
+    for (auto _ : state)
+    {
+        solver.solve();
+    }
+    report(state, solver);
+}
+
+static void BM_AUTO(benchmark::State& state)
+{
+    sparse::Model<T, I> model = problem(state);
+
+    AutoSolver<T, I> solver;
+    solver.setup(model.P, model.c, model.A, model.b, model.G, model.h, model.x_lb, model.x_ub);
+
+    for (auto _ : state)
+    {
+        solver.solve();
+    }
+    report(state, solver);
+    state.counters["t_dense"] = double(solver.estimated_dense_time());
+    state.counters["t_sparse"] = double(solver.estimated_sparse_time());
+    state.SetLabel(solver.backend() == BACKEND_DENSE ? "dense" : "sparse");
+}
+
+static void sweep(benchmark::internal::Benchmark* b)
+{
+    for (int dim : {20, 50, 100, 200, 400, 800})
+    {
+        for (int density : {1, 2, 5, 10, 20, 50})
+        {
+            b->Args({dim, density});
+        }
+    }
+}
+
+BENCHMARK(BM_DENSE)->Apply(sweep)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_SPARSE)->Apply(sweep)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_AUTO)->Apply(sweep)->Unit(benchmark::kMicrosecond);
+
+int main(int argc, char** argv)
+{
+    // calibrate the cost model before any benchmark runs, which also stores it for the solver
+    const CostModel<T> model = CostModel<T>::calibrate_machine();
+    benchmark::AddCustomContext("dense_flops_per_sec", std::to_string(model.dense_flops_per_sec));
+    benchmark::AddCustomContext("sparse_flops_per_sec", std::to_string(model.sparse_flops_per_sec));
+    benchmark::AddCustomContext("dense_overhead", std::to_string(model.dense_overhead));
+    benchmark::AddCustomContext("sparse_overhead", std::to_string(model.sparse_overhead));
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -9,6 +9,7 @@
 
 #include "piqp/piqp.hpp"
 #include "piqp/utils/io_utils.hpp"
+#include "perf_counters.hpp"
 
 using T = double;
 using I = int;
@@ -20,11 +21,15 @@ static void BM_CHAIN_SQP_KKT_FULL(benchmark::State& state)
     piqp::SparseSolver<T, I, piqp::KKTMode::KKT_FULL> solver;
     solver.setup(model.P, model.c, model.A, model.b, model.G, model.h, model.x_lb, model.x_ub);
 
+    piqp::benchmark_utils::PhaseCounters counters;
+    counters.start();
     for (auto _ : state)
     {
         solver.update(model.P, model.c, model.A, model.b, model.G, model.h, model.x_lb, model.x_ub);
         solver.solve();
     }
+    counters.stop();
+    counters.report(state, solver.result().info.factor_flops);
 }
 
 static void BM_CHAIN_SQP_KKT_ALL_ELIMINATED(benchmark::State& state)
@@ -34,11 +39,15 @@ static void BM_CHAIN_SQP_KKT_ALL_ELIMINATED(benchmark::State& state)
     piqp::SparseSolver<T, I, piqp::KKTMode::KKT_ALL_ELIMINATED> solver;
     solver.setup(model.P, model.c, model.A, model.b, model.G, model.h, model.x_lb, model.x_ub);
 
+    piqp::benchmark_utils::PhaseCounters counters;
+    counters.start();
     for (auto _ : state)
     {
         solver.update(model.P, model.c, model.A, model.b, model.G, model.h, model.x_lb, model.x_ub);
         solver.solve();
     }
+    counters.stop();
+    counters.report(state, solver.result().info.factor_flops);
 }
 
 BENCHMARK(BM_CHAIN_SQP_KKT_FULL)->Unit(benchmark::kMicrosecond);
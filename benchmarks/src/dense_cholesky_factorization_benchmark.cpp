@@ -8,7 +8,9 @@
 #include <benchmark/benchmark.h>
 
 #include "piqp/dense/ldlt_no_pivot.hpp"
+#include "piqp/dense/ldlt_tuning.hpp"
 #include "piqp/utils/random_utils.hpp"
+#include "perf_counters.hpp"
 
 using namespace piqp;
 using namespace piqp::dense;
@@ -21,10 +23,14 @@ static void BM_EIGEN_LLT_LOWER(benchmark::State& state)
 
     Eigen::LLT<Mat<T>, Eigen::Lower> llt(P.rows());
 
+    benchmark_utils::PhaseCounters counters;
+    counters.start();
     for (auto _ : state)
     {
         llt.compute(P);
     }
+    counters.stop();
+    counters.report(state);
 }
 
 template<typename T>
@@ -34,10 +40,14 @@ static void BM_EIGEN_LLT_UPPER(benchmark::State& state)
 
     Eigen::LLT<Mat<T>, Eigen::Upper> llt(P.rows());
 
+    benchmark_utils::PhaseCounters counters;
+    counters.start();
     for (auto _ : state)
     {
         llt.compute(P);
     }
+    counters.stop();
+    counters.report(state);
 }
 
 template<typename T>
@@ -48,10 +58,14 @@ static void BM_EIGEN_LDLT_LOWER(benchmark::State& state)
 
     Eigen::LDLT<Mat<T>, Eigen::Lower> ldlt(P.rows());
 
+    benchmark_utils::PhaseCounters counters;
+    counters.start();
     for (auto _ : state)
     {
         ldlt.compute(P);
     }
+    counters.stop();
+    counters.report(state);
 }
 
 template<typename T>
@@ -61,10 +75,14 @@ static void BM_EIGEN_LDLT_UPPER(benchmark::State& state)
 
     Eigen::LDLT<Mat<T>, Eigen::Upper> ldlt(P.rows());
 
+    benchmark_utils::PhaseCounters counters;
+    counters.start();
     for (auto _ : state)
     {
         ldlt.compute(P);
     }
+    counters.stop();
+    counters.report(state);
 }
 
 template<typename T>
@@ -75,10 +93,14 @@ static void BM_PIQP_LDLT_NO_PIVOT_LOWER(benchmark::State& state)
 
     LDLTNoPivot<Mat<T>, Eigen::Lower> ldlt(P.rows());
 
+    benchmark_utils::PhaseCounters counters;
+    counters.start();
     for (auto _ : state)
     {
         ldlt.compute(P);
     }
+    counters.stop();
+    counters.report(state);
 }
 
 template<typename T>
@@ -88,10 +110,81 @@ static void BM_PIQP_LDLT_NO_PIVOT_UPPER(benchmark::State& state)
 
     LDLTNoPivot<Mat<T>, Eigen::Upper> ldlt(P.rows());
 
+    benchmark_utils::PhaseCounters counters;
+    counters.start();
     for (auto _ : state)
     {
         ldlt.compute(P);
     }
+    counters.stop();
+    counters.report(state);
+}
+
+template<typename T>
+static void BM_PIQP_LDLT_NO_PIVOT_LOWER_THREADED(benchmark::State& state)
+{
+    Mat<T> P = rand::dense_positive_definite_upper_triangular_rand<T>(state.range(0), 1.0);
+    P.transposeInPlace();
+
+    ThreadPool pool(state.range(1));
+    LDLTNoPivot<Mat<T>, Eigen::Lower> ldlt(P.rows());
+    ldlt.setThreadPool(&pool);
+
+    benchmark_utils::PhaseCounters counters;
+    counters.start();
+    for (auto _ : state)
+    {
+        ldlt.compute(P);
+    }
+    counters.stop();
+    counters.report(state);
+}
+
+// compares the kernels, range(1) is the kernel and range(2) the block size (0 = heuristic)
+template<typename T>
+static void BM_PIQP_LDLT_NO_PIVOT_LOWER_KERNEL(benchmark::State& state)
+{
+    Mat<T> P = rand::dense_positive_definite_upper_triangular_rand<T>(state.range(0), 1.0);
+    P.transposeInPlace();
+
+    LDLTNoPivot<Mat<T>, Eigen::Lower> ldlt(P.rows());
+    ldlt.setKernel(LDLTKernel(state.range(1)), state.range(2));
+
+    benchmark_utils::PhaseCounters counters;
+    counters.start();
+    for (auto _ : state)
+    {
+        ldlt.compute(P);
+    }
+    counters.stop();
+    counters.report(state);
+    T n = T(P.rows());
+    state.counters["FLOPS"] = benchmark::Counter(n * n * n / 3, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+// kernel and block size tuned for this machine, the tuning is stored in the cache used by the solver
+template<typename T>
+static void BM_PIQP_LDLT_NO_PIVOT_LOWER_TUNED(benchmark::State& state)
+{
+    Mat<T> P = rand::dense_positive_definite_upper_triangular_rand<T>(state.range(0), 1.0);
+    P.transposeInPlace();
+
+    static const LDLTTuning<T> tuning = LDLTTuning<T>::tune_machine();
+    LDLTNoPivot<Mat<T>, Eigen::Lower> ldlt(P.rows());
+    tuning.apply(ldlt);
+
+    benchmark_utils::PhaseCounters counters;
+    counters.start();
+    for (auto _ : state)
+    {
+        ldlt.compute(P);
+    }
+    counters.stop();
+    counters.report(state);
+    T n = T(P.rows());
+    state.counters["FLOPS"] = benchmark::Counter(n * n * n / 3, benchmark::Counter::kIsIterationInvariantRate);
+    state.counters["kernel"] = double(tuning.kernel);
+    state.counters["block_size"] = double(tuning.block_size);
 }
 
 BENCHMARK(BM_EIGEN_LLT_LOWER<double>)->RangeMultiplier(2)->Range(4, 1<<10)->Unit(benchmark::kMicrosecond);
@@ -100,5 +193,9 @@ BENCHMARK(BM_EIGEN_LDLT_LOWER<double>)->RangeMultiplier(2)->Range(4, 1<<10)->Uni
 BENCHMARK(BM_EIGEN_LDLT_UPPER<double>)->RangeMultiplier(2)->Range(4, 1<<10)->Unit(benchmark::kMicrosecond);
 BENCHMARK(BM_PIQP_LDLT_NO_PIVOT_LOWER<double>)->RangeMultiplier(2)->Range(4, 1<<10)->Unit(benchmark::kMicrosecond);
 BENCHMARK(BM_PIQP_LDLT_NO_PIVOT_UPPER<double>)->RangeMultiplier(2)->Range(4, 1<<10)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_PIQP_LDLT_NO_PIVOT_LOWER_THREADED<double>)->ArgsProduct({{256, 1024, 2048}, {1, 2, 4, 8}})->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_PIQP_LDLT_NO_PIVOT_LOWER_KERNEL<double>)->ArgsProduct({{500, 1000, 2000}, {LDLT_KERNEL_BLOCKED}, {0, 32, 64, 128}})->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_PIQP_LDLT_NO_PIVOT_LOWER_KERNEL<double>)->ArgsProduct({{500, 1000, 2000}, {LDLT_KERNEL_RECURSIVE}, {16, 32, 64}})->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_PIQP_LDLT_NO_PIVOT_LOWER_TUNED<double>)->Arg(500)->Arg(1000)->Arg(2000)->Unit(benchmark::kMicrosecond);
 
 BENCHMARK_MAIN();
@@ -10,6 +10,7 @@
 
 #include "piqp/piqp.hpp"
 #include "piqp/utils/random_utils.hpp"
+#include "perf_counters.hpp"
 
 using namespace piqp;
 
@@ -25,10 +26,38 @@ static void BM_DENSE_SOLVER(benchmark::State& state)
     DenseSolver<T> solver;
     solver.setup(qp_model.P, qp_model.c, qp_model.A, qp_model.b, qp_model.G, qp_model.h, qp_model.x_lb, qp_model.x_ub);
 
+    benchmark_utils::PhaseCounters counters;
+    counters.start();
     for (auto _ : state)
     {
         solver.solve();
     }
+    counters.stop();
+    counters.report(state, solver.result().info.factor_flops);
+}
+
+// dense problems with many inequalities where forming G^T W G dominates
+template<typename T>
+static void BM_DENSE_SOLVER_THREADED(benchmark::State& state)
+{
+    isize dim = state.range(0);
+    isize n_eq = dim / 4;
+    isize n_ineq = 4 * dim;
+
+    dense::Model<T> qp_model = rand::dense_strongly_convex_qp<T>(dim, n_eq, n_ineq);
+
+    DenseSolver<T> solver;
+    solver.settings().n_threads = state.range(1);
+    solver.setup(qp_model.P, qp_model.c, qp_model.A, qp_model.b, qp_model.G, qp_model.h, qp_model.x_lb, qp_model.x_ub);
+
+    benchmark_utils::PhaseCounters counters;
+    counters.start();
+    for (auto _ : state)
+    {
+        solver.solve();
+    }
+    counters.stop();
+    counters.report(state, solver.result().info.factor_flops);
 }
 
 template<typename T, typename I>
@@ -44,13 +73,18 @@ static void BM_SPARSE_SOLVER(benchmark::State& state)
     SparseSolver<T, I> solver;
     solver.setup(qp_model.P, qp_model.c, qp_model.A, qp_model.b, qp_model.G, qp_model.h, qp_model.x_lb, qp_model.x_ub);
 
+    benchmark_utils::PhaseCounters counters;
+    counters.start();
     for (auto _ : state)
     {
         solver.solve();
     }
+    counters.stop();
+    counters.report(state, solver.result().info.factor_flops);
 }
 
 BENCHMARK(BM_DENSE_SOLVER<double>)->RangeMultiplier(2)->Range(4, 1<<10)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_DENSE_SOLVER_THREADED<double>)->ArgsProduct({{256, 1024}, {1, 2, 4, 8}})->UseRealTime()->Unit(benchmark::kMillisecond);
 BENCHMARK(BM_SPARSE_SOLVER<double, int>)->RangeMultiplier(2)->Range(4, 1<<10)->Unit(benchmark::kMicrosecond);
 
 BENCHMARK_MAIN();
@@ -0,0 +1,349 @@
+// This file is part of PIQP.
+//
+// Copyright (c) 2024 EPFL
+//
+// This source code is licensed under the BSD 2-Clause License found in the
+// LICENSE file in the root directory of this source tree.
+
+// Measures the latency distribution of update() and solve() in a tight loop
+// as it appears in, e.g., model predictive control or SQP methods.
+//
+// usage: latency_benchmark [--problem random_sparse|random_dense|<model.mat>]
+//                          [--dim <n>] [--calls <n>] [--warmup <n>]
+//                          [--perturbation <relative magnitude>] [--cpu <id>]
+//                          [--seed <n>] [--output <latencies.csv>]
+//
+// In every call the vector c and the non-zero values of P, A and G are
+// perturbed randomly around the nominal problem. The matrix P is scaled
+// as D P D with a positive diagonal D, which preserves its sparsity pattern
+// and convexity. To keep the problems feasible, b and h are recomputed
+// from the nominal solution x* as b = A x* and h = G x* + s, where the
+// slacks s are perturbed around their nominal values. The first --warmup
+// calls are not recorded.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+#include "piqp/piqp.hpp"
+#include "piqp/utils/io_utils.hpp"
+#include "piqp/utils/random_utils.hpp"
+
+using T = double;
+using I = int;
+
+struct Options
+{
+    std::string problem = "random_sparse";
+    piqp::isize dim = 100;
+    long calls = 10000;
+    long warmup = 100;
+    T perturbation = 1e-2;
+    int cpu = -1;
+    unsigned seed = 42;
+    std::string output;
+};
+
+struct Latencies
+{
+    std::vector<T> update; // in seconds
+    std::vector<T> solve;
+    long failed = 0;
+};
+
+class Perturbation
+{
+protected:
+    std::mt19937 m_gen;
+    std::uniform_real_distribution<T> m_dist;
+
+public:
+    Perturbation(unsigned seed, T magnitude) : m_gen(seed), m_dist(-magnitude, magnitude) {}
+
+    T operator()() { return m_dist(m_gen); }
+
+    void vec(const piqp::Vec<T>& nominal, piqp::Vec<T>& x)
+    {
+        for (piqp::isize i = 0; i < x.rows(); i++)
+        {
+            x[i] = nominal[i] * (1 + (*this)()) + (*this)() * 1e-3;
+        }
+    }
+
+    // keeps the sign of the nominal values
+    void slacks(const piqp::Vec<T>& nominal, piqp::Vec<T>& x)
+    {
+        using std::abs;
+        for (piqp::isize i = 0; i < x.rows(); i++)
+        {
+            x[i] = nominal[i] * (1 + (*this)()) + abs((*this)()) * 1e-3;
+        }
+    }
+
+    void values(const piqp::SparseMat<T, I>& nominal, piqp::SparseMat<T, I>& X)
+    {
+        for (piqp::isize k = 0; k < X.nonZeros(); k++)
+        {
+            X.valuePtr()[k] = nominal.valuePtr()[k] * (1 + (*this)());
+        }
+    }
+
+    void values(const piqp::Mat<T>& nominal, piqp::Mat<T>& X)
+    {
+        for (piqp::isize k = 0; k < X.size(); k++)
+        {
+            X.data()[k] = nominal.data()[k] * (1 + (*this)());
+        }
+    }
+
+    void diag_scaling(piqp::Vec<T>& d)
+    {
+        for (piqp::isize i = 0; i < d.rows(); i++)
+        {
+            d[i] = 1 + (*this)();
+        }
+    }
+};
+
+template<typename Model>
+struct NominalPoint
+{
+    piqp::Vec<T> x; // nominal solution
+    piqp::Vec<T> s; // nominal slacks of the inequality constraints
+    piqp::Vec<T> d; // workspace for the scaling of P
+
+    NominalPoint(const Model& nominal, const piqp::Vec<T>& x_sol)
+      : x(x_sol), s(nominal.h - nominal.G * x_sol), d(x_sol.rows())
+    {
+        s = s.cwiseMax(0);
+    }
+};
+
+static void perturb(Perturbation& perturbation, const piqp::sparse::Model<T, I>& nominal,
+                    NominalPoint<piqp::sparse::Model<T, I>>& point, piqp::sparse::Model<T, I>& model)
+{
+    piqp::Vec<T>& d = point.d;
+    perturbation.diag_scaling(d);
+    for (piqp::isize j = 0; j < model.P.outerSize(); j++)
+    {
+        for (piqp::isize k = model.P.outerIndexPtr()[j]; k < model.P.outerIndexPtr()[j + 1]; k++)
+        {
+            piqp::isize i = model.P.innerIndexPtr()[k];
+            model.P.valuePtr()[k] = d[i] * nominal.P.valuePtr()[k] * d[j];
+        }
+    }
+    perturbation.values(nominal.A, model.A);
+    perturbation.values(nominal.G, model.G);
+    perturbation.vec(nominal.c, model.c);
+    model.b.noalias() = model.A * point.x;
+    perturbation.slacks(point.s, model.h);
+    model.h.noalias() += model.G * point.x;
+}
+
+static void perturb(Perturbation& perturbation, const piqp::dense::Model<T>& nominal,
+                    NominalPoint<piqp::dense::Model<T>>& point, piqp::dense::Model<T>& model)
+{
+    piqp::Vec<T>& d = point.d;
+    perturbation.diag_scaling(d);
+    model.P.noalias() = d.asDiagonal() * nominal.P * d.asDiagonal();
+    perturbation.values(nominal.A, model.A);
+    perturbation.values(nominal.G, model.G);
+    perturbation.vec(nominal.c, model.c);
+    model.b.noalias() = model.A * point.x;
+    perturbation.slacks(point.s, model.h);
+    model.h.noalias() += model.G * point.x;
+}
+
+template<typename Solver, typename Model>
+Latencies run(const Options& options, const Model& nominal)
+{
+    using clock = std::chrono::steady_clock;
+
+    Latencies latencies;
+    latencies.update.reserve(std::size_t(options.calls));
+    latencies.solve.reserve(std::size_t(options.calls));
+
+    Perturbation perturbation(options.seed, options.perturbation);
+    Model model = nominal;
+
+    Solver solver;
+    solver.setup(model.P, model.c, model.A, model.b, model.G, model.h, model.x_lb, model.x_ub);
+    if (solver.solve() != piqp::Status::PIQP_SOLVED)
+    {
+        piqp_eprint("nominal problem could not be solved\n");
+    }
+    NominalPoint<Model> point(nominal, solver.result().x);
+
+    for (long k = 0; k < options.warmup + options.calls; k++)
+    {
+        perturb(perturbation, nominal, point, model);
+
+        auto t0 = clock::now();
+        solver.update(model.P, model.c, model.A, model.b, model.G, model.h, model.x_lb, model.x_ub);
+        auto t1 = clock::now();
+        piqp::Status status = solver.solve();
+        auto t2 = clock::now();
+
+        if (k < options.warmup) continue;
+        latencies.update.push_back(std::chrono::duration<T>(t1 - t0).count());
+        latencies.solve.push_back(std::chrono::duration<T>(t2 - t1).count());
+        if (status != piqp::Status::PIQP_SOLVED) latencies.failed++;
+    }
+
+    return latencies;
+}
+
+static T percentile(const std::vector<T>& sorted, T p)
+{
+    if (sorted.empty()) return 0;
+    // nearest-rank method
+    std::size_t rank = std::size_t(std::ceil(p / 100 * T(sorted.size())));
+    return sorted[std::min(sorted.size(), std::max(rank, std::size_t(1))) - 1];
+}
+
+static void print_distribution(const char* name, std::vector<T> latencies)
+{
+    std::sort(latencies.begin(), latencies.end());
+    T mean = 0;
+    for (T t : latencies) mean += t;
+    mean /= T(std::max(latencies.size(), std::size_t(1)));
+
+    piqp_print("%-8s %10.2f %10.2f %10.2f %10.2f %10.2f %10.2f %10.2f\n", name,
+               mean * 1e6, percentile(latencies, 50) * 1e6, percentile(latencies, 90) * 1e6,
+               percentile(latencies, 99) * 1e6, percentile(latencies, 99.9) * 1e6,
+               latencies.front() * 1e6, latencies.back() * 1e6);
+}
+
+static void print_histogram(const char* name, const std::vector<T>& latencies)
+{
+    // logarithmic buckets with two buckets per power of two, starting at 1us
+    const int n_buckets = 48;
+    std::vector<long> buckets(n_buckets, 0);
+    for (T t : latencies)
+    {
+        int b = t <= 1e-6 ? 0 : int(std::floor(2 * std::log2(t * 1e6)));
+        buckets[std::size_t(std::min(std::max(b, 0), n_buckets - 1))]++;
+    }
+    long max_count = *std::max_element(buckets.begin(), buckets.end());
+
+    piqp_print("\n%s latency histogram [us]\n", name);
+    for (int b = 0; b < n_buckets; b++)
+    {
+        if (buckets[std::size_t(b)] == 0) continue;
+        int bar = int(50 * buckets[std::size_t(b)] / max_count);
+        piqp_print("%10.1f - %10.1f %8ld |%s\n", std::pow(2.0, b / 2.0), std::pow(2.0, (b + 1) / 2.0),
+                   buckets[std::size_t(b)], std::string(std::size_t(std::max(bar, 1)), '#').c_str());
+    }
+}
+
+static bool pin_to_cpu(int cpu)
+{
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    (void) cpu;
+    return false;
+#endif
+}
+
+static bool parse_options(int argc, char** argv, Options& options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (i + 1 >= argc)
+        {
+            piqp_eprint("missing value for %s\n", arg.c_str());
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--problem") options.problem = value;
+        else if (arg == "--dim") options.dim = std::strtol(value.c_str(), nullptr, 10);
+        else if (arg == "--calls") options.calls = std::max(1L, std::strtol(value.c_str(), nullptr, 10));
+        else if (arg == "--warmup") options.warmup = std::max(0L, std::strtol(value.c_str(), nullptr, 10));
+        else if (arg == "--perturbation") options.perturbation = std::strtod(value.c_str(), nullptr);
+        else if (arg == "--cpu") options.cpu = int(std::strtol(value.c_str(), nullptr, 10));
+        else if (arg == "--seed") options.seed = unsigned(std::strtoul(value.c_str(), nullptr, 10));
+        else if (arg == "--output") options.output = value;
+        else
+        {
+            piqp_eprint("unknown option %s\n", arg.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parse_options(argc, argv, options)) return 2;
+
+#ifdef PIQP_WITH_TRACING
+    // recording the traced spans would add its overhead to the measured latencies
+    piqp::tracing::Recorder::instance().set_recording(false);
+#endif
+
+    if (options.cpu >= 0 && !pin_to_cpu(options.cpu))
+    {
+        piqp_eprint("could not pin thread to cpu %d\n", options.cpu);
+    }
+
+    Latencies latencies;
+    if (options.problem == "random_dense")
+    {
+        piqp::dense::Model<T> model = piqp::rand::dense_strongly_convex_qp<T>(options.dim, options.dim / 2, options.dim / 2);
+        latencies = run<piqp::DenseSolver<T>>(options, model);
+    }
+    else
+    {
+        piqp::sparse::Model<T, I> model = options.problem == "random_sparse"
+            ? piqp::rand::sparse_strongly_convex_qp<T, I>(options.dim, options.dim / 2, options.dim / 2, 0.1)
+            : piqp::load_sparse_model<T, I>(options.problem);
+        latencies = run<piqp::SparseSolver<T, I>>(options, model);
+    }
+
+    std::vector<T> total(latencies.update.size());
+    for (std::size_t k = 0; k < total.size(); k++)
+    {
+        total[k] = latencies.update[k] + latencies.solve[k];
+    }
+
+    piqp_print("problem %s, %ld calls, %ld warmup calls, %ld not solved\n\n",
+               options.problem.c_str(), options.calls, options.warmup, latencies.failed);
+    piqp_print("%-8s %10s %10s %10s %10s %10s %10s %10s\n", "[us]", "mean", "p50", "p90", "p99", "p99.9", "min", "max");
+    print_distribution("update", latencies.update);
+    print_distribution("solve", latencies.solve);
+    print_distribution("total", total);
+    print_histogram("update + solve", total);
+
+    if (!options.output.empty())
+    {
+        std::ofstream file(options.output);
+        if (!file.is_open())
+        {
+            piqp_eprint("could not open %s\n", options.output.c_str());
+            return 2;
+        }
+        file << "update,solve\n";
+        for (std::size_t k = 0; k < total.size(); k++)
+        {
+            file << latencies.update[k] << ',' << latencies.solve[k] << '\n';
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,469 @@
+// This file is part of PIQP.
+//
+// Copyright (c) 2024 EPFL
+//
+// This source code is licensed under the BSD 2-Clause License found in the
+// LICENSE file in the root directory of this source tree.
+
+// Runs the Maros-Meszaros test set through all solver variants and reports
+// shifted geometric means and performance profiles of the run times.
+//
+// usage: maros_meszaros_benchmark [--data <dir>] [--output <results.json>]
+//                                 [--baseline <baseline.json>] [--threshold <ratio>]
+//                                 [--filter <substring>] [--dense-max-size <n>]
+//                                 [--repeat <n>] [--shift <seconds>]
+//
+// Runs which fail or are skipped (dense solver on problems larger than
+// --dense-max-size) are counted with a penalty time of 10 times the largest
+// run time of all successful runs. If a baseline generated by this tool is
+// given, the program exits with a non-zero code if a solver fails on a problem
+// which was solved in the baseline, or if the run time of a problem or the
+// shifted geometric mean of a solver increased by more than the threshold.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "piqp/piqp.hpp"
+#include "piqp/utils/filesystem.hpp"
+#include "piqp/utils/io_utils.hpp"
+
+using T = double;
+using I = int;
+
+struct Options
+{
+#ifdef PIQP_MAROS_MESZAROS_DATA_DIR
+    std::string data_dir = PIQP_MAROS_MESZAROS_DATA_DIR;
+#else
+    std::string data_dir = "maros_meszaros_data";
+#endif
+    std::string output;
+    std::string baseline;
+    std::string filter;
+    T threshold = 0.2;
+    T shift = 10;
+    piqp::isize dense_max_size = 1000;
+    int repeat = 1;
+};
+
+struct RunResult
+{
+    std::string problem;
+    std::string solver;
+    bool skipped = false;
+    piqp::Status status = piqp::Status::PIQP_UNSOLVED;
+    piqp::isize iter = 0;
+    piqp::isize factorizations = 0;
+    T setup_time = 0;
+    T solve_time = 0;
+    T run_time = 0;
+
+    bool solved() const { return !skipped && status == piqp::Status::PIQP_SOLVED; }
+};
+
+#ifdef PIQP_WITH_TRACING
+// counts the numeric factorizations using the tracing hooks
+static piqp::isize factorization_counter = 0;
+
+static void count_factorizations(const char* name, void*)
+{
+    if (std::strcmp(name, "factorize") == 0) factorization_counter++;
+}
+#endif
+
+template<typename Solver, typename Model>
+RunResult run_solver(const std::string& problem, const std::string& solver_name, const Model& model, int repeat)
+{
+    RunResult result;
+    result.problem = problem;
+    result.solver = solver_name;
+    result.setup_time = std::numeric_limits<T>::infinity();
+    result.solve_time = std::numeric_limits<T>::infinity();
+    result.run_time = std::numeric_limits<T>::infinity();
+
+    for (int r = 0; r < repeat; r++)
+    {
+#ifdef PIQP_WITH_TRACING
+        factorization_counter = 0;
+#endif
+        Solver solver;
+        solver.settings().compute_timings = true;
+        solver.setup(model.P, model.c, model.A, model.b, model.G, model.h, model.x_lb, model.x_ub);
+        piqp::Status status = solver.solve();
+
+        const piqp::Info<T>& info = solver.result().info;
+        result.status = status;
+        result.iter = info.iter;
+#ifdef PIQP_WITH_TRACING
+        result.factorizations = factorization_counter;
+#else
+        result.factorizations = -1;
+#endif
+        // best of all repetitions
+        if (info.run_time < result.run_time)
+        {
+            result.setup_time = info.setup_time;
+            result.solve_time = info.solve_time;
+            result.run_time = info.run_time;
+        }
+    }
+
+    return result;
+}
+
+static std::vector<std::string> get_problems(const Options& options)
+{
+    std::vector<std::string> problems;
+    for (const auto& entry : piqp::fs::directory_iterator(options.data_dir))
+    {
+        std::string file_name = entry.path().filename().string();
+        if (file_name == "README.md" || file_name == "LICENSE") continue;
+        if (!options.filter.empty() && file_name.find(options.filter) == std::string::npos) continue;
+
+        problems.push_back(file_name);
+    }
+    std::sort(problems.begin(), problems.end());
+    return problems;
+}
+
+static T shifted_geometric_mean(const std::vector<T>& times, T shift)
+{
+    if (times.empty()) return 0;
+    T log_sum = 0;
+    for (T t : times)
+    {
+        log_sum += std::log(t + shift);
+    }
+    return std::exp(log_sum / T(times.size())) - shift;
+}
+
+static std::string json_number(T x)
+{
+    // JSON has no representation for inf and nan
+    if (!std::isfinite(x)) return "null";
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.9g", x);
+    return buffer;
+}
+
+static void write_json(const std::string& path, const Options& options,
+                       const std::vector<RunResult>& results,
+                       const std::vector<std::string>& solvers,
+                       const std::map<std::string, T>& sgm)
+{
+    std::ofstream file(path);
+    if (!file.is_open())
+    {
+        piqp_eprint("could not open %s\n", path.c_str());
+        return;
+    }
+
+    // one result per line, this allows reading back the file without a full JSON parser
+    file << "{\n";
+    file << "\"shift\": " << json_number(options.shift) << ",\n";
+    file << "\"summary\": [\n";
+    for (std::size_t i = 0; i < solvers.size(); i++)
+    {
+        const std::string& s = solvers[i];
+        piqp::isize solved = std::count_if(results.begin(), results.end(),
+                                           [&](const RunResult& r) { return r.solver == s && r.solved(); });
+        file << "{\"solver\": \"" << s << "\", \"solved\": " << solved
+             << ", \"sgm_run_time\": " << json_number(sgm.at(s)) << "}"
+             << (i + 1 < solvers.size() ? ",\n" : "\n");
+    }
+    file << "],\n";
+    file << "\"results\": [\n";
+    for (std::size_t i = 0; i < results.size(); i++)
+    {
+        const RunResult& r = results[i];
+        file << "{\"problem\": \"" << r.problem << "\", \"solver\": \"" << r.solver << "\""
+             << ", \"status\": \"" << (r.skipped ? "skipped" : piqp::status_to_string(r.status)) << "\""
+             << ", \"iter\": " << r.iter
+             << ", \"factorizations\": " << r.factorizations
+             << ", \"setup_time\": " << json_number(r.setup_time)
+             << ", \"solve_time\": " << json_number(r.solve_time)
+             << ", \"run_time\": " << json_number(r.run_time) << "}"
+             << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    file << "]\n}\n";
+}
+
+// extracts "key": value from a single line written by write_json
+static bool extract_field(const std::string& line, const std::string& key, std::string& value)
+{
+    std::string pattern = "\"" + key + "\": ";
+    std::size_t pos = line.find(pattern);
+    if (pos == std::string::npos) return false;
+    pos += pattern.size();
+    if (line[pos] == '"')
+    {
+        std::size_t end = line.find('"', pos + 1);
+        if (end == std::string::npos) return false;
+        value = line.substr(pos + 1, end - pos - 1);
+    }
+    else
+    {
+        std::size_t end = line.find_first_of(",}", pos);
+        value = line.substr(pos, end - pos);
+    }
+    return true;
+}
+
+static T parse_number(const std::string& value)
+{
+    if (value == "null") return std::numeric_limits<T>::infinity();
+    return std::strtod(value.c_str(), nullptr);
+}
+
+struct Baseline
+{
+    std::map<std::pair<std::string, std::string>, std::pair<bool, T>> runs; // (problem, solver) -> (solved, run time)
+    std::map<std::string, T> sgm;                                            // solver -> shifted geometric mean
+};
+
+static bool load_baseline(const std::string& path, Baseline& baseline)
+{
+    std::ifstream file(path);
+    if (!file.is_open()) return false;
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::string solver, problem, status, value;
+        if (!extract_field(line, "solver", solver)) continue;
+        if (extract_field(line, "problem", problem))
+        {
+            if (!extract_field(line, "status", status) || !extract_field(line, "run_time", value)) continue;
+            baseline.runs[{problem, solver}] = {status == "solved", parse_number(value)};
+        }
+        else if (extract_field(line, "sgm_run_time", value))
+        {
+            baseline.sgm[solver] = parse_number(value);
+        }
+    }
+    return true;
+}
+
+static int compare_baseline(const Options& options, const Baseline& baseline,
+                            const std::vector<RunResult>& results,
+                            const std::map<std::string, T>& sgm)
+{
+    // run time differences below this value are considered as noise
+    const T min_abs_diff = 1e-3;
+
+    int n_regressions = 0;
+    piqp_print("\nregressions compared to baseline %s (threshold %.0f%%):\n", options.baseline.c_str(), options.threshold * 100);
+    for (const RunResult& r : results)
+    {
+        auto it = baseline.runs.find({r.problem, r.solver});
+        if (it == baseline.runs.end() || !it->second.first) continue;
+
+        T base_time = it->second.second;
+        if (!r.solved())
+        {
+            piqp_print("  %-24s %-28s solved in baseline, now %s\n", r.problem.c_str(), r.solver.c_str(),
+                       r.skipped ? "skipped" : piqp::status_to_string(r.status));
+            n_regressions++;
+        }
+        else if (r.run_time > (1 + options.threshold) * base_time && r.run_time - base_time > min_abs_diff)
+        {
+            piqp_print("  %-24s %-28s run time %.3es -> %.3es (%+.0f%%)\n", r.problem.c_str(), r.solver.c_str(),
+                       base_time, r.run_time, (r.run_time / base_time - 1) * 100);
+            n_regressions++;
+        }
+    }
+    for (const auto& s : sgm)
+    {
+        auto it = baseline.sgm.find(s.first);
+        if (it == baseline.sgm.end()) continue;
+        if (s.second > (1 + options.threshold) * it->second)
+        {
+            piqp_print("  %-24s %-28s shifted geometric mean %.3es -> %.3es (%+.0f%%)\n", "", s.first.c_str(),
+                       it->second, s.second, (s.second / it->second - 1) * 100);
+            n_regressions++;
+        }
+    }
+    if (n_regressions == 0)
+    {
+        piqp_print("  none\n");
+    }
+    return n_regressions;
+}
+
+static bool parse_options(int argc, char** argv, Options& options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (i + 1 >= argc)
+        {
+            piqp_eprint("missing value for %s\n", arg.c_str());
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--data") options.data_dir = value;
+        else if (arg == "--output") options.output = value;
+        else if (arg == "--baseline") options.baseline = value;
+        else if (arg == "--filter") options.filter = value;
+        else if (arg == "--threshold") options.threshold = std::strtod(value.c_str(), nullptr);
+        else if (arg == "--shift") options.shift = std::strtod(value.c_str(), nullptr);
+        else if (arg == "--dense-max-size") options.dense_max_size = std::strtol(value.c_str(), nullptr, 10);
+        else if (arg == "--repeat") options.repeat = std::max(1, int(std::strtol(value.c_str(), nullptr, 10)));
+        else
+        {
+            piqp_eprint("unknown option %s\n", arg.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parse_options(argc, argv, options)) return 2;
+
+#ifdef PIQP_WITH_TRACING
+    piqp::tracing::Recorder& recorder = piqp::tracing::Recorder::instance();
+    recorder.set_recording(false);
+    piqp::tracing::Hooks hooks;
+    hooks.begin = &count_factorizations;
+    recorder.set_hooks(hooks);
+#endif
+
+    using SparseModel = piqp::sparse::Model<T, I>;
+    using DenseModel = piqp::dense::Model<T>;
+    std::vector<std::pair<std::string, std::function<RunResult(const std::string&, const SparseModel&)>>> solvers = {
+        {"sparse_kkt_full", [&](const std::string& p, const SparseModel& m) {
+            return run_solver<piqp::SparseSolver<T, I, piqp::KKTMode::KKT_FULL>>(p, "sparse_kkt_full", m, options.repeat);
+        }},
+        {"sparse_kkt_eq_eliminated", [&](const std::string& p, const SparseModel& m) {
+            return run_solver<piqp::SparseSolver<T, I, piqp::KKTMode::KKT_EQ_ELIMINATED>>(p, "sparse_kkt_eq_eliminated", m, options.repeat);
+        }},
+        {"sparse_kkt_ineq_eliminated", [&](const std::string& p, const SparseModel& m) {
+            return run_solver<piqp::SparseSolver<T, I, piqp::KKTMode::KKT_INEQ_ELIMINATED>>(p, "sparse_kkt_ineq_eliminated", m, options.repeat);
+        }},
+        {"sparse_kkt_all_eliminated", [&](const std::string& p, const SparseModel& m) {
+            return run_solver<piqp::SparseSolver<T, I, piqp::KKTMode::KKT_ALL_ELIMINATED>>(p, "sparse_kkt_all_eliminated", m, options.repeat);
+        }},
+        {"dense", [&](const std::string& p, const SparseModel& m) {
+            RunResult result;
+            if (m.P.rows() + m.A.rows() + m.G.rows() > options.dense_max_size)
+            {
+                result.problem = p;
+                result.solver = "dense";
+                result.skipped = true;
+                return result;
+            }
+            SparseModel model_copy = m;
+            DenseModel dense_model = model_copy.dense_model();
+            return run_solver<piqp::DenseSolver<T>>(p, "dense", dense_model, options.repeat);
+        }}
+    };
+    std::vector<std::string> solver_names;
+    for (const auto& s : solvers) solver_names.push_back(s.first);
+
+    std::vector<std::string> problems = get_problems(options);
+    std::vector<RunResult> results;
+
+    piqp_print("%-24s %-28s %-22s %6s %8s %12s\n", "problem", "solver", "status", "iter", "factor", "run time [s]");
+    for (const std::string& problem : problems)
+    {
+        SparseModel model = piqp::load_sparse_model<T, I>(options.data_dir + "/" + problem);
+        std::string name = problem.substr(0, problem.find('.'));
+
+        for (const auto& solver : solvers)
+        {
+            RunResult r = solver.second(name, model);
+            piqp_print("%-24s %-28s %-22s %6zd %8zd %12.3e\n", name.c_str(), r.solver.c_str(),
+                       r.skipped ? "skipped" : piqp::status_to_string(r.status),
+                       r.iter, r.factorizations, r.run_time);
+            results.push_back(r);
+        }
+    }
+
+    // penalty time for failed and skipped runs
+    T max_time = 0;
+    for (const RunResult& r : results)
+    {
+        if (r.solved()) max_time = std::max(max_time, r.run_time);
+    }
+    T penalty = 10 * max_time;
+    auto penalized_time = [&](const RunResult& r) { return r.solved() ? r.run_time : penalty; };
+
+    std::map<std::string, T> sgm;
+    piqp_print("\n%-28s %8s %22s\n", "solver", "solved", "shifted geo. mean [s]");
+    for (const std::string& s : solver_names)
+    {
+        std::vector<T> times;
+        piqp::isize solved = 0;
+        for (const RunResult& r : results)
+        {
+            if (r.solver != s) continue;
+            times.push_back(penalized_time(r));
+            if (r.solved()) solved++;
+        }
+        sgm[s] = shifted_geometric_mean(times, options.shift);
+        piqp_print("%-28s %4zd/%-4zd %22.6e\n", s.c_str(), solved, piqp::isize(times.size()), sgm[s]);
+    }
+
+    // performance profile: fraction of problems solved within tau times the best run time
+    std::map<std::string, std::vector<T>> ratios;
+    for (std::size_t p = 0; p < problems.size(); p++)
+    {
+        T best = std::numeric_limits<T>::infinity();
+        for (std::size_t s = 0; s < solvers.size(); s++)
+        {
+            const RunResult& r = results[p * solvers.size() + s];
+            if (r.solved()) best = std::min(best, r.run_time);
+        }
+        for (std::size_t s = 0; s < solvers.size(); s++)
+        {
+            const RunResult& r = results[p * solvers.size() + s];
+            ratios[r.solver].push_back(r.solved() ? r.run_time / std::max(best, std::numeric_limits<T>::min())
+                                                  : std::numeric_limits<T>::infinity());
+        }
+    }
+    const T taus[] = {1, 1.5, 2, 4, 8, 16, 32, 64, 128};
+    piqp_print("\nperformance profile\n%-28s", "solver \\ tau");
+    for (T tau : taus) piqp_print(" %6g", tau);
+    piqp_print("\n");
+    for (const std::string& s : solver_names)
+    {
+        piqp_print("%-28s", s.c_str());
+        for (T tau : taus)
+        {
+            const std::vector<T>& r = ratios[s];
+            piqp::isize count = std::count_if(r.begin(), r.end(), [&](T ratio) { return ratio <= tau; });
+            piqp_print(" %6.3f", r.empty() ? T(0) : T(count) / T(r.size()));
+        }
+        piqp_print("\n");
+    }
+
+    if (!options.output.empty())
+    {
+        write_json(options.output, options, results, solver_names, sgm);
+    }
+
+    if (!options.baseline.empty())
+    {
+        Baseline baseline;
+        if (!load_baseline(options.baseline, baseline))
+        {
+            piqp_eprint("could not read baseline %s\n", options.baseline.c_str());
+            return 2;
+        }
+        if (compare_baseline(options, baseline, results, sgm) > 0) return 1;
+    }
+
+    return 0;
+}
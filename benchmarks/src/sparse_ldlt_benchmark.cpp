@@ -0,0 +1,193 @@
+// This file is part of PIQP.
+//
+// Copyright (c) 2024 EPFL
+//
+// This source code is licensed under the BSD 2-Clause License found in the
+// LICENSE file in the root directory of this source tree.
+
+// Benchmarks the sparse LDL^T factorization on the permuted KKT matrices of the
+// Maros-Meszaros problems for every KKT mode, with Eigen's SimplicialLDLT on the
+// same (already permuted) matrices as baseline. The FLOPS counter is based on the
+// flop counts of the symbolic analysis of piqp::sparse::LDLt.
+//
+// usage: sparse_ldlt_benchmark [--benchmark_filter=<regex>] ...
+// The benchmarks are named BM_<LDLT>_<PHASE>/<KKT_MODE>/<PROBLEM>.
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <Eigen/SparseCholesky>
+
+#include "piqp/piqp.hpp"
+#include "piqp/utils/filesystem.hpp"
+#include "piqp/utils/io_utils.hpp"
+
+using namespace piqp;
+
+using T = double;
+using I = int;
+
+#ifdef PIQP_MAROS_MESZAROS_DATA_DIR
+static const std::string data_dir = PIQP_MAROS_MESZAROS_DATA_DIR;
+#else
+static const std::string data_dir = "maros_meszaros_data";
+#endif
+
+// permuted KKT matrix (upper triangular part) of the problem at the initial regularization
+template<int Mode>
+SparseMat<T, I> permuted_kkt_matrix(const std::string& problem)
+{
+    sparse::Model<T, I> model = load_sparse_model<T, I>(data_dir + "/" + problem);
+    sparse::Data<T, I> data(model);
+    Settings<T> settings;
+    sparse::KKT<T, I, Mode> kkt(data, settings);
+    kkt.init(settings.rho_init, settings.delta_init);
+    return kkt.PKPt;
+}
+
+template<int Mode>
+static void BM_PIQP_LDLT_SYMBOLIC(benchmark::State& state, const std::string& problem)
+{
+    SparseMat<T, I> PKPt = permuted_kkt_matrix<Mode>(problem);
+    sparse::LDLt<T, I> ldlt;
+
+    for (auto _ : state)
+    {
+        ldlt.factorize_symbolic_upper_triangular(PKPt);
+    }
+    state.counters["n"] = double(PKPt.rows());
+    state.counters["nnz_L"] = double(ldlt.stats.nnz);
+}
+
+template<int Mode>
+static void BM_PIQP_LDLT_NUMERIC(benchmark::State& state, const std::string& problem)
+{
+    SparseMat<T, I> PKPt = permuted_kkt_matrix<Mode>(problem);
+    sparse::LDLt<T, I> ldlt;
+    ldlt.factorize_symbolic_upper_triangular(PKPt);
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(ldlt.factorize_numeric_upper_triangular(PKPt));
+    }
+    state.counters["n"] = double(PKPt.rows());
+    state.counters["nnz_L"] = double(ldlt.stats.nnz);
+    state.counters["FLOPS"] = benchmark::Counter(ldlt.stats.factor_flops, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+template<int Mode>
+static void BM_PIQP_LDLT_SOLVE(benchmark::State& state, const std::string& problem)
+{
+    SparseMat<T, I> PKPt = permuted_kkt_matrix<Mode>(problem);
+    sparse::LDLt<T, I> ldlt;
+    ldlt.factorize_symbolic_upper_triangular(PKPt);
+    ldlt.factorize_numeric_upper_triangular(PKPt);
+    Vec<T> rhs = Vec<T>::Ones(PKPt.rows());
+    Vec<T> x(PKPt.rows());
+
+    for (auto _ : state)
+    {
+        x = rhs;
+        ldlt.solve_inplace(x);
+        benchmark::DoNotOptimize(x.data());
+    }
+    state.counters["n"] = double(PKPt.rows());
+    state.counters["nnz_L"] = double(ldlt.stats.nnz);
+    state.counters["FLOPS"] = benchmark::Counter(ldlt.stats.solve_flops, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+using EigenLDLT = Eigen::SimplicialLDLT<SparseMat<T, I>, Eigen::Upper, Eigen::NaturalOrdering<I>>;
+
+template<int Mode>
+static void BM_EIGEN_LDLT_SYMBOLIC(benchmark::State& state, const std::string& problem)
+{
+    SparseMat<T, I> PKPt = permuted_kkt_matrix<Mode>(problem);
+    EigenLDLT ldlt;
+
+    for (auto _ : state)
+    {
+        ldlt.analyzePattern(PKPt);
+    }
+    state.counters["n"] = double(PKPt.rows());
+}
+
+template<int Mode>
+static void BM_EIGEN_LDLT_NUMERIC(benchmark::State& state, const std::string& problem)
+{
+    SparseMat<T, I> PKPt = permuted_kkt_matrix<Mode>(problem);
+    EigenLDLT ldlt;
+    ldlt.analyzePattern(PKPt);
+    // the flop count is the same for both implementations since the ordering is the same
+    sparse::LDLt<T, I> piqp_ldlt;
+    piqp_ldlt.factorize_symbolic_upper_triangular(PKPt);
+
+    for (auto _ : state)
+    {
+        ldlt.factorize(PKPt);
+    }
+    state.counters["n"] = double(PKPt.rows());
+    state.counters["nnz_L"] = double(piqp_ldlt.stats.nnz);
+    state.counters["FLOPS"] = benchmark::Counter(piqp_ldlt.stats.factor_flops, benchmark::Counter::kIsIterationInvariantRate);
+    if (ldlt.info() != Eigen::Success) state.SetLabel("factorization failed");
+}
+
+template<int Mode>
+static void BM_EIGEN_LDLT_SOLVE(benchmark::State& state, const std::string& problem)
+{
+    SparseMat<T, I> PKPt = permuted_kkt_matrix<Mode>(problem);
+    EigenLDLT ldlt;
+    ldlt.compute(PKPt);
+    sparse::LDLt<T, I> piqp_ldlt;
+    piqp_ldlt.factorize_symbolic_upper_triangular(PKPt);
+    Vec<T> rhs = Vec<T>::Ones(PKPt.rows());
+    Vec<T> x(PKPt.rows());
+
+    for (auto _ : state)
+    {
+        x = ldlt.solve(rhs);
+        benchmark::DoNotOptimize(x.data());
+    }
+    state.counters["n"] = double(PKPt.rows());
+    state.counters["nnz_L"] = double(piqp_ldlt.stats.nnz);
+    state.counters["FLOPS"] = benchmark::Counter(piqp_ldlt.stats.solve_flops, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+template<int Mode>
+static void register_benchmarks(const std::string& mode_name, const std::string& problem)
+{
+    std::string suffix = "/" + mode_name + "/" + problem.substr(0, problem.find('.'));
+    benchmark::RegisterBenchmark(("BM_PIQP_LDLT_SYMBOLIC" + suffix).c_str(), BM_PIQP_LDLT_SYMBOLIC<Mode>, problem)->Unit(benchmark::kMicrosecond);
+    benchmark::RegisterBenchmark(("BM_EIGEN_LDLT_SYMBOLIC" + suffix).c_str(), BM_EIGEN_LDLT_SYMBOLIC<Mode>, problem)->Unit(benchmark::kMicrosecond);
+    benchmark::RegisterBenchmark(("BM_PIQP_LDLT_NUMERIC" + suffix).c_str(), BM_PIQP_LDLT_NUMERIC<Mode>, problem)->Unit(benchmark::kMicrosecond);
+    benchmark::RegisterBenchmark(("BM_EIGEN_LDLT_NUMERIC" + suffix).c_str(), BM_EIGEN_LDLT_NUMERIC<Mode>, problem)->Unit(benchmark::kMicrosecond);
+    benchmark::RegisterBenchmark(("BM_PIQP_LDLT_SOLVE" + suffix).c_str(), BM_PIQP_LDLT_SOLVE<Mode>, problem)->Unit(benchmark::kMicrosecond);
+    benchmark::RegisterBenchmark(("BM_EIGEN_LDLT_SOLVE" + suffix).c_str(), BM_EIGEN_LDLT_SOLVE<Mode>, problem)->Unit(benchmark::kMicrosecond);
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> problems;
+    for (const auto& entry : fs::directory_iterator(data_dir))
+    {
+        std::string file_name = entry.path().filename().string();
+        if (file_name == "README.md" || file_name == "LICENSE") continue;
+        problems.push_back(file_name);
+    }
+    std::sort(problems.begin(), problems.end());
+
+    for (const std::string& problem : problems)
+    {
+        register_benchmarks<KKTMode::KKT_FULL>("KKT_FULL", problem);
+        register_benchmarks<KKTMode::KKT_EQ_ELIMINATED>("KKT_EQ_ELIMINATED", problem);
+        register_benchmarks<KKTMode::KKT_INEQ_ELIMINATED>("KKT_INEQ_ELIMINATED", problem);
+        register_benchmarks<KKTMode::KKT_ALL_ELIMINATED>("KKT_ALL_ELIMINATED", problem);
+    }
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
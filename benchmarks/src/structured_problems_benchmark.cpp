@@ -0,0 +1,220 @@
+// This file is part of PIQP.
+//
+// Copyright (c) 2024 EPFL
+//
+// This source code is licensed under the BSD 2-Clause License found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <benchmark/benchmark.h>
+
+#include "piqp/piqp.hpp"
+#include "piqp/utils/structured_problems.hpp"
+#include "perf_counters.hpp"
+
+using namespace piqp;
+
+using T = double;
+using I = int;
+
+// all problem families are parameterized by a single scale parameter
+using Generator = sparse::Model<T, I> (*)(isize);
+
+static sparse::Model<T, I> mpc(isize scale) { return rand::mpc_qp<T, I>(scale, scale / 2, 20); }
+static sparse::Model<T, I> portfolio(isize scale) { return rand::portfolio_qp<T, I>(10 * scale, scale); }
+static sparse::Model<T, I> lasso(isize scale) { return rand::lasso_qp<T, I>(scale, 10 * scale); }
+static sparse::Model<T, I> huber(isize scale) { return rand::huber_qp<T, I>(scale, 10 * scale); }
+static sparse::Model<T, I> svm(isize scale) { return rand::svm_qp<T, I>(scale, 10 * scale); }
+static sparse::Model<T, I> control_allocation(isize scale) { return rand::control_allocation_qp<T, I>(scale); }
+
+template<typename Solver>
+static void report(benchmark::State& state, const Solver& solver, const benchmark_utils::PhaseCounters& counters)
+{
+    const Info<T>& info = solver.result().info;
+    state.counters["n"] = double(solver.result().x.rows());
+    state.counters["iter"] = double(info.iter);
+    state.counters["kkt_factor_nnz"] = double(info.kkt_factor_nnz);
+    if (info.status != Status::PIQP_SOLVED) state.SetLabel(status_to_string(info.status));
+    counters.report(state, info.factor_flops);
+}
+
+template<KKTMode Mode>
+static void BM_SPARSE(benchmark::State& state, Generator generator)
+{
+    sparse::Model<T, I> model = generator(state.range(0));
+
+    SparseSolver<T, I, Mode> solver;
+    solver.setup(model.P, model.c, model.A, model.b, model.G, model.h, model.x_lb, model.x_ub);
+
+    benchmark_utils::PhaseCounters counters;
+    counters.start();
+    for (auto _ : state)
+    {
+        solver.solve();
+    }
+    counters.stop();
+    report(state, solver, counters);
+}
+
+static void BM_DENSE(benchmark::State& state, Generator generator)
+{
+    dense::Model<T> model = generator(state.range(0)).dense_model();
+
+    DenseSolver<T> solver;
+    solver.setup(model.P, model.c, model.A, model.b, model.G, model.h, model.x_lb, model.x_ub);
+
+    benchmark_utils::PhaseCounters counters;
+    counters.start();
+    for (auto _ : state)
+    {
+        solver.solve();
+    }
+    counters.stop();
+    report(state, solver, counters);
+}
+
+// Same problem family as MPC, but with the variables ordered by stage and all entries of the
+// dynamics stored, i.e., with dense blocks. BM_MPC_STAGEWISE_SPARSE solves the same model with
+// the sparse backend as baseline.
+static void BM_MPC_STAGEWISE(benchmark::State& state)
+{
+    isize scale = state.range(0);
+    stagewise::Model<T, I> model = rand::stagewise_mpc_qp<T, I>(scale, scale / 2, 20);
+
+    StagewiseSolver<T, I> solver;
+    solver.setup(model);
+
+    benchmark_utils::PhaseCounters counters;
+    counters.start();
+    for (auto _ : state)
+    {
+        solver.solve();
+    }
+    counters.stop();
+    report(state, solver, counters);
+}
+
+static void BM_MPC_STAGEWISE_SPARSE(benchmark::State& state)
+{
+    isize scale = state.range(0);
+    stagewise::Model<T, I> model = rand::stagewise_mpc_qp<T, I>(scale, scale / 2, 20);
+    const sparse::Model<T, I>& qp = model.qp;
+
+    SparseSolver<T, I> solver;
+    solver.setup(qp.P, qp.c, qp.A, qp.b, qp.G, qp.h, qp.x_lb, qp.x_ub);
+
+    benchmark_utils::PhaseCounters counters;
+    counters.start();
+    for (auto _ : state)
+    {
+        solver.solve();
+    }
+    counters.stop();
+    report(state, solver, counters);
+}
+
+// Long horizon MPC with the horizon as first and the number of threads as second argument,
+// BM_MPC_LONG_HORIZON_SEQUENTIAL is the single threaded block elimination as baseline.
+static void long_horizon(benchmark::State& state, StagewiseKKTFactorization factorization)
+{
+    isize horizon = state.range(0);
+    stagewise::Model<T, I> model = rand::stagewise_mpc_qp<T, I>(12, 4, horizon, 2);
+
+    StagewiseSolver<T, I> solver;
+    solver.settings().n_threads = state.range(1);
+    solver.set_kkt_factorization(factorization);
+    solver.setup(model);
+
+    benchmark_utils::PhaseCounters counters;
+    counters.start();
+    for (auto _ : state)
+    {
+        solver.solve();
+    }
+    counters.stop();
+    report(state, solver, counters);
+}
+
+static void BM_MPC_LONG_HORIZON_SEQUENTIAL(benchmark::State& state)
+{
+    long_horizon(state, STAGEWISE_KKT_SEQUENTIAL);
+}
+
+static void BM_MPC_LONG_HORIZON_CYCLIC_REDUCTION(benchmark::State& state)
+{
+    long_horizon(state, STAGEWISE_KKT_CYCLIC_REDUCTION);
+}
+
+// Eight independent MPC problems solved as one problem, with the number of threads as argument.
+// With more than one thread, the independent blocks are factorized and solved in parallel.
+static void BM_INDEPENDENT_MPC(benchmark::State& state)
+{
+    std::vector<sparse::Model<T, I>> models;
+    for (int i = 0; i < 8; i++) models.push_back(rand::mpc_qp<T, I>(16, 8, 20));
+    sparse::Model<T, I> model = rand::block_diagonal_qp<T, I>(models);
+
+    SparseSolver<T, I> solver;
+    solver.settings().n_threads = state.range(0);
+    solver.setup(model.P, model.c, model.A, model.b, model.G, model.h, model.x_lb, model.x_ub);
+
+    benchmark_utils::PhaseCounters counters;
+    counters.start();
+    for (auto _ : state)
+    {
+        solver.solve();
+    }
+    counters.stop();
+    report(state, solver, counters);
+}
+
+int main(int argc, char** argv)
+{
+    struct Family
+    {
+        const char* name;
+        Generator generator;
+        isize min_scale;
+        isize max_scale;
+        isize max_dense_scale;
+    };
+    const Family families[] = {
+        {"MPC", &mpc, 4, 64, 16},
+        {"PORTFOLIO", &portfolio, 4, 128, 16},
+        {"LASSO", &lasso, 4, 128, 16},
+        {"HUBER", &huber, 4, 128, 16},
+        {"SVM", &svm, 4, 128, 16},
+        {"CONTROL_ALLOCATION", &control_allocation, 4, 512, 512}
+    };
+
+    for (const Family& f : families)
+    {
+        std::string name = f.name;
+        benchmark::RegisterBenchmark(("BM_" + name + "_SPARSE_KKT_FULL").c_str(), BM_SPARSE<KKT_FULL>, f.generator)
+            ->RangeMultiplier(2)->Range(f.min_scale, f.max_scale)->Unit(benchmark::kMicrosecond);
+        benchmark::RegisterBenchmark(("BM_" + name + "_SPARSE_KKT_EQ_ELIMINATED").c_str(), BM_SPARSE<KKT_EQ_ELIMINATED>, f.generator)
+            ->RangeMultiplier(2)->Range(f.min_scale, f.max_scale)->Unit(benchmark::kMicrosecond);
+        benchmark::RegisterBenchmark(("BM_" + name + "_SPARSE_KKT_INEQ_ELIMINATED").c_str(), BM_SPARSE<KKT_INEQ_ELIMINATED>, f.generator)
+            ->RangeMultiplier(2)->Range(f.min_scale, f.max_scale)->Unit(benchmark::kMicrosecond);
+        benchmark::RegisterBenchmark(("BM_" + name + "_SPARSE_KKT_ALL_ELIMINATED").c_str(), BM_SPARSE<KKT_ALL_ELIMINATED>, f.generator)
+            ->RangeMultiplier(2)->Range(f.min_scale, f.max_scale)->Unit(benchmark::kMicrosecond);
+        benchmark::RegisterBenchmark(("BM_" + name + "_DENSE").c_str(), BM_DENSE, f.generator)
+            ->RangeMultiplier(2)->Range(f.min_scale, f.max_dense_scale)->Unit(benchmark::kMicrosecond);
+    }
+
+    benchmark::RegisterBenchmark("BM_MPC_STAGEWISE", BM_MPC_STAGEWISE)
+        ->RangeMultiplier(2)->Range(4, 64)->Unit(benchmark::kMicrosecond);
+    benchmark::RegisterBenchmark("BM_MPC_STAGEWISE_SPARSE", BM_MPC_STAGEWISE_SPARSE)
+        ->RangeMultiplier(2)->Range(4, 64)->Unit(benchmark::kMicrosecond);
+    benchmark::RegisterBenchmark("BM_MPC_LONG_HORIZON_SEQUENTIAL", BM_MPC_LONG_HORIZON_SEQUENTIAL)
+        ->ArgsProduct({{100, 1000}, {1}})->Unit(benchmark::kMillisecond)->UseRealTime();
+    benchmark::RegisterBenchmark("BM_MPC_LONG_HORIZON_CYCLIC_REDUCTION", BM_MPC_LONG_HORIZON_CYCLIC_REDUCTION)
+        ->ArgsProduct({{100, 1000}, {1, 2, 4}})->Unit(benchmark::kMillisecond)->UseRealTime();
+
+    benchmark::RegisterBenchmark("BM_INDEPENDENT_MPC", BM_INDEPENDENT_MPC)
+        ->Arg(1)->Arg(2)->Arg(4)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,287 @@
+// This file is part of PIQP.
+//
+// Copyright (c) 2024 EPFL
+//
+// This source code is licensed under the BSD 2-Clause License found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef PIQP_AUTO_SOLVER_HPP
+#define PIQP_AUTO_SOLVER_HPP
+
+#include <cmath>
+#include <future>
+#include <limits>
+#include <memory>
+
+#include "piqp/solver.hpp"
+#include "piqp/cost_model.hpp"
+#include "piqp/sparse/kkt_analysis.hpp"
+
+namespace piqp
+{
+
+enum Backend
+{
+    BACKEND_DENSE = 0,
+    BACKEND_SPARSE = 1
+};
+
+// Solver front end which selects the dense or sparse backend in setup based on
+// the predicted time per iteration. The problem data is always passed in sparse
+// format and is converted if the dense backend is chosen. The sparse estimate is
+// based on a symbolic analysis of the KKT matrix, and only the chosen backend is set up.
+template<typename T, typename I = int>
+class AutoSolver
+{
+protected:
+    Settings<T> m_settings;
+    optional<CostModel<T>> m_cost_model;
+
+    Backend m_backend = BACKEND_SPARSE;
+    T m_estimated_dense_time = 0;
+    T m_estimated_sparse_time = 0;
+
+    // only the solver of the chosen backend exists after setup
+    std::unique_ptr<DenseSolver<T>> m_dense_solver;
+    std::unique_ptr<SparseSolver<T, I>> m_sparse_solver;
+
+    Result<T> m_empty_result;
+
+    // dense copies of the matrices passed to update
+    Mat<T> m_P_dense;
+    Mat<T> m_A_dense;
+    Mat<T> m_G_dense;
+
+public:
+    AutoSolver()
+    {
+        m_empty_result.info.status = Status::PIQP_UNSOLVED;
+    }
+
+    Settings<T>& settings() { return m_settings; }
+
+    // overrides the cost model of this machine, see CostModel::machine
+    void set_cost_model(const CostModel<T>& cost_model) { m_cost_model = cost_model; }
+
+    const CostModel<T>& cost_model() const
+    {
+        return m_cost_model.has_value() ? *m_cost_model : CostModel<T>::machine();
+    }
+
+    Backend backend() const { return m_backend; }
+
+    // predicted time per iteration of the backends, the sparse estimate is
+    // zero if the dense backend has been chosen based on the density alone
+    T estimated_dense_time() const { return m_estimated_dense_time; }
+    T estimated_sparse_time() const { return m_estimated_sparse_time; }
+
+    const Result<T>& result() const
+    {
+        if (m_dense_solver) return m_dense_solver->result();
+        if (m_sparse_solver) return m_sparse_solver->result();
+        return m_empty_result;
+    }
+
+    void setup(const CSparseMatRef<T, I>& P,
+               const CVecRef<T>& c,
+               const optional<CSparseMatRef<T, I>>& A = nullopt,
+               const optional<CVecRef<T>>& b = nullopt,
+               const optional<CSparseMatRef<T, I>>& G = nullopt,
+               const optional<CVecRef<T>>& h = nullopt,
+               const optional<CVecRef<T>>& x_lb = nullopt,
+               const optional<CVecRef<T>>& x_ub = nullopt)
+    {
+        const CostModel<T>& model = cost_model();
+
+        isize n = P.rows();
+        isize p = A.has_value() ? A->rows() : 0;
+        isize m = G.has_value() ? G->rows() : 0;
+
+        // density of the upper triangular part of the full KKT matrix
+        T N = T(n + p + m);
+        T kkt_nnz = T(P.nonZeros()) + N;
+        if (A.has_value()) kkt_nnz += T(A->nonZeros());
+        if (G.has_value()) kkt_nnz += T(G->nonZeros());
+        T density = kkt_nnz / (N * (N + 1) / 2);
+
+        m_estimated_dense_time = model.dense_iteration_time(n, p, m, is_positive_diagonal(P));
+        m_estimated_sparse_time = 0;
+
+        m_backend = BACKEND_DENSE;
+        if (density < model.dense_density_threshold)
+        {
+            Info<T> info;
+            sparse::analyze_kkt<T, I>(P, A, G, m_settings, info);
+            m_estimated_sparse_time = model.sparse_iteration_time(info.factor_flops, info.solve_flops);
+            if (m_estimated_sparse_time <= m_estimated_dense_time) m_backend = BACKEND_SPARSE;
+        }
+
+        if (m_backend == BACKEND_SPARSE)
+        {
+            m_dense_solver.reset();
+            m_P_dense.resize(0, 0);
+            m_A_dense.resize(0, 0);
+            m_G_dense.resize(0, 0);
+            m_sparse_solver.reset(new SparseSolver<T, I>());
+            m_sparse_solver->settings() = m_settings;
+            m_sparse_solver->setup(P, c, A, b, G, h, x_lb, x_ub);
+        }
+        else
+        {
+            m_sparse_solver.reset();
+            m_dense_solver.reset(new DenseSolver<T>());
+            m_dense_solver->settings() = m_settings;
+            m_dense_solver->setup(to_dense(m_P_dense, P), c,
+                                  to_dense(m_A_dense, A), b,
+                                  to_dense(m_G_dense, G), h,
+                                  x_lb, x_ub);
+        }
+    }
+
+    void update(const optional<CSparseMatRef<T, I>>& P = nullopt,
+                const optional<CVecRef<T>>& c = nullopt,
+                const optional<CSparseMatRef<T, I>>& A = nullopt,
+                const optional<CVecRef<T>>& b = nullopt,
+                const optional<CSparseMatRef<T, I>>& G = nullopt,
+                const optional<CVecRef<T>>& h = nullopt,
+                const optional<CVecRef<T>>& x_lb = nullopt,
+                const optional<CVecRef<T>>& x_ub = nullopt,
+                bool reuse_preconditioner = true)
+    {
+        if (m_sparse_solver)
+        {
+            m_sparse_solver->settings() = m_settings;
+            m_sparse_solver->update(P, c, A, b, G, h, x_lb, x_ub, reuse_preconditioner);
+        }
+        else if (m_dense_solver)
+        {
+            m_dense_solver->settings() = m_settings;
+            m_dense_solver->update(to_dense(m_P_dense, P), c,
+                                   to_dense(m_A_dense, A), b,
+                                   to_dense(m_G_dense, G), h,
+                                   x_lb, x_ub, reuse_preconditioner);
+        }
+        else
+        {
+            piqp_eprint("Solver not setup yet\n");
+        }
+    }
+
+    // see SolverBase::warm_start
+    void warm_start(const optional<CVecRef<T>>& x,
+                    const optional<CVecRef<T>>& y = nullopt,
+                    const optional<CVecRef<T>>& z = nullopt,
+                    const optional<CVecRef<T>>& z_lb = nullopt,
+                    const optional<CVecRef<T>>& z_ub = nullopt)
+    {
+        if (!visit([&](auto& solver) { solver.warm_start(x, y, z, z_lb, z_ub); }))
+        {
+            piqp_eprint("Solver not setup yet\n");
+        }
+    }
+
+    Status solve()
+    {
+        Status status = Status::PIQP_UNSOLVED;
+        if (!visit([&](auto& solver) {
+                solver.settings() = m_settings;
+                status = solver.solve();
+            }))
+        {
+            piqp_eprint("Solver not setup yet\n");
+        }
+        return status;
+    }
+
+    std::future<Status> solve_async()
+    {
+        std::future<Status> future;
+        if (!visit([&](auto& solver) {
+                solver.settings() = m_settings;
+                future = solver.solve_async();
+            }))
+        {
+            piqp_eprint("Solver not setup yet\n");
+            std::promise<Status> unsolved;
+            unsolved.set_value(Status::PIQP_UNSOLVED);
+            future = unsolved.get_future();
+        }
+        return future;
+    }
+
+    // see SolverBase::begin_solve
+    void begin_solve()
+    {
+        visit([&](auto& solver) {
+            solver.settings() = m_settings;
+            solver.begin_solve();
+        });
+    }
+
+    bool step()
+    {
+        bool running = false;
+        visit([&](auto& solver) { running = solver.step(); });
+        return running;
+    }
+
+    Status finish()
+    {
+        Status status = Status::PIQP_UNSOLVED;
+        visit([&](auto& solver) { status = solver.finish(); });
+        return status;
+    }
+
+    // can be called from any thread, see SolverBase::cancel
+    void cancel()
+    {
+        visit([&](auto& solver) { solver.cancel(); });
+    }
+
+protected:
+    // calls f with the solver of the chosen backend, returns false if there is none
+    template<typename F>
+    bool visit(const F& f)
+    {
+        if (m_sparse_solver) f(*m_sparse_solver);
+        else if (m_dense_solver) f(*m_dense_solver);
+        else return false;
+        return true;
+    }
+
+    // same criterion as the Schur formulation of the dense backend on the upper triangular part of P
+    static bool is_positive_diagonal(const CSparseMatRef<T, I>& P)
+    {
+        T min_diag = std::numeric_limits<T>::infinity();
+        T max_diag = 0;
+        for (isize j = 0; j < P.outerSize(); j++)
+        {
+            T diag = 0;
+            for (typename CSparseMatRef<T, I>::InnerIterator it(P, j); it; ++it)
+            {
+                if (it.row() < j && it.value() != T(0)) return false;
+                if (it.row() == j) diag = it.value();
+            }
+            min_diag = std::min(min_diag, diag);
+            max_diag = std::max(max_diag, diag);
+        }
+        if (P.outerSize() == 0) return true;
+        return min_diag > std::sqrt(std::numeric_limits<T>::epsilon()) * std::max(T(1), max_diag);
+    }
+
+    static CMatRef<T> to_dense(Mat<T>& dense, const CSparseMatRef<T, I>& sparse)
+    {
+        dense = sparse;
+        return dense;
+    }
+
+    static optional<CMatRef<T>> to_dense(Mat<T>& dense, const optional<CSparseMatRef<T, I>>& sparse)
+    {
+        if (!sparse.has_value()) return nullopt;
+        return to_dense(dense, *sparse);
+    }
+};
+
+} // namespace piqp
+
+#endif //PIQP_AUTO_SOLVER_HPP
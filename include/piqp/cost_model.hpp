@@ -0,0 +1,248 @@
+// This file is part of PIQP.
+//
+// Copyright (c) 2024 EPFL
+//
+// This source code is licensed under the BSD 2-Clause License found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef PIQP_COST_MODEL_HPP
+#define PIQP_COST_MODEL_HPP
+
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <system_error>
+
+#include "piqp/fwd.hpp"
+#include "piqp/typedefs.hpp"
+#include "piqp/timer.hpp"
+#include "piqp/dense/ldlt_no_pivot.hpp"
+#include "piqp/sparse/ldlt.hpp"
+#include "piqp/utils/filesystem.hpp"
+
+namespace piqp
+{
+
+// Machine dependent cost model used to predict the time per interior point
+// iteration of the dense and the sparse backend. The calibration is run explicitly
+// with calibrate_machine(), e.g., by the AutoSolver benchmark, which caches the result
+// on disk. The solver only reads the cache and otherwise uses the default values.
+template<typename T>
+struct CostModel
+{
+    T dense_flops_per_sec = T(5e9);  // throughput of the dense LDL^T factorization
+    T sparse_flops_per_sec = T(1e9); // throughput of the sparse LDL^T factorization
+    T dense_overhead = T(1e-6);      // time per iteration independent of the factorization
+    T sparse_overhead = T(2e-6);
+    T dense_density_threshold = T(0.4); // KKT density above which the dense backend is always used
+
+    // predicted time of one iteration of the dense backend, if P is a positive diagonal
+    // the backend factorizes the Schur complement of the constraints instead if it is cheaper
+    T dense_iteration_time(isize n, isize p, isize m, bool P_positive_diagonal = false) const
+    {
+        // KKT matrix P + A^T A / delta + G^T W G and its factorization
+        T N = T(p + m);
+        T flops = T(n) * T(n) * T(n) / T(3) + N * T(n) * T(n);
+        if (P_positive_diagonal)
+        {
+            // Schur complement S^{-1} + C D^{-1} C^T and its factorization
+            flops = std::min(flops, N * N * N / T(3) + N * N * T(n));
+        }
+        return flops / dense_flops_per_sec + dense_overhead;
+    }
+
+    // predicted time of one iteration of the sparse backend given the predicted
+    // flops of the symbolic factorization, see Info::factor_flops and Info::solve_flops
+    T sparse_iteration_time(T factor_flops, T solve_flops) const
+    {
+        return (factor_flops + T(2) * solve_flops) / sparse_flops_per_sec + sparse_overhead;
+    }
+
+    bool save(const std::string& path) const
+    {
+        std::ofstream file(path);
+        if (!file.is_open()) return false;
+        file.precision(17);
+        file << "# PIQP cost model\n";
+        file << "dense_flops_per_sec " << dense_flops_per_sec << "\n";
+        file << "sparse_flops_per_sec " << sparse_flops_per_sec << "\n";
+        file << "dense_overhead " << dense_overhead << "\n";
+        file << "sparse_overhead " << sparse_overhead << "\n";
+        file << "dense_density_threshold " << dense_density_threshold << "\n";
+        return file.good();
+    }
+
+    bool load(const std::string& path)
+    {
+        std::ifstream file(path);
+        if (!file.is_open()) return false;
+
+        CostModel<T> model;
+        std::string key;
+        T value;
+        isize n_read = 0;
+        while (file >> key)
+        {
+            if (key[0] == '#')
+            {
+                std::getline(file, key);
+                continue;
+            }
+            if (!(file >> value) || !(value > 0)) return false;
+            if (key == "dense_flops_per_sec") model.dense_flops_per_sec = value;
+            else if (key == "sparse_flops_per_sec") model.sparse_flops_per_sec = value;
+            else if (key == "dense_overhead") model.dense_overhead = value;
+            else if (key == "sparse_overhead") model.sparse_overhead = value;
+            else if (key == "dense_density_threshold") model.dense_density_threshold = value;
+            else continue;
+            n_read++;
+        }
+        if (n_read == 0) return false;
+
+        *this = model;
+        return true;
+    }
+
+    // measures the factorization throughput of both backends, takes a few tens of milliseconds
+    static CostModel<T> calibrate()
+    {
+        CostModel<T> model;
+        std::mt19937 gen(42);
+        std::uniform_real_distribution<double> dist(-1.0, 1.0);
+
+        // dense: factorization of a diagonally dominant matrix
+        {
+            const isize n = 192;
+            Mat<T> K(n, n);
+            for (isize j = 0; j < n; j++) {
+                for (isize i = 0; i <= j; i++) {
+                    K(i, j) = T(dist(gen));
+                    K(j, i) = K(i, j);
+                }
+                K(j, j) = T(n);
+            }
+            dense::LDLTNoPivot<Mat<T>> ldlt(n);
+            T time = best_of(5, [&]() { ldlt.compute(K); });
+            model.dense_flops_per_sec = T(n) * T(n) * T(n) / T(3) / time;
+
+            // the overhead is estimated as the time of the O(n^2) operations in a small problem
+            const isize n_small = 16;
+            Mat<T> K_small = K.topLeftCorner(n_small, n_small);
+            dense::LDLTNoPivot<Mat<T>> ldlt_small(n_small);
+            Vec<T> x = Vec<T>::Ones(n_small);
+            T time_small = best_of(5, [&]() {
+                for (int k = 0; k < 10; k++) {
+                    ldlt_small.compute(K_small);
+                    ldlt_small.solveInPlace(x);
+                }
+            }) / T(10);
+            model.dense_overhead = std::max(time_small - T(n_small) * T(n_small) * T(n_small) / T(3) / model.dense_flops_per_sec, T(1e-7));
+        }
+
+        // sparse: banded matrix with random fill, resembling a KKT matrix after reordering
+        {
+            const isize n = 4000;
+            const isize bandwidth = 12;
+            std::vector<Eigen::Triplet<T, int>> triplets;
+            for (isize j = 0; j < n; j++) {
+                for (isize i = std::max(isize(0), j - bandwidth); i < j; i++) {
+                    if (dist(gen) > 0) triplets.emplace_back(int(i), int(j), T(dist(gen)));
+                }
+                triplets.emplace_back(int(j), int(j), T(2 * bandwidth));
+            }
+            SparseMat<T, int> K(n, n);
+            K.setFromTriplets(triplets.begin(), triplets.end());
+            sparse::LDLt<T, int> ldlt;
+            ldlt.factorize_symbolic_upper_triangular(K);
+            T time = best_of(5, [&]() { ldlt.factorize_numeric_upper_triangular(K); });
+            model.sparse_flops_per_sec = ldlt.stats.factor_flops / time;
+
+            const isize n_small = 16;
+            SparseMat<T, int> K_small = K.topLeftCorner(n_small, n_small);
+            sparse::LDLt<T, int> ldlt_small;
+            ldlt_small.factorize_symbolic_upper_triangular(K_small);
+            Vec<T> x = Vec<T>::Ones(n_small);
+            T time_small = best_of(5, [&]() {
+                for (int k = 0; k < 10; k++) {
+                    ldlt_small.factorize_numeric_upper_triangular(K_small);
+                    ldlt_small.solve_inplace(x);
+                }
+            }) / T(10);
+            model.sparse_overhead = std::max(time_small - ldlt_small.stats.factor_flops / model.sparse_flops_per_sec, T(1e-7));
+        }
+
+        return model;
+    }
+
+    // location of the calibrated cost model, the environment variable PIQP_COST_MODEL
+    // takes precedence over the user cache directory
+    static std::string default_path()
+    {
+        if (const char* path = std::getenv("PIQP_COST_MODEL")) return path;
+        std::string cache_dir = user_cache_dir();
+        if (cache_dir.empty()) return "";
+        return (fs::path(cache_dir) / "cost_model.txt").string();
+    }
+
+    // cost model of this machine as read from the cache on first use, the default
+    // values if the machine has not been calibrated, never runs the calibration itself
+    static const CostModel<T>& machine()
+    {
+        return machine_storage();
+    }
+
+    // calibrates this machine, stores the result in the cache and uses it for solvers set up afterwards,
+    // should not be called concurrently with the setup of solvers using the machine cost model
+    static CostModel<T> calibrate_machine(const std::string& path = default_path())
+    {
+        CostModel<T> model = calibrate();
+        if (!path.empty())
+        {
+            std::error_code ec;
+            fs::create_directories(fs::path(path).parent_path(), ec);
+            if (!model.save(path))
+            {
+                piqp_eprint("piqp: could not save cost model to %s\n", path.c_str());
+            }
+        }
+        machine_storage() = model;
+        return model;
+    }
+
+protected:
+    static CostModel<T>& machine_storage()
+    {
+        static CostModel<T> model = load_cached(default_path());
+        return model;
+    }
+
+    static CostModel<T> load_cached(const std::string& path)
+    {
+        // load only changes the model if the cache could be read
+        CostModel<T> model;
+        if (!path.empty()) model.load(path);
+        return model;
+    }
+
+    template<typename F>
+    static T best_of(int repetitions, const F& f)
+    {
+        Timer<T> timer;
+        T best = std::numeric_limits<T>::infinity();
+        for (int r = 0; r < repetitions; r++)
+        {
+            timer.start();
+            f();
+            best = std::min(best, timer.stop());
+        }
+        return std::max(best, T(1e-9));
+    }
+};
+
+} // namespace piqp
+
+#endif //PIQP_COST_MODEL_HPP
@@ -9,10 +9,18 @@
 #ifndef PIQP_DENSE_KKT_HPP
 #define PIQP_DENSE_KKT_HPP
 
+#include <memory>
+
 #include "piqp/settings.hpp"
+#include "piqp/results.hpp"
+#include "piqp/utils/memory.hpp"
+#include "piqp/utils/thread_pool.hpp"
 #include "piqp/kkt_fwd.hpp"
+#include "piqp/tracing.hpp"
 #include "piqp/dense/data.hpp"
 #include "piqp/dense/ldlt_no_pivot.hpp"
+#include "piqp/dense/ldlt_tuning.hpp"
+#include "piqp/dense/rank_update.hpp"
 
 namespace piqp
 {
@@ -20,6 +28,11 @@ namespace piqp
 namespace dense
 {
 
+// maximum number of incremental updates of the KKT matrix before it is assembled from scratch
+constexpr isize KKT_MAX_INCREMENTAL_UPDATES = 20;
+// maximum ratio of the magnitude of the incremental updates and the diagonal of the KKT matrix
+constexpr double KKT_MAX_CANCELLATION = 1e4;
+
 template<typename T>
 struct KKT
 {
@@ -29,6 +42,8 @@ struct KKT
     T m_rho;
     T m_delta;
 
+    isize m_refine_iter = 0; // number of iterative refinement steps in last solve
+
     Vec<T> m_s;
     Vec<T> m_s_lb;
     Vec<T> m_s_ub;
@@ -39,21 +54,52 @@ struct KKT
     Mat<T> kkt_mat;
     Vec<T> kkt_diag; // unregularized diagonal of KKT matrix
     LDLTNoPivot<Mat<T>, Eigen::Lower> ldlt;
+    std::unique_ptr<ThreadPool> thread_pool; // only allocated if settings.n_threads != 1
 
     Mat<T> AT_A;
     Mat<T> W_delta_inv_G; // temporary matrix
+
+    // state of the terms currently assembled in kkt_mat, used for incremental updates,
+    // the temporaries of the incremental updates are only allocated for the reduced formulation
+    bool kkt_assembled = false;
+    isize kkt_incremental_updates = 0; // incremental updates since last full assembly
+    T kkt_cancellation_scale = 0;      // largest magnitude added or removed since last full assembly
+    T kkt_rho = 0;
+    T kkt_delta = 0;
+    Vec<T> kkt_G_weights;     // weights (s / z + delta)^{-1} of G^T W G
+    Vec<T> kkt_G_weights_new; // temporary variable holding the new weights and their change
+    Vec<T> kkt_bound_diag;    // diagonal contribution of the bounds
+    Vec<T> kkt_bound_diag_new;
+    Vec<T> G_row_norms_sq;    // squared norms of the rows of G
+    Eigen::Matrix<isize, Eigen::Dynamic, 1> kkt_G_changed; // indices of changed weights
     Vec<T> rhs_z_bar;     // temporary variable needed for back solve
     Vec<T> rhs;           // stores the rhs
     Vec<T> sol;           // solution of ldldt back solve
     Vec<T> err_corr;      // temporary variable to calculate error in iterative refinement and correction term
     Vec<T> ref_sol;       // refined solution
 
+    // If P is diagonal and positive, the reduced system K = D + C^T S C with D = P + rho I + bounds,
+    // C = [A; G] and S = diag(I / delta, W^{-1}) can be solved with the Woodbury identity
+    // K^{-1} = D^{-1} - D^{-1} C^T (S^{-1} + C D^{-1} C^T)^{-1} C D^{-1},
+    // which only requires the factorization of the (p + m) x (p + m) Schur complement.
+    DenseKKTFormulation requested_formulation = DENSE_KKT_AUTO;
+    DenseKKTFormulation formulation = DENSE_KKT_REDUCED;
+
+    Vec<T> schur_D;       // unregularized diagonal D
+    Vec<T> schur_D_inv;   // inverse of regularized diagonal D
+    Mat<T> schur_mat;     // Schur complement S^{-1} + C D^{-1} C^T, the ldlt factorizes this matrix
+    Mat<T> D_inv_CT;      // D^{-1} C^T
+    Vec<T> schur_tmp;     // temporary of size p + m
+    Vec<T> schur_tmp_n;   // temporary of size n
+
     KKT(const Data<T>& data, const Settings<T>& settings) : data(data), settings(settings) {}
 
     ~KKT() {};
 
     void init(const T& rho, const T& delta)
     {
+        PIQP_TRACE_SCOPE("kkt_init");
+
         // init workspace
         m_s.resize(data.m);
         m_s_lb.resize(data.n);
@@ -61,7 +107,8 @@ struct KKT
         m_z_inv.resize(data.m);
         m_z_lb_inv.resize(data.n);
         m_z_ub_inv.resize(data.n);
-        W_delta_inv_G.resize(data.m, data.n);
+        kkt_G_weights.resize(data.m);
+        kkt_bound_diag.resize(data.n);
         rhs_z_bar.resize(data.m);
         rhs.resize(data.n);
         sol.resize(data.n);
@@ -77,16 +124,115 @@ struct KKT
         m_z_lb_inv.head(data.n_lb).setConstant(1);
         m_z_ub_inv.head(data.n_ub).setConstant(1);
 
-        kkt_mat.resize(data.n, data.n);
-        kkt_diag.resize(data.n);
-        ldlt = LDLTNoPivot<Mat<T>>(data.n);
+        formulation = select_formulation();
+        allocate_formulation();
 
-        if (data.p > 0)
+        update_kkt();
+    }
+
+    // The Woodbury identity is unstable if D is close to singular. Since rho and the bound
+    // terms vanish close to convergence, the Schur formulation requires a positive diagonal P.
+    bool P_is_positive_diagonal() const
+    {
+        for (isize j = 1; j < data.n; j++)
         {
-            AT_A.resize(data.n, data.n);
-            AT_A.template triangularView<Eigen::Lower>() = data.AT * data.AT.transpose();
+            if (!data.P_utri.col(j).head(j).isZero(T(0))) return false;
         }
-        update_kkt();
+        T min_diag = data.n > 0 ? data.P_utri.diagonal().minCoeff() : T(1);
+        T max_diag = data.n > 0 ? data.P_utri.diagonal().maxCoeff() : T(1);
+        return min_diag > std::sqrt(std::numeric_limits<T>::epsilon()) * std::max(T(1), max_diag);
+    }
+
+    DenseKKTFormulation select_formulation() const
+    {
+        if (requested_formulation == DENSE_KKT_REDUCED || !P_is_positive_diagonal()) return DENSE_KKT_REDUCED;
+        if (requested_formulation == DENSE_KKT_SCHUR) return DENSE_KKT_SCHUR;
+
+        // predicted flops of forming and factorizing the respective systems
+        T n = T(data.n);
+        T N = T(data.p + data.m);
+        T reduced_flops = n * n * n / T(3) + N * n * n;
+        T schur_flops = N * N * N / T(3) + N * N * n;
+        return schur_flops < reduced_flops ? DENSE_KKT_SCHUR : DENSE_KKT_REDUCED;
+    }
+
+    // allocates the workspace of the active formulation and frees the one of the other
+    void allocate_formulation()
+    {
+        isize N = data.p + data.m;
+        if (formulation == DENSE_KKT_SCHUR)
+        {
+            kkt_mat.resize(0, 0);
+            AT_A.resize(0, 0);
+            W_delta_inv_G.resize(0, 0);
+            schur_D.resize(data.n);
+            schur_D_inv.resize(data.n);
+            schur_mat.resize(N, N);
+            D_inv_CT.resize(data.n, N);
+            schur_tmp.resize(N);
+            schur_tmp_n.resize(data.n);
+            kkt_diag.resize(0);
+            kkt_G_weights_new.resize(0);
+            kkt_bound_diag_new.resize(0);
+            G_row_norms_sq.resize(0);
+            kkt_G_changed.resize(0);
+            allocate_ldlt(N);
+        }
+        else
+        {
+            schur_D.resize(0);
+            schur_D_inv.resize(0);
+            schur_mat.resize(0, 0);
+            D_inv_CT.resize(0, 0);
+            schur_tmp.resize(0);
+            schur_tmp_n.resize(0);
+            W_delta_inv_G.resize(data.m, data.n);
+            kkt_mat.resize(data.n, data.n);
+            kkt_diag.resize(data.n);
+            kkt_G_weights_new.resize(data.m);
+            kkt_bound_diag_new.resize(data.n);
+            G_row_norms_sq = data.GT.colwise().squaredNorm().transpose();
+            kkt_G_changed.resize(data.m);
+            allocate_ldlt(data.n);
+
+            if (data.p > 0)
+            {
+                AT_A.resize(data.n, data.n);
+                AT_A.template triangularView<Eigen::Lower>() = data.AT * data.AT.transpose();
+            }
+        }
+        kkt_assembled = false;
+    }
+
+    void allocate_ldlt(isize dim)
+    {
+        ldlt = LDLTNoPivot<Mat<T>>(dim);
+        if (settings.dense_ldlt_tuning && dim >= LDLT_TUNING_MIN_SIZE)
+        {
+            LDLTTuning<T>::machine().apply(ldlt);
+        }
+    }
+
+    void update_factorization_info(Info<T>& info) const
+    {
+        // the dense LDL^T factorization has the same statistics as
+        // a sparse factorization of a fully dense matrix with a chain as elimination tree
+        isize dim = formulation == DENSE_KKT_SCHUR ? data.p + data.m : data.n;
+        T n = T(dim);
+        info.kkt_nnz = dim * (dim + 1) / 2;
+        info.kkt_factor_nnz = dim * (dim - 1) / 2;
+        info.kkt_fill_ratio = info.kkt_nnz > 0 ? T(info.kkt_factor_nnz + dim) / T(info.kkt_nnz) : T(0);
+        // sum_{k=0}^{n-1} k * (k + 2)
+        info.factor_flops = (n - 1) * n * (2 * n - 1) / 6 + n * (n - 1);
+        info.solve_flops = 4 * T(info.kkt_factor_nnz) + n;
+        info.etree_height = dim;
+        info.etree_width = dim > 0 ? 1 : 0;
+        info.workspace_bytes = memory_bytes(m_s, m_s_lb, m_s_ub, m_z_inv, m_z_lb_inv, m_z_ub_inv,
+                                            kkt_mat, kkt_diag, AT_A, W_delta_inv_G,
+                                            kkt_G_weights, kkt_G_weights_new, kkt_bound_diag, kkt_bound_diag_new, G_row_norms_sq, kkt_G_changed,
+                                            rhs_z_bar, rhs, sol, err_corr, ref_sol)
+                               + memory_bytes(schur_D, schur_D_inv, schur_mat, D_inv_CT, schur_tmp, schur_tmp_n)
+                               + isize(dim) * isize(dim + 1) * isize(sizeof(T)); // factor and temporary of ldlt
     }
 
     void update_scalings(const T& rho, const T& delta,
@@ -102,12 +248,23 @@ struct KKT
         m_z_lb_inv.head(data.n_lb).array() = T(1) / z_lb.head(data.n_lb).array();
         m_z_ub_inv.head(data.n_ub).array() = T(1) / z_ub.head(data.n_ub).array();
 
-        update_kkt();
+        update_kkt_incremental();
     }
 
     void update_data(int options)
     {
-        if (options & KKTUpdateOptions::KKT_UPDATE_A)
+        if (options & KKTUpdateOptions::KKT_UPDATE_P)
+        {
+            DenseKKTFormulation new_formulation = select_formulation();
+            if (new_formulation != formulation)
+            {
+                formulation = new_formulation;
+                allocate_formulation();
+                options &= ~KKTUpdateOptions::KKT_UPDATE_A; // A^T A is computed in allocate_formulation
+            }
+        }
+
+        if (options & KKTUpdateOptions::KKT_UPDATE_A && formulation == DENSE_KKT_REDUCED)
         {
             if (data.p > 0)
             {
@@ -115,36 +272,215 @@ struct KKT
             }
         }
 
+        // G might have been rescaled by the preconditioner even if it is not updated
+        if (formulation == DENSE_KKT_REDUCED)
+        {
+            G_row_norms_sq = data.GT.colwise().squaredNorm().transpose();
+        }
+
         if (options != KKTUpdateOptions::KKT_UPDATE_NONE)
         {
             update_kkt();
         }
+        else
+        {
+            // the data might have been rescaled by the preconditioner
+            kkt_assembled = false;
+        }
+    }
+
+    // (re)creates the thread pool if settings.n_threads changed
+    ThreadPool* update_thread_pool()
+    {
+        isize n_threads = settings.n_threads > 0 ? settings.n_threads : ThreadPool::hardware_threads();
+        if (n_threads <= 1)
+        {
+            thread_pool.reset();
+        }
+        else if (!thread_pool)
+        {
+            thread_pool.reset(new ThreadPool(n_threads));
+        }
+        else
+        {
+            thread_pool->resize(n_threads);
+        }
+        ldlt.setThreadPool(thread_pool.get());
+        return thread_pool.get();
+    }
+
+    void compute_G_weights(VecRef<T> weights) const
+    {
+        weights.array() = T(1) / (m_z_inv.array() * m_s.array() + m_delta);
+    }
+
+    void compute_bound_diag(VecRef<T> bound_diag) const
+    {
+        bound_diag.setZero();
+        for (isize i = 0; i < data.n_lb; i++)
+        {
+            bound_diag(data.x_lb_idx(i)) += data.x_lb_scaling(i) * data.x_lb_scaling(i) / (m_z_lb_inv(i) * m_s_lb(i) + m_delta);
+        }
+        for (isize i = 0; i < data.n_ub; i++)
+        {
+            bound_diag(data.x_ub_idx(i)) += data.x_ub_scaling(i) * data.x_ub_scaling(i) / (m_z_ub_inv(i) * m_s_ub(i) + m_delta);
+        }
     }
 
+    // W_delta_inv_G = diag(weights) * G, parallelized over the columns
+    void scale_G_rows(const CVecRef<T>& weights, ThreadPool* pool)
+    {
+        if (pool && data.n >= 2 * PARALLEL_MIN_BLOCK_ROWS)
+        {
+            isize n_chunks = std::min(pool->n_threads(), data.n / PARALLEL_MIN_BLOCK_ROWS);
+            pool->parallel_for(n_chunks, [&](isize i) {
+                isize c0 = data.n * i / n_chunks;
+                isize cb = data.n * (i + 1) / n_chunks - c0;
+                W_delta_inv_G.middleCols(c0, cb) = weights.asDiagonal() * data.GT.middleRows(c0, cb).transpose();
+            });
+        }
+        else
+        {
+            W_delta_inv_G = weights.asDiagonal() * data.GT.transpose();
+        }
+    }
+
+    // assembles the lower triangular part of the KKT matrix from scratch
     void update_kkt()
     {
+        ThreadPool* pool = update_thread_pool();
+
+        if (formulation == DENSE_KKT_SCHUR)
+        {
+            // the Schur complement depends on the regularization and is formed in regularize_and_factorize
+            compute_G_weights(kkt_G_weights);
+            compute_bound_diag(kkt_bound_diag);
+            schur_D = kkt_bound_diag + data.P_utri.diagonal();
+            schur_D.array() += m_rho;
+            return;
+        }
+
         kkt_mat.template triangularView<Eigen::Lower>() = data.P_utri.transpose() + m_rho * Mat<T>::Identity(data.n, data.n);
 
         if (data.m > 0)
         {
-            W_delta_inv_G = (m_z_inv.cwiseProduct(m_s) + Vec<T>::Constant(data.m, m_delta)).asDiagonal().inverse() * data.GT.transpose();
-            kkt_mat.template triangularView<Eigen::Lower>() += data.GT * W_delta_inv_G;
+            compute_G_weights(kkt_G_weights);
+            scale_G_rows(kkt_G_weights, pool);
+            // G^T W^{-1} G as rank-m update of the lower triangular part
+            rank_update_lower(kkt_mat, data.GT, W_delta_inv_G.transpose(), T(1), pool);
         }
 
-        for (isize i = 0; i < data.n_lb; i++)
+        compute_bound_diag(kkt_bound_diag);
+        kkt_mat.diagonal() += kkt_bound_diag;
+
+        if (data.p > 0)
         {
-            kkt_mat.diagonal()(data.x_lb_idx(i)) += data.x_lb_scaling(i) * data.x_lb_scaling(i) / (m_z_lb_inv(i) * m_s_lb(i) + m_delta);
+            kkt_mat.template triangularView<Eigen::Lower>() += T(1) / m_delta * AT_A;
         }
 
-        for (isize i = 0; i < data.n_ub; i++)
+        kkt_assembled = true;
+        kkt_incremental_updates = 0;
+        kkt_cancellation_scale = 0;
+        kkt_rho = m_rho;
+        kkt_delta = m_delta;
+    }
+
+    // Updates the assembled KKT matrix with the change of rho and the weights since
+    // the last update. Only the weights of G^T W G whose change is significant relative
+    // to the diagonal of the KKT matrix are applied. If only a few weights changed, the
+    // update is a low-rank correction with the corresponding rows of G.
+    // A change of delta changes all weights and the scaling of A^T A, in which case
+    // the matrix is assembled from scratch, as well as after a fixed number of
+    // incremental updates or if the cancellation error could have become significant.
+    void update_kkt_incremental()
+    {
+        if (!kkt_assembled || m_delta != kkt_delta || kkt_incremental_updates >= KKT_MAX_INCREMENTAL_UPDATES || formulation == DENSE_KKT_SCHUR)
         {
-            kkt_mat.diagonal()(data.x_ub_idx(i)) += data.x_ub_scaling(i) * data.x_ub_scaling(i) / (m_z_ub_inv(i) * m_s_ub(i) + m_delta);
+            update_kkt();
+            return;
         }
 
-        if (data.p > 0)
+        const T eps = std::numeric_limits<T>::epsilon();
+        T max_diag = kkt_mat.diagonal().template lpNorm<Eigen::Infinity>();
+
+        T cancellation_scale = std::max(kkt_cancellation_scale, std::abs(m_rho - kkt_rho));
+
+        compute_bound_diag(kkt_bound_diag_new);
+        if (data.n > 0)
         {
-            kkt_mat.template triangularView<Eigen::Lower>() += T(1) / m_delta * AT_A;
+            cancellation_scale = std::max(cancellation_scale, (kkt_bound_diag_new - kkt_bound_diag).template lpNorm<Eigen::Infinity>());
+        }
+
+        isize n_changed = 0;
+        if (data.m > 0)
+        {
+            compute_G_weights(kkt_G_weights_new);
+            kkt_G_weights_new -= kkt_G_weights;
+            for (isize i = 0; i < data.m; i++)
+            {
+                T change = std::abs(kkt_G_weights_new(i)) * G_row_norms_sq(i);
+                if (change > eps * max_diag)
+                {
+                    kkt_G_changed(n_changed++) = i;
+                    cancellation_scale = std::max(cancellation_scale, (std::abs(kkt_G_weights(i)) + std::abs(kkt_G_weights_new(i))) * G_row_norms_sq(i));
+                }
+            }
+        }
+
+        // the rounding errors of the updates are proportional to the largest terms
+        // which have been added or removed, which might cancel
+        if (cancellation_scale > KKT_MAX_CANCELLATION * max_diag)
+        {
+            update_kkt();
+            return;
+        }
+
+        ThreadPool* pool = update_thread_pool();
+
+        kkt_mat.diagonal().array() += m_rho - kkt_rho;
+
+        kkt_mat.diagonal() += kkt_bound_diag_new - kkt_bound_diag;
+        std::swap(kkt_bound_diag, kkt_bound_diag_new);
+
+        if (n_changed > 0 && 4 * n_changed <= data.m)
+        {
+            // low-rank correction G_k^T diag(dw_k) G_k, W_delta_inv_G is used as workspace
+            // with G_k in the first n_changed rows and diag(dw_k) G_k in the next n_changed rows
+            for (isize k = 0; k < n_changed; k++)
+            {
+                isize i = kkt_G_changed(k);
+                W_delta_inv_G.row(k) = data.GT.col(i).transpose();
+                W_delta_inv_G.row(n_changed + k) = kkt_G_weights_new(i) * data.GT.col(i).transpose();
+                kkt_G_weights(i) += kkt_G_weights_new(i);
+            }
+            rank_update_lower(kkt_mat,
+                              W_delta_inv_G.topRows(n_changed).transpose(),
+                              W_delta_inv_G.middleRows(n_changed, n_changed).transpose(),
+                              T(1), pool);
+        }
+        else if (n_changed > 0)
+        {
+            // weighted difference G^T diag(dw) G, insignificant changes are dropped
+            isize k = 0;
+            for (isize i = 0; i < data.m; i++)
+            {
+                if (k < n_changed && kkt_G_changed(k) == i)
+                {
+                    kkt_G_weights(i) += kkt_G_weights_new(i);
+                    k++;
+                }
+                else
+                {
+                    kkt_G_weights_new(i) = 0;
+                }
+            }
+            scale_G_rows(kkt_G_weights_new, pool);
+            rank_update_lower(kkt_mat, data.GT, W_delta_inv_G.transpose(), T(1), pool);
         }
+
+        kkt_incremental_updates++;
+        kkt_cancellation_scale = cancellation_scale;
+        kkt_rho = m_rho;
     }
 
     void multiply(const CVecRef<T>& delta_x, const CVecRef<T>& delta_y,
@@ -199,6 +535,8 @@ struct KKT
 
     bool regularize_and_factorize(bool iterative_refinement)
     {
+        PIQP_TRACE_SCOPE("factorize");
+
         if (iterative_refinement)
         {
             T static_kkt_diag_max = data.P_utri.diagonal().template lpNorm<Eigen::Infinity>();
@@ -217,8 +555,16 @@ struct KKT
             }
 
             T reg = settings.iterative_refinement_static_regularization_eps + settings.iterative_refinement_static_regularization_rel * max_diag;
+            if (formulation == DENSE_KKT_SCHUR)
+            {
+                return factorize_schur(std::max(T(0), reg - m_rho));
+            }
             this->regularize_kkt(reg);
         }
+        else if (formulation == DENSE_KKT_SCHUR)
+        {
+            return factorize_schur(T(0));
+        }
 
         ldlt.compute(kkt_mat);
 
@@ -230,6 +576,60 @@ struct KKT
         return ldlt.info() == Eigen::Success;
     }
 
+    bool factorize_schur(T rho_reg)
+    {
+        ThreadPool* pool = thread_pool.get();
+        isize p = data.p;
+        isize m = data.m;
+
+        schur_D_inv.array() = T(1) / (schur_D.array() + rho_reg);
+        D_inv_CT.leftCols(p).noalias() = schur_D_inv.asDiagonal() * data.AT;
+        D_inv_CT.rightCols(m).noalias() = schur_D_inv.asDiagonal() * data.GT;
+
+        // S^{-1} + C D^{-1} C^T
+        schur_mat.template triangularView<Eigen::Lower>().setZero();
+        schur_mat.diagonal().head(p).setConstant(m_delta);
+        schur_mat.diagonal().tail(m).array() = T(1) / kkt_G_weights.array();
+        if (p > 0)
+        {
+            auto schur_AA = schur_mat.topLeftCorner(p, p);
+            rank_update_lower(schur_AA, data.AT.transpose(), D_inv_CT.leftCols(p).transpose(), T(1), pool);
+        }
+        if (m > 0)
+        {
+            auto schur_GG = schur_mat.bottomRightCorner(m, m);
+            rank_update_lower(schur_GG, data.GT.transpose(), D_inv_CT.rightCols(m).transpose(), T(1), pool);
+        }
+        if (p > 0 && m > 0)
+        {
+            schur_mat.bottomLeftCorner(m, p).noalias() += data.GT.transpose() * D_inv_CT.leftCols(p);
+        }
+
+        ldlt.compute(schur_mat);
+        return ldlt.info() == Eigen::Success;
+    }
+
+    // y -= K x with the unregularized KKT matrix K
+    void subtract_kkt_product(const CVecRef<T>& x, VecRef<T> y)
+    {
+        if (formulation == DENSE_KKT_SCHUR)
+        {
+            isize p = data.p;
+            isize m = data.m;
+            y.array() -= schur_D.array() * x.array();
+            schur_tmp.head(p).noalias() = data.AT.transpose() * x;
+            schur_tmp.head(p) /= m_delta;
+            schur_tmp.tail(m).noalias() = data.GT.transpose() * x;
+            schur_tmp.tail(m).array() *= kkt_G_weights.array();
+            y.noalias() -= data.AT * schur_tmp.head(p);
+            y.noalias() -= data.GT * schur_tmp.tail(m);
+            return;
+        }
+
+        y.noalias() -= kkt_mat.template triangularView<Eigen::Lower>() * x;
+        y.noalias() -= kkt_mat.transpose().template triangularView<Eigen::StrictlyUpper>() * x;
+    }
+
     void regularize_kkt(T reg)
     {
         // save unregularized diagonal
@@ -254,6 +654,8 @@ struct KKT
                VecRef<T> delta_s, VecRef<T> delta_s_lb, VecRef<T> delta_s_ub,
                bool iterative_refinement)
     {
+        PIQP_TRACE_SCOPE("kkt_solve");
+
         T delta_inv = T(1) / m_delta;
 
         rhs_z_bar.array() = rhs_z.array() - m_z_inv.array() * rhs_s.array();
@@ -277,16 +679,22 @@ struct KKT
         sol = rhs;
         solve_ldlt_in_place(sol);
 
-        if (iterative_refinement && settings.iterative_refinement_max_iter > 0)
+        // The Woodbury identity loses accuracy if the diagonal D is badly scaled, i.e.,
+        // close to convergence, but refinement steps only cost O(n (p + m)) in this case.
+        iterative_refinement = iterative_refinement || formulation == DENSE_KKT_SCHUR;
+
+        m_refine_iter = 0;
+        if (iterative_refinement && settings.iterative_refinement_iter_limit() > 0)
         {
+            PIQP_TRACE_SCOPE("iterative_refinement");
+
             T rhs_norm = rhs.template lpNorm<Eigen::Infinity>();
 
             err_corr = rhs;
-            err_corr -= kkt_mat.template triangularView<Eigen::Lower>() * sol;
-            err_corr -= kkt_mat.transpose().template triangularView<Eigen::StrictlyUpper>() * sol;
+            subtract_kkt_product(sol, err_corr);
             T error_norm = err_corr.template lpNorm<Eigen::Infinity>();
 
-            for (isize i = 0; i < settings.iterative_refinement_max_iter; i++)
+            for (isize i = 0; i < settings.iterative_refinement_iter_limit(); i++)
             {
                 if (error_norm <= (settings.iterative_refinement_eps_abs + settings.iterative_refinement_eps_rel * rhs_norm))
                 {
@@ -296,11 +704,11 @@ struct KKT
                 T prev_error_norm = error_norm;
 
                 solve_ldlt_in_place(err_corr);
+                m_refine_iter++;
                 ref_sol = sol + err_corr;
 
                 err_corr = rhs;
-                err_corr -= kkt_mat.template triangularView<Eigen::Lower>() * ref_sol;
-                err_corr -= kkt_mat.transpose().template triangularView<Eigen::StrictlyUpper>() * ref_sol;
+                subtract_kkt_product(ref_sol, err_corr);
                 error_norm = err_corr.template lpNorm<Eigen::Infinity>();
 
                 T improvement_rate = prev_error_norm / error_norm;
@@ -387,12 +795,26 @@ struct KKT
         Vec<T> x_copy = x;
 #endif
 
-        ldlt.solveInPlace(x);
+        if (formulation == DENSE_KKT_SCHUR)
+        {
+            // x = D^{-1} x - D^{-1} C^T (S^{-1} + C D^{-1} C^T)^{-1} C D^{-1} x
+            x.array() *= schur_D_inv.array();
+            schur_tmp.head(data.p).noalias() = data.AT.transpose() * x;
+            schur_tmp.tail(data.m).noalias() = data.GT.transpose() * x;
+            ldlt.solveInPlace(schur_tmp);
+            schur_tmp_n.noalias() = data.AT * schur_tmp.head(data.p);
+            schur_tmp_n.noalias() += data.GT * schur_tmp.tail(data.m);
+            x.array() -= schur_D_inv.array() * schur_tmp_n.array();
+        }
+        else
+        {
+            ldlt.solveInPlace(x);
+        }
 
 #ifdef PIQP_DEBUG_PRINT
-        Vec<T> rhs_x = kkt_mat.template triangularView<Eigen::Lower>() * x;
-        rhs_x += kkt_mat.transpose().template triangularView<Eigen::StrictlyUpper>() * x;
-        std::cout << "ldlt_error: " << (x_copy - rhs_x).template lpNorm<Eigen::Infinity>() << std::endl;
+        Vec<T> rhs_x = x_copy;
+        subtract_kkt_product(x, rhs_x);
+        std::cout << "ldlt_error: " << rhs_x.template lpNorm<Eigen::Infinity>() << std::endl;
 #endif
     }
 };
@@ -23,6 +23,9 @@
 #include <iostream>
 #include <Eigen/Dense>
 
+#include "piqp/utils/thread_pool.hpp"
+#include "piqp/dense/rank_update.hpp"
+
 namespace piqp
 {
 
@@ -31,6 +34,12 @@ namespace dense
 
 template<typename MatrixType, int UpLo = Eigen::Lower> class LDLTNoPivot;
 
+enum LDLTKernel
+{
+    LDLT_KERNEL_BLOCKED = 0,  // right-looking blocked factorization with fixed panel width
+    LDLT_KERNEL_RECURSIVE = 1 // recursive halving, cache-oblivious up to the leaf size
+};
+
 } // namespace dense
 
 } // namespace piqp
@@ -205,6 +214,24 @@ public:
     template<typename InputType>
     LDLTNoPivot& compute(const Eigen::EigenBase<InputType>& matrix);
 
+    /** Sets the thread pool used to parallelize the blocked factorization,
+      * nullptr (default) factorizes on the calling thread only.
+      */
+    void setThreadPool(ThreadPool* pool) { m_thread_pool = pool; }
+
+    /** Sets the factorization kernel and its block size, i.e., the panel width of the
+      * blocked kernel or the leaf size of the recursive kernel. A block size of 0
+      * (default) uses a heuristic based on the matrix size.
+      */
+    void setKernel(LDLTKernel kernel, Eigen::Index block_size = 0)
+    {
+        m_kernel = kernel;
+        m_block_size = block_size;
+    }
+
+    LDLTKernel kernel() const { return m_kernel; }
+    Eigen::Index blockSize() const { return m_block_size; }
+
     /** \returns an estimate of the reciprocal condition number of the matrix of
       *  which \c *this is the LDLT decomposition.
       */
@@ -269,6 +296,9 @@ protected:
     TmpMatrixType m_temporary;
     bool m_isInitialized;
     Eigen::ComputationInfo m_info;
+    ThreadPool* m_thread_pool = nullptr;
+    LDLTKernel m_kernel = LDLT_KERNEL_BLOCKED;
+    Eigen::Index m_block_size = 0;
 };
 
 namespace internal {
@@ -312,17 +342,49 @@ template<> struct ldlt_no_pivot_inplace<Eigen::Lower>
         return -1;
     }
 
+    // A21 = A21 (A11^)^(-1) D11^(-1) given the factorized A11, and A21_tmp = A21 D11
+    template<typename Block11, typename Block21, typename BlockTmp>
+    static void panel(const Block11& A11, Block21& A21, BlockTmp& A21_tmp, ThreadPool* pool)
+    {
+        const Eigen::Index rs = A21.rows();
+
+        // the rows of the panel A21 are independent
+        auto panel_rows = [&](Eigen::Index r0, Eigen::Index rb) {
+            auto A21_r = A21.middleRows(r0, rb);
+            A11.adjoint().template triangularView<Eigen::UnitUpper>().template solveInPlace<Eigen::OnTheRight>(A21_r);
+            A21_r = A21_r * A11.diagonal().real().asDiagonal().inverse();
+            A21_tmp.middleRows(r0, rb) = A21_r * A11.diagonal().real().asDiagonal();
+        };
+
+        isize n_threads = pool ? pool->n_threads() : 1;
+        isize n_panels = (std::min)(n_threads, isize(rs) / piqp::dense::PARALLEL_MIN_BLOCK_ROWS);
+        if (n_panels > 1)
+        {
+            pool->parallel_for(n_panels, [&](isize i) {
+                Eigen::Index r0 = rs * i / n_panels;
+                panel_rows(r0, rs * (i + 1) / n_panels - r0);
+            });
+        }
+        else
+        {
+            panel_rows(0, rs);
+        }
+    }
+
     template<typename MatrixType, typename Workspace>
-    static Eigen::Index blocked(MatrixType& m, Workspace& temp)
+    static Eigen::Index blocked(MatrixType& m, Workspace& temp, ThreadPool* pool = nullptr, Eigen::Index blockSize = 0)
     {
         eigen_assert(m.rows() == m.cols());
         Eigen::Index size = m.rows();
         if (size < 32)
             return unblocked(m, temp);
 
-        Eigen::Index blockSize = size / 8;
-        blockSize = (blockSize / 16) * 16;
-        blockSize = (std::min)((std::max)(blockSize, Eigen::Index(8)), Eigen::Index(128));
+        if (blockSize <= 0)
+        {
+            blockSize = size / 8;
+            blockSize = (blockSize / 16) * 16;
+            blockSize = (std::min)((std::max)(blockSize, Eigen::Index(8)), Eigen::Index(128));
+        }
 
         for (Eigen::Index k = 0; k < size; k += blockSize)
         {
@@ -343,17 +405,61 @@ template<> struct ldlt_no_pivot_inplace<Eigen::Lower>
             if ((ret = unblocked(A11, temp)) >= 0) return k + ret;
             if (rs > 0)
             {
-                // A21 = A21 (A11^)^(-1) D11^(-1)
-                A11.adjoint().template triangularView<Eigen::UnitUpper>().template solveInPlace<Eigen::OnTheRight>(A21);
-                A21 = A21 * A11.diagonal().real().asDiagonal().inverse();
+                panel(A11, A21, A21_tmp, pool);
 
                 // A22 -= A21 * D11 * A21^
-                A21_tmp = A21 * A11.diagonal().real().asDiagonal();
-                A22.template triangularView<Eigen::Lower>() -= A21_tmp * A21.transpose();
+                rank_update_lower(A22, A21_tmp, A21, typename MatrixType::Scalar(-1), pool);
             }
         }
         return -1;
     }
+
+    // Splits the matrix in halves, factorizes the leading half, updates the trailing
+    // half with a single rank update and recurses on it. In contrast to the blocked
+    // kernel, most of the flops are spent in large matrix-matrix products independent
+    // of the cache sizes, the leaf size only determines when the unblocked kernel is used.
+    template<typename MatrixType, typename Workspace>
+    static Eigen::Index recursive(MatrixType& m, Workspace& temp, ThreadPool* pool = nullptr, Eigen::Index leafSize = 0)
+    {
+        eigen_assert(m.rows() == m.cols());
+        if (leafSize <= 0) leafSize = 32;
+        return recursive(m, 0, m.rows(), temp, pool, leafSize);
+    }
+
+    // factorizes the diagonal block m[k:k+size, k:k+size], the recursion works on index
+    // ranges of the same matrix to avoid nesting block expressions
+    template<typename MatrixType, typename Workspace>
+    static Eigen::Index recursive(MatrixType& m, Eigen::Index k, Eigen::Index size, Workspace& temp, ThreadPool* pool, Eigen::Index leafSize)
+    {
+        if (size <= leafSize)
+        {
+            Eigen::Block<MatrixType, Eigen::Dynamic, Eigen::Dynamic> A(m, k, k, size, size);
+            Eigen::Index ret = unblocked(A, temp);
+            return ret >= 0 ? k + ret : -1;
+        }
+
+        // keep the split aligned for the vectorized products
+        Eigen::Index n1 = (size / 2 / 16) * 16;
+        if (n1 == 0) n1 = size / 2;
+        Eigen::Index n2 = size - n1;
+
+        Eigen::Index ret;
+        if ((ret = recursive(m, k, n1, temp, pool, leafSize)) >= 0) return ret;
+
+        Eigen::Block<MatrixType, Eigen::Dynamic, Eigen::Dynamic> A11(m, k, k, n1, n1);
+        Eigen::Block<MatrixType, Eigen::Dynamic, Eigen::Dynamic> A21(m, k + n1, k, n2, n1);
+        Eigen::Block<MatrixType, Eigen::Dynamic, Eigen::Dynamic> A22(m, k + n1, k + n1, n2, n2);
+
+        // the unused upper triangular part is free once A11 is factorized
+        Eigen::Block<MatrixType, Eigen::Dynamic, Eigen::Dynamic> A21_tmp(m, k, k + n2, n2, n1);
+
+        panel(A11, A21, A21_tmp, pool);
+
+        // A22 -= A21 * D11 * A21^
+        rank_update_lower(A22, A21_tmp, A21, typename MatrixType::Scalar(-1), pool);
+
+        return recursive(m, k + n1, n2, temp, pool, leafSize);
+    }
 };
 
 template<> struct ldlt_no_pivot_inplace<Eigen::Upper>
@@ -365,10 +471,16 @@ template<> struct ldlt_no_pivot_inplace<Eigen::Upper>
         return ldlt_no_pivot_inplace<Eigen::Lower>::unblocked(matt, temp);
     }
     template<typename MatrixType, typename Workspace>
-    static EIGEN_STRONG_INLINE Eigen::Index blocked(MatrixType& mat, Workspace& temp)
+    static EIGEN_STRONG_INLINE Eigen::Index blocked(MatrixType& mat, Workspace& temp, ThreadPool* pool = nullptr, Eigen::Index blockSize = 0)
     {
         Eigen::Transpose<MatrixType> matt(mat);
-        return ldlt_no_pivot_inplace<Eigen::Lower>::blocked(matt, temp);
+        return ldlt_no_pivot_inplace<Eigen::Lower>::blocked(matt, temp, pool, blockSize);
+    }
+    template<typename MatrixType, typename Workspace>
+    static EIGEN_STRONG_INLINE Eigen::Index recursive(MatrixType& mat, Workspace& temp, ThreadPool* pool = nullptr, Eigen::Index leafSize = 0)
+    {
+        Eigen::Transpose<MatrixType> matt(mat);
+        return ldlt_no_pivot_inplace<Eigen::Lower>::recursive(matt, temp, pool, leafSize);
     }
 };
 
@@ -417,7 +529,12 @@ LDLTNoPivot<MatrixType,UpLo_>& LDLTNoPivot<MatrixType,UpLo_>::compute(const Eige
 
     m_temporary.resize(size);
     m_isInitialized = true;
-    bool ok = internal::ldlt_no_pivot_inplace<UpLo>::blocked(m_matrix, m_temporary) == -1;
+    Eigen::Index ret;
+    if (m_kernel == LDLT_KERNEL_RECURSIVE)
+        ret = internal::ldlt_no_pivot_inplace<UpLo>::recursive(m_matrix, m_temporary, m_thread_pool, m_block_size);
+    else
+        ret = internal::ldlt_no_pivot_inplace<UpLo>::blocked(m_matrix, m_temporary, m_thread_pool, m_block_size);
+    bool ok = ret == -1;
     m_info = ok ? Eigen::Success : Eigen::NumericalIssue;
 
     return *this;
@@ -0,0 +1,272 @@
+// This file is part of PIQP.
+//
+// Copyright (c) 2024 EPFL
+//
+// This source code is licensed under the BSD 2-Clause License found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef PIQP_DENSE_LDLT_TUNING_HPP
+#define PIQP_DENSE_LDLT_TUNING_HPP
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <system_error>
+
+#ifdef __APPLE__
+#include <sys/sysctl.h>
+#endif
+
+#include "piqp/fwd.hpp"
+#include "piqp/typedefs.hpp"
+#include "piqp/timer.hpp"
+#include "piqp/dense/ldlt_no_pivot.hpp"
+#include "piqp/utils/filesystem.hpp"
+
+namespace piqp
+{
+
+namespace dense
+{
+
+// matrices smaller than this are factorized with the default kernel, i.e.,
+// small problems never use the tuning
+constexpr isize LDLT_TUNING_MIN_SIZE = 256;
+
+// Kernel and block size of the dense LDL^T factorization, tuned per CPU and scalar type.
+// The tuning is run explicitly with tune_machine(), e.g., by the dense Cholesky benchmark,
+// which caches the result on disk, one line per CPU. The solver only reads the cache.
+template<typename T>
+struct LDLTTuning
+{
+    LDLTKernel kernel = LDLT_KERNEL_BLOCKED;
+    isize block_size = 0; // 0 uses the size based heuristic of the kernel
+
+    template<typename MatrixType, int UpLo>
+    void apply(LDLTNoPivot<MatrixType, UpLo>& ldlt) const
+    {
+        ldlt.setKernel(kernel, block_size);
+    }
+
+    // times the factorization of a size n matrix for all candidate kernels and
+    // block sizes, takes a few hundred milliseconds for the default size
+    static LDLTTuning<T> tune(isize n = 512)
+    {
+        std::mt19937 gen(42);
+        std::uniform_real_distribution<double> dist(-1.0, 1.0);
+        Mat<T> K(n, n);
+        for (isize j = 0; j < n; j++) {
+            for (isize i = 0; i <= j; i++) {
+                K(i, j) = T(dist(gen));
+                K(j, i) = K(i, j);
+            }
+            K(j, j) = T(n);
+        }
+
+        struct Candidate
+        {
+            LDLTKernel kernel;
+            isize block_size;
+        };
+        const Candidate candidates[] = {
+            {LDLT_KERNEL_BLOCKED, 0},
+            {LDLT_KERNEL_BLOCKED, 16},
+            {LDLT_KERNEL_BLOCKED, 32},
+            {LDLT_KERNEL_BLOCKED, 64},
+            {LDLT_KERNEL_BLOCKED, 96},
+            {LDLT_KERNEL_BLOCKED, 128},
+            {LDLT_KERNEL_RECURSIVE, 16},
+            {LDLT_KERNEL_RECURSIVE, 32},
+            {LDLT_KERNEL_RECURSIVE, 48},
+            {LDLT_KERNEL_RECURSIVE, 64}
+        };
+
+        LDLTNoPivot<Mat<T>> ldlt(n);
+        Timer<T> timer;
+        LDLTTuning<T> best;
+        T best_time = std::numeric_limits<T>::infinity();
+        T default_time = std::numeric_limits<T>::infinity();
+        for (const Candidate& candidate : candidates)
+        {
+            ldlt.setKernel(candidate.kernel, candidate.block_size);
+            T time = std::numeric_limits<T>::infinity();
+            for (int r = 0; r < 3; r++)
+            {
+                timer.start();
+                ldlt.compute(K);
+                time = std::min(time, timer.stop());
+            }
+            if (candidate.kernel == LDLT_KERNEL_BLOCKED && candidate.block_size == 0) default_time = time;
+            if (time < best_time)
+            {
+                best_time = time;
+                best.kernel = candidate.kernel;
+                best.block_size = candidate.block_size;
+            }
+        }
+
+        // only deviate from the default if the gain is above the timing noise
+        if (best_time > T(0.95) * default_time)
+        {
+            best = LDLTTuning<T>();
+        }
+        return best;
+    }
+
+    // identifies the CPU model and the scalar type, the tuning is only reused on an identical key
+    static std::string cpu_key()
+    {
+        std::string name;
+#if defined(__APPLE__)
+        char brand[256];
+        size_t size = sizeof(brand);
+        if (sysctlbyname("machdep.cpu.brand_string", brand, &size, nullptr, 0) == 0) name = brand;
+#elif defined(_WIN32)
+        if (const char* identifier = std::getenv("PROCESSOR_IDENTIFIER")) name = identifier;
+#else
+        std::ifstream cpuinfo("/proc/cpuinfo");
+        std::string line;
+        while (std::getline(cpuinfo, line))
+        {
+            // x86 reports "model name", arm "CPU implementer" and "CPU part"
+            if (line.rfind("model name", 0) == 0 || line.rfind("CPU implementer", 0) == 0 || line.rfind("CPU part", 0) == 0)
+            {
+                std::size_t colon = line.find(':');
+                if (colon == std::string::npos) continue;
+                if (!name.empty()) name += " ";
+                name += line.substr(colon + 1);
+                if (line.rfind("model name", 0) == 0 || line.rfind("CPU part", 0) == 0) break;
+            }
+        }
+#endif
+        if (name.empty()) name = "unknown";
+        // normalize whitespace, the key is stored as the remainder of a line
+        std::istringstream words(name);
+        std::string word, key = sizeof(T) == sizeof(float) ? "f32" : "f64";
+        while (words >> word) key += " " + word;
+        return key;
+    }
+
+    // file format: one "<kernel> <block_size> <cpu key>" line per CPU
+    bool load(const std::string& path, const std::string& key = cpu_key())
+    {
+        std::ifstream file(path);
+        if (!file.is_open()) return false;
+
+        std::string line;
+        while (std::getline(file, line))
+        {
+            if (line.empty() || line[0] == '#') continue;
+            std::istringstream fields(line);
+            int kernel_value;
+            isize block_size_value;
+            std::string line_key;
+            if (!(fields >> kernel_value >> block_size_value)) continue;
+            std::getline(fields >> std::ws, line_key);
+            if (line_key != key) continue;
+            if (kernel_value != LDLT_KERNEL_BLOCKED && kernel_value != LDLT_KERNEL_RECURSIVE) return false;
+            if (block_size_value < 0) return false;
+            kernel = LDLTKernel(kernel_value);
+            block_size = block_size_value;
+            return true;
+        }
+        return false;
+    }
+
+    // adds or replaces the line of this CPU, keeping the lines of other CPUs
+    bool save(const std::string& path, const std::string& key = cpu_key()) const
+    {
+        std::vector<std::string> lines;
+        {
+            std::ifstream file(path);
+            std::string line;
+            while (std::getline(file, line))
+            {
+                if (line.empty() || line[0] == '#') continue;
+                std::istringstream fields(line);
+                int kernel_value;
+                isize block_size_value;
+                std::string line_key;
+                if (!(fields >> kernel_value >> block_size_value)) continue;
+                std::getline(fields >> std::ws, line_key);
+                if (line_key != key) lines.push_back(line);
+            }
+        }
+        lines.push_back(std::to_string(int(kernel)) + " " + std::to_string(block_size) + " " + key);
+
+        // write to a temporary file first such that concurrent readers never see a partial file
+        std::string tmp_path = path + ".tmp";
+        {
+            std::ofstream file(tmp_path);
+            if (!file.is_open()) return false;
+            file << "# PIQP dense LDL^T tuning: <kernel> <block_size> <cpu>\n";
+            for (const std::string& line : lines) file << line << "\n";
+            if (!file.good()) return false;
+        }
+        std::error_code ec;
+        fs::rename(tmp_path, path, ec);
+        return !ec;
+    }
+
+    // location of the tuning cache, the environment variable PIQP_LDLT_TUNING
+    // takes precedence over the user cache directory
+    static std::string default_path()
+    {
+        if (const char* path = std::getenv("PIQP_LDLT_TUNING")) return path;
+        std::string cache_dir = user_cache_dir();
+        if (cache_dir.empty()) return "";
+        return (fs::path(cache_dir) / "ldlt_tuning.txt").string();
+    }
+
+    // tuning of this machine as read from the cache on first use, the default
+    // kernel if the machine has not been tuned, never runs the tuning itself
+    static const LDLTTuning<T>& machine()
+    {
+        return machine_storage();
+    }
+
+    // tunes this machine, stores the result in the cache and uses it for solvers set up afterwards,
+    // should not be called concurrently with the setup of dense solvers
+    static LDLTTuning<T> tune_machine(const std::string& path = default_path())
+    {
+        LDLTTuning<T> tuning = tune();
+        if (!path.empty())
+        {
+            std::error_code ec;
+            fs::create_directories(fs::path(path).parent_path(), ec);
+            if (!tuning.save(path))
+            {
+                piqp_eprint("piqp: could not save LDL^T tuning to %s\n", path.c_str());
+            }
+        }
+        machine_storage() = tuning;
+        return tuning;
+    }
+
+protected:
+    static LDLTTuning<T>& machine_storage()
+    {
+        static LDLTTuning<T> tuning = load_cached(default_path());
+        return tuning;
+    }
+
+    static LDLTTuning<T> load_cached(const std::string& path)
+    {
+        // load only changes the tuning if an entry of this CPU is found
+        LDLTTuning<T> tuning;
+        if (!path.empty()) tuning.load(path);
+        return tuning;
+    }
+};
+
+} // namespace dense
+
+} // namespace piqp
+
+#endif //PIQP_DENSE_LDLT_TUNING_HPP
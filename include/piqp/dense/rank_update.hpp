@@ -0,0 +1,79 @@
+// This file is part of PIQP.
+//
+// Copyright (c) 2024 EPFL
+//
+// This source code is licensed under the BSD 2-Clause License found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef PIQP_DENSE_RANK_UPDATE_HPP
+#define PIQP_DENSE_RANK_UPDATE_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <Eigen/Dense>
+
+#include "piqp/typedefs.hpp"
+#include "piqp/utils/thread_pool.hpp"
+
+namespace piqp
+{
+
+namespace dense
+{
+
+// minimum number of rows per task, smaller updates are not worth distributing
+constexpr isize PARALLEL_MIN_BLOCK_ROWS = 32;
+
+// Splits the rows of a lower triangular n x n matrix into n_blocks row blocks
+// of roughly equal area, i.e., block k starts at row n * sqrt(k / n_blocks).
+inline void triangular_row_blocks(isize n, isize n_blocks, std::vector<isize>& bounds)
+{
+    bounds.resize(std::size_t(n_blocks + 1));
+    bounds[0] = 0;
+    for (isize k = 1; k < n_blocks; k++)
+    {
+        isize bound = isize(std::round(double(n) * std::sqrt(double(k) / double(n_blocks))));
+        bounds[std::size_t(k)] = std::min(std::max(bound, bounds[std::size_t(k - 1)]), n);
+    }
+    bounds[std::size_t(n_blocks)] = n;
+}
+
+// SYRK-like update of the lower triangular part C += alpha * X * Y^T where X and Y are
+// n x k matrices. If a thread pool is given, the rows of C are split into blocks of
+// roughly equal work which are updated in parallel. Block i only writes the rows
+// [r_i, r_{i+1}) of the lower triangle, so the tasks are independent.
+template<typename MatC, typename MatX, typename MatY, typename T>
+void rank_update_lower(MatC& C, const MatX& X, const MatY& Y, const T& alpha, ThreadPool* pool)
+{
+    const isize n = C.rows();
+    isize n_threads = pool ? pool->n_threads() : 1;
+    if (n_threads <= 1 || n < 2 * PARALLEL_MIN_BLOCK_ROWS)
+    {
+        C.template triangularView<Eigen::Lower>() += alpha * X * Y.transpose();
+        return;
+    }
+
+    isize n_blocks = std::min(4 * n_threads, n / PARALLEL_MIN_BLOCK_ROWS);
+    std::vector<isize> bounds;
+    triangular_row_blocks(n, n_blocks, bounds);
+
+    // the blocks at the bottom carry the most work and are handed out first
+    pool->parallel_for(n_blocks, [&](isize task) {
+        isize k = n_blocks - 1 - task;
+        isize r0 = bounds[std::size_t(k)];
+        isize rb = bounds[std::size_t(k + 1)] - r0;
+        if (rb <= 0) return;
+        if (r0 > 0)
+        {
+            C.block(r0, 0, rb, r0).noalias() += alpha * X.middleRows(r0, rb) * Y.topRows(r0).transpose();
+        }
+        C.block(r0, r0, rb, rb).template triangularView<Eigen::Lower>() += alpha * X.middleRows(r0, rb) * Y.middleRows(r0, rb).transpose();
+    });
+}
+
+} // namespace dense
+
+} // namespace piqp
+
+#endif //PIQP_DENSE_RANK_UPDATE_HPP
@@ -0,0 +1,134 @@
+// This file is part of PIQP.
+//
+// Copyright (c) 2024 EPFL
+//
+// This source code is licensed under the BSD 2-Clause License found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef PIQP_DISPATCHED_SOLVER_HPP
+#define PIQP_DISPATCHED_SOLVER_HPP
+
+#include <memory>
+
+#include "piqp/common.hpp"
+#include "piqp/typedefs.hpp"
+#include "piqp/settings.hpp"
+#include "piqp/results.hpp"
+#include "piqp/utils/optional.hpp"
+
+namespace piqp
+{
+
+namespace dispatch
+{
+
+// Interface of the solvers created by the instruction set modules of libpiqp. The modules are
+// compiled from the same sources and definitions as libpiqp, so the data types are shared.
+template<typename T, typename MatRef>
+class SolverInterface
+{
+public:
+    virtual ~SolverInterface() = default;
+
+    virtual Settings<T>& settings() = 0;
+    virtual const Result<T>& result() const = 0;
+
+    virtual void setup(const MatRef& P,
+                       const CVecRef<T>& c,
+                       const optional<MatRef>& A,
+                       const optional<CVecRef<T>>& b,
+                       const optional<MatRef>& G,
+                       const optional<CVecRef<T>>& h,
+                       const optional<CVecRef<T>>& x_lb,
+                       const optional<CVecRef<T>>& x_ub) = 0;
+
+    virtual void update(const optional<MatRef>& P,
+                        const optional<CVecRef<T>>& c,
+                        const optional<MatRef>& A,
+                        const optional<CVecRef<T>>& b,
+                        const optional<MatRef>& G,
+                        const optional<CVecRef<T>>& h,
+                        const optional<CVecRef<T>>& x_lb,
+                        const optional<CVecRef<T>>& x_ub,
+                        bool reuse_preconditioner) = 0;
+
+    virtual void warm_start(const optional<CVecRef<T>>& x,
+                            const optional<CVecRef<T>>& y,
+                            const optional<CVecRef<T>>& z,
+                            const optional<CVecRef<T>>& z_lb,
+                            const optional<CVecRef<T>>& z_ub) = 0;
+
+    virtual Status solve() = 0;
+    virtual void cancel() = 0;
+};
+
+} // namespace dispatch
+
+// Front end of DenseSolver<double> and SparseSolver<double, int> in libpiqp, which runs the
+// variant of the solver compiled for the best instruction set supported by the CPU, i.e.,
+// SSE4.2, AVX2 or AVX-512, if libpiqp is built with instruction set variants. The variant is
+// selected with cpu_features when the first solver is created, see instruction_set(). Otherwise,
+// and if no variant can be loaded, the solver of libpiqp itself is used. Only available when
+// linking against libpiqp, i.e., not with the header-only library.
+template<typename T, typename MatRef>
+class DispatchedSolver
+{
+protected:
+    std::unique_ptr<dispatch::SolverInterface<T, MatRef>> m_solver;
+
+public:
+    DispatchedSolver();
+
+    // instruction set the solvers are compiled for, i.e., "baseline", "sse42", "avx2" or "avx512"
+    static const char* instruction_set();
+
+    Settings<T>& settings() { return m_solver->settings(); }
+
+    const Result<T>& result() const { return m_solver->result(); }
+
+    void setup(const MatRef& P,
+               const CVecRef<T>& c,
+               const optional<MatRef>& A = nullopt,
+               const optional<CVecRef<T>>& b = nullopt,
+               const optional<MatRef>& G = nullopt,
+               const optional<CVecRef<T>>& h = nullopt,
+               const optional<CVecRef<T>>& x_lb = nullopt,
+               const optional<CVecRef<T>>& x_ub = nullopt)
+    {
+        m_solver->setup(P, c, A, b, G, h, x_lb, x_ub);
+    }
+
+    void update(const optional<MatRef>& P = nullopt,
+                const optional<CVecRef<T>>& c = nullopt,
+                const optional<MatRef>& A = nullopt,
+                const optional<CVecRef<T>>& b = nullopt,
+                const optional<MatRef>& G = nullopt,
+                const optional<CVecRef<T>>& h = nullopt,
+                const optional<CVecRef<T>>& x_lb = nullopt,
+                const optional<CVecRef<T>>& x_ub = nullopt,
+                bool reuse_preconditioner = true)
+    {
+        m_solver->update(P, c, A, b, G, h, x_lb, x_ub, reuse_preconditioner);
+    }
+
+    void warm_start(const optional<CVecRef<T>>& x,
+                    const optional<CVecRef<T>>& y = nullopt,
+                    const optional<CVecRef<T>>& z = nullopt,
+                    const optional<CVecRef<T>>& z_lb = nullopt,
+                    const optional<CVecRef<T>>& z_ub = nullopt)
+    {
+        m_solver->warm_start(x, y, z, z_lb, z_ub);
+    }
+
+    Status solve() { return m_solver->solve(); }
+
+    // requests to stop the running solve, can be called from any thread
+    void cancel() { m_solver->cancel(); }
+};
+
+using DispatchedDenseSolver = DispatchedSolver<common::Scalar, CMatRef<common::Scalar>>;
+using DispatchedSparseSolver = DispatchedSolver<common::Scalar, CSparseMatRef<common::Scalar, common::StorageIndex>>;
+
+} // namespace piqp
+
+#endif //PIQP_DISPATCHED_SOLVER_HPP
@@ -0,0 +1,268 @@
+// This file is part of PIQP.
+//
+// Copyright (c) 2024 EPFL
+//
+// This source code is licensed under the BSD 2-Clause License found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef PIQP_DYNAMIC_SPARSE_SOLVER_HPP
+#define PIQP_DYNAMIC_SPARSE_SOLVER_HPP
+
+#include <functional>
+#include <future>
+#include <memory>
+
+#include "piqp/solver.hpp"
+#include "piqp/sparse/kkt_analysis.hpp"
+
+namespace piqp
+{
+
+// Sparse solver with the KKT mode chosen at runtime instead of as template parameter.
+// With KKT_AUTO, setup analyzes the KKT matrices of all modes symbolically and sets up the one
+// with the fewest non-zeros in the factor.
+template<typename T, typename I = int>
+class DynamicSparseSolver
+{
+protected:
+    Settings<T> m_settings;
+    int m_requested_kkt_mode = KKTMode::KKT_FULL;
+    int m_kkt_mode = KKTMode::KKT_FULL;
+
+    // exactly one of the solvers exists after setup
+    std::unique_ptr<SparseSolver<T, I, KKTMode::KKT_FULL>> m_full;
+    std::unique_ptr<SparseSolver<T, I, KKTMode::KKT_EQ_ELIMINATED>> m_eq_eliminated;
+    std::unique_ptr<SparseSolver<T, I, KKTMode::KKT_INEQ_ELIMINATED>> m_ineq_eliminated;
+    std::unique_ptr<SparseSolver<T, I, KKTMode::KKT_ALL_ELIMINATED>> m_all_eliminated;
+
+    Result<T> m_empty_result;
+    Trace<T> m_empty_trace;
+
+public:
+    explicit DynamicSparseSolver(int kkt_mode = KKTMode::KKT_FULL) : m_requested_kkt_mode(kkt_mode)
+    {
+        m_empty_result.info.status = Status::PIQP_UNSOLVED;
+    }
+
+    Settings<T>& settings() { return m_settings; }
+
+    // takes effect on the next setup
+    void set_kkt_mode(int kkt_mode) { m_requested_kkt_mode = kkt_mode; }
+
+    // KKT mode of the current setup, KKT_AUTO is resolved to the chosen mode
+    int kkt_mode() const { return m_kkt_mode; }
+
+    const Result<T>& result() const
+    {
+        const Result<T>* result = &m_empty_result;
+        visit([&](const auto& solver) { result = &solver.result(); });
+        return *result;
+    }
+
+    const Trace<T>& trace() const
+    {
+        const Trace<T>* trace = &m_empty_trace;
+        visit([&](const auto& solver) { trace = &solver.trace(); });
+        return *trace;
+    }
+
+    void clear_trace()
+    {
+        visit([&](auto& solver) { solver.clear_trace(); });
+    }
+
+    void setup(const CSparseMatRef<T, I>& P,
+               const CVecRef<T>& c,
+               const optional<CSparseMatRef<T, I>>& A = nullopt,
+               const optional<CVecRef<T>>& b = nullopt,
+               const optional<CSparseMatRef<T, I>>& G = nullopt,
+               const optional<CVecRef<T>>& h = nullopt,
+               const optional<CVecRef<T>>& x_lb = nullopt,
+               const optional<CVecRef<T>>& x_ub = nullopt)
+    {
+        reset();
+
+        int kkt_mode = m_requested_kkt_mode;
+        if (kkt_mode == KKTMode::KKT_AUTO)
+        {
+            // analyze every mode and choose the one with the fewest non-zeros in the factor
+            isize best_factor_nnz = 0;
+            for (int mode : {KKTMode::KKT_FULL, KKTMode::KKT_EQ_ELIMINATED, KKTMode::KKT_INEQ_ELIMINATED, KKTMode::KKT_ALL_ELIMINATED})
+            {
+                Info<T> info;
+                sparse::analyze_kkt<T, I>(mode, P, A, G, m_settings, info);
+                if (kkt_mode == KKTMode::KKT_AUTO || info.kkt_factor_nnz < best_factor_nnz)
+                {
+                    kkt_mode = mode;
+                    best_factor_nnz = info.kkt_factor_nnz;
+                }
+            }
+        }
+
+        create(kkt_mode);
+        visit([&](auto& solver) {
+            solver.settings() = m_settings;
+            solver.setup(P, c, A, b, G, h, x_lb, x_ub);
+        });
+    }
+
+    void update(const optional<CSparseMatRef<T, I>>& P = nullopt,
+                const optional<CVecRef<T>>& c = nullopt,
+                const optional<CSparseMatRef<T, I>>& A = nullopt,
+                const optional<CVecRef<T>>& b = nullopt,
+                const optional<CSparseMatRef<T, I>>& G = nullopt,
+                const optional<CVecRef<T>>& h = nullopt,
+                const optional<CVecRef<T>>& x_lb = nullopt,
+                const optional<CVecRef<T>>& x_ub = nullopt,
+                bool reuse_preconditioner = true)
+    {
+        if (!visit([&](auto& solver) {
+                solver.settings() = m_settings;
+                solver.update(P, c, A, b, G, h, x_lb, x_ub, reuse_preconditioner);
+            }))
+        {
+            piqp_eprint("Solver not setup yet\n");
+        }
+    }
+
+    // see SolverBase::warm_start
+    void warm_start(const optional<CVecRef<T>>& x,
+                    const optional<CVecRef<T>>& y = nullopt,
+                    const optional<CVecRef<T>>& z = nullopt,
+                    const optional<CVecRef<T>>& z_lb = nullopt,
+                    const optional<CVecRef<T>>& z_ub = nullopt)
+    {
+        if (!visit([&](auto& solver) { solver.warm_start(x, y, z, z_lb, z_ub); }))
+        {
+            piqp_eprint("Solver not setup yet\n");
+        }
+    }
+
+    Status solve()
+    {
+        Status status = Status::PIQP_UNSOLVED;
+        if (!visit([&](auto& solver) {
+                solver.settings() = m_settings;
+                status = solver.solve();
+            }))
+        {
+            piqp_eprint("Solver not setup yet\n");
+        }
+        return status;
+    }
+
+    // see SolverBase::solve_async
+    std::future<Status> solve_async()
+    {
+        return solve_async([](Status) {});
+    }
+
+    std::future<Status> solve_async(std::function<void(Status)> on_done)
+    {
+        std::future<Status> future;
+        if (!visit([&](auto& solver) {
+                solver.settings() = m_settings;
+                future = solver.solve_async(on_done);
+            }))
+        {
+            piqp_eprint("Solver not setup yet\n");
+            std::promise<Status> unsolved;
+            unsolved.set_value(Status::PIQP_UNSOLVED);
+            on_done(Status::PIQP_UNSOLVED);
+            future = unsolved.get_future();
+        }
+        return future;
+    }
+
+    // can be called from any thread, see SolverBase::cancel
+    void cancel()
+    {
+        visit([&](auto& solver) { solver.cancel(); });
+    }
+
+    // see SolverBase::begin_solve
+    void begin_solve()
+    {
+        visit([&](auto& solver) {
+            solver.settings() = m_settings;
+            solver.begin_solve();
+        });
+    }
+
+    bool step()
+    {
+        bool running = false;
+        visit([&](auto& solver) { running = solver.step(); });
+        return running;
+    }
+
+    Status finish()
+    {
+        Status status = Status::PIQP_UNSOLVED;
+        visit([&](auto& solver) { status = solver.finish(); });
+        return status;
+    }
+
+protected:
+    void reset()
+    {
+        m_full.reset();
+        m_eq_eliminated.reset();
+        m_ineq_eliminated.reset();
+        m_all_eliminated.reset();
+    }
+
+    void create(int kkt_mode)
+    {
+        switch (kkt_mode)
+        {
+            case KKTMode::KKT_EQ_ELIMINATED:
+                m_eq_eliminated.reset(new SparseSolver<T, I, KKTMode::KKT_EQ_ELIMINATED>());
+                m_kkt_mode = KKTMode::KKT_EQ_ELIMINATED;
+                break;
+            case KKTMode::KKT_INEQ_ELIMINATED:
+                m_ineq_eliminated.reset(new SparseSolver<T, I, KKTMode::KKT_INEQ_ELIMINATED>());
+                m_kkt_mode = KKTMode::KKT_INEQ_ELIMINATED;
+                break;
+            case KKTMode::KKT_ALL_ELIMINATED:
+                m_all_eliminated.reset(new SparseSolver<T, I, KKTMode::KKT_ALL_ELIMINATED>());
+                m_kkt_mode = KKTMode::KKT_ALL_ELIMINATED;
+                break;
+            default:
+                m_full.reset(new SparseSolver<T, I, KKTMode::KKT_FULL>());
+                m_kkt_mode = KKTMode::KKT_FULL;
+                break;
+        }
+    }
+
+    // calls f with the existing solver, returns false if there is none
+    template<typename F>
+    bool visit(const F& f)
+    {
+        if (m_full) f(*m_full);
+        else if (m_eq_eliminated) f(*m_eq_eliminated);
+        else if (m_ineq_eliminated) f(*m_ineq_eliminated);
+        else if (m_all_eliminated) f(*m_all_eliminated);
+        else return false;
+        return true;
+    }
+
+    // calls f with the existing solver as const, the pointers themselves do not propagate constness
+    template<typename F>
+    bool visit(const F& f) const
+    {
+        if (m_full) f(as_const(*m_full));
+        else if (m_eq_eliminated) f(as_const(*m_eq_eliminated));
+        else if (m_ineq_eliminated) f(as_const(*m_ineq_eliminated));
+        else if (m_all_eliminated) f(as_const(*m_all_eliminated));
+        else return false;
+        return true;
+    }
+
+    template<typename Solver>
+    static const Solver& as_const(const Solver& solver) { return solver; }
+};
+
+} // namespace piqp
+
+#endif //PIQP_DYNAMIC_SPARSE_SOLVER_HPP
@@ -17,7 +17,22 @@ enum KKTMode
     KKT_FULL = 0,
     KKT_EQ_ELIMINATED = 0x1,
     KKT_INEQ_ELIMINATED = 0x2,
-    KKT_ALL_ELIMINATED = KKT_EQ_ELIMINATED | KKT_INEQ_ELIMINATED
+    KKT_ALL_ELIMINATED = KKT_EQ_ELIMINATED | KKT_INEQ_ELIMINATED,
+    KKT_AUTO = -1 // only for runtime selection, see DynamicSparseSolver
+};
+
+enum DenseKKTFormulation
+{
+    DENSE_KKT_AUTO = 0,    // smaller of the two formulations below
+    DENSE_KKT_REDUCED = 1, // n x n reduced system P + rho I + G^T W G + A^T A / delta
+    DENSE_KKT_SCHUR = 2    // (p + m) x (p + m) Schur complement, requires a positive diagonal P
+};
+
+enum StagewiseKKTFactorization
+{
+    STAGEWISE_KKT_AUTO = 0,            // cyclic reduction for long horizons if several threads are available
+    STAGEWISE_KKT_SEQUENTIAL = 1,      // block elimination from the first to the last stage
+    STAGEWISE_KKT_CYCLIC_REDUCTION = 2 // block cyclic reduction, parallel over the stages
 };
 
 enum KKTUpdateOptions
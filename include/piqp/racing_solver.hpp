@@ -0,0 +1,262 @@
+// This file is part of PIQP.
+//
+// Copyright (c) 2024 EPFL
+//
+// This source code is licensed under the BSD 2-Clause License found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef PIQP_RACING_SOLVER_HPP
+#define PIQP_RACING_SOLVER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "piqp/dynamic_sparse_solver.hpp"
+#include "piqp/utils/thread_pool.hpp"
+
+namespace piqp
+{
+
+// One contestant of the RacingSolver. If settings is not set, the settings of the RacingSolver are used.
+template<typename T>
+struct RacingConfig
+{
+    int kkt_mode = KKTMode::KKT_FULL;
+    optional<Settings<T>> settings = nullopt;
+};
+
+// Winning configuration per sparsity pattern, can be shared between RacingSolvers
+// with the same list of configurations.
+class RacingMemory
+{
+protected:
+    std::mutex m_mutex;
+    std::unordered_map<std::uint64_t, isize> m_winners;
+
+public:
+    // returns -1 if the pattern has not been raced yet
+    isize winner(std::uint64_t pattern_hash)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_winners.find(pattern_hash);
+        return it != m_winners.end() ? it->second : -1;
+    }
+
+    void set_winner(std::uint64_t pattern_hash, isize config)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_winners[pattern_hash] = config;
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_winners.clear();
+    }
+};
+
+// Sparse solver front end which sets up one solver per configuration in parallel and races
+// them in solve. The first solver which terminates with a conclusive status (solved, primal
+// or dual infeasible) wins, the others are stopped at their next iteration. Updates are
+// applied to all contestants such that every solve is a new race.
+template<typename T, typename I = int>
+class RacingSolver
+{
+protected:
+    struct Contestant
+    {
+        isize config;
+        DynamicSparseSolver<T, I> solver;
+    };
+
+    Settings<T> m_settings;
+    std::vector<RacingConfig<T>> m_configs;
+    std::shared_ptr<RacingMemory> m_memory;
+
+    std::vector<Contestant> m_contestants;
+    ThreadPool m_pool;
+    std::atomic<isize> m_winner{-1};
+    isize m_result_contestant = 0;
+    std::uint64_t m_pattern_hash = 0;
+
+    Result<T> m_empty_result;
+
+public:
+    RacingSolver()
+    {
+        m_empty_result.info.status = Status::PIQP_UNSOLVED;
+        for (int kkt_mode : {KKTMode::KKT_FULL, KKTMode::KKT_EQ_ELIMINATED, KKTMode::KKT_INEQ_ELIMINATED, KKTMode::KKT_ALL_ELIMINATED})
+        {
+            RacingConfig<T> config;
+            config.kkt_mode = kkt_mode;
+            m_configs.push_back(config);
+        }
+    }
+
+    Settings<T>& settings() { return m_settings; }
+
+    // replaces the default configurations, i.e., all KKT modes with the settings of the RacingSolver,
+    // takes effect on the next setup
+    void set_configs(const std::vector<RacingConfig<T>>& configs) { m_configs = configs; }
+
+    const std::vector<RacingConfig<T>>& configs() const { return m_configs; }
+
+    // If a memory is set, the winning configuration is stored per sparsity pattern, and later setups
+    // of the same pattern only set up the winner instead of racing all configurations.
+    void set_memory(std::shared_ptr<RacingMemory> memory) { m_memory = std::move(memory); }
+
+    // index of the configuration which produced the last result
+    isize winner() const { return m_contestants.empty() ? -1 : m_contestants[std::size_t(m_result_contestant)].config; }
+
+    // number of configurations set up in the last setup
+    isize n_contestants() const { return isize(m_contestants.size()); }
+
+    std::uint64_t pattern_hash() const { return m_pattern_hash; }
+
+    // an unsolved result if there is no contestant, i.e., before setup or without configurations
+    const Result<T>& result() const
+    {
+        if (m_contestants.empty()) return m_empty_result;
+        return m_contestants[std::size_t(m_result_contestant)].solver.result();
+    }
+
+    void setup(const CSparseMatRef<T, I>& P,
+               const CVecRef<T>& c,
+               const optional<CSparseMatRef<T, I>>& A = nullopt,
+               const optional<CVecRef<T>>& b = nullopt,
+               const optional<CSparseMatRef<T, I>>& G = nullopt,
+               const optional<CVecRef<T>>& h = nullopt,
+               const optional<CVecRef<T>>& x_lb = nullopt,
+               const optional<CVecRef<T>>& x_ub = nullopt)
+    {
+        m_pattern_hash = hash_pattern(P, A, G);
+
+        isize remembered = m_memory ? m_memory->winner(m_pattern_hash) : -1;
+        if (remembered >= isize(m_configs.size())) remembered = -1;
+
+        m_contestants.clear();
+        for (isize i = 0; i < isize(m_configs.size()); i++)
+        {
+            if (remembered >= 0 && i != remembered) continue;
+            m_contestants.push_back(make_contestant(i));
+        }
+        m_result_contestant = 0;
+
+        m_pool.resize(isize(m_contestants.size()));
+        m_pool.parallel_for(isize(m_contestants.size()), [&](isize i) {
+            m_contestants[std::size_t(i)].solver.setup(P, c, A, b, G, h, x_lb, x_ub);
+        });
+    }
+
+    void update(const optional<CSparseMatRef<T, I>>& P = nullopt,
+                const optional<CVecRef<T>>& c = nullopt,
+                const optional<CSparseMatRef<T, I>>& A = nullopt,
+                const optional<CVecRef<T>>& b = nullopt,
+                const optional<CSparseMatRef<T, I>>& G = nullopt,
+                const optional<CVecRef<T>>& h = nullopt,
+                const optional<CVecRef<T>>& x_lb = nullopt,
+                const optional<CVecRef<T>>& x_ub = nullopt,
+                bool reuse_preconditioner = true)
+    {
+        m_pool.parallel_for(isize(m_contestants.size()), [&](isize i) {
+            m_contestants[std::size_t(i)].solver.update(P, c, A, b, G, h, x_lb, x_ub, reuse_preconditioner);
+        });
+    }
+
+    Status solve()
+    {
+        if (m_contestants.empty())
+        {
+            piqp_eprint("Solver not setup yet\n");
+            return Status::PIQP_UNSOLVED;
+        }
+
+        m_winner.store(-1);
+        m_pool.parallel_for(isize(m_contestants.size()), [&](isize i) {
+            Contestant& contestant = m_contestants[std::size_t(i)];
+            contestant.solver.settings() = settings_of(contestant);
+            contestant.solver.begin_solve();
+            while (m_winner.load(std::memory_order_relaxed) < 0 && contestant.solver.step()) {}
+            Status status = contestant.solver.finish();
+            if (is_conclusive(status))
+            {
+                isize no_winner = -1;
+                m_winner.compare_exchange_strong(no_winner, i);
+            }
+        });
+
+        isize winner = m_winner.load();
+        m_result_contestant = winner >= 0 ? winner : 0;
+        if (winner >= 0 && m_memory)
+        {
+            m_memory->set_winner(m_pattern_hash, m_contestants[std::size_t(winner)].config);
+        }
+
+        return result().info.status;
+    }
+
+protected:
+    static bool is_conclusive(Status status)
+    {
+        return status == Status::PIQP_SOLVED ||
+               status == Status::PIQP_PRIMAL_INFEASIBLE ||
+               status == Status::PIQP_DUAL_INFEASIBLE;
+    }
+
+    const Settings<T>& settings_of(const Contestant& contestant) const
+    {
+        const RacingConfig<T>& config = m_configs[std::size_t(contestant.config)];
+        return config.settings.has_value() ? *config.settings : m_settings;
+    }
+
+    Contestant make_contestant(isize config)
+    {
+        Contestant contestant{config, DynamicSparseSolver<T, I>(m_configs[std::size_t(config)].kkt_mode)};
+        contestant.solver.settings() = settings_of(contestant);
+        return contestant;
+    }
+
+    // FNV-1a hash of the dimensions and the sparsity patterns of P, A and G
+    static void hash_combine(std::uint64_t& hash, std::uint64_t value)
+    {
+        for (int byte = 0; byte < 8; byte++)
+        {
+            hash ^= (value >> (8 * byte)) & 0xff;
+            hash *= 1099511628211ull;
+        }
+    }
+
+    static void hash_matrix(std::uint64_t& hash, const CSparseMatRef<T, I>& M)
+    {
+        hash_combine(hash, std::uint64_t(M.rows()));
+        hash_combine(hash, std::uint64_t(M.cols()));
+        for (isize j = 0; j < M.outerSize(); j++)
+        {
+            for (typename CSparseMatRef<T, I>::InnerIterator it(M, j); it; ++it)
+            {
+                hash_combine(hash, std::uint64_t(it.index()));
+            }
+            hash_combine(hash, std::uint64_t(-1));
+        }
+    }
+
+    static std::uint64_t hash_pattern(const CSparseMatRef<T, I>& P,
+                                      const optional<CSparseMatRef<T, I>>& A,
+                                      const optional<CSparseMatRef<T, I>>& G)
+    {
+        std::uint64_t hash = 14695981039346656037ull;
+        hash_matrix(hash, P);
+        if (A.has_value()) hash_matrix(hash, *A);
+        hash_combine(hash, std::uint64_t(-2));
+        if (G.has_value()) hash_matrix(hash, *G);
+        return hash;
+    }
+};
+
+} // namespace piqp
+
+#endif //PIQP_RACING_SOLVER_HPP
@@ -20,6 +20,9 @@ enum Status
     PIQP_MAX_ITER_REACHED = -1,
     PIQP_PRIMAL_INFEASIBLE = -2,
     PIQP_DUAL_INFEASIBLE = -3,
+    PIQP_CANCELLED = -4,
+    PIQP_TIME_LIMIT_REACHED = -5,
+    PIQP_REAL_TIME_LIMIT_REACHED = -6,
     PIQP_NUMERICS = -8,
     PIQP_UNSOLVED = -9,
     PIQP_INVALID_SETTINGS = -10
@@ -33,6 +36,9 @@ constexpr const char* status_to_string(Status status)
         case Status::PIQP_MAX_ITER_REACHED: return "max iterations reached";
         case Status::PIQP_PRIMAL_INFEASIBLE: return "primal infeasible";
         case Status::PIQP_DUAL_INFEASIBLE: return "dual infeasible";
+        case Status::PIQP_CANCELLED: return "cancelled";
+        case Status::PIQP_TIME_LIMIT_REACHED: return "time limit reached";
+        case Status::PIQP_REAL_TIME_LIMIT_REACHED: return "real-time limit reached";
         case Status::PIQP_NUMERICS: return "numerics issue";
         case Status::PIQP_UNSOLVED: return "unsolved";
         case Status::PIQP_INVALID_SETTINGS: return "invalid settings";
@@ -68,6 +74,15 @@ struct Info
     isize no_primal_update; // dual infeasibility detection counter
     isize no_dual_update;   // primal infeasibility detection counter
 
+    isize kkt_nnz;        // number of non-zeros in the (triangular) KKT matrix
+    isize kkt_factor_nnz; // number of non-zeros in the factor L
+    T kkt_fill_ratio;     // (nnz(L) + dim(KKT)) / nnz(KKT)
+    T factor_flops;       // predicted flops of one numeric factorization
+    T solve_flops;        // predicted flops of one triangular solve
+    isize etree_height;   // height of the elimination tree
+    isize etree_width;    // maximum number of nodes on one level of the elimination tree
+    isize workspace_bytes;
+
     T setup_time;
     T update_time;
     T solve_time;
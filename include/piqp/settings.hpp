@@ -9,6 +9,7 @@
 #ifndef PIQP_SETTINGS_HPP
 #define PIQP_SETTINGS_HPP
 
+#include <algorithm>
 #include <limits>
 #include "piqp/typedefs.hpp"
 
@@ -35,6 +36,13 @@ struct Settings
 
     isize max_iter = 250;
     isize max_factor_retires = 10;
+    T time_limit = std::numeric_limits<T>::infinity(); // wall-clock time limit of solve in seconds
+
+    // real-time mode: stop before an iteration which is predicted to exceed time_limit and return
+    // the best iterate, and cap the factorization retries and iterative refinement steps
+    bool real_time = false;
+    isize real_time_max_factor_retires = 2;
+    isize real_time_iterative_refinement_max_iter = 2;
 
     bool preconditioner_scale_cost = false;
     isize preconditioner_iter = 10;
@@ -52,6 +60,22 @@ struct Settings
     bool verbose = false;
     bool compute_timings = false;
 
+    isize trace_capacity = 0;
+
+    isize n_threads = 1;
+
+    bool dense_ldlt_tuning = true; // use the cached LDL^T tuning of this CPU, see dense::LDLTTuning
+
+    isize factor_retires_limit() const noexcept
+    {
+        return real_time ? std::min(max_factor_retires, real_time_max_factor_retires) : max_factor_retires;
+    }
+
+    isize iterative_refinement_iter_limit() const noexcept
+    {
+        return real_time ? std::min(iterative_refinement_max_iter, real_time_iterative_refinement_max_iter) : iterative_refinement_max_iter;
+    }
+
     bool verify_settings() const noexcept
     {
         return rho_init > 0 &&
@@ -65,6 +89,9 @@ struct Settings
                reg_finetune_dual_update_threshold >= 0 &&
                max_iter > 0 &&
                max_factor_retires > 0 &&
+               time_limit > 0 &&
+               real_time_max_factor_retires >= 0 &&
+               real_time_iterative_refinement_max_iter >= 0 &&
                preconditioner_iter >= 0 &&
                tau > 0 && tau <= 1 &&
                iterative_refinement_eps_abs > 0 &&
@@ -72,7 +99,9 @@ struct Settings
                iterative_refinement_max_iter >= 0 &&
                iterative_refinement_min_improvement_rate >= 1.0 &&
                iterative_refinement_static_regularization_eps > 0 &&
-               iterative_refinement_static_regularization_rel >= 0;
+               iterative_refinement_static_regularization_rel >= 0 &&
+               trace_capacity >= 0 &&
+               n_threads >= 0;
     }
 };
 
@@ -9,13 +9,18 @@
 #ifndef PIQP_SOLVER_HPP
 #define PIQP_SOLVER_HPP
 
+#include <atomic>
 #include <cstdio>
+#include <functional>
+#include <future>
 #include <Eigen/Dense>
 #include <Eigen/Sparse>
 
 #include "piqp/fwd.hpp"
 #include "piqp/common.hpp"
 #include "piqp/timer.hpp"
+#include "piqp/trace.hpp"
+#include "piqp/tracing.hpp"
 #include "piqp/results.hpp"
 #include "piqp/settings.hpp"
 #include "piqp/dense/data.hpp"
@@ -24,7 +29,12 @@
 #include "piqp/sparse/data.hpp"
 #include "piqp/sparse/preconditioner.hpp"
 #include "piqp/sparse/kkt.hpp"
+#include "piqp/sparse/block_kkt.hpp"
+#include "piqp/stagewise/kkt.hpp"
+#include "piqp/stagewise/model.hpp"
+#include "piqp/stagewise/structure.hpp"
 #include "piqp/utils/optional.hpp"
+#include "piqp/utils/memory.hpp"
 
 namespace piqp
 {
@@ -32,7 +42,8 @@ namespace piqp
 enum SolverMatrixType
 {
     PIQP_DENSE = 0,
-    PIQP_SPARSE = 1
+    PIQP_SPARSE = 1,
+    PIQP_STAGEWISE = 2
 };
 
 template<typename Derived, typename T, typename I, typename Preconditioner, int MatrixType, int Mode = KKTMode::KKT_FULL>
@@ -40,7 +51,8 @@ class SolverBase
 {
 protected:
     using DataType = typename std::conditional<MatrixType == PIQP_DENSE, dense::Data<T>, sparse::Data<T, I>>::type;
-    using KKTType = typename std::conditional<MatrixType == PIQP_DENSE, dense::KKT<T>, sparse::KKT<T, I, Mode>>::type;
+    using KKTType = typename std::conditional<MatrixType == PIQP_DENSE, dense::KKT<T>,
+                        typename std::conditional<MatrixType == PIQP_STAGEWISE, stagewise::KKT<T, I>, sparse::BlockKKT<T, I, Mode>>::type>::type;
     using CMatRefType = typename std::conditional<MatrixType == PIQP_DENSE, CMatRef<T>, CSparseMatRef<T, I>>::type;
 
     Timer<T> m_timer;
@@ -53,6 +65,40 @@ protected:
     bool m_kkt_init_state = false;
     bool m_setup_done = false;
     bool m_enable_iterative_refinement = false;
+    bool m_solve_started = false; // between begin_solve() and finish()
+    bool m_solve_running = false; // between begin_solve() and the last step()
+
+    // cancellation request and time limit, checked once per iteration
+    std::atomic<bool> m_cancel_requested{false};
+    Timer<T> m_time_limit_timer;
+
+    // time-limited solves: best iterate so far and, in real-time mode, iteration time prediction
+    T m_rt_last_timestamp = 0;
+    T m_rt_max_iter_time = 0;
+    bool m_rt_best_valid = false;
+    Result<T> m_rt_best;
+
+    // starting point of the next solve passed to warm_start(), unscaled
+    bool m_warm_start_x = false;
+    bool m_warm_start_y = false;
+    bool m_warm_start_z = false;
+    bool m_warm_start_z_lb = false;
+    bool m_warm_start_z_ub = false;
+    Vec<T> m_warm_x;
+    Vec<T> m_warm_y;
+    Vec<T> m_warm_z;
+    Vec<T> m_warm_z_lb;
+    Vec<T> m_warm_z_ub;
+
+    // per-iteration trace
+    Trace<T> m_trace;
+    Timer<T> m_trace_timer;
+    TraceEntry<T> m_trace_step; // accumulates the statistics of the current iteration
+    isize m_solve_count = 0;
+
+#ifdef PIQP_WITH_TRACING
+    std::int64_t m_tracing_id = tracing::next_solver_id();
+#endif
 
     // residuals
     Vec<T> rx;
@@ -90,8 +136,175 @@ public:
 
     const Result<T>& result() const { return m_result; }
 
+    const Trace<T>& trace() const { return m_trace; }
+
+    void clear_trace() { m_trace.clear(); }
+
     Status solve()
     {
+        m_cancel_requested.store(false);
+        return run_solve();
+    }
+
+    // Solves the problem on a separate thread. Until the returned future is ready,
+    // the solver must not be accessed from other threads, except for cancel().
+    std::future<Status> solve_async()
+    {
+        m_cancel_requested.store(false);
+        return std::async(std::launch::async, [this]() { return run_solve(); });
+    }
+
+    // As solve_async(), additionally calls on_done(status) on the solving thread after the solve finished.
+    std::future<Status> solve_async(std::function<void(Status)> on_done)
+    {
+        m_cancel_requested.store(false);
+        return std::async(std::launch::async, [this, on_done]() {
+            Status status = run_solve();
+            on_done(status);
+            return status;
+        });
+    }
+
+    // Requests to stop the running solve, can be called from any thread. The request is
+    // checked once per iteration and the solve returns PIQP_CANCELLED with the current iterate.
+    void cancel() { m_cancel_requested.store(true); }
+
+    // Starts the next solve from the given point instead of the default initial point. The vectors
+    // have the dimensions of the result, and entries of z_lb and z_ub without finite bound are
+    // ignored. Any of them can be nullopt to use the default initialization for it. The slacks are
+    // derived from x, and slacks and inequality duals are moved into the interior. If all vectors
+    // of the problem are given, the factorization for the default initial point is skipped.
+    void warm_start(const optional<CVecRef<T>>& x,
+                    const optional<CVecRef<T>>& y = nullopt,
+                    const optional<CVecRef<T>>& z = nullopt,
+                    const optional<CVecRef<T>>& z_lb = nullopt,
+                    const optional<CVecRef<T>>& z_ub = nullopt)
+    {
+        if (!m_setup_done)
+        {
+            piqp_eprint("Solver not setup yet\n");
+            return;
+        }
+
+        if (x.has_value() && x->rows() != m_data.n) { piqp_eprint("x has wrong dimensions\n"); return; }
+        if (y.has_value() && y->rows() != m_data.p) { piqp_eprint("y has wrong dimensions\n"); return; }
+        if (z.has_value() && z->rows() != m_data.m) { piqp_eprint("z has wrong dimensions\n"); return; }
+        if (z_lb.has_value() && z_lb->rows() != m_data.n) { piqp_eprint("z_lb has wrong dimensions\n"); return; }
+        if (z_ub.has_value() && z_ub->rows() != m_data.n) { piqp_eprint("z_ub has wrong dimensions\n"); return; }
+
+        m_warm_start_x = x.has_value();
+        m_warm_start_y = y.has_value();
+        m_warm_start_z = z.has_value();
+        m_warm_start_z_lb = z_lb.has_value();
+        m_warm_start_z_ub = z_ub.has_value();
+        if (m_warm_start_x) m_warm_x = *x;
+        if (m_warm_start_y) m_warm_y = *y;
+        if (m_warm_start_z) m_warm_z = *z;
+        if (m_warm_start_z_lb) m_warm_z_lb = *z_lb;
+        if (m_warm_start_z_ub) m_warm_z_ub = *z_ub;
+    }
+
+    // Step-wise alternative to solve(), keeping all state in the solver:
+    //
+    //   solver.begin_solve();
+    //   while (solver.step()) { /* other work, or stop early */ }
+    //   solver.finish();
+    //
+    // begin_solve() computes the initial iterate, step() runs one iteration and returns false
+    // once the solve terminated, and finish() makes the result available. If finish() is called
+    // before step() returned false, the current iterate is returned with status PIQP_CANCELLED.
+    void begin_solve()
+    {
+        m_cancel_requested.store(false);
+        start_solve();
+    }
+
+    bool step()
+    {
+        PIQP_TRACE_SOLVER_SCOPE(m_tracing_id);
+
+        if (!m_solve_running) return false;
+
+        if (m_settings.compute_timings)
+        {
+            m_timer.start();
+        }
+
+        m_solve_running = step_impl() == Status::PIQP_UNSOLVED;
+
+        if (m_settings.compute_timings)
+        {
+            m_result.info.solve_time += m_timer.stop();
+        }
+
+        return m_solve_running;
+    }
+
+    Status finish()
+    {
+        PIQP_TRACE_SOLVER_SCOPE(m_tracing_id);
+
+        if (!m_solve_started) return m_result.info.status;
+        m_solve_started = false;
+
+        if (m_settings.compute_timings)
+        {
+            m_timer.start();
+        }
+
+        if (m_solve_running)
+        {
+            m_solve_running = false;
+            m_result.info.status = Status::PIQP_CANCELLED;
+        }
+        Status status = m_result.info.status;
+
+        // the results are only allocated after a successful setup
+        if (m_setup_done)
+        {
+            unscale_results();
+            restore_box_dual();
+        }
+
+        if (m_settings.compute_timings)
+        {
+            m_result.info.solve_time += m_timer.stop();
+            m_result.info.run_time += m_result.info.solve_time;
+        }
+
+        if (m_settings.verbose)
+        {
+            piqp_print("\n");
+            piqp_print("status:               %s\n", status_to_string(status));
+            piqp_print("number of iterations: %zd\n", m_result.info.iter);
+            piqp_print("objective:            %.5e\n", (double) m_result.info.primal_obj);
+            if (m_settings.compute_timings)
+            {
+                piqp_print("total run time:       %.3es\n", (double) m_result.info.run_time);
+                piqp_print("  setup time:         %.3es\n", (double) m_result.info.setup_time);
+                piqp_print("  update time:        %.3es\n", (double) m_result.info.update_time);
+                piqp_print("  solve time:         %.3es\n", (double) m_result.info.solve_time);
+            }
+        }
+
+        return status;
+    }
+
+protected:
+    Status run_solve()
+    {
+        PIQP_TRACE_SOLVER_SCOPE(m_tracing_id);
+        PIQP_TRACE_SCOPE("solve");
+
+        start_solve();
+        while (step()) {}
+        return finish();
+    }
+
+    void start_solve()
+    {
+        PIQP_TRACE_SOLVER_SCOPE(m_tracing_id);
+
         if (m_settings.verbose)
         {
             piqp_print("----------------------------------------------------------\n");
@@ -108,53 +321,35 @@ public:
             }
             else
             {
-                piqp_print("sparse backend\n");
+                piqp_print("%s\n", MatrixType == PIQP_STAGEWISE ? "stagewise backend" : "sparse backend");
                 piqp_print("variables n = %zd, nzz(P upper triangular) = %zd\n", m_data.n, m_data.non_zeros_P_utri());
                 piqp_print("equality constraints p = %zd, nnz(A) = %zd\n", m_data.p, m_data.non_zeros_A());
                 piqp_print("inequality constraints m = %zd, nnz(G) = %zd\n", m_data.m, m_data.non_zeros_G());
             }
             piqp_print("variable lower bounds n_lb = %zd\n", m_data.n_lb);
             piqp_print("variable upper bounds n_ub = %zd\n", m_data.n_ub);
+            piqp_print("nnz(KKT) = %zd, nnz(L) = %zd, fill ratio = %.2f, factor flops = %.2e\n",
+                       m_result.info.kkt_nnz, m_result.info.kkt_factor_nnz,
+                       (double) m_result.info.kkt_fill_ratio, (double) m_result.info.factor_flops);
             piqp_print("\n");
             piqp_print("iter  prim_obj       dual_obj       duality_gap   prim_inf      dual_inf      rho         delta       mu          p_step   d_step\n");
         }
 
         if (m_settings.compute_timings)
         {
+            m_result.info.solve_time = 0;
             m_timer.start();
         }
 
-        Status status = solve_impl();
-
-        unscale_results();
-        restore_box_dual();
+        m_solve_started = true;
+        m_solve_running = begin_solve_impl() == Status::PIQP_UNSOLVED && m_setup_done;
 
         if (m_settings.compute_timings)
         {
-            T solve_time = m_timer.stop();
-            m_result.info.solve_time = solve_time;
-            m_result.info.run_time += solve_time;
+            m_result.info.solve_time += m_timer.stop();
         }
-
-        if (m_settings.verbose)
-        {
-            piqp_print("\n");
-            piqp_print("status:               %s\n", status_to_string(status));
-            piqp_print("number of iterations: %zd\n", m_result.info.iter);
-            piqp_print("objective:            %.5e\n", (double) m_result.info.primal_obj);
-            if (m_settings.compute_timings)
-            {
-                piqp_print("total run time:       %.3es\n", (double) m_result.info.run_time);
-                piqp_print("  setup time:         %.3es\n", (double) m_result.info.setup_time);
-                piqp_print("  update time:        %.3es\n", (double) m_result.info.update_time);
-                piqp_print("  solve time:         %.3es\n", (double) m_result.info.solve_time);
-            }
-        }
-
-        return status;
     }
 
-protected:
     void setup_impl(const CMatRefType& P,
                     const CVecRef<T>& c,
                     const optional<CMatRefType>& A,
@@ -164,6 +359,9 @@ protected:
                     const optional<CVecRef<T>>& x_lb,
                     const optional<CVecRef<T>>& x_ub)
     {
+        PIQP_TRACE_SOLVER_SCOPE(m_tracing_id);
+        PIQP_TRACE_SCOPE("setup");
+
         if (m_settings.compute_timings)
         {
             m_timer.start();
@@ -182,6 +380,13 @@ protected:
         if (x_lb.has_value() && x_lb->size() != m_data.n) { piqp_eprint("x_lb must have correct dimensions\n"); return; }
         if (x_ub.has_value() && x_ub->size() != m_data.n) { piqp_eprint("x_ub must have correct dimensions\n"); return; }
 
+        // a warm start given before might have the dimensions of the previous problem
+        m_warm_start_x = false;
+        m_warm_start_y = false;
+        m_warm_start_z = false;
+        m_warm_start_z_lb = false;
+        m_warm_start_z_ub = false;
+
         m_data.P_utri = P.template triangularView<Eigen::Upper>();
         if (A.has_value()) {
             m_data.AT = A->transpose();
@@ -213,15 +418,22 @@ protected:
 
         init_workspace();
 
-        m_preconditioner.init(m_data);
-        m_preconditioner.scale_data(m_data,
-                                    false,
-                                    m_settings.preconditioner_scale_cost,
-                                    m_settings.preconditioner_iter);
+        {
+            PIQP_TRACE_SCOPE("preconditioner");
+            m_preconditioner.init(m_data);
+            m_preconditioner.scale_data(m_data,
+                                        false,
+                                        m_settings.preconditioner_scale_cost,
+                                        m_settings.preconditioner_iter);
+        }
 
         m_kkt.init(m_result.info.rho, m_result.info.delta);
         m_kkt_init_state = true;
 
+        m_trace.reserve(m_settings.trace_capacity);
+
+        update_factorization_info();
+
         m_setup_done = true;
 
         m_enable_iterative_refinement = m_settings.iterative_refinement_always_enabled;
@@ -234,6 +446,22 @@ protected:
         }
     }
 
+    void update_factorization_info()
+    {
+        m_kkt.update_factorization_info(m_result.info);
+        m_result.info.workspace_bytes += memory_bytes(m_data.P_utri, m_data.AT, m_data.GT,
+                                                      m_data.c, m_data.b, m_data.h,
+                                                      m_data.x_lb_idx, m_data.x_ub_idx,
+                                                      m_data.x_lb_scaling, m_data.x_ub_scaling,
+                                                      m_data.x_lb_n, m_data.x_ub);
+        m_result.info.workspace_bytes += memory_bytes(m_result.x, m_result.y, m_result.z, m_result.z_lb, m_result.z_ub,
+                                                      m_result.s, m_result.s_lb, m_result.s_ub,
+                                                      m_result.zeta, m_result.lambda, m_result.nu, m_result.nu_lb, m_result.nu_ub);
+        m_result.info.workspace_bytes += memory_bytes(rx, ry, rz, rz_lb, rz_ub, rs, rs_lb, rs_ub,
+                                                      rx_nr, ry_nr, rz_nr, rz_lb_nr, rz_ub_nr,
+                                                      dx, dy, dz, dz_lb, dz_ub, ds, ds_lb, ds_ub);
+    }
+
     void setup_lb_data(const optional<CVecRef<T>>& x_lb)
     {
         isize n_lb = 0;
@@ -323,17 +551,23 @@ protected:
         ds.resize(m_data.m);
         ds_lb.resize(m_data.n);
         ds_ub.resize(m_data.n);
+
+        m_rt_best.x.resize(m_data.n);
+        m_rt_best.y.resize(m_data.p);
+        m_rt_best.z.resize(m_data.m);
+        m_rt_best.z_lb.resize(m_data.n);
+        m_rt_best.z_ub.resize(m_data.n);
+        m_rt_best.s.resize(m_data.m);
+        m_rt_best.s_lb.resize(m_data.n);
+        m_rt_best.s_ub.resize(m_data.n);
+        m_rt_best.zeta.resize(m_data.n);
+        m_rt_best.lambda.resize(m_data.p);
+        m_rt_best.nu.resize(m_data.m);
     }
 
-    Status solve_impl()
+    // initializes the iterates, returns PIQP_UNSOLVED if the iterations can start
+    Status begin_solve_impl()
     {
-        auto s_lb = m_result.s_lb.head(m_data.n_lb);
-        auto s_ub = m_result.s_ub.head(m_data.n_ub);
-        auto z_lb = m_result.z_lb.head(m_data.n_lb);
-        auto z_ub = m_result.z_ub.head(m_data.n_ub);
-        auto nu_lb = m_result.nu_lb.head(m_data.n_lb);
-        auto nu_ub = m_result.nu_ub.head(m_data.n_ub);
-
         if (!m_setup_done)
         {
             piqp_eprint("Solver not setup yet\n");
@@ -341,6 +575,15 @@ protected:
             return m_result.info.status;
         }
 
+        m_time_limit_timer.start();
+
+        auto s_lb = m_result.s_lb.head(m_data.n_lb);
+        auto s_ub = m_result.s_ub.head(m_data.n_ub);
+        auto z_lb = m_result.z_lb.head(m_data.n_lb);
+        auto z_ub = m_result.z_ub.head(m_data.n_ub);
+        auto nu_lb = m_result.nu_lb.head(m_data.n_lb);
+        auto nu_ub = m_result.nu_ub.head(m_data.n_ub);
+
         if (!m_settings.verify_settings())
         {
             m_result.info.status = Status::PIQP_INVALID_SETTINGS;
@@ -354,11 +597,37 @@ protected:
         m_result.info.no_primal_update = 0;
         m_result.info.no_dual_update = 0;
         m_result.info.mu = 0;
+        m_result.info.sigma = 0;
         m_result.info.primal_step = 0;
         m_result.info.dual_step = 0;
         m_result.info.rho = m_settings.rho_init;
         m_result.info.delta = m_settings.delta_init;
 
+        m_rt_last_timestamp = 0;
+        m_rt_max_iter_time = 0;
+        m_rt_best_valid = false;
+
+        m_solve_count++;
+        if (m_settings.trace_capacity > 0)
+        {
+            if (m_trace.capacity() != m_settings.trace_capacity)
+            {
+                m_trace.reserve(m_settings.trace_capacity);
+            }
+            reset_trace_step();
+            m_trace_timer.start();
+        }
+
+        // a complete warm start does not need the default initial point
+        if (m_warm_start_x && (m_warm_start_y || m_data.p == 0) && (m_warm_start_z || m_data.m == 0) &&
+            (m_warm_start_z_lb || m_data.n_lb == 0) && (m_warm_start_z_ub || m_data.n_ub == 0))
+        {
+            // the scalings are updated in the first iteration
+            m_kkt_init_state = false;
+            apply_warm_start();
+            return m_result.info.status;
+        }
+
         if (!m_kkt_init_state)
         {
             m_result.s.setConstant(1);
@@ -383,7 +652,7 @@ protected:
             {
                 m_enable_iterative_refinement = true;
             }
-            else if (m_result.info.factor_retires < m_settings.max_factor_retires)
+            else if (m_result.info.factor_retires < m_settings.factor_retires_limit())
             {
                 m_result.info.delta *= 100;
                 m_result.info.rho *= 100;
@@ -396,6 +665,7 @@ protected:
                 return m_result.info.status;
             }
         }
+        trace_factorization();
         m_result.info.factor_retires = 0;
 
         rx = -m_data.c;
@@ -414,6 +684,7 @@ protected:
                     m_result.z, m_result.z_lb, m_result.z_ub,
                     m_result.s, m_result.s_lb, m_result.s_ub,
                     m_enable_iterative_refinement);
+        trace_kkt_solve(m_trace_step.predictor_time);
 
         if (m_data.m + m_data.n_lb + m_data.n_ub > 0)
         {
@@ -456,305 +727,562 @@ protected:
             m_result.info.mu = (m_result.s.dot(m_result.z) + s_lb.dot(z_lb) + s_ub.dot(z_ub) ) / T(m_data.m + m_data.n_lb + m_data.n_ub);
         }
 
+        if (m_warm_start_x || m_warm_start_y || m_warm_start_z || m_warm_start_z_lb || m_warm_start_z_ub)
+        {
+            apply_warm_start();
+            return m_result.info.status;
+        }
+
         m_result.zeta = m_result.x;
         m_result.lambda = m_result.y;
         m_result.nu = m_result.z;
         nu_lb = z_lb;
         nu_ub = z_ub;
 
-        while (m_result.info.iter < m_settings.max_iter)
+        return m_result.info.status;
+    }
+
+    // overwrites the initial iterate with the scaled warm start, which is consumed
+    void apply_warm_start()
+    {
+        auto s_lb = m_result.s_lb.head(m_data.n_lb);
+        auto s_ub = m_result.s_ub.head(m_data.n_ub);
+        auto z_lb = m_result.z_lb.head(m_data.n_lb);
+        auto z_ub = m_result.z_ub.head(m_data.n_ub);
+        auto nu_lb = m_result.nu_lb.head(m_data.n_lb);
+        auto nu_ub = m_result.nu_ub.head(m_data.n_ub);
+
+        // lower limit for the slacks and inequality duals, keeping the iterate away from the boundary
+        const T interior = T(1e-2);
+
+        if (m_warm_start_x)
         {
-            if (m_result.info.iter == 0)
+            m_result.x = m_preconditioner.scale_primal(m_warm_x);
+            m_result.s.noalias() = m_data.h - m_data.GT.transpose() * m_result.x;
+            m_result.s = m_result.s.cwiseMax(interior);
+            for (isize i = 0; i < m_data.n_lb; i++)
+            {
+                s_lb(i) = std::max(m_result.x(m_data.x_lb_idx(i)) + m_data.x_lb_n(i), interior);
+            }
+            for (isize i = 0; i < m_data.n_ub; i++)
             {
-                update_nr_residuals();
+                s_ub(i) = std::max(m_data.x_ub(i) - m_result.x(m_data.x_ub_idx(i)), interior);
             }
+        }
+        if (m_warm_start_y)
+        {
+            m_result.y = m_preconditioner.scale_dual_eq(m_warm_y);
+        }
+        if (m_warm_start_z)
+        {
+            m_result.z = m_preconditioner.scale_dual_ineq(m_warm_z).cwiseMax(interior);
+        }
+        if (m_warm_start_z_lb)
+        {
+            for (isize i = 0; i < m_data.n_lb; i++) z_lb(i) = m_warm_z_lb(m_data.x_lb_idx(i));
+            z_lb = m_preconditioner.scale_dual_lb(z_lb).cwiseMax(interior);
+        }
+        if (m_warm_start_z_ub)
+        {
+            for (isize i = 0; i < m_data.n_ub; i++) z_ub(i) = m_warm_z_ub(m_data.x_ub_idx(i));
+            z_ub = m_preconditioner.scale_dual_ub(z_ub).cwiseMax(interior);
+        }
+
+        if (m_data.m + m_data.n_lb + m_data.n_ub > 0)
+        {
+            m_result.info.mu = (m_result.s.dot(m_result.z) + s_lb.dot(z_lb) + s_ub.dot(z_ub)) / T(m_data.m + m_data.n_lb + m_data.n_ub);
+        }
+
+        m_result.zeta = m_result.x;
+        m_result.lambda = m_result.y;
+        m_result.nu = m_result.z;
+        nu_lb = z_lb;
+        nu_ub = z_ub;
 
-            m_result.info.primal_inf = primal_inf_nr();
-            m_result.info.dual_inf = dual_inf_nr();
+        m_warm_start_x = false;
+        m_warm_start_y = false;
+        m_warm_start_z = false;
+        m_warm_start_z_lb = false;
+        m_warm_start_z_ub = false;
+    }
+
+    // runs one interior point iteration, returns PIQP_UNSOLVED if the solve is not finished yet
+    Status step_impl()
+    {
+        auto s_lb = m_result.s_lb.head(m_data.n_lb);
+        auto s_ub = m_result.s_ub.head(m_data.n_ub);
+        auto z_lb = m_result.z_lb.head(m_data.n_lb);
+        auto z_ub = m_result.z_ub.head(m_data.n_ub);
+        auto nu_lb = m_result.nu_lb.head(m_data.n_lb);
+        auto nu_ub = m_result.nu_ub.head(m_data.n_ub);
+
+        if (m_result.info.iter >= m_settings.max_iter)
+        {
+            m_result.info.status = Status::PIQP_MAX_ITER_REACHED;
+            return m_result.info.status;
+        }
+
+        if (m_result.info.iter == 0)
+        {
+            update_nr_residuals();
+            trace_timestamp(m_trace_step.residual_time);
+        }
+
+        m_result.info.primal_inf = primal_inf_nr();
+        m_result.info.dual_inf = dual_inf_nr();
+
+        if (m_settings.trace_capacity > 0)
+        {
+            record_trace();
+        }
+
+        if (m_settings.verbose)
+        {
+            piqp_print("%3zd   % .5e   % .5e   %.5e   %.5e   %.5e   %.3e   %.3e   %.3e   %.4f   %.4f\n",
+                    m_result.info.iter,
+                    (double) m_result.info.primal_obj,
+                    (double) m_result.info.dual_obj,
+                    (double) m_result.info.duality_gap,
+                    (double) m_result.info.primal_inf,
+                    (double) m_result.info.dual_inf,
+                    (double) m_result.info.rho,
+                    (double) m_result.info.delta,
+                    (double) m_result.info.mu,
+                    (double) m_result.info.primal_step,
+                    (double) m_result.info.dual_step);
+        }
+
+        if (m_result.info.primal_inf < m_settings.eps_abs + m_settings.eps_rel * m_result.info.primal_rel_inf &&
+            m_result.info.dual_inf < m_settings.eps_abs + m_settings.eps_rel * m_result.info.dual_rel_inf &&
+            (!m_settings.check_duality_gap || m_result.info.duality_gap < m_settings.eps_duality_gap_abs + m_settings.eps_duality_gap_rel * m_result.info.duality_gap_rel))
+        {
+            m_result.info.status = Status::PIQP_SOLVED;
+            return m_result.info.status;
+        }
+
+        if (m_cancel_requested.load(std::memory_order_relaxed))
+        {
+            m_result.info.status = Status::PIQP_CANCELLED;
+            return m_result.info.status;
+        }
 
-            if (m_settings.verbose)
+        if (m_settings.time_limit < std::numeric_limits<T>::infinity())
+        {
+            T elapsed = m_time_limit_timer.elapsed();
+            update_best_iterate();
+            if (m_settings.real_time)
             {
-                piqp_print("%3zd   % .5e   % .5e   %.5e   %.5e   %.5e   %.3e   %.3e   %.3e   %.4f   %.4f\n",
-                        m_result.info.iter,
-                        (double) m_result.info.primal_obj,
-                        (double) m_result.info.dual_obj,
-                        (double) m_result.info.duality_gap,
-                        (double) m_result.info.primal_inf,
-                        (double) m_result.info.dual_inf,
-                        (double) m_result.info.rho,
-                        (double) m_result.info.delta,
-                        (double) m_result.info.mu,
-                        (double) m_result.info.primal_step,
-                        (double) m_result.info.dual_step);
-            }
+                // the first duration includes the initialization, which is comparable to an iteration
+                m_rt_max_iter_time = std::max(m_rt_max_iter_time, elapsed - m_rt_last_timestamp);
+                m_rt_last_timestamp = elapsed;
 
-            if (m_result.info.primal_inf < m_settings.eps_abs + m_settings.eps_rel * m_result.info.primal_rel_inf &&
-                m_result.info.dual_inf < m_settings.eps_abs + m_settings.eps_rel * m_result.info.dual_rel_inf &&
-                (!m_settings.check_duality_gap || m_result.info.duality_gap < m_settings.eps_duality_gap_abs + m_settings.eps_duality_gap_rel * m_result.info.duality_gap_rel))
+                if (elapsed + m_rt_max_iter_time > m_settings.time_limit)
+                {
+                    restore_best_iterate();
+                    m_result.info.status = Status::PIQP_REAL_TIME_LIMIT_REACHED;
+                    return m_result.info.status;
+                }
+            }
+            else if (elapsed >= m_settings.time_limit)
             {
-                m_result.info.status = Status::PIQP_SOLVED;
+                restore_best_iterate();
+                m_result.info.status = Status::PIQP_TIME_LIMIT_REACHED;
                 return m_result.info.status;
             }
+        }
+
+        rx = rx_nr - m_result.info.rho * (m_result.x - m_result.zeta);
+        ry = ry_nr - m_result.info.delta * (m_result.lambda - m_result.y);
+        rz = rz_nr - m_result.info.delta * (m_result.nu - m_result.z);
+        rz_lb.head(m_data.n_lb) = rz_lb_nr.head(m_data.n_lb) - m_result.info.delta * (nu_lb.head(m_data.n_lb) - z_lb.head(m_data.n_lb));
+        rz_ub.head(m_data.n_ub) = rz_ub_nr.head(m_data.n_ub) - m_result.info.delta * (nu_ub.head(m_data.n_ub) - z_ub.head(m_data.n_ub));
+
+        if (m_result.info.no_dual_update > std::min(isize(5), m_settings.reg_finetune_dual_update_threshold) &&
+            primal_prox_inf() > 1e12 &&
+            primal_inf_r() < m_settings.eps_abs + m_settings.eps_rel * m_result.info.primal_rel_inf)
+        {
+            m_result.info.status = Status::PIQP_PRIMAL_INFEASIBLE;
+            return m_result.info.status;
+        }
 
-            rx = rx_nr - m_result.info.rho * (m_result.x - m_result.zeta);
-            ry = ry_nr - m_result.info.delta * (m_result.lambda - m_result.y);
-            rz = rz_nr - m_result.info.delta * (m_result.nu - m_result.z);
-            rz_lb.head(m_data.n_lb) = rz_lb_nr.head(m_data.n_lb) - m_result.info.delta * (nu_lb.head(m_data.n_lb) - z_lb.head(m_data.n_lb));
-            rz_ub.head(m_data.n_ub) = rz_ub_nr.head(m_data.n_ub) - m_result.info.delta * (nu_ub.head(m_data.n_ub) - z_ub.head(m_data.n_ub));
+        if (m_result.info.no_primal_update > std::min(isize(5), m_settings.reg_finetune_primal_update_threshold) &&
+            dual_prox_inf() > 1e12 &&
+            dual_inf_r() < m_settings.eps_abs + m_settings.eps_rel * m_result.info.dual_rel_inf)
+        {
+            m_result.info.status = Status::PIQP_DUAL_INFEASIBLE;
+            return m_result.info.status;
+        }
+
+        m_result.info.iter++;
+
+        // avoid possibility of converging to a local minimum -> decrease the minimum regularization value
+        if ((m_result.info.no_primal_update > m_settings.reg_finetune_primal_update_threshold &&
+             m_result.info.rho == m_result.info.reg_limit &&
+             m_result.info.reg_limit != m_settings.reg_finetune_lower_limit) ||
+            (m_result.info.no_dual_update > m_settings.reg_finetune_dual_update_threshold &&
+             m_result.info.delta == m_result.info.reg_limit &&
+             m_result.info.reg_limit != m_settings.reg_finetune_lower_limit))
+        {
+            m_result.info.reg_limit = m_settings.reg_finetune_lower_limit;
+            m_result.info.no_primal_update = 0;
+            m_result.info.no_dual_update = 0;
+        }
 
-            if (m_result.info.no_dual_update > std::min(isize(5), m_settings.reg_finetune_dual_update_threshold) &&
-                primal_prox_inf() > 1e12 &&
-                primal_inf_r() < m_settings.eps_abs + m_settings.eps_rel * m_result.info.primal_rel_inf)
+        m_kkt.update_scalings(m_result.info.rho, m_result.info.delta,
+                              m_result.s, m_result.s_lb, m_result.s_ub,
+                              m_result.z, m_result.z_lb, m_result.z_ub);
+
+        if (!m_kkt.regularize_and_factorize(m_enable_iterative_refinement))
+        {
+            if (!m_enable_iterative_refinement)
             {
-                m_result.info.status = Status::PIQP_PRIMAL_INFEASIBLE;
+                m_enable_iterative_refinement = true;
                 return m_result.info.status;
             }
-
-            if (m_result.info.no_primal_update > std::min(isize(5), m_settings.reg_finetune_primal_update_threshold) &&
-                dual_prox_inf() > 1e12 &&
-                dual_inf_r() < m_settings.eps_abs + m_settings.eps_rel * m_result.info.dual_rel_inf)
+            else if (m_result.info.factor_retires < m_settings.factor_retires_limit())
             {
-                m_result.info.status = Status::PIQP_DUAL_INFEASIBLE;
+                m_result.info.delta *= 100;
+                m_result.info.rho *= 100;
+                m_result.info.iter--;
+                m_result.info.factor_retires++;
+                m_result.info.reg_limit = std::min(10 * m_result.info.reg_limit, m_settings.eps_abs);
+                trace_factorization();
                 return m_result.info.status;
             }
-
-            m_result.info.iter++;
-
-            // avoid possibility of converging to a local minimum -> decrease the minimum regularization value
-            if ((m_result.info.no_primal_update > m_settings.reg_finetune_primal_update_threshold &&
-                 m_result.info.rho == m_result.info.reg_limit &&
-                 m_result.info.reg_limit != m_settings.reg_finetune_lower_limit) ||
-                (m_result.info.no_dual_update > m_settings.reg_finetune_dual_update_threshold &&
-                 m_result.info.delta == m_result.info.reg_limit &&
-                 m_result.info.reg_limit != m_settings.reg_finetune_lower_limit))
+            else
             {
-                m_result.info.reg_limit = m_settings.reg_finetune_lower_limit;
-                m_result.info.no_primal_update = 0;
-                m_result.info.no_dual_update = 0;
+                m_result.info.status = Status::PIQP_NUMERICS;
+                return m_result.info.status;
             }
+        }
+        trace_factorization();
+        m_result.info.factor_retires = 0;
 
-            m_kkt.update_scalings(m_result.info.rho, m_result.info.delta,
-                                  m_result.s, m_result.s_lb, m_result.s_ub,
-                                  m_result.z, m_result.z_lb, m_result.z_ub);
-
-            if (!m_kkt.regularize_and_factorize(m_enable_iterative_refinement))
+        if (m_data.m + m_data.n_lb + m_data.n_ub > 0)
+        {
+            // ------------------ predictor step ------------------
+            rs.array() = -m_result.s.array() * m_result.z.array();
+            rs_lb.head(m_data.n_lb).array() = -s_lb.array() * z_lb.array();
+            rs_ub.head(m_data.n_ub).array() = -s_ub.array() * z_ub.array();
+
+            m_kkt.solve(rx, ry, rz, rz_lb, rz_ub, rs, rs_lb, rs_ub,
+                        dx, dy, dz, dz_lb, dz_ub, ds, ds_lb, ds_ub,
+                        m_enable_iterative_refinement);
+            trace_kkt_solve(m_trace_step.predictor_time);
+
+            // step in the non-negative orthant
+            T alpha_s = T(1);
+            T alpha_z = T(1);
+            for (isize i = 0; i < m_data.m; i++)
             {
-                if (!m_enable_iterative_refinement)
+                if (ds(i) < 0)
                 {
-                    m_enable_iterative_refinement = true;
-                    continue;
+                    alpha_s = std::min(alpha_s, -m_result.s(i) / ds(i));
                 }
-                else if (m_result.info.factor_retires < m_settings.max_factor_retires)
+                if (dz(i) < 0)
                 {
-                    m_result.info.delta *= 100;
-                    m_result.info.rho *= 100;
-                    m_result.info.iter--;
-                    m_result.info.factor_retires++;
-                    m_result.info.reg_limit = std::min(10 * m_result.info.reg_limit, m_settings.eps_abs);
-                    continue;
-                }
-                else
-                {
-                    m_result.info.status = Status::PIQP_NUMERICS;
-                    return m_result.info.status;
+                    alpha_z = std::min(alpha_z, -m_result.z(i) / dz(i));
                 }
             }
-            m_result.info.factor_retires = 0;
-
-            if (m_data.m + m_data.n_lb + m_data.n_ub > 0)
+            for (isize i = 0; i < m_data.n_lb; i++)
             {
-                // ------------------ predictor step ------------------
-                rs.array() = -m_result.s.array() * m_result.z.array();
-                rs_lb.head(m_data.n_lb).array() = -s_lb.array() * z_lb.array();
-                rs_ub.head(m_data.n_ub).array() = -s_ub.array() * z_ub.array();
-
-                m_kkt.solve(rx, ry, rz, rz_lb, rz_ub, rs, rs_lb, rs_ub,
-                            dx, dy, dz, dz_lb, dz_ub, ds, ds_lb, ds_ub,
-                            m_enable_iterative_refinement);
-
-                // step in the non-negative orthant
-                T alpha_s = T(1);
-                T alpha_z = T(1);
-                for (isize i = 0; i < m_data.m; i++)
+                if (ds_lb(i) < 0)
                 {
-                    if (ds(i) < 0)
-                    {
-                        alpha_s = std::min(alpha_s, -m_result.s(i) / ds(i));
-                    }
-                    if (dz(i) < 0)
-                    {
-                        alpha_z = std::min(alpha_z, -m_result.z(i) / dz(i));
-                    }
+                    alpha_s = std::min(alpha_s, -m_result.s_lb(i) / ds_lb(i));
                 }
-                for (isize i = 0; i < m_data.n_lb; i++)
+                if (dz_lb(i) < 0)
                 {
-                    if (ds_lb(i) < 0)
-                    {
-                        alpha_s = std::min(alpha_s, -m_result.s_lb(i) / ds_lb(i));
-                    }
-                    if (dz_lb(i) < 0)
-                    {
-                        alpha_z = std::min(alpha_z, -m_result.z_lb(i) / dz_lb(i));
-                    }
+                    alpha_z = std::min(alpha_z, -m_result.z_lb(i) / dz_lb(i));
                 }
-                for (isize i = 0; i < m_data.n_ub; i++)
+            }
+            for (isize i = 0; i < m_data.n_ub; i++)
+            {
+                if (ds_ub(i) < 0)
                 {
-                    if (ds_ub(i) < 0)
-                    {
-                        alpha_s = std::min(alpha_s, -m_result.s_ub(i) / ds_ub(i));
-                    }
-                    if (dz_ub(i) < 0)
-                    {
-                        alpha_z = std::min(alpha_z, -m_result.z_ub(i) / dz_ub(i));
-                    }
+                    alpha_s = std::min(alpha_s, -m_result.s_ub(i) / ds_ub(i));
                 }
-                // avoid getting to close to the boundary
-                alpha_s *= m_settings.tau;
-                alpha_z *= m_settings.tau;
-
-                m_result.info.sigma = (m_result.s + alpha_s * ds).dot(m_result.z + alpha_z * dz);
-                m_result.info.sigma += (s_lb + alpha_s * ds_lb.head(m_data.n_lb)).dot(z_lb + alpha_z * dz_lb.head(m_data.n_lb));
-                m_result.info.sigma += (s_ub + alpha_s * ds_ub.head(m_data.n_ub)).dot(z_ub + alpha_z * dz_ub.head(m_data.n_ub));
-                m_result.info.sigma /= (m_result.info.mu * T(m_data.m + m_data.n_lb + m_data.n_ub));
-                m_result.info.sigma = std::max(T(0), std::min(T(1), m_result.info.sigma));
-                m_result.info.sigma = m_result.info.sigma * m_result.info.sigma * m_result.info.sigma;
-
-                // ------------------ corrector step ------------------
-                rs.array() += -ds.array() * dz.array() + m_result.info.sigma * m_result.info.mu;
-                rs_lb.head(m_data.n_lb).array() += -ds_lb.head(m_data.n_lb).array() * dz_lb.head(m_data.n_lb).array() + m_result.info.sigma * m_result.info.mu;
-                rs_ub.head(m_data.n_ub).array() += -ds_ub.head(m_data.n_ub).array() * dz_ub.head(m_data.n_ub).array() + m_result.info.sigma * m_result.info.mu;
-
-                m_kkt.solve(rx, ry, rz, rz_lb, rz_ub, rs, rs_lb, rs_ub,
-                            dx, dy, dz, dz_lb, dz_ub, ds, ds_lb, ds_ub,
-                            m_enable_iterative_refinement);
-
-                // step in the non-negative orthant
-                alpha_s = T(1);
-                alpha_z = T(1);
-                for (isize i = 0; i < m_data.m; i++)
+                if (dz_ub(i) < 0)
                 {
-                    if (ds(i) < 0)
-                    {
-                        alpha_s = std::min(alpha_s, -m_result.s(i) / ds(i));
-                    }
-                    if (dz(i) < 0)
-                    {
-                        alpha_z = std::min(alpha_z, -m_result.z(i) / dz(i));
-                    }
+                    alpha_z = std::min(alpha_z, -m_result.z_ub(i) / dz_ub(i));
                 }
-                for (isize i = 0; i < m_data.n_lb; i++)
+            }
+            // avoid getting to close to the boundary
+            alpha_s *= m_settings.tau;
+            alpha_z *= m_settings.tau;
+
+            m_result.info.sigma = (m_result.s + alpha_s * ds).dot(m_result.z + alpha_z * dz);
+            m_result.info.sigma += (s_lb + alpha_s * ds_lb.head(m_data.n_lb)).dot(z_lb + alpha_z * dz_lb.head(m_data.n_lb));
+            m_result.info.sigma += (s_ub + alpha_s * ds_ub.head(m_data.n_ub)).dot(z_ub + alpha_z * dz_ub.head(m_data.n_ub));
+            m_result.info.sigma /= (m_result.info.mu * T(m_data.m + m_data.n_lb + m_data.n_ub));
+            m_result.info.sigma = std::max(T(0), std::min(T(1), m_result.info.sigma));
+            m_result.info.sigma = m_result.info.sigma * m_result.info.sigma * m_result.info.sigma;
+
+            // ------------------ corrector step ------------------
+            rs.array() += -ds.array() * dz.array() + m_result.info.sigma * m_result.info.mu;
+            rs_lb.head(m_data.n_lb).array() += -ds_lb.head(m_data.n_lb).array() * dz_lb.head(m_data.n_lb).array() + m_result.info.sigma * m_result.info.mu;
+            rs_ub.head(m_data.n_ub).array() += -ds_ub.head(m_data.n_ub).array() * dz_ub.head(m_data.n_ub).array() + m_result.info.sigma * m_result.info.mu;
+
+            m_kkt.solve(rx, ry, rz, rz_lb, rz_ub, rs, rs_lb, rs_ub,
+                        dx, dy, dz, dz_lb, dz_ub, ds, ds_lb, ds_ub,
+                        m_enable_iterative_refinement);
+            trace_kkt_solve(m_trace_step.corrector_time);
+
+            // step in the non-negative orthant
+            alpha_s = T(1);
+            alpha_z = T(1);
+            for (isize i = 0; i < m_data.m; i++)
+            {
+                if (ds(i) < 0)
                 {
-                    if (ds_lb(i) < 0)
-                    {
-                        alpha_s = std::min(alpha_s, -m_result.s_lb(i) / ds_lb(i));
-                    }
-                    if (dz_lb(i) < 0)
-                    {
-                        alpha_z = std::min(alpha_z, -m_result.z_lb(i) / dz_lb(i));
-                    }
+                    alpha_s = std::min(alpha_s, -m_result.s(i) / ds(i));
                 }
-                for (isize i = 0; i < m_data.n_ub; i++)
+                if (dz(i) < 0)
                 {
-                    if (ds_ub(i) < 0)
-                    {
-                        alpha_s = std::min(alpha_s, -m_result.s_ub(i) / ds_ub(i));
-                    }
-                    if (dz_ub(i) < 0)
-                    {
-                        alpha_z = std::min(alpha_z, -m_result.z_ub(i) / dz_ub(i));
-                    }
+                    alpha_z = std::min(alpha_z, -m_result.z(i) / dz(i));
                 }
-                // avoid getting to close to the boundary
-                m_result.info.primal_step = alpha_s * m_settings.tau;
-                m_result.info.dual_step = alpha_z * m_settings.tau;
-
-                // ------------------ update ------------------
-                m_result.x += m_result.info.primal_step * dx;
-                m_result.y += m_result.info.dual_step * dy;
-                m_result.z += m_result.info.dual_step * dz;
-                z_lb += m_result.info.dual_step * dz_lb.head(m_data.n_lb);
-                z_ub += m_result.info.dual_step * dz_ub.head(m_data.n_ub);
-                m_result.s += m_result.info.primal_step * ds;
-                s_lb += m_result.info.primal_step * ds_lb.head(m_data.n_lb);
-                s_ub += m_result.info.primal_step * ds_ub.head(m_data.n_ub);
-
-                T mu_prev = m_result.info.mu;
-                m_result.info.mu = (m_result.s.dot(m_result.z) + s_lb.dot(z_lb) + s_ub.dot(z_ub) ) / T(m_data.m + m_data.n_lb + m_data.n_ub);
-                T mu_rate = std::max(T(0), (mu_prev - m_result.info.mu) / mu_prev);
-
-                // ------------------ update regularization ------------------
-                update_nr_residuals();
-
-                if (dual_inf_nr() < 0.95 * m_result.info.dual_inf || (m_result.info.rho == m_settings.reg_finetune_lower_limit && dual_prox_inf() < 1e2))
+            }
+            for (isize i = 0; i < m_data.n_lb; i++)
+            {
+                if (ds_lb(i) < 0)
                 {
-                    m_result.zeta = m_result.x;
-                    m_result.info.rho = std::max(m_result.info.reg_limit, (T(1) - mu_rate) * m_result.info.rho);
+                    alpha_s = std::min(alpha_s, -m_result.s_lb(i) / ds_lb(i));
                 }
-                else
+                if (dz_lb(i) < 0)
                 {
-                    m_result.info.no_primal_update++;
-                    m_result.info.rho = std::max(m_result.info.reg_limit, (T(1) - T(0.666) * mu_rate) * m_result.info.rho);
+                    alpha_z = std::min(alpha_z, -m_result.z_lb(i) / dz_lb(i));
                 }
-
-                if (primal_inf_nr() < 0.95 * m_result.info.primal_inf || (m_result.info.delta == m_settings.reg_finetune_lower_limit && primal_prox_inf() < 1e2))
+            }
+            for (isize i = 0; i < m_data.n_ub; i++)
+            {
+                if (ds_ub(i) < 0)
                 {
-                    m_result.lambda = m_result.y;
-                    m_result.nu = m_result.z;
-                    nu_lb = z_lb;
-                    nu_ub = z_ub;
-                    m_result.info.delta = std::max(m_result.info.reg_limit, (T(1) - mu_rate) * m_result.info.delta);
+                    alpha_s = std::min(alpha_s, -m_result.s_ub(i) / ds_ub(i));
                 }
-                else
+                if (dz_ub(i) < 0)
                 {
-                    m_result.info.no_dual_update++;
-                    m_result.info.delta = std::max(m_result.info.reg_limit, (T(1) - T(0.666) * mu_rate) * m_result.info.delta);
+                    alpha_z = std::min(alpha_z, -m_result.z_ub(i) / dz_ub(i));
                 }
             }
-            else
-            {
-                // since there are no inequalities we can take full steps
-                m_kkt.solve(rx, ry, rz, rz_lb, rz_ub, rs, rs_lb, rs_ub,
-                            dx, dy, dz, dz_lb, dz_ub, ds, ds_lb, ds_ub,
-                            m_enable_iterative_refinement);
+            // avoid getting to close to the boundary
+            m_result.info.primal_step = alpha_s * m_settings.tau;
+            m_result.info.dual_step = alpha_z * m_settings.tau;
+
+            // ------------------ update ------------------
+            m_result.x += m_result.info.primal_step * dx;
+            m_result.y += m_result.info.dual_step * dy;
+            m_result.z += m_result.info.dual_step * dz;
+            z_lb += m_result.info.dual_step * dz_lb.head(m_data.n_lb);
+            z_ub += m_result.info.dual_step * dz_ub.head(m_data.n_ub);
+            m_result.s += m_result.info.primal_step * ds;
+            s_lb += m_result.info.primal_step * ds_lb.head(m_data.n_lb);
+            s_ub += m_result.info.primal_step * ds_ub.head(m_data.n_ub);
+
+            T mu_prev = m_result.info.mu;
+            m_result.info.mu = (m_result.s.dot(m_result.z) + s_lb.dot(z_lb) + s_ub.dot(z_ub) ) / T(m_data.m + m_data.n_lb + m_data.n_ub);
+            T mu_rate = std::max(T(0), (mu_prev - m_result.info.mu) / mu_prev);
 
-                m_result.info.primal_step = T(1);
-                m_result.info.dual_step = T(1);
-                m_result.x += m_result.info.primal_step * dx;
-                m_result.y += m_result.info.dual_step * dy;
+            // ------------------ update regularization ------------------
+            update_nr_residuals();
+            trace_timestamp(m_trace_step.residual_time);
 
-                // ------------------ update regularization ------------------
-                update_nr_residuals();
+            if (dual_inf_nr() < 0.95 * m_result.info.dual_inf || (m_result.info.rho == m_settings.reg_finetune_lower_limit && dual_prox_inf() < 1e2))
+            {
+                m_result.zeta = m_result.x;
+                m_result.info.rho = std::max(m_result.info.reg_limit, (T(1) - mu_rate) * m_result.info.rho);
+            }
+            else
+            {
+                m_result.info.no_primal_update++;
+                m_result.info.rho = std::max(m_result.info.reg_limit, (T(1) - T(0.666) * mu_rate) * m_result.info.rho);
+            }
 
-                if (dual_inf_nr() < 0.95 * m_result.info.dual_inf)
-                {
-                    m_result.zeta = m_result.x;
-                    m_result.info.rho = std::max(m_result.info.reg_limit, T(0.1) * m_result.info.rho);
-                }
-                else
-                {
-                    m_result.info.no_primal_update++;
-                    m_result.info.rho = std::max(m_result.info.reg_limit, T(0.5) * m_result.info.rho);
-                }
+            if (primal_inf_nr() < 0.95 * m_result.info.primal_inf || (m_result.info.delta == m_settings.reg_finetune_lower_limit && primal_prox_inf() < 1e2))
+            {
+                m_result.lambda = m_result.y;
+                m_result.nu = m_result.z;
+                nu_lb = z_lb;
+                nu_ub = z_ub;
+                m_result.info.delta = std::max(m_result.info.reg_limit, (T(1) - mu_rate) * m_result.info.delta);
+            }
+            else
+            {
+                m_result.info.no_dual_update++;
+                m_result.info.delta = std::max(m_result.info.reg_limit, (T(1) - T(0.666) * mu_rate) * m_result.info.delta);
+            }
+        }
+        else
+        {
+            // since there are no inequalities we can take full steps
+            m_kkt.solve(rx, ry, rz, rz_lb, rz_ub, rs, rs_lb, rs_ub,
+                        dx, dy, dz, dz_lb, dz_ub, ds, ds_lb, ds_ub,
+                        m_enable_iterative_refinement);
+            trace_kkt_solve(m_trace_step.predictor_time);
+
+            m_result.info.primal_step = T(1);
+            m_result.info.dual_step = T(1);
+            m_result.x += m_result.info.primal_step * dx;
+            m_result.y += m_result.info.dual_step * dy;
+
+            // ------------------ update regularization ------------------
+            update_nr_residuals();
+            trace_timestamp(m_trace_step.residual_time);
+
+            if (dual_inf_nr() < 0.95 * m_result.info.dual_inf)
+            {
+                m_result.zeta = m_result.x;
+                m_result.info.rho = std::max(m_result.info.reg_limit, T(0.1) * m_result.info.rho);
+            }
+            else
+            {
+                m_result.info.no_primal_update++;
+                m_result.info.rho = std::max(m_result.info.reg_limit, T(0.5) * m_result.info.rho);
+            }
 
-                if (primal_inf_nr() < 0.95 * m_result.info.primal_inf)
-                {
-                    m_result.lambda = m_result.y;
-                    m_result.info.delta = std::max(m_result.info.reg_limit, T(0.1) * m_result.info.delta);
-                }
-                else
-                {
-                    m_result.info.no_dual_update++;
-                    m_result.info.delta = std::max(m_result.info.reg_limit, T(0.5) * m_result.info.delta);
-                }
+            if (primal_inf_nr() < 0.95 * m_result.info.primal_inf)
+            {
+                m_result.lambda = m_result.y;
+                m_result.info.delta = std::max(m_result.info.reg_limit, T(0.1) * m_result.info.delta);
+            }
+            else
+            {
+                m_result.info.no_dual_update++;
+                m_result.info.delta = std::max(m_result.info.reg_limit, T(0.5) * m_result.info.delta);
             }
         }
 
-        m_result.info.status = Status::PIQP_MAX_ITER_REACHED;
         return m_result.info.status;
     }
 
+    bool primal_feasible(T primal_inf, T primal_rel_inf) const
+    {
+        return primal_inf < m_settings.eps_abs + m_settings.eps_rel * primal_rel_inf;
+    }
+
+    // The best iterate is the one with the smallest primal infeasibility, or,
+    // once an iterate is primal feasible, the feasible one with the smallest dual infeasibility.
+    void update_best_iterate()
+    {
+        if (m_rt_best_valid)
+        {
+            bool best_feasible = primal_feasible(m_rt_best.info.primal_inf, m_rt_best.info.primal_rel_inf);
+            bool feasible = primal_feasible(m_result.info.primal_inf, m_result.info.primal_rel_inf);
+            bool better = best_feasible ? (feasible && m_result.info.dual_inf < m_rt_best.info.dual_inf)
+                                        : (feasible || m_result.info.primal_inf < m_rt_best.info.primal_inf);
+            if (!better) return;
+        }
+
+        m_rt_best_valid = true;
+        m_rt_best.x = m_result.x;
+        m_rt_best.y = m_result.y;
+        m_rt_best.z = m_result.z;
+        m_rt_best.z_lb.head(m_data.n_lb) = m_result.z_lb.head(m_data.n_lb);
+        m_rt_best.z_ub.head(m_data.n_ub) = m_result.z_ub.head(m_data.n_ub);
+        m_rt_best.s = m_result.s;
+        m_rt_best.s_lb.head(m_data.n_lb) = m_result.s_lb.head(m_data.n_lb);
+        m_rt_best.s_ub.head(m_data.n_ub) = m_result.s_ub.head(m_data.n_ub);
+        m_rt_best.zeta = m_result.zeta;
+        m_rt_best.lambda = m_result.lambda;
+        m_rt_best.nu = m_result.nu;
+        m_rt_best.info.primal_inf = m_result.info.primal_inf;
+        m_rt_best.info.primal_rel_inf = m_result.info.primal_rel_inf;
+        m_rt_best.info.dual_inf = m_result.info.dual_inf;
+        m_rt_best.info.dual_rel_inf = m_result.info.dual_rel_inf;
+        m_rt_best.info.primal_obj = m_result.info.primal_obj;
+        m_rt_best.info.dual_obj = m_result.info.dual_obj;
+        m_rt_best.info.duality_gap = m_result.info.duality_gap;
+        m_rt_best.info.duality_gap_rel = m_result.info.duality_gap_rel;
+    }
+
+    void restore_best_iterate()
+    {
+        if (!m_rt_best_valid) return;
+
+        m_result.x = m_rt_best.x;
+        m_result.y = m_rt_best.y;
+        m_result.z = m_rt_best.z;
+        m_result.z_lb.head(m_data.n_lb) = m_rt_best.z_lb.head(m_data.n_lb);
+        m_result.z_ub.head(m_data.n_ub) = m_rt_best.z_ub.head(m_data.n_ub);
+        m_result.s = m_rt_best.s;
+        m_result.s_lb.head(m_data.n_lb) = m_rt_best.s_lb.head(m_data.n_lb);
+        m_result.s_ub.head(m_data.n_ub) = m_rt_best.s_ub.head(m_data.n_ub);
+        m_result.zeta = m_rt_best.zeta;
+        m_result.lambda = m_rt_best.lambda;
+        m_result.nu = m_rt_best.nu;
+        m_result.info.primal_inf = m_rt_best.info.primal_inf;
+        m_result.info.primal_rel_inf = m_rt_best.info.primal_rel_inf;
+        m_result.info.dual_inf = m_rt_best.info.dual_inf;
+        m_result.info.dual_rel_inf = m_rt_best.info.dual_rel_inf;
+        m_result.info.primal_obj = m_rt_best.info.primal_obj;
+        m_result.info.dual_obj = m_rt_best.info.dual_obj;
+        m_result.info.duality_gap = m_rt_best.info.duality_gap;
+        m_result.info.duality_gap_rel = m_rt_best.info.duality_gap_rel;
+    }
+
+    void reset_trace_step()
+    {
+        m_trace_step.refine_iter = 0;
+        m_trace_step.factor_retires = 0;
+        m_trace_step.factor_time = std::numeric_limits<T>::quiet_NaN();
+        m_trace_step.predictor_time = std::numeric_limits<T>::quiet_NaN();
+        m_trace_step.corrector_time = std::numeric_limits<T>::quiet_NaN();
+        m_trace_step.residual_time = std::numeric_limits<T>::quiet_NaN();
+    }
+
+    void trace_timestamp(T& stamp)
+    {
+        if (m_settings.trace_capacity > 0)
+        {
+            stamp = m_trace_timer.elapsed();
+        }
+    }
+
+    void trace_factorization()
+    {
+        if (m_settings.trace_capacity > 0)
+        {
+            m_trace_step.factor_retires = m_result.info.factor_retires;
+            m_trace_step.factor_time = m_trace_timer.elapsed();
+        }
+    }
+
+    void trace_kkt_solve(T& stamp)
+    {
+        if (m_settings.trace_capacity > 0)
+        {
+            m_trace_step.refine_iter += m_kkt.m_refine_iter;
+            stamp = m_trace_timer.elapsed();
+        }
+    }
+
+    void record_trace()
+    {
+        TraceEntry<T>& entry = m_trace.push();
+        entry.solve = m_solve_count;
+        entry.iter = m_result.info.iter;
+        entry.primal_obj = m_result.info.primal_obj;
+        entry.dual_obj = m_result.info.dual_obj;
+        entry.duality_gap = m_result.info.duality_gap;
+        entry.primal_inf = m_result.info.primal_inf;
+        entry.dual_inf = m_result.info.dual_inf;
+        entry.rho = m_result.info.rho;
+        entry.delta = m_result.info.delta;
+        entry.mu = m_result.info.mu;
+        entry.sigma = m_result.info.sigma;
+        entry.primal_step = m_result.info.primal_step;
+        entry.dual_step = m_result.info.dual_step;
+        entry.refine_iter = m_trace_step.refine_iter;
+        entry.factor_retires = m_trace_step.factor_retires;
+        entry.factor_time = m_trace_step.factor_time;
+        entry.predictor_time = m_trace_step.predictor_time;
+        entry.corrector_time = m_trace_step.corrector_time;
+        entry.residual_time = m_trace_step.residual_time;
+        reset_trace_step();
+    }
+
     void update_nr_residuals()
     {
+        PIQP_TRACE_SCOPE("update_nr_residuals");
+
         using std::abs;
 
         // first part of dual residual and infeasibility calculation (used in cost calculation)
@@ -944,6 +1472,9 @@ public:
                 const optional<CVecRef<T>>& x_ub = nullopt,
                 bool reuse_preconditioner = true)
     {
+        PIQP_TRACE_SOLVER_SCOPE(this->m_tracing_id);
+        PIQP_TRACE_SCOPE("update");
+
         if (!this->m_setup_done)
         {
             piqp_eprint("Solver not setup yet\n");
@@ -1012,6 +1543,8 @@ public:
                                           this->m_settings.preconditioner_iter);
 
         this->m_kkt.update_data(update_options);
+        // the formulation might have changed with P
+        this->m_kkt.update_factorization_info(this->m_result.info);
 
         if (this->m_settings.compute_timings)
         {
@@ -1020,24 +1553,23 @@ public:
             this->m_result.info.run_time += update_time;
         }
     }
-};
 
-template<typename T, typename I = int, int Mode = KKTMode::KKT_FULL, typename Preconditioner = sparse::RuizEquilibration<T, I>>
-class SparseSolver : public SolverBase<SparseSolver<T, I, Mode, Preconditioner>, T, I, Preconditioner, PIQP_SPARSE, Mode>
-{
-public:
-    void setup(const CSparseMatRef<T, I>& P,
-               const CVecRef<T>& c,
-               const optional<CSparseMatRef<T, I>>& A = nullopt,
-               const optional<CVecRef<T>>& b = nullopt,
-               const optional<CSparseMatRef<T, I>>& G = nullopt,
-               const optional<CVecRef<T>>& h = nullopt,
-               const optional<CVecRef<T>>& x_lb = nullopt,
-               const optional<CVecRef<T>>& x_ub = nullopt)
+    // Selects the formulation of the reduced KKT system, has to be called before setup.
+    // DENSE_KKT_SCHUR falls back to DENSE_KKT_REDUCED if P is not diagonal and positive.
+    void set_kkt_formulation(DenseKKTFormulation formulation)
     {
-        this->setup_impl(P, c, A, b, G, h, x_lb, x_ub);
+        this->m_kkt.requested_formulation = formulation;
     }
 
+    // formulation chosen in setup, DENSE_KKT_REDUCED or DENSE_KKT_SCHUR
+    DenseKKTFormulation kkt_formulation() const { return this->m_kkt.formulation; }
+};
+
+// common base of the solvers operating on sparse problem data
+template<typename Derived, typename T, typename I, typename Preconditioner, int MatrixType, int Mode>
+class SparseSolverBase : public SolverBase<Derived, T, I, Preconditioner, MatrixType, Mode>
+{
+public:
     void update(const optional<CSparseMatRef<T, I>>& P = nullopt,
                 const optional<CVecRef<T>>& c = nullopt,
                 const optional<CSparseMatRef<T, I>>& A = nullopt,
@@ -1048,6 +1580,9 @@ public:
                 const optional<CVecRef<T>>& x_ub = nullopt,
                 bool reuse_preconditioner = true)
     {
+        PIQP_TRACE_SOLVER_SCOPE(this->m_tracing_id);
+        PIQP_TRACE_SCOPE("update");
+
         if (!this->m_setup_done)
         {
             piqp_eprint("Solver not setup yet\n");
@@ -1135,6 +1670,105 @@ public:
     }
 };
 
+template<typename T, typename I = int, int Mode = KKTMode::KKT_FULL, typename Preconditioner = sparse::RuizEquilibration<T, I>>
+class SparseSolver : public SparseSolverBase<SparseSolver<T, I, Mode, Preconditioner>, T, I, Preconditioner, PIQP_SPARSE, Mode>
+{
+public:
+    void setup(const CSparseMatRef<T, I>& P,
+               const CVecRef<T>& c,
+               const optional<CSparseMatRef<T, I>>& A = nullopt,
+               const optional<CVecRef<T>>& b = nullopt,
+               const optional<CSparseMatRef<T, I>>& G = nullopt,
+               const optional<CVecRef<T>>& h = nullopt,
+               const optional<CVecRef<T>>& x_lb = nullopt,
+               const optional<CVecRef<T>>& x_ub = nullopt)
+    {
+        this->setup_impl(P, c, A, b, G, h, x_lb, x_ub);
+    }
+};
+
+// Solver for problems with stagewise structure, e.g., optimal control problems, whose
+// variables are ordered by stage and where P and every constraint row only couple
+// variables of consecutive stages. The KKT matrix is then block tridiagonal and is
+// factorized by block elimination or, in parallel, by block cyclic reduction with dense blocks.
+template<typename T, typename I = int, typename Preconditioner = sparse::RuizEquilibration<T, I>>
+class StagewiseSolver : public SparseSolverBase<StagewiseSolver<T, I, Preconditioner>, T, I, Preconditioner, PIQP_STAGEWISE, KKTMode::KKT_FULL>
+{
+    using Base = SparseSolverBase<StagewiseSolver<T, I, Preconditioner>, T, I, Preconditioner, PIQP_STAGEWISE, KKTMode::KKT_FULL>;
+
+public:
+
+    // stage_dims holds the number of variables of every stage
+    void setup(const std::vector<isize>& stage_dims,
+               const CSparseMatRef<T, I>& P,
+               const CVecRef<T>& c,
+               const optional<CSparseMatRef<T, I>>& A = nullopt,
+               const optional<CVecRef<T>>& b = nullopt,
+               const optional<CSparseMatRef<T, I>>& G = nullopt,
+               const optional<CVecRef<T>>& h = nullopt,
+               const optional<CVecRef<T>>& x_lb = nullopt,
+               const optional<CVecRef<T>>& x_ub = nullopt)
+    {
+        if (!stagewise::check_structure<T, I>(stage_dims, P, A, G)) return;
+
+        this->m_kkt.stage_dims = stage_dims;
+        this->setup_impl(P, c, A, b, G, h, x_lb, x_ub);
+    }
+
+    void setup(const stagewise::Model<T, I>& model)
+    {
+        setup(model.stage_dims, model.qp.P, model.qp.c, model.qp.A, model.qp.b, model.qp.G, model.qp.h, model.qp.x_lb, model.qp.x_ub);
+    }
+
+    // The constraint rows are assigned to stages in setup, hence the rows of A and G
+    // can only involve the same stages as in setup.
+    void update(const optional<CSparseMatRef<T, I>>& P = nullopt,
+                const optional<CVecRef<T>>& c = nullopt,
+                const optional<CSparseMatRef<T, I>>& A = nullopt,
+                const optional<CVecRef<T>>& b = nullopt,
+                const optional<CSparseMatRef<T, I>>& G = nullopt,
+                const optional<CVecRef<T>>& h = nullopt,
+                const optional<CVecRef<T>>& x_lb = nullopt,
+                const optional<CVecRef<T>>& x_ub = nullopt,
+                bool reuse_preconditioner = true)
+    {
+        if (this->m_setup_done)
+        {
+            if (A.has_value())
+            {
+                if (A->rows() != this->m_data.p || A->cols() != this->m_data.n) { piqp_eprint("A has wrong dimensions\n"); return; }
+                if (!this->m_kkt.rows_fit_stages(*A, this->m_kkt.A_row_stage)) { piqp_eprint("A has rows involving other stages than in setup\n"); return; }
+            }
+            if (G.has_value())
+            {
+                if (G->rows() != this->m_data.m || G->cols() != this->m_data.n) { piqp_eprint("G has wrong dimensions\n"); return; }
+                if (!this->m_kkt.rows_fit_stages(*G, this->m_kkt.G_row_stage)) { piqp_eprint("G has rows involving other stages than in setup\n"); return; }
+            }
+        }
+
+        Base::update(P, c, A, b, G, h, x_lb, x_ub, reuse_preconditioner);
+    }
+
+    // the stages of the model have to have the same dimensions as in setup
+    void update(const stagewise::Model<T, I>& model, bool reuse_preconditioner = true)
+    {
+        if (model.stage_dims != this->m_kkt.stage_dims) { piqp_eprint("stage dimensions missmatch\n"); return; }
+        update(model.qp.P, model.qp.c, model.qp.A, model.qp.b, model.qp.G, model.qp.h, model.qp.x_lb, model.qp.x_ub, reuse_preconditioner);
+    }
+
+    const std::vector<isize>& stage_dims() const { return this->m_kkt.stage_dims; }
+
+    // Selects the factorization of the block tridiagonal KKT matrix, has to be called before setup.
+    // STAGEWISE_KKT_CYCLIC_REDUCTION is parallelized over the stages with settings.n_threads threads.
+    void set_kkt_factorization(StagewiseKKTFactorization factorization)
+    {
+        this->m_kkt.requested_factorization = factorization;
+    }
+
+    // factorization chosen in setup, STAGEWISE_KKT_SEQUENTIAL or STAGEWISE_KKT_CYCLIC_REDUCTION
+    StagewiseKKTFactorization kkt_factorization() const { return this->m_kkt.factorization; }
+};
+
 } // namespace piqp
 
 #ifdef PIQP_WITH_TEMPLATE_INSTANTIATION
@@ -0,0 +1,501 @@
+// This file is part of PIQP.
+//
+// Copyright (c) 2024 EPFL
+//
+// This source code is licensed under the BSD 2-Clause License found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef PIQP_SPARSE_BLOCK_KKT_HPP
+#define PIQP_SPARSE_BLOCK_KKT_HPP
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+
+#include "piqp/settings.hpp"
+#include "piqp/results.hpp"
+#include "piqp/kkt_fwd.hpp"
+#include "piqp/tracing.hpp"
+#include "piqp/utils/memory.hpp"
+#include "piqp/utils/thread_pool.hpp"
+#include "piqp/sparse/data.hpp"
+#include "piqp/sparse/kkt.hpp"
+#include "piqp/sparse/utils.hpp"
+
+namespace piqp
+{
+
+namespace sparse
+{
+
+// KKT system of a problem which might consist of independent subproblems, i.e., whose
+// variable-constraint graph has several connected components. If more than one thread is
+// configured, the components are distributed over up to settings.n_threads blocks of
+// roughly equal size, and every block gets its own data, KKT matrix and LDL^T factorization,
+// which are updated, factorized and solved in parallel. Otherwise, or if the problem is
+// connected, the KKT system of the whole problem is used directly.
+template<typename T, typename I, int Mode = KKTMode::KKT_FULL, typename Ordering = AMDOrdering<I>>
+struct BlockKKT
+{
+    const Data<T, I>& data;
+    const Settings<T>& settings;
+
+    isize m_refine_iter = 0; // maximum number of iterative refinement steps of the blocks in last solve
+
+    struct Block
+    {
+        Data<T, I> data;
+        KKT<T, I, Mode, Ordering> kkt;
+
+        // global indices of the variables, equality and inequality rows of the block
+        Vec<isize> var_idx;
+        Vec<isize> eq_idx;
+        Vec<isize> ineq_idx;
+        // global indices of the finite bounds of the block, only the first data.n_lb/n_ub are valid
+        Vec<isize> lb_idx;
+        Vec<isize> ub_idx;
+        // global positions of the non-zeros of P_utri, AT and GT
+        Vec<isize> P_nz;
+        Vec<isize> AT_nz;
+        Vec<isize> GT_nz;
+
+        // block parts of the right hand sides and scalings, and of the solution
+        Vec<T> in_x, in_y, in_z, in_z_lb, in_z_ub, in_s, in_s_lb, in_s_ub;
+        Vec<T> out_x, out_y, out_z, out_z_lb, out_z_ub, out_s, out_s_lb, out_s_ub;
+
+        explicit Block(const Settings<T>& settings) : kkt(data, settings) {}
+    };
+
+    KKT<T, I, Mode, Ordering> full_kkt;  // used if the problem is not decomposed
+    std::vector<std::unique_ptr<Block>> blocks;
+    Vec<isize> var_block;  // block of every variable
+    Vec<isize> var_local;  // index of every variable in its block
+    std::unique_ptr<ThreadPool> thread_pool; // only allocated if the problem is decomposed
+
+    BlockKKT(const Data<T, I>& data, const Settings<T>& settings) : data(data), settings(settings), full_kkt(data, settings) {}
+
+    ~BlockKKT() {};
+
+    isize n_blocks() const { return isize(blocks.size()); }
+
+    void init(const T& rho, const T& delta)
+    {
+        PIQP_TRACE_SCOPE("kkt_init");
+
+        blocks.clear();
+        isize n_threads = settings.n_threads > 0 ? settings.n_threads : ThreadPool::hardware_threads();
+        Vec<isize> component;
+        isize n_components = data.n > 0 ? connected_components(data.P_utri, data.AT, data.GT, component) : 0;
+        if (n_threads <= 1 || n_components <= 1)
+        {
+            thread_pool.reset();
+            var_block.resize(0);
+            var_local.resize(0);
+            full_kkt.init(rho, delta);
+            return;
+        }
+
+        partition(component, n_components, std::min(n_threads, n_components));
+        update_thread_pool();
+
+        for_each_block([&](Block& block) { block.kkt.init(rho, delta); });
+    }
+
+    // assigns the components to blocks and extracts the data of every block
+    void partition(const Vec<isize>& component, isize n_components, isize n_blocks)
+    {
+        // work estimate of every component, i.e., number of rows and non-zeros of its part of the KKT matrix
+        Vec<isize> weight = Vec<isize>::Zero(n_components);
+        for (isize j = 0; j < data.n; j++)
+        {
+            weight(component(j)) += 1 + (data.P_utri.outerIndexPtr()[j + 1] - data.P_utri.outerIndexPtr()[j]);
+        }
+        for (const SparseMat<T, I>* CT : {&data.AT, &data.GT})
+        {
+            for (isize r = 0; r < CT->outerSize(); r++)
+            {
+                isize begin = CT->outerIndexPtr()[r];
+                isize nnz = CT->outerIndexPtr()[r + 1] - begin;
+                weight(nnz > 0 ? component(CT->innerIndexPtr()[begin]) : 0) += 1 + nnz;
+            }
+        }
+
+        // greedy assignment of the largest remaining component to the smallest block
+        std::vector<isize> order(static_cast<std::size_t>(n_components));
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](isize a, isize b) { return weight(a) > weight(b); });
+        Vec<isize> component_block(n_components);
+        Vec<isize> block_weight = Vec<isize>::Zero(n_blocks);
+        for (isize c : order)
+        {
+            isize b;
+            block_weight.minCoeff(&b);
+            component_block(c) = b;
+            block_weight(b) += weight(c);
+        }
+
+        blocks.resize(std::size_t(n_blocks));
+        for (auto& block : blocks) block.reset(new Block(settings));
+
+        // variables and rows are numbered in increasing order within their block,
+        // hence the extracted matrices have sorted inner indices
+        var_block.resize(data.n);
+        var_local.resize(data.n);
+        Vec<isize> n_b = Vec<isize>::Zero(n_blocks);
+        Vec<isize> p_b = Vec<isize>::Zero(n_blocks);
+        Vec<isize> m_b = Vec<isize>::Zero(n_blocks);
+        for (isize j = 0; j < data.n; j++)
+        {
+            var_block(j) = component_block(component(j));
+            var_local(j) = n_b(var_block(j))++;
+        }
+        Vec<isize> eq_block(data.p);
+        Vec<isize> ineq_block(data.m);
+        for (isize r = 0; r < data.p; r++)
+        {
+            eq_block(r) = row_block(data.AT, r);
+            p_b(eq_block(r))++;
+        }
+        for (isize r = 0; r < data.m; r++)
+        {
+            ineq_block(r) = row_block(data.GT, r);
+            m_b(ineq_block(r))++;
+        }
+
+        for (isize b = 0; b < n_blocks; b++)
+        {
+            Block& block = *blocks[std::size_t(b)];
+            block.data.n = n_b(b);
+            block.data.p = p_b(b);
+            block.data.m = m_b(b);
+            block.var_idx.resize(n_b(b));
+            block.eq_idx.resize(p_b(b));
+            block.ineq_idx.resize(m_b(b));
+        }
+        n_b.setZero(); p_b.setZero(); m_b.setZero();
+        for (isize j = 0; j < data.n; j++) blocks[std::size_t(var_block(j))]->var_idx(n_b(var_block(j))++) = j;
+        for (isize r = 0; r < data.p; r++) blocks[std::size_t(eq_block(r))]->eq_idx(p_b(eq_block(r))++) = r;
+        for (isize r = 0; r < data.m; r++) blocks[std::size_t(ineq_block(r))]->ineq_idx(m_b(ineq_block(r))++) = r;
+
+        for (auto& block_ptr : blocks)
+        {
+            Block& block = *block_ptr;
+            Data<T, I>& d = block.data;
+            extract_columns(data.P_utri, block.var_idx, d.n, d.P_utri, block.P_nz);
+            extract_columns(data.AT, block.eq_idx, d.n, d.AT, block.AT_nz);
+            extract_columns(data.GT, block.ineq_idx, d.n, d.GT, block.GT_nz);
+            d.c.resize(d.n);
+            d.b.resize(d.p);
+            d.h.resize(d.m);
+            d.x_lb_idx.resize(d.n);
+            d.x_ub_idx.resize(d.n);
+            d.x_lb_scaling.resize(d.n);
+            d.x_ub_scaling.resize(d.n);
+            d.x_lb_n.resize(d.n);
+            d.x_ub.resize(d.n);
+            block.lb_idx.resize(d.n);
+            block.ub_idx.resize(d.n);
+
+            block.in_x.resize(d.n); block.in_y.resize(d.p); block.in_z.resize(d.m);
+            block.in_z_lb.resize(d.n); block.in_z_ub.resize(d.n);
+            block.in_s.resize(d.m); block.in_s_lb.resize(d.n); block.in_s_ub.resize(d.n);
+            block.out_x.resize(d.n); block.out_y.resize(d.p); block.out_z.resize(d.m);
+            block.out_z_lb.resize(d.n); block.out_z_ub.resize(d.n);
+            block.out_s.resize(d.m); block.out_s_lb.resize(d.n); block.out_s_ub.resize(d.n);
+        }
+        update_block_values();
+    }
+
+    // block of a row of A or G, empty rows are assigned to the block of the first variable
+    isize row_block(const SparseMat<T, I>& CT, isize r) const
+    {
+        isize begin = CT.outerIndexPtr()[r];
+        return begin < CT.outerIndexPtr()[r + 1] ? var_block(CT.innerIndexPtr()[begin]) : var_block(0);
+    }
+
+    // extracts the columns cols of M with the row indices mapped by var_local
+    void extract_columns(const SparseMat<T, I>& M, const Vec<isize>& cols, isize rows,
+                         SparseMat<T, I>& M_block, Vec<isize>& nz)
+    {
+        isize nnz = 0;
+        for (isize k = 0; k < cols.rows(); k++)
+        {
+            nnz += M.outerIndexPtr()[cols(k) + 1] - M.outerIndexPtr()[cols(k)];
+        }
+        M_block.resize(rows, cols.rows());
+        M_block.resizeNonZeros(nnz);
+        nz.resize(nnz);
+        isize l = 0;
+        for (isize k = 0; k < cols.rows(); k++)
+        {
+            for (isize i = M.outerIndexPtr()[cols(k)]; i < M.outerIndexPtr()[cols(k) + 1]; i++)
+            {
+                M_block.innerIndexPtr()[l] = I(var_local(M.innerIndexPtr()[i]));
+                nz(l++) = i;
+            }
+            M_block.outerIndexPtr()[k + 1] = I(l);
+        }
+    }
+
+    // copies the (scaled) values and the finite bounds of the global data into the blocks
+    void update_block_values()
+    {
+        for (auto& block_ptr : blocks)
+        {
+            Block& block = *block_ptr;
+            Data<T, I>& d = block.data;
+            for (isize k = 0; k < block.P_nz.rows(); k++) d.P_utri.valuePtr()[k] = data.P_utri.valuePtr()[block.P_nz(k)];
+            for (isize k = 0; k < block.AT_nz.rows(); k++) d.AT.valuePtr()[k] = data.AT.valuePtr()[block.AT_nz(k)];
+            for (isize k = 0; k < block.GT_nz.rows(); k++) d.GT.valuePtr()[k] = data.GT.valuePtr()[block.GT_nz(k)];
+            for (isize i = 0; i < d.n; i++) d.c(i) = data.c(block.var_idx(i));
+            for (isize i = 0; i < d.p; i++) d.b(i) = data.b(block.eq_idx(i));
+            for (isize i = 0; i < d.m; i++) d.h(i) = data.h(block.ineq_idx(i));
+            d.n_lb = 0;
+            d.n_ub = 0;
+        }
+        for (isize i = 0; i < data.n_lb; i++)
+        {
+            isize j = data.x_lb_idx(i);
+            Block& block = *blocks[std::size_t(var_block(j))];
+            Data<T, I>& d = block.data;
+            block.lb_idx(d.n_lb) = i;
+            d.x_lb_idx(d.n_lb) = var_local(j);
+            d.x_lb_scaling(d.n_lb) = data.x_lb_scaling(i);
+            d.x_lb_n(d.n_lb) = data.x_lb_n(i);
+            d.n_lb++;
+        }
+        for (isize i = 0; i < data.n_ub; i++)
+        {
+            isize j = data.x_ub_idx(i);
+            Block& block = *blocks[std::size_t(var_block(j))];
+            Data<T, I>& d = block.data;
+            block.ub_idx(d.n_ub) = i;
+            d.x_ub_idx(d.n_ub) = var_local(j);
+            d.x_ub_scaling(d.n_ub) = data.x_ub_scaling(i);
+            d.x_ub(d.n_ub) = data.x_ub(i);
+            d.n_ub++;
+        }
+    }
+
+    // (re)creates the thread pool if settings.n_threads changed
+    ThreadPool* update_thread_pool()
+    {
+        isize n_threads = settings.n_threads > 0 ? settings.n_threads : ThreadPool::hardware_threads();
+        n_threads = std::min(n_threads, n_blocks());
+        if (n_threads <= 1)
+        {
+            thread_pool.reset();
+        }
+        else if (!thread_pool)
+        {
+            thread_pool.reset(new ThreadPool(n_threads));
+        }
+        else
+        {
+            thread_pool->resize(n_threads);
+        }
+        return thread_pool.get();
+    }
+
+    template<typename F>
+    void for_each_block(const F& f)
+    {
+        auto task = [&](isize b) { f(*blocks[std::size_t(b)]); };
+        if (thread_pool)
+        {
+            thread_pool->parallel_for(n_blocks(), task);
+        }
+        else
+        {
+            for (isize b = 0; b < n_blocks(); b++) task(b);
+        }
+    }
+
+    void update_factorization_info(Info<T>& info) const
+    {
+        if (blocks.empty())
+        {
+            full_kkt.update_factorization_info(info);
+            return;
+        }
+
+        // the blocks are independent, i.e., their elimination trees form a forest
+        isize n_kkt = 0;
+        Info<T> block_info;
+        info.kkt_nnz = 0;
+        info.kkt_factor_nnz = 0;
+        info.factor_flops = 0;
+        info.solve_flops = 0;
+        info.etree_height = 0;
+        info.etree_width = 0;
+        info.workspace_bytes = memory_bytes(var_block, var_local);
+        for (const auto& block_ptr : blocks)
+        {
+            const Block& block = *block_ptr;
+            block.kkt.update_factorization_info(block_info);
+            n_kkt += block.kkt.PKPt.rows();
+            info.kkt_nnz += block_info.kkt_nnz;
+            info.kkt_factor_nnz += block_info.kkt_factor_nnz;
+            info.factor_flops += block_info.factor_flops;
+            info.solve_flops += block_info.solve_flops;
+            info.etree_height = std::max(info.etree_height, block_info.etree_height);
+            info.etree_width += block_info.etree_width;
+            info.workspace_bytes += block_info.workspace_bytes
+                                    + memory_bytes(block.data.P_utri, block.data.AT, block.data.GT,
+                                                   block.data.c, block.data.b, block.data.h,
+                                                   block.data.x_lb_idx, block.data.x_ub_idx,
+                                                   block.data.x_lb_scaling, block.data.x_ub_scaling,
+                                                   block.data.x_lb_n, block.data.x_ub)
+                                    + memory_bytes(block.var_idx, block.eq_idx, block.ineq_idx, block.lb_idx, block.ub_idx,
+                                                   block.P_nz, block.AT_nz, block.GT_nz)
+                                    + memory_bytes(block.in_x, block.in_y, block.in_z, block.in_z_lb, block.in_z_ub,
+                                                   block.in_s, block.in_s_lb, block.in_s_ub)
+                                    + memory_bytes(block.out_x, block.out_y, block.out_z, block.out_z_lb, block.out_z_ub,
+                                                   block.out_s, block.out_s_lb, block.out_s_ub);
+        }
+        info.kkt_fill_ratio = info.kkt_nnz > 0 ? T(info.kkt_factor_nnz + n_kkt) / T(info.kkt_nnz) : T(0);
+    }
+
+    void update_scalings(const T& rho, const T& delta,
+                         const CVecRef<T>& s, const CVecRef<T>& s_lb, const CVecRef<T>& s_ub,
+                         const CVecRef<T>& z, const CVecRef<T>& z_lb, const CVecRef<T>& z_ub)
+    {
+        if (blocks.empty())
+        {
+            full_kkt.update_scalings(rho, delta, s, s_lb, s_ub, z, z_lb, z_ub);
+            return;
+        }
+
+        for_each_block([&](Block& block) {
+            const Data<T, I>& d = block.data;
+            for (isize i = 0; i < d.m; i++)
+            {
+                block.in_s(i) = s(block.ineq_idx(i));
+                block.in_z(i) = z(block.ineq_idx(i));
+            }
+            for (isize i = 0; i < d.n_lb; i++)
+            {
+                block.in_s_lb(i) = s_lb(block.lb_idx(i));
+                block.in_z_lb(i) = z_lb(block.lb_idx(i));
+            }
+            for (isize i = 0; i < d.n_ub; i++)
+            {
+                block.in_s_ub(i) = s_ub(block.ub_idx(i));
+                block.in_z_ub(i) = z_ub(block.ub_idx(i));
+            }
+            block.kkt.update_scalings(rho, delta, block.in_s, block.in_s_lb, block.in_s_ub,
+                                      block.in_z, block.in_z_lb, block.in_z_ub);
+        });
+    }
+
+    void update_data(int options)
+    {
+        if (blocks.empty())
+        {
+            full_kkt.update_data(options);
+            return;
+        }
+
+        update_block_values();
+        update_thread_pool();
+        for_each_block([&](Block& block) { block.kkt.update_data(options); });
+    }
+
+    bool regularize_and_factorize(bool iterative_refinement)
+    {
+        if (blocks.empty())
+        {
+            return full_kkt.regularize_and_factorize(iterative_refinement);
+        }
+
+        PIQP_TRACE_SCOPE("factorize");
+
+        // every block is factorized, such that all factorizations are consistent on return
+        std::atomic<bool> success(true);
+        for_each_block([&](Block& block) {
+            if (!block.kkt.regularize_and_factorize(iterative_refinement)) success = false;
+        });
+        return success;
+    }
+
+    void solve(const CVecRef<T>& rhs_x, const CVecRef<T>& rhs_y,
+               const CVecRef<T>& rhs_z, const CVecRef<T>& rhs_z_lb, const CVecRef<T>& rhs_z_ub,
+               const CVecRef<T>& rhs_s, const CVecRef<T>& rhs_s_lb, const CVecRef<T>& rhs_s_ub,
+               VecRef<T> delta_x, VecRef<T> delta_y,
+               VecRef<T> delta_z, VecRef<T> delta_z_lb, VecRef<T> delta_z_ub,
+               VecRef<T> delta_s, VecRef<T> delta_s_lb, VecRef<T> delta_s_ub,
+               bool iterative_refinement)
+    {
+        if (blocks.empty())
+        {
+            full_kkt.solve(rhs_x, rhs_y, rhs_z, rhs_z_lb, rhs_z_ub, rhs_s, rhs_s_lb, rhs_s_ub,
+                           delta_x, delta_y, delta_z, delta_z_lb, delta_z_ub, delta_s, delta_s_lb, delta_s_ub,
+                           iterative_refinement);
+            m_refine_iter = full_kkt.m_refine_iter;
+            return;
+        }
+
+        PIQP_TRACE_SCOPE("kkt_solve");
+
+        // the blocks write to disjoint entries of the solution
+        for_each_block([&](Block& block) {
+            const Data<T, I>& d = block.data;
+            for (isize i = 0; i < d.n; i++) block.in_x(i) = rhs_x(block.var_idx(i));
+            for (isize i = 0; i < d.p; i++) block.in_y(i) = rhs_y(block.eq_idx(i));
+            for (isize i = 0; i < d.m; i++)
+            {
+                block.in_z(i) = rhs_z(block.ineq_idx(i));
+                block.in_s(i) = rhs_s(block.ineq_idx(i));
+            }
+            for (isize i = 0; i < d.n_lb; i++)
+            {
+                block.in_z_lb(i) = rhs_z_lb(block.lb_idx(i));
+                block.in_s_lb(i) = rhs_s_lb(block.lb_idx(i));
+            }
+            for (isize i = 0; i < d.n_ub; i++)
+            {
+                block.in_z_ub(i) = rhs_z_ub(block.ub_idx(i));
+                block.in_s_ub(i) = rhs_s_ub(block.ub_idx(i));
+            }
+
+            block.kkt.solve(block.in_x, block.in_y, block.in_z, block.in_z_lb, block.in_z_ub,
+                            block.in_s, block.in_s_lb, block.in_s_ub,
+                            block.out_x, block.out_y, block.out_z, block.out_z_lb, block.out_z_ub,
+                            block.out_s, block.out_s_lb, block.out_s_ub,
+                            iterative_refinement);
+
+            for (isize i = 0; i < d.n; i++) delta_x(block.var_idx(i)) = block.out_x(i);
+            for (isize i = 0; i < d.p; i++) delta_y(block.eq_idx(i)) = block.out_y(i);
+            for (isize i = 0; i < d.m; i++)
+            {
+                delta_z(block.ineq_idx(i)) = block.out_z(i);
+                delta_s(block.ineq_idx(i)) = block.out_s(i);
+            }
+            for (isize i = 0; i < d.n_lb; i++)
+            {
+                delta_z_lb(block.lb_idx(i)) = block.out_z_lb(i);
+                delta_s_lb(block.lb_idx(i)) = block.out_s_lb(i);
+            }
+            for (isize i = 0; i < d.n_ub; i++)
+            {
+                delta_z_ub(block.ub_idx(i)) = block.out_z_ub(i);
+                delta_s_ub(block.ub_idx(i)) = block.out_s_ub(i);
+            }
+        });
+
+        m_refine_iter = 0;
+        for (const auto& block : blocks) m_refine_iter = std::max(m_refine_iter, block->kkt.m_refine_iter);
+    }
+};
+
+} // namespace sparse
+
+} // namespace piqp
+
+#ifdef PIQP_WITH_TEMPLATE_INSTANTIATION
+#include "piqp/sparse/block_kkt.tpp"
+#endif
+
+#endif //PIQP_SPARSE_BLOCK_KKT_HPP
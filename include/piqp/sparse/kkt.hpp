@@ -10,11 +10,13 @@
 #define PIQP_SPARSE_KKT_HPP
 
 #include "piqp/settings.hpp"
+#include "piqp/results.hpp"
 #include "piqp/sparse/data.hpp"
 #include "piqp/sparse/ldlt.hpp"
 #include "piqp/sparse/ordering.hpp"
 #include "piqp/sparse/utils.hpp"
 #include "piqp/kkt_fwd.hpp"
+#include "piqp/tracing.hpp"
 #include "piqp/sparse/kkt_full.hpp"
 #include "piqp/sparse/kkt_eq_eliminated.hpp"
 #include "piqp/sparse/kkt_ineq_eliminated.hpp"
@@ -35,6 +37,8 @@ struct KKT : public KKTImpl<KKT<T, I, Mode, Ordering>, T, I, Mode>
     T m_rho;
     T m_delta;
 
+    isize m_refine_iter = 0; // number of iterative refinement steps in last solve
+
     Vec<T> m_s;
     Vec<T> m_s_lb;
     Vec<T> m_s_ub;
@@ -84,6 +88,8 @@ struct KKT : public KKTImpl<KKT<T, I, Mode, Ordering>, T, I, Mode>
 
     void init(const T& rho, const T& delta)
     {
+        PIQP_TRACE_SCOPE("kkt_init");
+
         isize n_kkt = kkt_size();
 
         // init workspace
@@ -120,6 +126,22 @@ struct KKT : public KKTImpl<KKT<T, I, Mode, Ordering>, T, I, Mode>
         ldlt.factorize_symbolic_upper_triangular(PKPt);
     }
 
+    void update_factorization_info(Info<T>& info) const
+    {
+        isize n_kkt = PKPt.rows();
+        info.kkt_nnz = PKPt.nonZeros();
+        info.kkt_factor_nnz = ldlt.stats.nnz;
+        info.kkt_fill_ratio = info.kkt_nnz > 0 ? T(info.kkt_factor_nnz + n_kkt) / T(info.kkt_nnz) : T(0);
+        info.factor_flops = ldlt.stats.factor_flops;
+        info.solve_flops = ldlt.stats.solve_flops;
+        info.etree_height = ldlt.stats.etree_height;
+        info.etree_width = ldlt.stats.etree_width;
+        info.workspace_bytes = ldlt.memory_bytes() + this->impl_memory_bytes()
+                               + memory_bytes(m_s, m_s_lb, m_s_ub, m_z_inv, m_z_lb_inv, m_z_ub_inv,
+                                              ordering.P, ordering.P_inv, PKPt, PKi, kkt_diag,
+                                              rhs_z_bar, rhs, rhs_perm, sol_perm, err_corr_perm, ref_sol_perm);
+    }
+
     void update_scalings(const T& rho, const T& delta,
                          const CVecRef<T>& s, const CVecRef<T>& s_lb, const CVecRef<T>& s_ub,
                          const CVecRef<T>& z, const CVecRef<T>& z_lb, const CVecRef<T>& z_ub)
@@ -209,6 +231,8 @@ struct KKT : public KKTImpl<KKT<T, I, Mode, Ordering>, T, I, Mode>
 
     bool regularize_and_factorize(bool iterative_refinement)
     {
+        PIQP_TRACE_SCOPE("factorize");
+
         if (iterative_refinement)
         {
             T static_kkt_diag_max = 0;
@@ -292,6 +316,8 @@ struct KKT : public KKTImpl<KKT<T, I, Mode, Ordering>, T, I, Mode>
                VecRef<T> delta_s, VecRef<T> delta_s_lb, VecRef<T> delta_s_ub,
                bool iterative_refinement)
     {
+        PIQP_TRACE_SCOPE("kkt_solve");
+
         T delta_inv = T(1) / m_delta;
 
         rhs_z_bar.array() = rhs_z.array() - m_z_inv.array() * rhs_s.array();
@@ -335,8 +361,11 @@ struct KKT : public KKTImpl<KKT<T, I, Mode, Ordering>, T, I, Mode>
         sol_perm = rhs_perm;
         solve_ldlt_in_place(sol_perm);
 
-        if (iterative_refinement && settings.iterative_refinement_max_iter > 0)
+        m_refine_iter = 0;
+        if (iterative_refinement && settings.iterative_refinement_iter_limit() > 0)
         {
+            PIQP_TRACE_SCOPE("iterative_refinement");
+
             T rhs_norm = rhs_perm.template lpNorm<Eigen::Infinity>();
 
             err_corr_perm = rhs_perm;
@@ -344,7 +373,7 @@ struct KKT : public KKTImpl<KKT<T, I, Mode, Ordering>, T, I, Mode>
             err_corr_perm -= PKPt.transpose().template triangularView<Eigen::StrictlyLower>() * sol_perm;
             T error_norm = err_corr_perm.template lpNorm<Eigen::Infinity>();
 
-            for (isize i = 0; i < settings.iterative_refinement_max_iter; i++)
+            for (isize i = 0; i < settings.iterative_refinement_iter_limit(); i++)
             {
                 if (error_norm <= (settings.iterative_refinement_eps_abs + settings.iterative_refinement_eps_rel * rhs_norm))
                 {
@@ -354,6 +383,7 @@ struct KKT : public KKTImpl<KKT<T, I, Mode, Ordering>, T, I, Mode>
                 T prev_error_norm = error_norm;
 
                 solve_ldlt_in_place(err_corr_perm);
+                m_refine_iter++;
                 ref_sol_perm = sol_perm + err_corr_perm;
 
                 err_corr_perm = rhs_perm;
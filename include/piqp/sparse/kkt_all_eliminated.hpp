@@ -10,6 +10,7 @@
 #define PIQP_SPARSE_KKT_ALL_ELIMINATED_HPP
 
 #include "piqp/typedefs.hpp"
+#include "piqp/utils/memory.hpp"
 #include "piqp/kkt_fwd.hpp"
 
 namespace piqp
@@ -35,6 +36,11 @@ struct KKTImpl<Derived, T, I, KKTMode::KKT_ALL_ELIMINATED>
 
     ~KKTImpl() {};
 
+    isize impl_memory_bytes() const
+    {
+        return memory_bytes(A, G, AT_A, GT_W_delta_inv_G, tmp_scatter, P_utri_to_Ki, AT_A_to_Ki, GT_G_to_Ki);
+    }
+
     void init_workspace()
     {
         auto& data = static_cast<Derived*>(this)->data;
@@ -0,0 +1,95 @@
+// This file is part of PIQP.
+//
+// Copyright (c) 2024 EPFL
+//
+// This source code is licensed under the BSD 2-Clause License found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef PIQP_SPARSE_KKT_ANALYSIS_HPP
+#define PIQP_SPARSE_KKT_ANALYSIS_HPP
+
+#include "piqp/fwd.hpp"
+#include "piqp/typedefs.hpp"
+#include "piqp/settings.hpp"
+#include "piqp/results.hpp"
+#include "piqp/kkt_fwd.hpp"
+#include "piqp/utils/optional.hpp"
+#include "piqp/sparse/data.hpp"
+#include "piqp/sparse/block_kkt.hpp"
+
+namespace piqp
+{
+
+namespace sparse
+{
+
+// Predicts the factorization statistics of the sparse backend with the given KKT mode, i.e.,
+// Info::kkt_nnz, kkt_factor_nnz, kkt_fill_ratio, factor_flops, solve_flops, etree_height,
+// etree_width and workspace_bytes of the KKT system, from the ordering and the symbolic
+// factorization of the KKT matrix alone. In contrast to a setup, the data is not copied
+// into a solver and not preconditioned, and nothing is kept after the analysis.
+// The bounds only contribute to the diagonal and therefore do not change the result.
+template<typename T, typename I, int Mode = KKTMode::KKT_FULL>
+void analyze_kkt(const CSparseMatRef<T, I>& P,
+                 const optional<CSparseMatRef<T, I>>& A,
+                 const optional<CSparseMatRef<T, I>>& G,
+                 const Settings<T>& settings,
+                 Info<T>& info)
+{
+    Data<T, I> data;
+    data.n = P.rows();
+    data.p = A.has_value() ? A->rows() : 0;
+    data.m = G.has_value() ? G->rows() : 0;
+
+    data.P_utri = P.template triangularView<Eigen::Upper>();
+    if (A.has_value()) {
+        data.AT = A->transpose();
+    } else {
+        data.AT.resize(data.n, 0);
+    }
+    if (G.has_value()) {
+        data.GT = G->transpose();
+    } else {
+        data.GT.resize(data.n, 0);
+    }
+    data.c.setZero(data.n);
+    data.b.setZero(data.p);
+    data.h.setZero(data.m);
+
+    data.n_lb = 0;
+    data.n_ub = 0;
+    data.x_lb_idx.resize(data.n);
+    data.x_ub_idx.resize(data.n);
+    data.x_lb_scaling = Vec<T>::Constant(data.n, T(1));
+    data.x_ub_scaling = Vec<T>::Constant(data.n, T(1));
+    data.x_lb_n.resize(data.n);
+    data.x_ub.resize(data.n);
+
+    BlockKKT<T, I, Mode> kkt(data, settings);
+    kkt.init(settings.rho_init, settings.delta_init);
+    kkt.update_factorization_info(info);
+}
+
+// see analyze_kkt, with the KKT mode chosen at runtime
+template<typename T, typename I>
+void analyze_kkt(int kkt_mode,
+                 const CSparseMatRef<T, I>& P,
+                 const optional<CSparseMatRef<T, I>>& A,
+                 const optional<CSparseMatRef<T, I>>& G,
+                 const Settings<T>& settings,
+                 Info<T>& info)
+{
+    switch (kkt_mode)
+    {
+        case KKTMode::KKT_EQ_ELIMINATED: analyze_kkt<T, I, KKTMode::KKT_EQ_ELIMINATED>(P, A, G, settings, info); break;
+        case KKTMode::KKT_INEQ_ELIMINATED: analyze_kkt<T, I, KKTMode::KKT_INEQ_ELIMINATED>(P, A, G, settings, info); break;
+        case KKTMode::KKT_ALL_ELIMINATED: analyze_kkt<T, I, KKTMode::KKT_ALL_ELIMINATED>(P, A, G, settings, info); break;
+        default: analyze_kkt<T, I, KKTMode::KKT_FULL>(P, A, G, settings, info); break;
+    }
+}
+
+} // namespace sparse
+
+} // namespace piqp
+
+#endif //PIQP_SPARSE_KKT_ANALYSIS_HPP
@@ -10,6 +10,7 @@
 #define PIQP_SPARSE_KKT_EQ_ELIMINATED_HPP
 
 #include "piqp/typedefs.hpp"
+#include "piqp/utils/memory.hpp"
 #include "piqp/kkt_fwd.hpp"
 
 namespace piqp
@@ -33,6 +34,11 @@ struct KKTImpl<Derived, T, I, KKTMode::KKT_EQ_ELIMINATED>
 
     ~KKTImpl() {};
 
+    isize impl_memory_bytes() const
+    {
+        return memory_bytes(A, AT_A, tmp_scatter, P_utri_to_Ki, AT_A_to_Ki, GT_to_Ki);
+    }
+
     void init_workspace()
     {
         auto& data = static_cast<Derived*>(this)->data;
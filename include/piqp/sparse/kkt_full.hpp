@@ -10,6 +10,7 @@
 #define PIQP_SPARSE_KKT_FULL_HPP
 
 #include "piqp/typedefs.hpp"
+#include "piqp/utils/memory.hpp"
 #include "piqp/kkt_fwd.hpp"
 
 namespace piqp
@@ -30,6 +31,11 @@ struct KKTImpl<Derived, T, I, KKTMode::KKT_FULL>
 
     ~KKTImpl() {};
 
+    isize impl_memory_bytes() const
+    {
+        return memory_bytes(P_utri_to_Ki, P_diagonal, AT_to_Ki, GT_to_Ki);
+    }
+
     void init_workspace()
     {
         auto& data = static_cast<Derived*>(this)->data;
@@ -10,6 +10,7 @@
 #define PIQP_SPARSE_KKT_INEQ_ELIMINATED_HPP
 
 #include "piqp/typedefs.hpp"
+#include "piqp/utils/memory.hpp"
 #include "piqp/kkt_fwd.hpp"
 
 namespace piqp
@@ -33,6 +34,11 @@ struct KKTImpl<Derived, T, I, KKTMode::KKT_INEQ_ELIMINATED>
 
     ~KKTImpl() {};
 
+    isize impl_memory_bytes() const
+    {
+        return memory_bytes(G, GT_W_delta_inv_G, tmp_scatter, P_utri_to_Ki, AT_to_Ki, GT_G_to_Ki);
+    }
+
     void init_workspace()
     {
         auto& data = static_cast<Derived*>(this)->data;
@@ -11,6 +11,7 @@
 
 #include "piqp/fwd.hpp"
 #include "piqp/typedefs.hpp"
+#include "piqp/utils/memory.hpp"
 
 // Disable FMA instructions
 #if defined(_MSC_VER) && !defined(__INTEL_COMPILER)
@@ -46,6 +47,15 @@ struct LDLt
         Vec<T> y;
     } work;
 
+    // statistics of the symbolic factorization
+    struct {
+        isize nnz = 0;          // number of non-zeros in L (without unit diagonal)
+        T factor_flops = 0;     // flops of one numeric factorization
+        T solve_flops = 0;      // flops of one solve L D L^T x = b
+        isize etree_height = 0; // height of the elimination tree
+        isize etree_width = 0;  // maximum number of nodes on one level of the elimination tree
+    } stats;
+
     LDLt() {};
 
     ~LDLt() {};
@@ -105,6 +115,43 @@ struct LDLt
 
         L_ind.resize(L_cols[n]);
         L_vals.resize(L_cols[n]);
+
+        compute_stats();
+    }
+
+    void compute_stats()
+    {
+        // flop counts as reported by LDL_demo in
+        // https://github.com/DrTimothyAldenDavis/SuiteSparse/blob/stable/LDL/Demo/ldlsimple.c
+        const isize n = L_nnz.rows();
+        stats.nnz = L_cols[n];
+        stats.factor_flops = 0;
+        for (isize k = 0; k < n; k++)
+        {
+            stats.factor_flops += T(L_nnz[k]) * T(L_nnz[k] + 2);
+        }
+        stats.solve_flops = T(4) * T(stats.nnz) + T(n);
+
+        // the parent of a node always has a larger index,
+        // hence the depth of all nodes can be computed in a single backward sweep
+        // we use the (not yet needed) working variables of the numeric factorization as temporaries
+        Eigen::Map<Vec<I>> depth(work.flag.data(), n);
+        Eigen::Map<Vec<I>> level_count(work.pattern.data(), n);
+        level_count.setZero();
+        stats.etree_height = 0;
+        stats.etree_width = 0;
+        for (isize k = n - 1; k >= 0; k--)
+        {
+            depth[k] = etree[k] == -1 ? 0 : depth[etree[k]] + 1;
+            level_count[depth[k]]++;
+            stats.etree_height = std::max(stats.etree_height, isize(depth[k]) + 1);
+            stats.etree_width = std::max(stats.etree_width, isize(level_count[depth[k]]));
+        }
+    }
+
+    isize memory_bytes() const
+    {
+        return piqp::memory_bytes(etree, L_cols, L_nnz, L_ind, L_vals, D, D_inv, work.flag, work.pattern, work.y);
     }
 
     isize factorize_numeric_upper_triangular(const SparseMat<T, I>& A)
@@ -198,6 +198,65 @@ void post_mult_diagonal(SparseMat<T, I>& A, const CVecRef<T>& diag)
     }
 }
 
+/*
+ * Computes the connected components of the bipartite graph of variables and constraints,
+ * i.e., two variables are connected if they are coupled by P or appear in the same row
+ * of A or G. The components are numbered in the order of their first variable.
+ *
+ * @param P_utri     upper triangular part of P
+ * @param AT         A transpose
+ * @param GT         G transpose
+ * @param component  component of every variable
+ *
+ * @return number of components
+ */
+template<typename T, typename I>
+isize connected_components(const SparseMat<T, I>& P_utri, const SparseMat<T, I>& AT, const SparseMat<T, I>& GT,
+                           Vec<isize>& component)
+{
+    isize n = P_utri.rows();
+
+    // union-find with path halving, the root is the smallest variable of the set
+    Vec<isize> parent = Vec<isize>::LinSpaced(n, 0, n - 1);
+    auto find = [&](isize i) {
+        while (parent(i) != i)
+        {
+            parent(i) = parent(parent(i));
+            i = parent(i);
+        }
+        return i;
+    };
+    auto join = [&](isize i, isize j) {
+        i = find(i);
+        j = find(j);
+        if (i < j) parent(j) = i;
+        else if (j < i) parent(i) = j;
+    };
+
+    for (isize j = 0; j < P_utri.outerSize(); j++)
+    {
+        for (typename SparseMat<T, I>::InnerIterator it(P_utri, j); it; ++it) join(isize(it.index()), j);
+    }
+    for (const SparseMat<T, I>* CT : {&AT, &GT})
+    {
+        for (isize r = 0; r < CT->outerSize(); r++)
+        {
+            isize begin = CT->outerIndexPtr()[r];
+            isize end = CT->outerIndexPtr()[r + 1];
+            for (isize k = begin + 1; k < end; k++) join(isize(CT->innerIndexPtr()[begin]), isize(CT->innerIndexPtr()[k]));
+        }
+    }
+
+    isize n_components = 0;
+    component.resize(n);
+    for (isize i = 0; i < n; i++)
+    {
+        isize root = find(i);
+        component(i) = root == i ? n_components++ : component(root);
+    }
+    return n_components;
+}
+
 } // namespace sparse
 
 } // namespace piqp
@@ -0,0 +1,281 @@
+// This file is part of PIQP.
+//
+// Copyright (c) 2024 EPFL
+//
+// This source code is licensed under the BSD 2-Clause License found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef PIQP_STAGEWISE_CYCLIC_REDUCTION_HPP
+#define PIQP_STAGEWISE_CYCLIC_REDUCTION_HPP
+
+#include <atomic>
+#include <vector>
+#include <algorithm>
+
+#include "piqp/typedefs.hpp"
+#include "piqp/utils/memory.hpp"
+#include "piqp/utils/thread_pool.hpp"
+#include "piqp/dense/ldlt_no_pivot.hpp"
+#include "piqp/dense/rank_update.hpp"
+#include "piqp/stagewise/structure.hpp"
+
+namespace piqp
+{
+
+namespace stagewise
+{
+
+// Block cyclic reduction of a symmetric block tridiagonal matrix with diagonal blocks D_k
+// and sub-diagonal blocks E_k = K_{k+1,k}. On every level, every second of the remaining
+// stages j is eliminated. Its neighbours l and r are updated with the Schur complement
+//   D_l -= K_lj K_jj^{-1} K_jl,  D_r -= K_rj K_jj^{-1} K_jr,  K_rl = -K_rj K_jj^{-1} K_jl,
+// which couples l and r on the next level. The eliminations of one level are independent,
+// hence the factorization and the solves have O(log N) depth, at about twice the flops of
+// the sequential elimination. With K_jj = L_j D_j L_j^T, U_l = L_j^{-1} K_jl and
+// W_l = D_j^{-1} U_l, the Schur complements are K_lj K_jj^{-1} K_jl = U_l^T W_l.
+template<typename T>
+class CyclicReduction
+{
+public:
+    void init(const std::vector<isize>& stage_dims)
+    {
+        n_stages = isize(stage_dims.size());
+        offsets = stage_offsets(stage_dims);
+
+        // elimination schedule, the first stage is always kept and ends up as root
+        levels.clear();
+        IdxVec active = IdxVec::LinSpaced(n_stages, 0, n_stages - 1);
+        while (active.rows() > 1)
+        {
+            levels.push_back(active);
+            IdxVec kept((active.rows() + 1) / 2);
+            for (isize k = 0; k < kept.rows(); k++) kept(k) = active(2 * k);
+            active = kept;
+        }
+
+        U_l.assign(std::size_t(n_stages), Mat<T>());
+        U_r.assign(std::size_t(n_stages), Mat<T>());
+        W_l.assign(std::size_t(n_stages), Mat<T>());
+        W_r.assign(std::size_t(n_stages), Mat<T>());
+        fill.assign(levels.size(), std::vector<Mat<T>>());
+        for (std::size_t level = 0; level < levels.size(); level++)
+        {
+            const IdxVec& a = levels[level];
+            isize M = a.rows();
+            for (isize k = 1; k < M; k += 2)
+            {
+                std::size_t j = std::size_t(a(k));
+                U_l[j].resize(dim(a(k)), dim(a(k - 1)));
+                W_l[j].resize(dim(a(k)), dim(a(k - 1)));
+                if (k + 1 < M)
+                {
+                    U_r[j].resize(dim(a(k)), dim(a(k + 1)));
+                    W_r[j].resize(dim(a(k)), dim(a(k + 1)));
+                }
+            }
+            // couplings of the kept stages on the next level
+            if (level + 1 < levels.size())
+            {
+                const IdxVec& next = levels[level + 1];
+                fill[level + 1].resize(std::size_t(next.rows() - 1));
+                for (isize k = 0; k + 1 < next.rows(); k++)
+                {
+                    fill[level + 1][std::size_t(k)].resize(dim(next(k + 1)), dim(next(k)));
+                }
+            }
+        }
+
+        ldlt_tmp.resize(offsets(n_stages));
+        solve_tmp.resize(offsets(n_stages));
+    }
+
+    isize dim(isize k) const { return offsets(k + 1) - offsets(k); }
+
+    isize n_levels() const { return isize(levels.size()); }
+
+    // maximum dimension of the stages eliminated on the given level
+    isize max_dim(isize level) const
+    {
+        const IdxVec& a = levels[std::size_t(level)];
+        isize d = 0;
+        for (isize k = 1; k < a.rows(); k += 2) d = std::max(d, dim(a(k)));
+        return d;
+    }
+
+    // Factorizes the matrix with the lower triangular parts of the diagonal blocks in D,
+    // which are overwritten with the factors, and the sub-diagonal blocks E.
+    bool factorize(std::vector<Mat<T>>& D, const std::vector<Mat<T>>& E, ThreadPool* pool)
+    {
+        std::atomic<bool> failed(false);
+
+        for (std::size_t level = 0; level < levels.size(); level++)
+        {
+            const IdxVec& a = levels[level];
+            isize M = a.rows();
+            isize n_elim = M / 2;
+
+            // coupling K_{a(k+1), a(k)} of the stages active on this level
+            auto coupling = [&](isize k) -> const Mat<T>& {
+                return level == 0 ? E[std::size_t(a(k))] : fill[level][std::size_t(k)];
+            };
+
+            for_each(pool, n_elim, [&](isize t) {
+                isize k = 2 * t + 1;
+                std::size_t j = std::size_t(a(k));
+                auto tmp = ldlt_tmp.segment(offsets(a(k)), dim(a(k)));
+                if (dense::internal::ldlt_no_pivot_inplace<Eigen::Lower>::blocked(D[j], tmp) >= 0)
+                {
+                    failed = true;
+                    return;
+                }
+                auto L = D[j].template triangularView<Eigen::UnitLower>();
+                U_l[j] = coupling(k - 1);
+                L.solveInPlace(U_l[j]);
+                W_l[j].noalias() = D[j].diagonal().asDiagonal().inverse() * U_l[j];
+                if (k + 1 < M)
+                {
+                    U_r[j] = coupling(k).transpose();
+                    L.solveInPlace(U_r[j]);
+                    W_r[j].noalias() = D[j].diagonal().asDiagonal().inverse() * U_r[j];
+                    fill[level + 1][std::size_t(t)].noalias() = -U_r[j].transpose() * W_l[j];
+                }
+            });
+            if (failed) return false;
+
+            for_each(pool, (M + 1) / 2, [&](isize t) {
+                isize k = 2 * t;
+                std::size_t l = std::size_t(a(k));
+                if (k + 1 < M)
+                {
+                    std::size_t j = std::size_t(a(k + 1));
+                    dense::rank_update_lower(D[l], U_l[j].transpose(), W_l[j].transpose(), T(-1), nullptr);
+                }
+                if (k > 0)
+                {
+                    std::size_t j = std::size_t(a(k - 1));
+                    dense::rank_update_lower(D[l], U_r[j].transpose(), W_r[j].transpose(), T(-1), nullptr);
+                }
+            });
+        }
+
+        auto tmp = ldlt_tmp.segment(0, dim(0));
+        return dense::internal::ldlt_no_pivot_inplace<Eigen::Lower>::blocked(D[0], tmp) < 0;
+    }
+
+    void solve_in_place(const std::vector<Mat<T>>& D, VecRef<T> x, ThreadPool* pool)
+    {
+        auto x_seg = [&](isize k) { return x.segment(offsets(k), dim(k)); };
+
+        for (std::size_t level = 0; level < levels.size(); level++)
+        {
+            const IdxVec& a = levels[level];
+            isize M = a.rows();
+
+            for_each(pool, M / 2, [&](isize t) {
+                isize j = a(2 * t + 1);
+                auto x_j = x_seg(j);
+                D[std::size_t(j)].template triangularView<Eigen::UnitLower>().solveInPlace(x_j);
+                x_j.array() /= D[std::size_t(j)].diagonal().array();
+            });
+
+            for_each(pool, (M + 1) / 2, [&](isize t) {
+                isize k = 2 * t;
+                auto x_l = x_seg(a(k));
+                if (k + 1 < M) x_l.noalias() -= U_l[std::size_t(a(k + 1))].transpose() * x_seg(a(k + 1));
+                if (k > 0) x_l.noalias() -= U_r[std::size_t(a(k - 1))].transpose() * x_seg(a(k - 1));
+            });
+        }
+
+        {
+            auto x_0 = x_seg(0);
+            D[0].template triangularView<Eigen::UnitLower>().solveInPlace(x_0);
+            x_0.array() /= D[0].diagonal().array();
+            D[0].transpose().template triangularView<Eigen::UnitUpper>().solveInPlace(x_0);
+        }
+
+        for (std::size_t level = levels.size(); level-- > 0;)
+        {
+            const IdxVec& a = levels[level];
+            isize M = a.rows();
+
+            for_each(pool, M / 2, [&](isize t) {
+                isize k = 2 * t + 1;
+                std::size_t j = std::size_t(a(k));
+                auto x_j = x_seg(a(k));
+                auto tmp = solve_tmp.segment(offsets(a(k)), dim(a(k)));
+                tmp.noalias() = U_l[j] * x_seg(a(k - 1));
+                if (k + 1 < M) tmp.noalias() += U_r[j] * x_seg(a(k + 1));
+                x_j.array() -= tmp.array() / D[j].diagonal().array();
+                D[j].transpose().template triangularView<Eigen::UnitUpper>().solveInPlace(x_j);
+            });
+        }
+    }
+
+    T factor_flops() const
+    {
+        auto ldlt_flops = [](T n) { return (n - 1) * n * (2 * n - 1) / 6 + n * (n - 1); };
+        T flops = n_stages > 0 ? ldlt_flops(T(dim(0))) : T(0);
+        for (const IdxVec& a : levels)
+        {
+            isize M = a.rows();
+            for (isize k = 1; k < M; k += 2)
+            {
+                T nj = T(dim(a(k)));
+                T nl = T(dim(a(k - 1)));
+                T nr = k + 1 < M ? T(dim(a(k + 1))) : T(0);
+                flops += ldlt_flops(nj) + nj * nj * (nl + nr) + nj * (nl + nr);
+                flops += 2 * nr * nl * nj + nl * (nl + 1) * nj + nr * (nr + 1) * nj;
+            }
+        }
+        return flops;
+    }
+
+    // number of stages eliminated in parallel on the first level
+    isize max_parallel_stages() const { return levels.empty() ? 1 : levels[0].rows() / 2; }
+
+    isize workspace_bytes() const
+    {
+        isize bytes = memory_bytes(offsets, ldlt_tmp, solve_tmp);
+        for (const IdxVec& a : levels) bytes += memory_bytes(a);
+        for (std::size_t j = 0; j < U_l.size(); j++)
+        {
+            bytes += memory_bytes(U_l[j], U_r[j], W_l[j], W_r[j]);
+        }
+        for (const std::vector<Mat<T>>& level_fill : fill)
+        {
+            for (const Mat<T>& F : level_fill) bytes += memory_bytes(F);
+        }
+        return bytes;
+    }
+
+protected:
+    template<typename F>
+    static void for_each(ThreadPool* pool, isize n_tasks, const F& f)
+    {
+        if (pool)
+        {
+            pool->parallel_for(n_tasks, f);
+        }
+        else
+        {
+            for (isize i = 0; i < n_tasks; i++) f(i);
+        }
+    }
+
+    isize n_stages = 0;
+    IdxVec offsets;
+    std::vector<IdxVec> levels;           // stages active on every level
+    std::vector<Mat<T>> U_l;              // L_j^{-1} K_jl of the eliminated stage j and its left neighbour
+    std::vector<Mat<T>> U_r;              // L_j^{-1} K_jr of the eliminated stage j and its right neighbour
+    std::vector<Mat<T>> W_l;              // D_j^{-1} U_l
+    std::vector<Mat<T>> W_r;              // D_j^{-1} U_r
+    std::vector<std::vector<Mat<T>>> fill; // couplings of the active stages created on every level
+    Vec<T> ldlt_tmp;
+    Vec<T> solve_tmp;
+};
+
+} // namespace stagewise
+
+} // namespace piqp
+
+#endif //PIQP_STAGEWISE_CYCLIC_REDUCTION_HPP
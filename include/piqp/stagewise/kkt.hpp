@@ -0,0 +1,672 @@
+// This file is part of PIQP.
+//
+// Copyright (c) 2024 EPFL
+//
+// This source code is licensed under the BSD 2-Clause License found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef PIQP_STAGEWISE_KKT_HPP
+#define PIQP_STAGEWISE_KKT_HPP
+
+#include <memory>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+
+#include "piqp/settings.hpp"
+#include "piqp/results.hpp"
+#include "piqp/utils/memory.hpp"
+#include "piqp/kkt_fwd.hpp"
+#include "piqp/tracing.hpp"
+#include "piqp/sparse/data.hpp"
+#include "piqp/dense/ldlt_no_pivot.hpp"
+#include "piqp/dense/rank_update.hpp"
+#include "piqp/utils/thread_pool.hpp"
+#include "piqp/stagewise/structure.hpp"
+#include "piqp/stagewise/cyclic_reduction.hpp"
+
+namespace piqp
+{
+
+namespace stagewise
+{
+
+// KKT system of problems whose variables are ordered by stage such that the reduced
+// KKT matrix P + rho I + A^T A / delta + G^T W G + bounds is block tridiagonal with
+// dense blocks. The matrix is factorized by block elimination, i.e., for k = 0, ..., N-1
+//   D_k = L_k D_k L_k^T,  L_{k+1,k} = E_k L_k^{-T} D_k^{-1},  D_{k+1} -= L_{k+1,k} D_k L_{k+1,k}^T,
+// with diagonal blocks D_k and sub-diagonal blocks E_k, which costs O(N n^3) for stages of size n.
+// Every constraint row belongs to the first stage it involves, and the rows of stage k are
+// stored as dense matrix C_k over the variables of the stages k and k+1.
+// For long horizons, the sequential elimination can be replaced by block cyclic reduction,
+// which eliminates the stages in O(log N) parallel steps.
+template<typename T, typename I>
+struct KKT
+{
+    const sparse::Data<T, I>& data;
+    const Settings<T>& settings;
+
+    // number of variables per stage, has to be set before init
+    std::vector<isize> stage_dims;
+
+    T m_rho;
+    T m_delta;
+
+    isize m_refine_iter = 0; // number of iterative refinement steps in last solve
+
+    Vec<T> m_s;
+    Vec<T> m_s_lb;
+    Vec<T> m_s_ub;
+    Vec<T> m_z_inv;
+    Vec<T> m_z_lb_inv;
+    Vec<T> m_z_ub_inv;
+
+    isize n_stages = 0;
+    IdxVec offsets;        // offsets of the stages in the variable vector
+    IdxVec var_stage;      // stage of every variable
+    IdxVec A_row_stage;    // stage of every row of A
+    IdxVec A_row_local;    // row of every row of A in C_k
+    IdxVec G_row_stage;    // stage of every row of G
+    IdxVec G_row_local;    // row of every row of G in C_k, after the rows of A
+    IdxVec G_rows;         // rows of G ordered by stage
+    IdxVec A_stage_ptr;    // rows of A of stage k are in [A_stage_ptr(k), A_stage_ptr(k+1))
+    IdxVec G_stage_ptr;    // rows of G of stage k are G_rows([G_stage_ptr(k), G_stage_ptr(k+1)))
+
+    std::vector<Mat<T>> C;     // constraint rows of stage k, A rows first, then G rows
+    std::vector<Mat<T>> WC;    // weighted rows diag(1 / delta, W^{-1}) C_k
+    std::vector<Mat<T>> kkt_D; // lower triangular part of the diagonal blocks
+    std::vector<Mat<T>> kkt_E; // sub-diagonal blocks, n_{k+1} x n_k
+    std::vector<Mat<T>> fac_D; // L_k and D_k of the factorization
+    std::vector<Mat<T>> fac_E; // L_{k+1,k} of the factorization
+    Mat<T> fac_tmp;            // temporary of size max n_{k+1} x n_k
+    Vec<T> ldlt_tmp;           // temporary of size max n_k
+
+    StagewiseKKTFactorization requested_factorization = STAGEWISE_KKT_AUTO;
+    StagewiseKKTFactorization factorization = STAGEWISE_KKT_SEQUENTIAL;
+    CyclicReduction<T> cyclic_reduction;
+    std::unique_ptr<ThreadPool> thread_pool; // only allocated if settings.n_threads != 1
+
+    Vec<T> G_weights;     // weights (s / z + delta)^{-1} of G^T W G
+    Vec<T> bound_diag;    // diagonal contribution of the bounds
+    Vec<T> rhs_z_bar;     // temporary variable needed for back solve
+    Vec<T> rhs;           // stores the rhs
+    Vec<T> sol;           // solution of ldldt back solve
+    Vec<T> err_corr;      // temporary variable to calculate error in iterative refinement and correction term
+    Vec<T> ref_sol;       // refined solution
+
+    KKT(const sparse::Data<T, I>& data, const Settings<T>& settings) : data(data), settings(settings) {}
+
+    ~KKT() {};
+
+    void init(const T& rho, const T& delta)
+    {
+        PIQP_TRACE_SCOPE("kkt_init");
+
+        // init workspace
+        m_s.resize(data.m);
+        m_s_lb.resize(data.n);
+        m_s_ub.resize(data.n);
+        m_z_inv.resize(data.m);
+        m_z_lb_inv.resize(data.n);
+        m_z_ub_inv.resize(data.n);
+        G_weights.resize(data.m);
+        bound_diag.resize(data.n);
+        rhs_z_bar.resize(data.m);
+        rhs.resize(data.n);
+        sol.resize(data.n);
+        err_corr.resize(data.n);
+        ref_sol.resize(data.n);
+
+        m_rho = rho;
+        m_delta = delta;
+        m_s.setConstant(1);
+        m_s_lb.head(data.n_lb).setConstant(1);
+        m_s_ub.head(data.n_ub).setConstant(1);
+        m_z_inv.setConstant(1);
+        m_z_lb_inv.head(data.n_lb).setConstant(1);
+        m_z_ub_inv.head(data.n_ub).setConstant(1);
+
+        init_structure();
+        factorization = select_factorization();
+        if (factorization == STAGEWISE_KKT_CYCLIC_REDUCTION)
+        {
+            cyclic_reduction.init(stage_dims);
+        }
+        else
+        {
+            cyclic_reduction = CyclicReduction<T>();
+        }
+        extract_constraints();
+        update_kkt();
+    }
+
+    // Cyclic reduction needs about twice the flops of the sequential elimination,
+    // hence it only pays off if enough stages can be eliminated in parallel.
+    StagewiseKKTFactorization select_factorization() const
+    {
+        if (requested_factorization != STAGEWISE_KKT_AUTO) return requested_factorization;
+
+        isize n_threads = settings.n_threads > 0 ? settings.n_threads : ThreadPool::hardware_threads();
+        if (n_threads > 1 && n_stages >= 4 * n_threads) return STAGEWISE_KKT_CYCLIC_REDUCTION;
+        return STAGEWISE_KKT_SEQUENTIAL;
+    }
+
+    // (re)creates the thread pool if settings.n_threads changed
+    ThreadPool* update_thread_pool()
+    {
+        isize n_threads = settings.n_threads > 0 ? settings.n_threads : ThreadPool::hardware_threads();
+        if (n_threads <= 1)
+        {
+            thread_pool.reset();
+        }
+        else if (!thread_pool)
+        {
+            thread_pool.reset(new ThreadPool(n_threads));
+        }
+        else
+        {
+            thread_pool->resize(n_threads);
+        }
+        return thread_pool.get();
+    }
+
+    isize stage_dim(isize k) const { return k < n_stages ? offsets(k + 1) - offsets(k) : 0; }
+
+    // assigns the constraint rows to stages and allocates the blocks
+    void init_structure()
+    {
+        if (stage_dims.empty()) stage_dims.push_back(data.n);
+        eigen_assert(std::accumulate(stage_dims.begin(), stage_dims.end(), isize(0)) == data.n && "stage dimensions do not match");
+
+        n_stages = isize(stage_dims.size());
+        offsets = stage_offsets(stage_dims);
+        var_stage = variable_stages(stage_dims);
+
+        assign_rows(data.AT, A_row_stage, A_row_local, A_stage_ptr, nullptr);
+        assign_rows(data.GT, G_row_stage, G_row_local, G_stage_ptr, &G_rows);
+
+        isize max_dim = 0;
+        isize max_sub = 0;
+        C.resize(std::size_t(n_stages));
+        WC.resize(std::size_t(n_stages));
+        kkt_D.resize(std::size_t(n_stages));
+        kkt_E.resize(std::size_t(n_stages));
+        fac_D.resize(std::size_t(n_stages));
+        fac_E.resize(std::size_t(n_stages));
+        for (isize k = 0; k < n_stages; k++)
+        {
+            std::size_t sk = std::size_t(k);
+            isize n0 = stage_dim(k);
+            isize n1 = stage_dim(k + 1);
+            isize rows = A_stage_ptr(k + 1) - A_stage_ptr(k) + G_stage_ptr(k + 1) - G_stage_ptr(k);
+            C[sk].resize(rows, n0 + n1);
+            WC[sk].resize(rows, n0 + n1);
+            kkt_D[sk].resize(n0, n0);
+            kkt_E[sk].resize(n1, n0);
+            fac_D[sk].resize(n0, n0);
+            fac_E[sk].resize(n1, n0);
+            max_dim = std::max(max_dim, n0);
+            max_sub = std::max(max_sub, n1 * n0);
+        }
+        fac_tmp.resize(max_sub, 1);
+        ldlt_tmp.resize(max_dim);
+    }
+
+    // Assigns the rows of the transposed constraint matrix CT to the first stage they involve.
+    // The rows of stage k are numbered in increasing order starting from zero.
+    void assign_rows(const SparseMat<T, I>& CT, IdxVec& row_stage, IdxVec& row_local, IdxVec& stage_ptr, IdxVec* stage_rows)
+    {
+        isize n_rows = CT.outerSize();
+        row_stage.resize(n_rows);
+        row_local.resize(n_rows);
+        stage_ptr.setZero(n_stages + 1);
+        for (isize r = 0; r < n_rows; r++)
+        {
+            isize k = n_stages - 1;
+            for (typename SparseMat<T, I>::InnerIterator it(CT, r); it; ++it)
+            {
+                k = std::min(k, var_stage(it.index()));
+            }
+            if (CT.outerIndexPtr()[r] == CT.outerIndexPtr()[r + 1]) k = 0;
+            row_stage(r) = k;
+            row_local(r) = stage_ptr(k + 1)++;
+        }
+        for (isize k = 0; k < n_stages; k++)
+        {
+            stage_ptr(k + 1) += stage_ptr(k);
+        }
+        if (stage_rows)
+        {
+            stage_rows->resize(n_rows);
+            for (isize r = 0; r < n_rows; r++)
+            {
+                (*stage_rows)(stage_ptr(row_stage(r)) + row_local(r)) = r;
+            }
+        }
+    }
+
+    // checks that every row of the constraint matrix M only involves the stages k and k+1
+    // of the stage k it has been assigned to in setup, i.e., that it still fits into C_k
+    bool rows_fit_stages(const CSparseMatRef<T, I>& M, const IdxVec& row_stage) const
+    {
+        for (isize j = 0; j < M.outerSize(); j++)
+        {
+            for (typename CSparseMatRef<T, I>::InnerIterator it(M, j); it; ++it)
+            {
+                isize d = var_stage(j) - row_stage(it.index());
+                if (d < 0 || d > 1) return false;
+            }
+        }
+        return true;
+    }
+
+    // copies the (scaled) constraint rows into the dense blocks C_k
+    void extract_constraints()
+    {
+        for (isize k = 0; k < n_stages; k++)
+        {
+            C[std::size_t(k)].setZero();
+        }
+        for (isize r = 0; r < data.p; r++)
+        {
+            isize k = A_row_stage(r);
+            Mat<T>& Ck = C[std::size_t(k)];
+            for (typename SparseMat<T, I>::InnerIterator it(data.AT, r); it; ++it)
+            {
+                Ck(A_row_local(r), isize(it.index()) - offsets(k)) = it.value();
+            }
+        }
+        for (isize r = 0; r < data.m; r++)
+        {
+            isize k = G_row_stage(r);
+            isize p_k = A_stage_ptr(k + 1) - A_stage_ptr(k);
+            Mat<T>& Ck = C[std::size_t(k)];
+            for (typename SparseMat<T, I>::InnerIterator it(data.GT, r); it; ++it)
+            {
+                Ck(p_k + G_row_local(r), isize(it.index()) - offsets(k)) = it.value();
+            }
+        }
+    }
+
+    void update_factorization_info(Info<T>& info) const
+    {
+        // every stage is a dense LDL^T factorization followed by a
+        // triangular solve and a symmetric rank update of the next stage
+        T factor_flops = 0;
+        isize kkt_nnz = 0;
+        isize kkt_factor_nnz = 0;
+        isize workspace_bytes = 0;
+        for (isize k = 0; k < n_stages; k++)
+        {
+            std::size_t sk = std::size_t(k);
+            T n0 = T(stage_dim(k));
+            T n1 = T(stage_dim(k + 1));
+            kkt_nnz += stage_dim(k) * (stage_dim(k) + 1) / 2 + stage_dim(k + 1) * stage_dim(k);
+            kkt_factor_nnz += stage_dim(k) * (stage_dim(k) - 1) / 2 + stage_dim(k + 1) * stage_dim(k);
+            factor_flops += (n0 - 1) * n0 * (2 * n0 - 1) / 6 + n0 * (n0 - 1);
+            factor_flops += n1 * n0 * n0 + n1 * (n1 + 1) * n0;
+            workspace_bytes += memory_bytes(C[sk], WC[sk], kkt_D[sk], kkt_E[sk], fac_D[sk], fac_E[sk]);
+        }
+        if (factorization == STAGEWISE_KKT_CYCLIC_REDUCTION)
+        {
+            // the couplings created by the eliminations are stored in U_l, U_r and the fill blocks
+            factor_flops = cyclic_reduction.factor_flops();
+            workspace_bytes += cyclic_reduction.workspace_bytes();
+        }
+        info.kkt_nnz = kkt_nnz;
+        info.kkt_factor_nnz = kkt_factor_nnz;
+        info.kkt_fill_ratio = kkt_nnz > 0 ? T(kkt_factor_nnz + data.n) / T(kkt_nnz) : T(0);
+        info.factor_flops = factor_flops;
+        info.solve_flops = 4 * T(kkt_factor_nnz) + T(data.n);
+        if (factorization == STAGEWISE_KKT_CYCLIC_REDUCTION)
+        {
+            // every level adds one eliminated stage to the longest path to the first stage, which is factorized last
+            isize height = stage_dim(0);
+            for (isize level = 0; level < cyclic_reduction.n_levels(); level++)
+            {
+                height += cyclic_reduction.max_dim(level);
+            }
+            info.etree_height = height;
+            info.etree_width = cyclic_reduction.max_parallel_stages();
+        }
+        else
+        {
+            // the stages form a chain
+            info.etree_height = data.n;
+            info.etree_width = data.n > 0 ? 1 : 0;
+        }
+        info.workspace_bytes = workspace_bytes
+                               + memory_bytes(m_s, m_s_lb, m_s_ub, m_z_inv, m_z_lb_inv, m_z_ub_inv,
+                                              offsets, var_stage, A_row_stage, A_row_local, G_row_stage, G_row_local, G_rows,
+                                              A_stage_ptr, G_stage_ptr, fac_tmp, ldlt_tmp, G_weights, bound_diag,
+                                              rhs_z_bar, rhs, sol, err_corr, ref_sol);
+    }
+
+    void update_scalings(const T& rho, const T& delta,
+                         const CVecRef<T>& s, const CVecRef<T>& s_lb, const CVecRef<T>& s_ub,
+                         const CVecRef<T>& z, const CVecRef<T>& z_lb, const CVecRef<T>& z_ub)
+    {
+        m_rho = rho;
+        m_delta = delta;
+        m_s = s;
+        m_s_lb.head(data.n_lb) = s_lb.head(data.n_lb);
+        m_s_ub.head(data.n_ub) = s_ub.head(data.n_ub);
+        m_z_inv.array() = T(1) / z.array();
+        m_z_lb_inv.head(data.n_lb).array() = T(1) / z_lb.head(data.n_lb).array();
+        m_z_ub_inv.head(data.n_ub).array() = T(1) / z_ub.head(data.n_ub).array();
+
+        update_kkt();
+    }
+
+    void update_data(int options)
+    {
+        // the preconditioner might have rescaled all data, hence all blocks are updated
+        (void) options;
+        extract_constraints();
+        update_kkt();
+    }
+
+    void compute_bound_diag(VecRef<T> diag) const
+    {
+        diag.setZero();
+        for (isize i = 0; i < data.n_lb; i++)
+        {
+            diag(data.x_lb_idx(i)) += data.x_lb_scaling(i) * data.x_lb_scaling(i) / (m_z_lb_inv(i) * m_s_lb(i) + m_delta);
+        }
+        for (isize i = 0; i < data.n_ub; i++)
+        {
+            diag(data.x_ub_idx(i)) += data.x_ub_scaling(i) * data.x_ub_scaling(i) / (m_z_ub_inv(i) * m_s_ub(i) + m_delta);
+        }
+    }
+
+    // assembles the lower triangular parts of the diagonal blocks and the sub-diagonal blocks
+    void update_kkt()
+    {
+        G_weights.array() = T(1) / (m_z_inv.array() * m_s.array() + m_delta);
+        compute_bound_diag(bound_diag);
+
+        for (isize k = 0; k < n_stages; k++)
+        {
+            std::size_t sk = std::size_t(k);
+            kkt_D[sk].template triangularView<Eigen::Lower>().setZero();
+            kkt_D[sk].diagonal() = bound_diag.segment(offsets(k), stage_dim(k));
+            kkt_D[sk].diagonal().array() += m_rho;
+            kkt_E[sk].setZero();
+        }
+
+        // P is upper triangular, i.e., the row index is at most the column index
+        for (isize j = 0; j < data.n; j++)
+        {
+            isize sj = var_stage(j);
+            for (typename SparseMat<T, I>::InnerIterator it(data.P_utri, j); it; ++it)
+            {
+                isize i = isize(it.index());
+                isize si = var_stage(i);
+                if (si == sj)
+                {
+                    kkt_D[std::size_t(sj)](j - offsets(sj), i - offsets(sj)) += it.value();
+                }
+                else
+                {
+                    kkt_E[std::size_t(si)](j - offsets(sj), i - offsets(si)) += it.value();
+                }
+            }
+        }
+
+        for (isize k = 0; k < n_stages; k++)
+        {
+            std::size_t sk = std::size_t(k);
+            isize n0 = stage_dim(k);
+            isize n1 = stage_dim(k + 1);
+            isize p_k = A_stage_ptr(k + 1) - A_stage_ptr(k);
+            isize m_k = G_stage_ptr(k + 1) - G_stage_ptr(k);
+            if (p_k + m_k == 0) continue;
+
+            WC[sk].topRows(p_k) = C[sk].topRows(p_k) / m_delta;
+            for (isize l = 0; l < m_k; l++)
+            {
+                WC[sk].row(p_k + l) = G_weights(G_rows(G_stage_ptr(k) + l)) * C[sk].row(p_k + l);
+            }
+
+            kkt_D[sk].template triangularView<Eigen::Lower>() += C[sk].leftCols(n0).transpose() * WC[sk].leftCols(n0);
+            if (n1 > 0)
+            {
+                kkt_E[sk].noalias() += C[sk].rightCols(n1).transpose() * WC[sk].leftCols(n0);
+                kkt_D[sk + 1].template triangularView<Eigen::Lower>() += C[sk].rightCols(n1).transpose() * WC[sk].rightCols(n1);
+            }
+        }
+    }
+
+    bool regularize_and_factorize(bool iterative_refinement)
+    {
+        PIQP_TRACE_SCOPE("factorize");
+
+        T rho_reg = 0;
+        if (iterative_refinement)
+        {
+            T max_diag = data.P_utri.diagonal().template lpNorm<Eigen::Infinity>();
+            for (isize i = 0; i < data.m; i++)
+            {
+                max_diag = std::max(max_diag, m_z_inv(i) * m_s(i));
+            }
+            for (isize i = 0; i < data.n_lb; i++)
+            {
+                max_diag = std::max(max_diag, m_z_lb_inv(i) * m_s_lb(i));
+            }
+            for (isize i = 0; i < data.n_ub; i++)
+            {
+                max_diag = std::max(max_diag, m_z_ub_inv(i) * m_s_ub(i));
+            }
+
+            T reg = settings.iterative_refinement_static_regularization_eps + settings.iterative_refinement_static_regularization_rel * max_diag;
+            rho_reg = std::max(T(0), reg - m_rho);
+        }
+
+        // the assembled blocks are kept for the iterative refinement and repeated factorizations
+        for (isize k = 0; k < n_stages; k++)
+        {
+            std::size_t sk = std::size_t(k);
+            fac_D[sk].template triangularView<Eigen::Lower>() = kkt_D[sk];
+            fac_D[sk].diagonal().array() += rho_reg;
+            fac_E[sk] = kkt_E[sk];
+        }
+
+        if (factorization == STAGEWISE_KKT_CYCLIC_REDUCTION)
+        {
+            return cyclic_reduction.factorize(fac_D, fac_E, update_thread_pool());
+        }
+
+        for (isize k = 0; k < n_stages; k++)
+        {
+            std::size_t sk = std::size_t(k);
+            isize n0 = stage_dim(k);
+            isize n1 = stage_dim(k + 1);
+
+            auto tmp = ldlt_tmp.head(n0);
+            if (dense::internal::ldlt_no_pivot_inplace<Eigen::Lower>::blocked(fac_D[sk], tmp) >= 0) return false;
+
+            if (n1 > 0)
+            {
+                // L_{k+1,k} = E_k L_k^{-T} D_k^{-1}, D_{k+1} -= L_{k+1,k} D_k L_{k+1,k}^T
+                Eigen::Map<Mat<T>> E_L(fac_tmp.data(), n1, n0);
+                fac_D[sk].transpose().template triangularView<Eigen::UnitUpper>().template solveInPlace<Eigen::OnTheRight>(fac_E[sk]);
+                E_L = fac_E[sk];
+                fac_E[sk] = fac_E[sk] * fac_D[sk].diagonal().asDiagonal().inverse();
+                dense::rank_update_lower(fac_D[sk + 1], fac_E[sk], E_L, T(-1), nullptr);
+            }
+        }
+
+        return true;
+    }
+
+    // y -= K x with the unregularized KKT matrix K
+    void subtract_kkt_product(const CVecRef<T>& x, VecRef<T> y)
+    {
+        for (isize k = 0; k < n_stages; k++)
+        {
+            std::size_t sk = std::size_t(k);
+            isize n0 = stage_dim(k);
+            isize n1 = stage_dim(k + 1);
+            auto y_k = y.segment(offsets(k), n0);
+            auto x_k = x.segment(offsets(k), n0);
+            y_k.noalias() -= kkt_D[sk].template triangularView<Eigen::Lower>() * x_k;
+            y_k.noalias() -= kkt_D[sk].transpose().template triangularView<Eigen::StrictlyUpper>() * x_k;
+            if (n1 > 0)
+            {
+                y_k.noalias() -= kkt_E[sk].transpose() * x.segment(offsets(k + 1), n1);
+                y.segment(offsets(k + 1), n1).noalias() -= kkt_E[sk] * x_k;
+            }
+        }
+    }
+
+    void solve(const CVecRef<T>& rhs_x, const CVecRef<T>& rhs_y,
+               const CVecRef<T>& rhs_z, const CVecRef<T>& rhs_z_lb, const CVecRef<T>& rhs_z_ub,
+               const CVecRef<T>& rhs_s, const CVecRef<T>& rhs_s_lb, const CVecRef<T>& rhs_s_ub,
+               VecRef<T> delta_x, VecRef<T> delta_y,
+               VecRef<T> delta_z, VecRef<T> delta_z_lb, VecRef<T> delta_z_ub,
+               VecRef<T> delta_s, VecRef<T> delta_s_lb, VecRef<T> delta_s_ub,
+               bool iterative_refinement)
+    {
+        PIQP_TRACE_SCOPE("kkt_solve");
+
+        T delta_inv = T(1) / m_delta;
+
+        rhs_z_bar.array() = rhs_z.array() - m_z_inv.array() * rhs_s.array();
+
+        rhs = rhs_x;
+        rhs_z_bar.array() *= T(1) / (m_s.array() * m_z_inv.array() + m_delta);
+        rhs.noalias() += data.GT * rhs_z_bar;
+        rhs.noalias() += delta_inv * data.AT * rhs_y;
+
+        for (isize i = 0; i < data.n_lb; i++)
+        {
+            rhs(data.x_lb_idx(i)) -= data.x_lb_scaling(i) * (rhs_z_lb(i) - m_z_lb_inv(i) * rhs_s_lb(i))
+                                     / (m_s_lb(i) * m_z_lb_inv(i) + m_delta);
+        }
+        for (isize i = 0; i < data.n_ub; i++)
+        {
+            rhs(data.x_ub_idx(i)) += data.x_ub_scaling(i) * (rhs_z_ub(i) - m_z_ub_inv(i) * rhs_s_ub(i))
+                                     / (m_s_ub(i) * m_z_ub_inv(i) + m_delta);
+        }
+
+        sol = rhs;
+        solve_ldlt_in_place(sol);
+
+        m_refine_iter = 0;
+        if (iterative_refinement && settings.iterative_refinement_iter_limit() > 0)
+        {
+            PIQP_TRACE_SCOPE("iterative_refinement");
+
+            T rhs_norm = rhs.template lpNorm<Eigen::Infinity>();
+
+            err_corr = rhs;
+            subtract_kkt_product(sol, err_corr);
+            T error_norm = err_corr.template lpNorm<Eigen::Infinity>();
+
+            for (isize i = 0; i < settings.iterative_refinement_iter_limit(); i++)
+            {
+                if (error_norm <= (settings.iterative_refinement_eps_abs + settings.iterative_refinement_eps_rel * rhs_norm))
+                {
+                    break;
+                }
+
+                T prev_error_norm = error_norm;
+
+                solve_ldlt_in_place(err_corr);
+                m_refine_iter++;
+                ref_sol = sol + err_corr;
+
+                err_corr = rhs;
+                subtract_kkt_product(ref_sol, err_corr);
+                error_norm = err_corr.template lpNorm<Eigen::Infinity>();
+
+                T improvement_rate = prev_error_norm / error_norm;
+                if (improvement_rate < settings.iterative_refinement_min_improvement_rate)
+                {
+                    if (improvement_rate > T(1))
+                    {
+                        std::swap(sol, ref_sol);
+                    }
+                    break;
+                }
+                else
+                {
+                    std::swap(sol, ref_sol);
+                }
+            }
+        }
+
+        delta_x.noalias() = sol;
+
+        delta_y.noalias() = delta_inv * data.AT.transpose() * delta_x;
+        delta_y.noalias() -= delta_inv * rhs_y;
+
+        delta_z.noalias() = data.GT.transpose() * delta_x;
+        delta_z.array() *= T(1) / (m_s.array() * m_z_inv.array() + m_delta);
+        delta_z.noalias() -= rhs_z_bar;
+
+        for (isize i = 0; i < data.n_lb; i++)
+        {
+            delta_z_lb(i) = (-data.x_lb_scaling(i) * delta_x(data.x_lb_idx(i)) - rhs_z_lb(i) + m_z_lb_inv(i) * rhs_s_lb(i))
+                / (m_s_lb(i) * m_z_lb_inv(i) + m_delta);
+        }
+        for (isize i = 0; i < data.n_ub; i++)
+        {
+            delta_z_ub(i) = (data.x_ub_scaling(i) * delta_x(data.x_ub_idx(i)) - rhs_z_ub(i) + m_z_ub_inv(i) * rhs_s_ub(i))
+                            / (m_s_ub(i) * m_z_ub_inv(i) + m_delta);
+        }
+
+        delta_s.array() = m_z_inv.array() * (rhs_s.array() - m_s.array() * delta_z.array());
+
+        delta_s_lb.head(data.n_lb).array() = m_z_lb_inv.head(data.n_lb).array()
+            * (rhs_s_lb.head(data.n_lb).array() - m_s_lb.head(data.n_lb).array() * delta_z_lb.head(data.n_lb).array());
+
+        delta_s_ub.head(data.n_ub).array() = m_z_ub_inv.head(data.n_ub).array()
+            * (rhs_s_ub.head(data.n_ub).array() - m_s_ub.head(data.n_ub).array() * delta_z_ub.head(data.n_ub).array());
+    }
+
+    // block forward substitution, diagonal scaling and block backward substitution
+    void solve_ldlt_in_place(VecRef<T> x)
+    {
+        if (factorization == STAGEWISE_KKT_CYCLIC_REDUCTION)
+        {
+            cyclic_reduction.solve_in_place(fac_D, x, thread_pool.get());
+            return;
+        }
+
+        for (isize k = 0; k < n_stages; k++)
+        {
+            auto x_k = x.segment(offsets(k), stage_dim(k));
+            if (k > 0)
+            {
+                x_k.noalias() -= fac_E[std::size_t(k - 1)] * x.segment(offsets(k - 1), stage_dim(k - 1));
+            }
+            fac_D[std::size_t(k)].template triangularView<Eigen::UnitLower>().solveInPlace(x_k);
+        }
+
+        for (isize k = 0; k < n_stages; k++)
+        {
+            x.segment(offsets(k), stage_dim(k)).array() /= fac_D[std::size_t(k)].diagonal().array();
+        }
+
+        for (isize k = n_stages - 1; k >= 0; k--)
+        {
+            auto x_k = x.segment(offsets(k), stage_dim(k));
+            if (k < n_stages - 1)
+            {
+                x_k.noalias() -= fac_E[std::size_t(k)].transpose() * x.segment(offsets(k + 1), stage_dim(k + 1));
+            }
+            fac_D[std::size_t(k)].transpose().template triangularView<Eigen::UnitUpper>().solveInPlace(x_k);
+        }
+    }
+};
+
+} // namespace stagewise
+
+} // namespace piqp
+
+#ifdef PIQP_WITH_TEMPLATE_INSTANTIATION
+#include "piqp/stagewise/kkt.tpp"
+#endif
+
+#endif //PIQP_STAGEWISE_KKT_HPP
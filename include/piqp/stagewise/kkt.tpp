@@ -0,0 +1,26 @@
+// This file is part of PIQP.
+//
+// Copyright (c) 2024 EPFL
+//
+// This source code is licensed under the BSD 2-Clause License found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef PIQP_STAGEWISE_KKT_TPP
+#define PIQP_STAGEWISE_KKT_TPP
+
+#include "piqp/common.hpp"
+#include "piqp/stagewise/kkt.hpp"
+
+namespace piqp
+{
+
+namespace stagewise
+{
+
+extern template struct KKT<common::Scalar, common::StorageIndex>;
+
+} // namespace stagewise
+
+} // namespace piqp
+
+#endif //PIQP_STAGEWISE_KKT_TPP
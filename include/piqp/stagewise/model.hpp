@@ -0,0 +1,181 @@
+// This file is part of PIQP.
+//
+// Copyright (c) 2024 EPFL
+//
+// This source code is licensed under the BSD 2-Clause License found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef PIQP_STAGEWISE_MODEL_HPP
+#define PIQP_STAGEWISE_MODEL_HPP
+
+#include <limits>
+#include <vector>
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+
+#include "piqp/fwd.hpp"
+#include "piqp/typedefs.hpp"
+#include "piqp/sparse/model.hpp"
+
+namespace piqp
+{
+
+namespace stagewise
+{
+
+// Data of stage k of the optimal control problem
+//   min  sum_k 1/2 x_k^T Q_k x_k + u_k^T S_k x_k + 1/2 u_k^T R_k u_k + q_k^T x_k + r_k^T u_k
+//   s.t. x_0 = x_init,
+//        x_{k+1} = A_k x_k + B_k u_k + f_k,
+//        C_k x_k + D_k u_k <= d_k,
+//        x_lb_k <= x_k <= x_ub_k, u_lb_k <= u_k <= u_ub_k.
+// The dimensions are given by Q (states) and R (inputs), all other members may be
+// empty, in which case they are zero or, for the bounds, unbounded. The dynamics of
+// the last stage are ignored.
+template<typename T>
+struct Stage
+{
+    Mat<T> Q;
+    Mat<T> S;
+    Mat<T> R;
+    Vec<T> q;
+    Vec<T> r;
+
+    Mat<T> A;
+    Mat<T> B;
+    Vec<T> f;
+
+    Mat<T> C;
+    Mat<T> D;
+    Vec<T> d;
+
+    Vec<T> x_lb;
+    Vec<T> x_ub;
+    Vec<T> u_lb;
+    Vec<T> u_ub;
+
+    isize nx() const { return Q.rows(); }
+    isize nu() const { return R.rows(); }
+    isize nc() const { return d.rows(); }
+};
+
+// QP of a stagewise problem with the variables [x_0, u_0, x_1, u_1, ...]. All entries
+// of the dense blocks are stored, such that the sparsity pattern does not depend on
+// the values and the model can be used to update a solver.
+template<typename T, typename I>
+struct Model
+{
+    std::vector<isize> stage_dims;
+    sparse::Model<T, I> qp;
+
+    Model(const std::vector<Stage<T>>& stages, const CVecRef<T>& x_init)
+      : stage_dims(dims(stages)), qp(build(stages, x_init)) {}
+
+protected:
+    static std::vector<isize> dims(const std::vector<Stage<T>>& stages)
+    {
+        std::vector<isize> stage_dims;
+        for (const Stage<T>& stage : stages)
+        {
+            stage_dims.push_back(stage.nx() + stage.nu());
+        }
+        return stage_dims;
+    }
+
+    static sparse::Model<T, I> build(const std::vector<Stage<T>>& stages, const CVecRef<T>& x_init)
+    {
+        using Triplet = Eigen::Triplet<T, I>;
+        const T inf = std::numeric_limits<T>::infinity();
+        const isize N = isize(stages.size());
+
+        isize n = 0;
+        isize p = N > 0 ? stages[0].nx() : 0;
+        isize m = 0;
+        for (isize k = 0; k < N; k++)
+        {
+            n += stages[std::size_t(k)].nx() + stages[std::size_t(k)].nu();
+            if (k + 1 < N) p += stages[std::size_t(k + 1)].nx();
+            m += stages[std::size_t(k)].nc();
+        }
+
+        std::vector<Triplet> P_triplets, A_triplets, G_triplets;
+        Vec<T> c = Vec<T>::Zero(n);
+        Vec<T> b(p);
+        Vec<T> h(m);
+        Vec<T> x_lb = Vec<T>::Constant(n, -inf);
+        Vec<T> x_ub = Vec<T>::Constant(n, inf);
+
+        // x_0 = x_init
+        for (isize i = 0; N > 0 && i < stages[0].nx(); i++)
+        {
+            A_triplets.emplace_back(I(i), I(i), T(1));
+        }
+        if (N > 0) b.head(stages[0].nx()) = x_init;
+
+        isize offset = 0;
+        isize row_A = N > 0 ? stages[0].nx() : 0;
+        isize row_G = 0;
+        for (isize k = 0; k < N; k++)
+        {
+            const Stage<T>& stage = stages[std::size_t(k)];
+            const isize nx = stage.nx();
+            const isize nu = stage.nu();
+            const isize x_off = offset;
+            const isize u_off = offset + nx;
+
+            // upper triangular part of [Q S^T; S R]
+            for (isize j = 0; j < nx; j++) {
+                for (isize i = 0; i <= j; i++) P_triplets.emplace_back(I(x_off + i), I(x_off + j), stage.Q(i, j));
+            }
+            for (isize j = 0; j < nu; j++) {
+                for (isize i = 0; i < nx; i++) P_triplets.emplace_back(I(x_off + i), I(u_off + j), stage.S.size() > 0 ? stage.S(j, i) : T(0));
+                for (isize i = 0; i <= j; i++) P_triplets.emplace_back(I(u_off + i), I(u_off + j), stage.R(i, j));
+            }
+            if (stage.q.size() > 0) c.segment(x_off, nx) = stage.q;
+            if (stage.r.size() > 0) c.segment(u_off, nu) = stage.r;
+
+            // A_k x_k + B_k u_k - x_{k+1} = -f_k
+            if (k + 1 < N)
+            {
+                const isize nx_next = stages[std::size_t(k + 1)].nx();
+                for (isize i = 0; i < nx_next; i++)
+                {
+                    for (isize j = 0; j < nx; j++) A_triplets.emplace_back(I(row_A + i), I(x_off + j), stage.A(i, j));
+                    for (isize j = 0; j < nu; j++) A_triplets.emplace_back(I(row_A + i), I(u_off + j), stage.B(i, j));
+                    A_triplets.emplace_back(I(row_A + i), I(offset + nx + nu + i), T(-1));
+                }
+                if (stage.f.size() > 0) b.segment(row_A, nx_next) = -stage.f;
+                else b.segment(row_A, nx_next).setZero();
+                row_A += nx_next;
+            }
+
+            // C_k x_k + D_k u_k <= d_k
+            for (isize i = 0; i < stage.nc(); i++)
+            {
+                for (isize j = 0; j < nx && stage.C.size() > 0; j++) G_triplets.emplace_back(I(row_G + i), I(x_off + j), stage.C(i, j));
+                for (isize j = 0; j < nu && stage.D.size() > 0; j++) G_triplets.emplace_back(I(row_G + i), I(u_off + j), stage.D(i, j));
+            }
+            h.segment(row_G, stage.nc()) = stage.d;
+            row_G += stage.nc();
+
+            if (stage.x_lb.size() > 0) x_lb.segment(x_off, nx) = stage.x_lb;
+            if (stage.x_ub.size() > 0) x_ub.segment(x_off, nx) = stage.x_ub;
+            if (stage.u_lb.size() > 0) x_lb.segment(u_off, nu) = stage.u_lb;
+            if (stage.u_ub.size() > 0) x_ub.segment(u_off, nu) = stage.u_ub;
+
+            offset += nx + nu;
+        }
+
+        SparseMat<T, I> P(n, n), A(p, n), G(m, n);
+        P.setFromTriplets(P_triplets.begin(), P_triplets.end());
+        A.setFromTriplets(A_triplets.begin(), A_triplets.end());
+        G.setFromTriplets(G_triplets.begin(), G_triplets.end());
+        return sparse::Model<T, I>(P, c, A, b, G, h, x_lb, x_ub);
+    }
+};
+
+} // namespace stagewise
+
+} // namespace piqp
+
+#endif //PIQP_STAGEWISE_MODEL_HPP
@@ -0,0 +1,128 @@
+// This file is part of PIQP.
+//
+// Copyright (c) 2024 EPFL
+//
+// This source code is licensed under the BSD 2-Clause License found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef PIQP_STAGEWISE_STRUCTURE_HPP
+#define PIQP_STAGEWISE_STRUCTURE_HPP
+
+#include <cstdlib>
+#include <vector>
+#include <algorithm>
+
+#include "piqp/fwd.hpp"
+#include "piqp/typedefs.hpp"
+#include "piqp/utils/optional.hpp"
+
+namespace piqp
+{
+
+namespace stagewise
+{
+
+using IdxVec = Eigen::Matrix<isize, Eigen::Dynamic, 1>;
+
+// offsets of the stages in the variable vector, the last entry is the total number of variables
+inline IdxVec stage_offsets(const std::vector<isize>& stage_dims)
+{
+    IdxVec offsets(isize(stage_dims.size()) + 1);
+    offsets(0) = 0;
+    for (std::size_t k = 0; k < stage_dims.size(); k++)
+    {
+        offsets(isize(k) + 1) = offsets(isize(k)) + stage_dims[k];
+    }
+    return offsets;
+}
+
+// stage of every variable
+inline IdxVec variable_stages(const std::vector<isize>& stage_dims)
+{
+    IdxVec offsets = stage_offsets(stage_dims);
+    IdxVec var_stage(offsets(offsets.rows() - 1));
+    for (isize k = 0; k < isize(stage_dims.size()); k++)
+    {
+        var_stage.segment(offsets(k), stage_dims[std::size_t(k)]).setConstant(k);
+    }
+    return var_stage;
+}
+
+namespace detail
+{
+
+// checks that every row of M only involves variables of two consecutive stages
+template<typename T, typename I>
+bool rows_couple_consecutive_stages(const CSparseMatRef<T, I>& M, const IdxVec& var_stage)
+{
+    std::vector<isize> row_min(std::size_t(M.rows()), var_stage.rows());
+    std::vector<isize> row_max(std::size_t(M.rows()), -1);
+    for (isize j = 0; j < M.outerSize(); j++)
+    {
+        for (typename CSparseMatRef<T, I>::InnerIterator it(M, j); it; ++it)
+        {
+            std::size_t i = std::size_t(it.index());
+            row_min[i] = std::min(row_min[i], var_stage(j));
+            row_max[i] = std::max(row_max[i], var_stage(j));
+        }
+    }
+    for (std::size_t i = 0; i < row_min.size(); i++)
+    {
+        if (row_max[i] > row_min[i] + 1) return false;
+    }
+    return true;
+}
+
+} // namespace detail
+
+// Checks that the problem is block tridiagonal if the variables are ordered by stage,
+// i.e., P only couples variables of the same or of consecutive stages and every row
+// of A and G only involves variables of two consecutive stages.
+template<typename T, typename I>
+bool check_structure(const std::vector<isize>& stage_dims,
+                     const CSparseMatRef<T, I>& P,
+                     const optional<CSparseMatRef<T, I>>& A,
+                     const optional<CSparseMatRef<T, I>>& G)
+{
+    if (P.rows() != P.cols()) { piqp_eprint("P must be square\n"); return false; }
+    if (A.has_value() && A->cols() != P.cols()) { piqp_eprint("A must have correct dimensions\n"); return false; }
+    if (G.has_value() && G->cols() != P.cols()) { piqp_eprint("G must have correct dimensions\n"); return false; }
+
+    isize n = 0;
+    for (isize n_k : stage_dims)
+    {
+        if (n_k <= 0) { piqp_eprint("stage dimensions must be positive\n"); return false; }
+        n += n_k;
+    }
+    if (n != P.rows()) { piqp_eprint("stage dimensions must sum up to the number of variables\n"); return false; }
+
+    IdxVec var_stage = variable_stages(stage_dims);
+    for (isize j = 0; j < P.outerSize(); j++)
+    {
+        for (typename CSparseMatRef<T, I>::InnerIterator it(P, j); it; ++it)
+        {
+            if (std::abs(var_stage(it.index()) - var_stage(j)) > 1)
+            {
+                piqp_eprint("P couples variables of non-consecutive stages\n");
+                return false;
+            }
+        }
+    }
+    if (A.has_value() && !detail::rows_couple_consecutive_stages<T, I>(*A, var_stage))
+    {
+        piqp_eprint("A has rows involving non-consecutive stages\n");
+        return false;
+    }
+    if (G.has_value() && !detail::rows_couple_consecutive_stages<T, I>(*G, var_stage))
+    {
+        piqp_eprint("G has rows involving non-consecutive stages\n");
+        return false;
+    }
+    return true;
+}
+
+} // namespace stagewise
+
+} // namespace piqp
+
+#endif //PIQP_STAGEWISE_STRUCTURE_HPP
@@ -27,6 +27,12 @@ public:
         m_start = std::chrono::steady_clock::now();
     }
 
+    // time since start without stopping the timer
+    T elapsed() const noexcept
+    {
+        return static_cast<T>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count()) * 1e-9;
+    }
+
     T stop() noexcept
     {
         m_end = std::chrono::steady_clock::now();
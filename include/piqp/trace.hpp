@@ -0,0 +1,187 @@
+// This file is part of PIQP.
+//
+// Copyright (c) 2024 EPFL
+//
+// This source code is licensed under the BSD 2-Clause License found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef PIQP_TRACE_HPP
+#define PIQP_TRACE_HPP
+
+#include <vector>
+#include <string>
+#include <limits>
+#include <ostream>
+#include <sstream>
+#include <cmath>
+#include <algorithm>
+
+#include "piqp/typedefs.hpp"
+
+namespace piqp
+{
+
+template<typename T>
+struct TraceEntry
+{
+    isize solve;          // index of the solve call the iteration belongs to
+    isize iter;
+
+    T primal_obj;
+    T dual_obj;
+    T duality_gap;
+    T primal_inf;
+    T dual_inf;
+
+    T rho;
+    T delta;
+    T mu;
+    T sigma;
+    T primal_step;
+    T dual_step;
+
+    isize refine_iter;    // number of iterative refinement steps
+    isize factor_retires; // number of factorization retires
+
+    // time stamps relative to the start of the solve call
+    T factor_time;        // end of the KKT factorization
+    T predictor_time;     // end of the predictor solve
+    T corrector_time;     // end of the corrector solve
+    T residual_time;      // end of the residual update
+};
+
+// Preallocated ring buffer of per-iteration solver statistics.
+// If the buffer is full, the oldest entries get overwritten.
+template<typename T>
+class Trace
+{
+protected:
+    std::vector<TraceEntry<T>> m_entries;
+    isize m_head = 0; // position of the next entry
+    isize m_size = 0;
+
+public:
+    void reserve(isize capacity)
+    {
+        m_entries.resize(static_cast<std::size_t>(capacity));
+        clear();
+    }
+
+    void clear() noexcept
+    {
+        m_head = 0;
+        m_size = 0;
+    }
+
+    isize capacity() const noexcept { return isize(m_entries.size()); }
+
+    isize size() const noexcept { return m_size; }
+
+    bool empty() const noexcept { return m_size == 0; }
+
+    // returns a reference to the next entry, capacity has to be positive
+    TraceEntry<T>& push() noexcept
+    {
+        TraceEntry<T>& entry = m_entries[static_cast<std::size_t>(m_head)];
+        m_head = (m_head + 1) % capacity();
+        m_size = std::min(m_size + 1, capacity());
+        return entry;
+    }
+
+    // i-th entry, starting from the oldest one
+    const TraceEntry<T>& operator[](isize i) const noexcept
+    {
+        isize idx = (m_head - m_size + i + capacity()) % capacity();
+        return m_entries[static_cast<std::size_t>(idx)];
+    }
+
+    const TraceEntry<T>& back() const noexcept
+    {
+        return (*this)[m_size - 1];
+    }
+
+    void write_csv(std::ostream& os) const
+    {
+        std::streamsize precision = os.precision(std::numeric_limits<T>::max_digits10);
+        os << "solve,iter,primal_obj,dual_obj,duality_gap,primal_inf,dual_inf,"
+           << "rho,delta,mu,sigma,primal_step,dual_step,refine_iter,factor_retires,"
+           << "factor_time,predictor_time,corrector_time,residual_time\n";
+        for (isize i = 0; i < m_size; i++)
+        {
+            const TraceEntry<T>& e = (*this)[i];
+            os << e.solve << ',' << e.iter << ','
+               << e.primal_obj << ',' << e.dual_obj << ',' << e.duality_gap << ','
+               << e.primal_inf << ',' << e.dual_inf << ','
+               << e.rho << ',' << e.delta << ',' << e.mu << ',' << e.sigma << ','
+               << e.primal_step << ',' << e.dual_step << ','
+               << e.refine_iter << ',' << e.factor_retires << ','
+               << e.factor_time << ',' << e.predictor_time << ',' << e.corrector_time << ',' << e.residual_time << '\n';
+        }
+        os.precision(precision);
+    }
+
+    void write_json(std::ostream& os) const
+    {
+        std::streamsize precision = os.precision(std::numeric_limits<T>::max_digits10);
+        os << '[';
+        for (isize i = 0; i < m_size; i++)
+        {
+            const TraceEntry<T>& e = (*this)[i];
+            if (i > 0) os << ',';
+            os << "\n  {\"solve\": " << e.solve << ", \"iter\": " << e.iter;
+            write_json_field(os, "primal_obj", e.primal_obj);
+            write_json_field(os, "dual_obj", e.dual_obj);
+            write_json_field(os, "duality_gap", e.duality_gap);
+            write_json_field(os, "primal_inf", e.primal_inf);
+            write_json_field(os, "dual_inf", e.dual_inf);
+            write_json_field(os, "rho", e.rho);
+            write_json_field(os, "delta", e.delta);
+            write_json_field(os, "mu", e.mu);
+            write_json_field(os, "sigma", e.sigma);
+            write_json_field(os, "primal_step", e.primal_step);
+            write_json_field(os, "dual_step", e.dual_step);
+            os << ", \"refine_iter\": " << e.refine_iter << ", \"factor_retires\": " << e.factor_retires;
+            write_json_field(os, "factor_time", e.factor_time);
+            write_json_field(os, "predictor_time", e.predictor_time);
+            write_json_field(os, "corrector_time", e.corrector_time);
+            write_json_field(os, "residual_time", e.residual_time);
+            os << '}';
+        }
+        os << (m_size > 0 ? "\n]\n" : "]\n");
+        os.precision(precision);
+    }
+
+    std::string to_csv() const
+    {
+        std::ostringstream os;
+        write_csv(os);
+        return os.str();
+    }
+
+    std::string to_json() const
+    {
+        std::ostringstream os;
+        write_json(os);
+        return os.str();
+    }
+
+protected:
+    static void write_json_field(std::ostream& os, const char* name, const T& x)
+    {
+        using std::isfinite;
+        os << ", \"" << name << "\": ";
+        // JSON has no representation for inf and nan
+        if (isfinite(x))
+        {
+            os << x;
+        }
+        else
+        {
+            os << "null";
+        }
+    }
+};
+
+} // namespace piqp
+
+#endif //PIQP_TRACE_HPP
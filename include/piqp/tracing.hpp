@@ -0,0 +1,224 @@
+// This file is part of PIQP.
+//
+// Copyright (c) 2024 EPFL
+//
+// This source code is licensed under the BSD 2-Clause License found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef PIQP_TRACING_HPP
+#define PIQP_TRACING_HPP
+
+// Tracing of solver phases in the Chrome/Perfetto trace event format.
+// Tracing is disabled by default and all macros expand to nothing,
+// define PIQP_WITH_TRACING (cmake option ENABLE_TRACING) to enable it.
+
+#ifdef PIQP_WITH_TRACING
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace piqp
+{
+
+namespace tracing
+{
+
+struct Event
+{
+    const char* name;   // has to be a string literal
+    std::int64_t solver_id;
+    std::int64_t thread_id;
+    std::int64_t begin; // in nanoseconds since the creation of the recorder
+    std::int64_t duration;
+};
+
+// optional callbacks invoked on entering and leaving a span,
+// e.g., to read hardware performance counters per solver phase
+struct Hooks
+{
+    void (*begin)(const char* name, void* user_data) = nullptr;
+    void (*end)(const char* name, void* user_data) = nullptr;
+    void* user_data = nullptr;
+};
+
+class Recorder
+{
+protected:
+    std::chrono::time_point<std::chrono::steady_clock> m_epoch;
+    std::mutex m_mutex;
+    std::vector<Event> m_events;
+    std::atomic<bool> m_recording{true};
+    Hooks m_hooks;
+
+    Recorder() : m_epoch(std::chrono::steady_clock::now())
+    {
+        m_events.reserve(1 << 16);
+    }
+
+public:
+    static Recorder& instance()
+    {
+        static Recorder recorder;
+        return recorder;
+    }
+
+    std::int64_t now() const noexcept
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_epoch).count();
+    }
+
+    // enables or disables the recording of events, hooks are called regardless
+    void set_recording(bool recording) noexcept { m_recording = recording; }
+
+    bool recording() const noexcept { return m_recording; }
+
+    // hooks are not synchronized, they should only be changed while no solver is running
+    void set_hooks(const Hooks& hooks) noexcept { m_hooks = hooks; }
+
+    const Hooks& hooks() const noexcept { return m_hooks; }
+
+    void record(const Event& event)
+    {
+        if (!m_recording) return;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_events.push_back(event);
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_events.clear();
+    }
+
+    std::vector<Event> events()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_events;
+    }
+
+    void write_chrome_trace(std::ostream& os)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // complete events, timestamps and durations are in microseconds,
+        // each solver instance is shown as its own process
+        os << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+        for (std::size_t i = 0; i < m_events.size(); i++)
+        {
+            const Event& e = m_events[i];
+            if (i > 0) os << ',';
+            os << "\n  {\"name\": \"" << e.name << "\", \"cat\": \"piqp\", \"ph\": \"X\""
+               << ", \"ts\": " << e.begin / 1000 << '.' << pad3(e.begin % 1000)
+               << ", \"dur\": " << e.duration / 1000 << '.' << pad3(e.duration % 1000)
+               << ", \"pid\": " << e.solver_id << ", \"tid\": " << e.thread_id
+               << ", \"args\": {\"solver\": " << e.solver_id << "}}";
+        }
+        os << "\n]}\n";
+    }
+
+    bool save_chrome_trace(const std::string& path)
+    {
+        std::ofstream file(path);
+        if (!file.is_open()) return false;
+        write_chrome_trace(file);
+        return file.good();
+    }
+
+protected:
+    static std::string pad3(std::int64_t x)
+    {
+        std::string s = std::to_string(x);
+        return std::string(3 - s.size(), '0') + s;
+    }
+};
+
+inline std::int64_t next_solver_id() noexcept
+{
+    static std::atomic<std::int64_t> counter{0};
+    return counter++;
+}
+
+inline std::int64_t thread_id() noexcept
+{
+    static std::atomic<std::int64_t> counter{0};
+    thread_local std::int64_t id = counter++;
+    return id;
+}
+
+// solver id of the solver currently running on this thread
+inline std::int64_t& current_solver_id() noexcept
+{
+    thread_local std::int64_t id = -1;
+    return id;
+}
+
+class SolverScope
+{
+protected:
+    std::int64_t m_prev_id;
+
+public:
+    explicit SolverScope(std::int64_t id) noexcept : m_prev_id(current_solver_id())
+    {
+        current_solver_id() = id;
+    }
+
+    ~SolverScope() noexcept
+    {
+        current_solver_id() = m_prev_id;
+    }
+
+    SolverScope(const SolverScope&) = delete;
+    SolverScope& operator=(const SolverScope&) = delete;
+};
+
+class Span
+{
+protected:
+    const char* m_name;
+    std::int64_t m_begin;
+
+public:
+    explicit Span(const char* name) noexcept : m_name(name)
+    {
+        Recorder& recorder = Recorder::instance();
+        const Hooks& hooks = recorder.hooks();
+        if (hooks.begin) hooks.begin(m_name, hooks.user_data);
+        m_begin = recorder.now();
+    }
+
+    ~Span()
+    {
+        Recorder& recorder = Recorder::instance();
+        std::int64_t end = recorder.now();
+        const Hooks& hooks = recorder.hooks();
+        if (hooks.end) hooks.end(m_name, hooks.user_data);
+        recorder.record({m_name, current_solver_id(), thread_id(), m_begin, end - m_begin});
+    }
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+};
+
+} // namespace tracing
+
+} // namespace piqp
+
+#define PIQP_TRACE_CONCAT_IMPL(a, b) a##b
+#define PIQP_TRACE_CONCAT(a, b) PIQP_TRACE_CONCAT_IMPL(a, b)
+#define PIQP_TRACE_SCOPE(name) ::piqp::tracing::Span PIQP_TRACE_CONCAT(piqp_trace_span_, __LINE__)(name)
+#define PIQP_TRACE_SOLVER_SCOPE(id) ::piqp::tracing::SolverScope PIQP_TRACE_CONCAT(piqp_trace_solver_scope_, __LINE__)(id)
+
+#else
+
+#define PIQP_TRACE_SCOPE(name)
+#define PIQP_TRACE_SOLVER_SCOPE(id)
+
+#endif
+
+#endif //PIQP_TRACING_HPP
@@ -8,6 +8,9 @@
 #ifndef PIQP_UTILS_FILESYSTEM_HPP
 #define PIQP_UTILS_FILESYSTEM_HPP
 
+#include <cstdlib>
+#include <string>
+
 #include "piqp/fwd.hpp"
 
 #ifdef PIQP_STD_FILESYSTEM
@@ -27,6 +30,22 @@ namespace fs = std::filesystem;
 namespace fs = ghc::filesystem;
 #endif
 
+// per-user cache directory of PIQP for machine dependent data,
+// empty if it can't be determined
+inline std::string user_cache_dir()
+{
+#ifdef _WIN32
+    const char* cache_dir = std::getenv("LOCALAPPDATA");
+    if (cache_dir) return std::string(cache_dir) + "\\piqp";
+#else
+    const char* cache_dir = std::getenv("XDG_CACHE_HOME");
+    if (cache_dir) return std::string(cache_dir) + "/piqp";
+    const char* home = std::getenv("HOME");
+    if (home) return std::string(home) + "/.cache/piqp";
+#endif
+    return "";
+}
+
 } // namespace piqp
 
 #endif //PIQP_UTILS_FILESYSTEM_HPP
@@ -0,0 +1,39 @@
+// This file is part of PIQP.
+//
+// Copyright (c) 2024 EPFL
+//
+// This source code is licensed under the BSD 2-Clause License found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef PIQP_UTILS_MEMORY_HPP
+#define PIQP_UTILS_MEMORY_HPP
+
+#include "piqp/typedefs.hpp"
+
+namespace piqp
+{
+
+// number of heap allocated bytes of a dense Eigen object
+template<typename Derived>
+isize memory_bytes(const Eigen::PlainObjectBase<Derived>& x)
+{
+    return isize(x.size()) * isize(sizeof(typename Derived::Scalar));
+}
+
+// number of heap allocated bytes of a compressed sparse Eigen matrix
+template<typename T, typename I>
+isize memory_bytes(const SparseMat<T, I>& x)
+{
+    return isize(x.outerSize() + 1) * isize(sizeof(I))
+           + isize(x.nonZeros()) * isize(sizeof(I) + sizeof(T));
+}
+
+template<typename First, typename Second, typename... Rest>
+isize memory_bytes(const First& first, const Second& second, const Rest&... rest)
+{
+    return memory_bytes(first) + memory_bytes(second, rest...);
+}
+
+} // namespace piqp
+
+#endif //PIQP_UTILS_MEMORY_HPP
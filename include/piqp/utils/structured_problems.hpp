@@ -0,0 +1,465 @@
+// This file is part of PIQP.
+//
+// Copyright (c) 2024 EPFL
+//
+// This source code is licensed under the BSD 2-Clause License found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef PIQP_UTILS_STRUCTURED_PROBLEMS_HPP
+#define PIQP_UTILS_STRUCTURED_PROBLEMS_HPP
+
+#include <vector>
+#include <algorithm>
+
+#include "piqp/typedefs.hpp"
+#include "piqp/sparse/model.hpp"
+#include "piqp/stagewise/model.hpp"
+#include "piqp/utils/random_utils.hpp"
+
+// Random instances of common structured QP families, the formulations follow
+// Stellato et al., "OSQP: an operator splitting solver for quadratic programs",
+// Math. Prog. Comp., 2020. All problems are feasible by construction and P is
+// stored as an upper triangular matrix. Dense models can be obtained with
+// Model::dense_model().
+
+namespace piqp
+{
+
+namespace rand
+{
+
+namespace detail
+{
+
+template<typename T, typename I>
+SparseMat<T, I> from_triplets(isize rows, isize cols, const std::vector<Eigen::Triplet<T, I>>& triplets)
+{
+    SparseMat<T, I> A(rows, cols);
+    A.setFromTriplets(triplets.begin(), triplets.end());
+    A.makeCompressed();
+    return A;
+}
+
+template<typename T, typename I>
+void add_diagonal(std::vector<Eigen::Triplet<T, I>>& triplets, isize offset, const Vec<T>& diag)
+{
+    for (isize i = 0; i < diag.rows(); i++) {
+        triplets.emplace_back(I(offset + i), I(offset + i), diag(i));
+    }
+}
+
+template<typename T, typename I>
+void add_sparse_rand(std::vector<Eigen::Triplet<T, I>>& triplets, isize row_offset, isize col_offset,
+                     isize rows, isize cols, T density, T scale = T(1))
+{
+    for (isize i = 0; i < rows; i++) {
+        for (isize j = 0; j < cols; j++) {
+            if (uniform_dist(gen) < density) {
+                triplets.emplace_back(I(row_offset + i), I(col_offset + j), scale * T(normal_dist(gen)));
+            }
+        }
+    }
+}
+
+} // namespace detail
+
+// Multistage model predictive control problem with box constrained states and inputs
+//   min  sum_k x_k^T Q x_k + u_k^T R u_k + x_N^T Q_N x_N
+//   s.t. x_{k+1} = A x_k + B u_k, x_0 = x_init,
+//        |x_k| <= x_bar, |u_k| <= u_bar
+// with variables [x_0, ..., x_N, u_0, ..., u_{N-1}].
+// The dynamics are scaled such that ||A||_inf <= 1, hence u = 0 is always feasible.
+template<typename T, typename I>
+sparse::Model<T, I> mpc_qp(isize nx, isize nu, isize horizon)
+{
+    using Triplet = Eigen::Triplet<T, I>;
+    const isize N = horizon;
+    const isize n = (N + 1) * nx + N * nu;
+    const isize p = (N + 1) * nx;
+    const T x_bar = 5;
+    const T u_bar = 1;
+
+    // dynamics A = I + 0.1 * sprandn, B = sprandn
+    Mat<T> Ad = Mat<T>::Identity(nx, nx);
+    for (isize i = 0; i < nx; i++) {
+        for (isize j = 0; j < nx; j++) {
+            if (uniform_dist(gen) < std::min(T(1), T(3) / T(nx))) Ad(i, j) += T(0.1) * T(normal_dist(gen));
+        }
+    }
+    T A_norm = Ad.cwiseAbs().rowwise().sum().maxCoeff();
+    if (A_norm > 1) Ad /= A_norm;
+    Mat<T> Bd = Mat<T>::Zero(nx, nu);
+    for (isize i = 0; i < nx; i++) {
+        for (isize j = 0; j < nu; j++) {
+            if (uniform_dist(gen) < T(0.5)) Bd(i, j) = T(normal_dist(gen));
+        }
+    }
+
+    Vec<T> q_diag(nx);
+    for (isize i = 0; i < nx; i++) q_diag(i) = uniform_dist(gen) < 0.7 ? T(10) * T(uniform_dist(gen)) : T(0);
+    Vec<T> r_diag = Vec<T>::Constant(nu, T(0.1));
+    Vec<T> qn_diag = q_diag.array() + T(1);
+
+    std::vector<Triplet> P_triplets;
+    for (isize k = 0; k < N; k++) detail::add_diagonal<T, I>(P_triplets, k * nx, q_diag);
+    detail::add_diagonal<T, I>(P_triplets, N * nx, qn_diag);
+    for (isize k = 0; k < N; k++) detail::add_diagonal<T, I>(P_triplets, (N + 1) * nx + k * nu, r_diag);
+
+    // -x_0 = -x_init, A x_k + B u_k - x_{k+1} = 0
+    std::vector<Triplet> A_triplets;
+    for (isize i = 0; i < nx; i++) A_triplets.emplace_back(I(i), I(i), T(-1));
+    for (isize k = 0; k < N; k++) {
+        isize row = (k + 1) * nx;
+        for (isize i = 0; i < nx; i++) {
+            for (isize j = 0; j < nx; j++) {
+                if (Ad(i, j) != 0) A_triplets.emplace_back(I(row + i), I(k * nx + j), Ad(i, j));
+            }
+            for (isize j = 0; j < nu; j++) {
+                if (Bd(i, j) != 0) A_triplets.emplace_back(I(row + i), I((N + 1) * nx + k * nu + j), Bd(i, j));
+            }
+            A_triplets.emplace_back(I(row + i), I(row + i), T(-1));
+        }
+    }
+
+    Vec<T> x_init(nx);
+    for (isize i = 0; i < nx; i++) x_init(i) = x_bar * T(0.5) * (T(2) * T(uniform_dist(gen)) - T(1));
+    Vec<T> b = Vec<T>::Zero(p);
+    b.head(nx) = -x_init;
+
+    Vec<T> x_lb(n), x_ub(n);
+    x_lb.head((N + 1) * nx).setConstant(-x_bar);
+    x_ub.head((N + 1) * nx).setConstant(x_bar);
+    x_lb.tail(N * nu).setConstant(-u_bar);
+    x_ub.tail(N * nu).setConstant(u_bar);
+
+    SparseMat<T, I> P = detail::from_triplets<T, I>(n, n, P_triplets);
+    SparseMat<T, I> A = detail::from_triplets<T, I>(p, n, A_triplets);
+    SparseMat<T, I> G(0, n);
+    return sparse::Model<T, I>(P, Vec<T>::Zero(n), A, b, G, Vec<T>(0), x_lb, x_ub);
+}
+
+// Factor model portfolio optimization with n assets and k factors
+//   min  x^T D x + y^T y - mu^T x / gamma
+//   s.t. y = F^T x, 1^T x = 1, x >= 0
+// with variables [x, y].
+template<typename T, typename I>
+sparse::Model<T, I> portfolio_qp(isize n_assets, isize n_factors, T gamma = T(1))
+{
+    using Triplet = Eigen::Triplet<T, I>;
+    const isize n = n_assets + n_factors;
+    const isize k = n_factors;
+
+    Vec<T> d(n_assets);
+    for (isize i = 0; i < n_assets; i++) d(i) = T(2) * T(uniform_dist(gen)) * std::sqrt(T(k));
+    Vec<T> mu = vector_rand<T>(n_assets);
+
+    std::vector<Triplet> P_triplets;
+    detail::add_diagonal<T, I>(P_triplets, 0, d);
+    detail::add_diagonal<T, I>(P_triplets, n_assets, Vec<T>::Constant(k, T(2)));
+
+    // F^T x - y = 0, 1^T x = 1
+    std::vector<Triplet> A_triplets;
+    detail::add_sparse_rand<T, I>(A_triplets, 0, 0, k, n_assets, T(0.5));
+    for (isize i = 0; i < k; i++) A_triplets.emplace_back(I(i), I(n_assets + i), T(-1));
+    for (isize j = 0; j < n_assets; j++) A_triplets.emplace_back(I(k), I(j), T(1));
+
+    Vec<T> c = Vec<T>::Zero(n);
+    c.head(n_assets) = -mu / gamma;
+    Vec<T> b = Vec<T>::Zero(k + 1);
+    b(k) = 1;
+
+    Vec<T> x_lb = Vec<T>::Constant(n, -std::numeric_limits<T>::infinity());
+    Vec<T> x_ub = Vec<T>::Constant(n, std::numeric_limits<T>::infinity());
+    x_lb.head(n_assets).setZero();
+
+    SparseMat<T, I> P = detail::from_triplets<T, I>(n, n, P_triplets);
+    SparseMat<T, I> A = detail::from_triplets<T, I>(k + 1, n, A_triplets);
+    SparseMat<T, I> G(0, n);
+    return sparse::Model<T, I>(P, c, A, b, G, Vec<T>(0), x_lb, x_ub);
+}
+
+// Lasso regression with n features and m data points
+//   min  1/2 y^T y + lambda 1^T t
+//   s.t. y = A_d x - b_d, -t <= x <= t
+// with variables [x, y, t].
+template<typename T, typename I>
+sparse::Model<T, I> lasso_qp(isize n_features, isize n_data)
+{
+    using Triplet = Eigen::Triplet<T, I>;
+    const isize nf = n_features;
+    const isize m = n_data;
+    const isize n = 2 * nf + m;
+
+    std::vector<Triplet> Ad_triplets;
+    detail::add_sparse_rand<T, I>(Ad_triplets, 0, 0, m, nf, T(0.15));
+    SparseMat<T, I> Ad = detail::from_triplets<T, I>(m, nf, Ad_triplets);
+    Vec<T> x_true(nf);
+    for (isize i = 0; i < nf; i++) x_true(i) = uniform_dist(gen) < 0.5 ? T(normal_dist(gen)) / std::sqrt(T(nf)) : T(0);
+    Vec<T> bd = Ad * x_true + vector_rand<T>(m);
+    T lambda = (Ad.transpose() * bd).template lpNorm<Eigen::Infinity>() / T(5);
+
+    std::vector<Triplet> P_triplets;
+    detail::add_diagonal<T, I>(P_triplets, nf, Vec<T>::Ones(m));
+
+    // A_d x - y = b_d
+    std::vector<Triplet> A_triplets = Ad_triplets;
+    for (isize i = 0; i < m; i++) A_triplets.emplace_back(I(i), I(nf + i), T(-1));
+
+    // x - t <= 0, -x - t <= 0
+    std::vector<Triplet> G_triplets;
+    for (isize i = 0; i < nf; i++) {
+        G_triplets.emplace_back(I(i), I(i), T(1));
+        G_triplets.emplace_back(I(i), I(nf + m + i), T(-1));
+        G_triplets.emplace_back(I(nf + i), I(i), T(-1));
+        G_triplets.emplace_back(I(nf + i), I(nf + m + i), T(-1));
+    }
+
+    Vec<T> c = Vec<T>::Zero(n);
+    c.tail(nf).setConstant(lambda);
+
+    SparseMat<T, I> P = detail::from_triplets<T, I>(n, n, P_triplets);
+    SparseMat<T, I> A = detail::from_triplets<T, I>(m, n, A_triplets);
+    SparseMat<T, I> G = detail::from_triplets<T, I>(2 * nf, n, G_triplets);
+    return sparse::Model<T, I>(P, c, A, bd, G, Vec<T>::Zero(2 * nf), nullopt, nullopt);
+}
+
+// Huber fitting with n features and m data points, 5% of the data are outliers
+//   min  u^T u + 2 * 1^T (r + s)
+//   s.t. A_d x - b_d = u + r - s, r >= 0, s >= 0
+// with variables [x, u, r, s].
+template<typename T, typename I>
+sparse::Model<T, I> huber_qp(isize n_features, isize n_data)
+{
+    using Triplet = Eigen::Triplet<T, I>;
+    const isize nf = n_features;
+    const isize m = n_data;
+    const isize n = nf + 3 * m;
+
+    std::vector<Triplet> Ad_triplets;
+    detail::add_sparse_rand<T, I>(Ad_triplets, 0, 0, m, nf, T(0.15));
+    SparseMat<T, I> Ad = detail::from_triplets<T, I>(m, nf, Ad_triplets);
+    Vec<T> x_true = vector_rand<T>(nf) / std::sqrt(T(nf));
+    Vec<T> bd = Ad * x_true;
+    for (isize i = 0; i < m; i++) {
+        bd(i) += uniform_dist(gen) < 0.95 ? T(normal_dist(gen)) / T(2) : T(10) * T(normal_dist(gen));
+    }
+
+    std::vector<Triplet> P_triplets;
+    detail::add_diagonal<T, I>(P_triplets, nf, Vec<T>::Constant(m, T(2)));
+
+    // A_d x - u - r + s = b_d
+    std::vector<Triplet> A_triplets = Ad_triplets;
+    for (isize i = 0; i < m; i++) {
+        A_triplets.emplace_back(I(i), I(nf + i), T(-1));
+        A_triplets.emplace_back(I(i), I(nf + m + i), T(-1));
+        A_triplets.emplace_back(I(i), I(nf + 2 * m + i), T(1));
+    }
+
+    Vec<T> c = Vec<T>::Zero(n);
+    c.tail(2 * m).setConstant(T(2));
+
+    Vec<T> x_lb = Vec<T>::Constant(n, -std::numeric_limits<T>::infinity());
+    x_lb.tail(2 * m).setZero();
+
+    SparseMat<T, I> P = detail::from_triplets<T, I>(n, n, P_triplets);
+    SparseMat<T, I> A = detail::from_triplets<T, I>(m, n, A_triplets);
+    SparseMat<T, I> G(0, n);
+    return sparse::Model<T, I>(P, c, A, bd, G, Vec<T>(0), x_lb, nullopt);
+}
+
+// Support vector machine with n features and m data points of two classes
+//   min  x^T x + lambda 1^T t
+//   s.t. t >= diag(b_d) A_d x + 1, t >= 0
+// with variables [x, t].
+template<typename T, typename I>
+sparse::Model<T, I> svm_qp(isize n_features, isize n_data, T lambda = T(1))
+{
+    using Triplet = Eigen::Triplet<T, I>;
+    const isize nf = n_features;
+    const isize m = n_data;
+    const isize n = nf + m;
+
+    std::vector<Triplet> P_triplets;
+    detail::add_diagonal<T, I>(P_triplets, 0, Vec<T>::Constant(nf, T(2)));
+
+    // diag(b_d) A_d x - t <= -1, first half of the data belongs to class +1
+    std::vector<Triplet> G_triplets;
+    for (isize i = 0; i < m; i++) {
+        T label = i < m / 2 ? T(1) : T(-1);
+        for (isize j = 0; j < nf; j++) {
+            if (uniform_dist(gen) < 0.15) {
+                G_triplets.emplace_back(I(i), I(j), label * (label / T(nf) + T(normal_dist(gen)) / T(nf)));
+            }
+        }
+        G_triplets.emplace_back(I(i), I(nf + i), T(-1));
+    }
+
+    Vec<T> c = Vec<T>::Zero(n);
+    c.tail(m).setConstant(lambda);
+
+    Vec<T> x_lb = Vec<T>::Constant(n, -std::numeric_limits<T>::infinity());
+    x_lb.tail(m).setZero();
+
+    SparseMat<T, I> P = detail::from_triplets<T, I>(n, n, P_triplets);
+    SparseMat<T, I> A(0, n);
+    SparseMat<T, I> G = detail::from_triplets<T, I>(m, n, G_triplets);
+    return sparse::Model<T, I>(P, c, A, Vec<T>(0), G, Vec<T>::Constant(m, T(-1)), x_lb, nullopt);
+}
+
+// Control allocation of n actuators to k virtual controls with rate limits
+//   min  e^T W e + eps ||u - u_pref||^2
+//   s.t. B u - e = v, u_min <= u <= u_max, |u - u_prev| <= du
+// with variables [u, e]. The effectiveness matrix B is dense.
+template<typename T, typename I>
+sparse::Model<T, I> control_allocation_qp(isize n_actuators, isize n_virtual = 6, T eps = T(1e-3))
+{
+    using Triplet = Eigen::Triplet<T, I>;
+    const isize na = n_actuators;
+    const isize k = n_virtual;
+    const isize n = na + k;
+    const T du = T(0.2);
+
+    Vec<T> u_pref = Vec<T>::Zero(na);
+    Vec<T> u_prev(na);
+    for (isize i = 0; i < na; i++) u_prev(i) = T(2) * T(uniform_dist(gen)) - T(1);
+    Vec<T> v = vector_rand<T>(k) * std::sqrt(T(na));
+
+    std::vector<Triplet> P_triplets;
+    detail::add_diagonal<T, I>(P_triplets, 0, Vec<T>::Constant(na, T(2) * eps));
+    Vec<T> w(k);
+    for (isize i = 0; i < k; i++) w(i) = T(2) * (T(1) + T(9) * T(uniform_dist(gen)));
+    detail::add_diagonal<T, I>(P_triplets, na, w);
+
+    // B u - e = v
+    std::vector<Triplet> A_triplets;
+    detail::add_sparse_rand<T, I>(A_triplets, 0, 0, k, na, T(1));
+    for (isize i = 0; i < k; i++) A_triplets.emplace_back(I(i), I(na + i), T(-1));
+
+    // u <= u_prev + du, -u <= -(u_prev - du)
+    std::vector<Triplet> G_triplets;
+    for (isize i = 0; i < na; i++) {
+        G_triplets.emplace_back(I(i), I(i), T(1));
+        G_triplets.emplace_back(I(na + i), I(i), T(-1));
+    }
+    Vec<T> h(2 * na);
+    h.head(na) = u_prev.array() + du;
+    h.tail(na) = -(u_prev.array() - du);
+
+    Vec<T> c = Vec<T>::Zero(n);
+    c.head(na) = -T(2) * eps * u_pref;
+
+    Vec<T> x_lb = Vec<T>::Constant(n, -std::numeric_limits<T>::infinity());
+    Vec<T> x_ub = Vec<T>::Constant(n, std::numeric_limits<T>::infinity());
+    x_lb.head(na).setConstant(T(-1));
+    x_ub.head(na).setConstant(T(1));
+
+    SparseMat<T, I> P = detail::from_triplets<T, I>(n, n, P_triplets);
+    SparseMat<T, I> A = detail::from_triplets<T, I>(k, n, A_triplets);
+    SparseMat<T, I> G = detail::from_triplets<T, I>(2 * na, n, G_triplets);
+    return sparse::Model<T, I>(P, c, A, v, G, h, x_lb, x_ub);
+}
+
+// Problem consisting of the given independent problems, i.e., with block diagonal P, A and G.
+template<typename T, typename I>
+sparse::Model<T, I> block_diagonal_qp(const std::vector<sparse::Model<T, I>>& models)
+{
+    isize n = 0, p = 0, m = 0;
+    for (const sparse::Model<T, I>& model : models) {
+        n += model.P.rows();
+        p += model.A.rows();
+        m += model.G.rows();
+    }
+
+    std::vector<Eigen::Triplet<T, I>> P_triplets, A_triplets, G_triplets;
+    Vec<T> c(n), b(p), h(m), x_lb(n), x_ub(n);
+    isize n_off = 0, p_off = 0, m_off = 0;
+    for (const sparse::Model<T, I>& model : models) {
+        for (isize j = 0; j < model.P.outerSize(); j++) {
+            for (typename SparseMat<T, I>::InnerIterator it(model.P, j); it; ++it) P_triplets.emplace_back(I(n_off + it.row()), I(n_off + j), it.value());
+            for (typename SparseMat<T, I>::InnerIterator it(model.A, j); it; ++it) A_triplets.emplace_back(I(p_off + it.row()), I(n_off + j), it.value());
+            for (typename SparseMat<T, I>::InnerIterator it(model.G, j); it; ++it) G_triplets.emplace_back(I(m_off + it.row()), I(n_off + j), it.value());
+        }
+        c.segment(n_off, model.P.rows()) = model.c;
+        x_lb.segment(n_off, model.P.rows()) = model.x_lb;
+        x_ub.segment(n_off, model.P.rows()) = model.x_ub;
+        b.segment(p_off, model.A.rows()) = model.b;
+        h.segment(m_off, model.G.rows()) = model.h;
+        n_off += model.P.rows();
+        p_off += model.A.rows();
+        m_off += model.G.rows();
+    }
+
+    return sparse::Model<T, I>(detail::from_triplets<T, I>(n, n, P_triplets), c,
+                               detail::from_triplets<T, I>(p, n, A_triplets), b,
+                               detail::from_triplets<T, I>(m, n, G_triplets), h, x_lb, x_ub);
+}
+
+// Model predictive control problem of mpc_qp in stagewise form, with additional
+// coupled state and input constraints |C x_k + D u_k| <= d,
+// with variables [x_0, u_0, x_1, u_1, ..., x_N].
+template<typename T, typename I>
+stagewise::Model<T, I> stagewise_mpc_qp(isize nx, isize nu, isize horizon, isize n_path = 0)
+{
+    const isize N = horizon;
+    const T x_bar = 5;
+    const T u_bar = 1;
+
+    Mat<T> Ad = Mat<T>::Identity(nx, nx);
+    for (isize i = 0; i < nx; i++) {
+        for (isize j = 0; j < nx; j++) {
+            if (uniform_dist(gen) < std::min(T(1), T(3) / T(nx))) Ad(i, j) += T(0.1) * T(normal_dist(gen));
+        }
+    }
+    T A_norm = Ad.cwiseAbs().rowwise().sum().maxCoeff();
+    if (A_norm > 1) Ad /= A_norm;
+    Mat<T> Bd = Mat<T>::Zero(nx, nu);
+    for (isize i = 0; i < nx; i++) {
+        for (isize j = 0; j < nu; j++) {
+            if (uniform_dist(gen) < T(0.5)) Bd(i, j) = T(normal_dist(gen));
+        }
+    }
+
+    // |x_k| <= x_bar / 2 for u = 0, hence the constraints are feasible
+    Mat<T> C = Mat<T>::Zero(2 * n_path, nx);
+    Mat<T> D = Mat<T>::Zero(2 * n_path, nu);
+    for (isize i = 0; i < n_path; i++) {
+        for (isize j = 0; j < nx; j++) C(i, j) = T(normal_dist(gen)) / T(nx);
+        for (isize j = 0; j < nu; j++) D(i, j) = T(normal_dist(gen)) / T(nu);
+    }
+    C.bottomRows(n_path) = -C.topRows(n_path);
+    D.bottomRows(n_path) = -D.topRows(n_path);
+    Vec<T> d = C.cwiseAbs().rowwise().sum() * x_bar / T(2) + D.cwiseAbs().rowwise().sum() * u_bar;
+    d.array() += T(1);
+
+    Vec<T> q_diag(nx);
+    for (isize i = 0; i < nx; i++) q_diag(i) = uniform_dist(gen) < 0.7 ? T(10) * T(uniform_dist(gen)) : T(0);
+
+    std::vector<stagewise::Stage<T>> stages(std::size_t(N + 1));
+    for (isize k = 0; k <= N; k++)
+    {
+        stagewise::Stage<T>& stage = stages[std::size_t(k)];
+        bool terminal = k == N;
+        stage.Q = (terminal ? Vec<T>(q_diag.array() + T(1)) : q_diag).asDiagonal();
+        stage.R = Mat<T>::Identity(terminal ? 0 : nu, terminal ? 0 : nu) * T(0.1);
+        stage.x_lb = Vec<T>::Constant(nx, -x_bar);
+        stage.x_ub = Vec<T>::Constant(nx, x_bar);
+        if (terminal) continue;
+        stage.A = Ad;
+        stage.B = Bd;
+        stage.C = C;
+        stage.D = D;
+        stage.d = d;
+        stage.u_lb = Vec<T>::Constant(nu, -u_bar);
+        stage.u_ub = Vec<T>::Constant(nu, u_bar);
+    }
+
+    Vec<T> x_init(nx);
+    for (isize i = 0; i < nx; i++) x_init(i) = x_bar * T(0.5) * (T(2) * T(uniform_dist(gen)) - T(1));
+    return stagewise::Model<T, I>(stages, x_init);
+}
+
+} // namespace rand
+
+} // namespace piqp
+
+#endif //PIQP_UTILS_STRUCTURED_PROBLEMS_HPP
@@ -0,0 +1,154 @@
+// This file is part of PIQP.
+//
+// Copyright (c) 2024 EPFL
+//
+// This source code is licensed under the BSD 2-Clause License found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef PIQP_UTILS_THREAD_POOL_HPP
+#define PIQP_UTILS_THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "piqp/typedefs.hpp"
+
+namespace piqp
+{
+
+// Minimal fork-join thread pool owned by a single solver. The calling thread
+// takes part in the work, i.e., a pool with n threads spawns n - 1 workers.
+// Nested calls to parallel_for are executed serially by the calling thread.
+class ThreadPool
+{
+public:
+    explicit ThreadPool(isize n_threads = 1) { resize(n_threads); }
+
+    ~ThreadPool() { stop(); }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    isize n_threads() const { return isize(m_workers.size()) + 1; }
+
+    // number of threads used if n_threads is set to 0
+    static isize hardware_threads()
+    {
+        unsigned n = std::thread::hardware_concurrency();
+        return n > 0 ? isize(n) : 1;
+    }
+
+    // n_threads <= 0 uses all hardware threads
+    void resize(isize n_threads)
+    {
+        if (n_threads <= 0) n_threads = hardware_threads();
+        if (n_threads == this->n_threads()) return;
+
+        stop();
+        m_stop = false;
+        m_workers.reserve(std::size_t(n_threads - 1));
+        std::size_t generation = m_generation;
+        for (isize i = 1; i < n_threads; i++)
+        {
+            m_workers.emplace_back([this, generation]() { worker_loop(generation); });
+        }
+    }
+
+    // calls f(i) for i = 0, ..., n_tasks - 1, tasks are handed out in increasing order
+    template<typename F>
+    void parallel_for(isize n_tasks, const F& f)
+    {
+        if (n_tasks <= 0) return;
+        if (m_workers.empty() || n_tasks == 1 || in_parallel_region())
+        {
+            for (isize i = 0; i < n_tasks; i++) f(i);
+            return;
+        }
+
+        std::function<void(isize)> task = [&f](isize i) { f(i); };
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_task = &task;
+            m_n_tasks = n_tasks;
+            m_next_task.store(0);
+            m_n_busy = m_workers.size();
+            m_generation++;
+        }
+        m_start.notify_all();
+
+        run_tasks();
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this]() { return m_n_busy == 0; });
+        m_task = nullptr;
+    }
+
+protected:
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_start;
+    std::condition_variable m_done;
+    bool m_stop = false;
+    std::size_t m_generation = 0;
+    std::size_t m_n_busy = 0;
+
+    const std::function<void(isize)>* m_task = nullptr;
+    isize m_n_tasks = 0;
+    std::atomic<isize> m_next_task{0};
+
+    static bool& in_parallel_region()
+    {
+        static thread_local bool in_region = false;
+        return in_region;
+    }
+
+    void run_tasks()
+    {
+        in_parallel_region() = true;
+        for (isize i = m_next_task.fetch_add(1); i < m_n_tasks; i = m_next_task.fetch_add(1))
+        {
+            (*m_task)(i);
+        }
+        in_parallel_region() = false;
+    }
+
+    // generation is the number of jobs posted before the worker was created
+    void worker_loop(std::size_t generation)
+    {
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_start.wait(lock, [&]() { return m_stop || m_generation != generation; });
+                if (m_stop) return;
+                generation = m_generation;
+            }
+
+            run_tasks();
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (--m_n_busy == 0) m_done.notify_one();
+            }
+        }
+    }
+
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_start.notify_all();
+        for (std::thread& worker : m_workers) worker.join();
+        m_workers.clear();
+    }
+};
+
+} // namespace piqp
+
+#endif //PIQP_UTILS_THREAD_POOL_HPP
@@ -37,10 +37,41 @@ void piqp_update_sparse(piqp_workspace* workspace,
                         piqp_csc* G, piqp_float* h,
                         piqp_float* x_lb, piqp_float* x_ub);
 
+// Updates the sparse matrices by their values only. P_x, A_x and G_x have the non-zeros of the
+// matrices passed to piqp_setup_sparse in the same order, i.e., the sparsity pattern is unchanged.
+void piqp_update_sparse_values(piqp_workspace* workspace,
+                               piqp_float* P_x, piqp_float* c,
+                               piqp_float* A_x, piqp_float* b,
+                               piqp_float* G_x, piqp_float* h,
+                               piqp_float* x_lb, piqp_float* x_ub);
+
+// Starts the next solve from the given point instead of the default initial point, e.g., the
+// result of a previous solve. Any of the vectors can be NULL, z_lb and z_ub have size n.
+void piqp_warm_start(piqp_workspace* workspace,
+                     const piqp_float* x, const piqp_float* y, const piqp_float* z,
+                     const piqp_float* z_lb, const piqp_float* z_ub);
+
 piqp_status piqp_solve(piqp_workspace* workspace);
 
+// Starts the solve on a separate thread, callback can be NULL. The workspace must not be
+// used until piqp_wait returned, except for piqp_cancel.
+void piqp_solve_async(piqp_workspace* workspace, piqp_solve_callback callback, void* user_data);
+// Waits for a pending asynchronous solve and returns its status.
+piqp_status piqp_wait(piqp_workspace* workspace);
+// Requests to stop the running solve, can be called from any thread.
+void piqp_cancel(piqp_workspace* workspace);
+
+piqp_int piqp_trace_size(const piqp_workspace* workspace);
+piqp_int piqp_get_trace(const piqp_workspace* workspace, piqp_trace_entry* entries, piqp_int max_entries);
+void piqp_clear_trace(piqp_workspace* workspace);
+
 void piqp_cleanup(piqp_workspace* workspace);
 
+// Instruction set the solver was compiled for, i.e., "baseline", "sse42", "avx2" or "avx512".
+// With instruction set variants, this is the variant selected when the library was loaded,
+// or "none" if no variant could be loaded.
+const char* piqp_instruction_set(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -8,6 +8,8 @@
 #ifndef PIQP_TYPEDEF_H
 #define PIQP_TYPEDEF_H
 
+#include <stddef.h>
+
 # ifdef __cplusplus
 extern "C" {
 # endif
@@ -61,6 +63,14 @@ typedef struct {
     piqp_float* x_ub; // decision variables upper bounds x_ub (size n), can be NULL
 } piqp_data_sparse;
 
+typedef enum {
+    PIQP_KKT_AUTO = -1,           // sets up the mode whose KKT factorization has the fewest non-zeros by symbolic analysis
+    PIQP_KKT_FULL = 0,
+    PIQP_KKT_EQ_ELIMINATED = 1,   // equality constraints eliminated from the KKT system
+    PIQP_KKT_INEQ_ELIMINATED = 2, // inequality constraints eliminated from the KKT system
+    PIQP_KKT_ALL_ELIMINATED = 3   // both eliminated
+} piqp_kkt_mode;
+
 typedef struct {
     piqp_float rho_init;
     piqp_float delta_init;
@@ -75,6 +85,10 @@ typedef struct {
     piqp_int  reg_finetune_dual_update_threshold;
     piqp_int  max_iter;
     piqp_int  max_factor_retires;
+    piqp_float time_limit;
+    piqp_int  real_time;
+    piqp_int  real_time_max_factor_retires;
+    piqp_int  real_time_iterative_refinement_max_iter;
     piqp_int  preconditioner_scale_cost;
     piqp_int  preconditioner_iter;
     piqp_float tau;
@@ -87,6 +101,10 @@ typedef struct {
     piqp_float iterative_refinement_static_regularization_rel;
     piqp_int  verbose;
     piqp_int  compute_timings;
+    piqp_int  trace_capacity;
+    piqp_int  n_threads;
+    piqp_int  dense_ldlt_tuning;
+    piqp_kkt_mode kkt_mode; // only used by piqp_setup_sparse
 } piqp_settings;
 
 typedef enum {
@@ -94,6 +112,9 @@ typedef enum {
     PIQP_MAX_ITER_REACHED = -1,
     PIQP_PRIMAL_INFEASIBLE = -2,
     PIQP_DUAL_INFEASIBLE = -3,
+    PIQP_CANCELLED = -4,
+    PIQP_TIME_LIMIT_REACHED = -5,
+    PIQP_REAL_TIME_LIMIT_REACHED = -6,
     PIQP_NUMERICS = -8,
     PIQP_UNSOLVED = -9,
     PIQP_INVALID_SETTINGS = -10
@@ -124,6 +145,14 @@ typedef struct {
     piqp_float reg_limit;
     piqp_int no_primal_update;
     piqp_int no_dual_update;
+    piqp_int kkt_nnz;
+    piqp_int kkt_factor_nnz;
+    piqp_float kkt_fill_ratio;
+    piqp_float factor_flops;
+    piqp_float solve_flops;
+    piqp_int etree_height;
+    piqp_int etree_width;
+    size_t workspace_bytes;
 
     piqp_float setup_time;
     piqp_float update_time;
@@ -150,20 +179,54 @@ typedef struct {
     piqp_info info;
 } piqp_result;
 
+typedef struct {
+    piqp_int solve;
+    piqp_int iter;
+
+    piqp_float primal_obj;
+    piqp_float dual_obj;
+    piqp_float duality_gap;
+    piqp_float primal_inf;
+    piqp_float dual_inf;
+
+    piqp_float rho;
+    piqp_float delta;
+    piqp_float mu;
+    piqp_float sigma;
+    piqp_float primal_step;
+    piqp_float dual_step;
+
+    piqp_int refine_iter;
+    piqp_int factor_retires;
+
+    piqp_float factor_time;
+    piqp_float predictor_time;
+    piqp_float corrector_time;
+    piqp_float residual_time;
+} piqp_trace_entry;
+
 struct piqp_solver_handle; // An opaque type that we'll use as a handle for the C++ solver object
 typedef struct piqp_solver_handle piqp_solver_handle;
 
+struct piqp_async_handle; // An opaque handle of a solve running on another thread
+typedef struct piqp_async_handle piqp_async_handle;
+
+// called on the solving thread after an asynchronous solve finished and the result is updated
+typedef void (*piqp_solve_callback)(piqp_status status, void* user_data);
+
 typedef struct {
     piqp_int is_dense; // dense interface is being used
     piqp_int n;        // number of decision variables
     piqp_int p;        // number of equality constraints
     piqp_int m;        // number of inequality constraints
+    piqp_kkt_mode kkt_mode; // KKT mode of the sparse interface, PIQP_KKT_AUTO is resolved in setup
 } pipq_solver_info;
 
 typedef struct {
     piqp_solver_handle* solver_handle;
     pipq_solver_info    solver_info;
     piqp_result*       result;
+    piqp_async_handle*  async_handle; // pending asynchronous solve, NULL if there is none
 } piqp_workspace;
 
 # ifdef __cplusplus
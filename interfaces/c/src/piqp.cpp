@@ -5,16 +5,66 @@
 // This source code is licensed under the BSD 2-Clause License found in the
 // LICENSE file in the root directory of this source tree.
 
+#include <future>
+
 #include "piqp.h"
 
 #include "piqp/piqp.hpp"
+#include "piqp/dynamic_sparse_solver.hpp"
 
 using CVec = Eigen::Matrix<piqp_float, Eigen::Dynamic, 1>;
 using CMat = Eigen::Matrix<piqp_float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
 using CSparseMat = Eigen::SparseMatrix<piqp_float, Eigen::ColMajor, piqp_int>;
 
 using DenseSolver = piqp::DenseSolver<piqp_float>;
-using SparseSolver = piqp::SparseSolver<piqp_float, piqp_int>;
+
+// sparsity pattern of a matrix passed to setup, such that updates can pass only the values
+struct SparsityPattern
+{
+    piqp_int rows = 0;
+    piqp_int cols = 0;
+    Eigen::Matrix<piqp_int, Eigen::Dynamic, 1> outer;
+    Eigen::Matrix<piqp_int, Eigen::Dynamic, 1> inner;
+
+    void store(const piqp_csc* M)
+    {
+        if (!M)
+        {
+            rows = cols = 0;
+            outer.setZero(1);
+            inner.resize(0);
+            return;
+        }
+        rows = M->m;
+        cols = M->n;
+        outer = Eigen::Map<const Eigen::Matrix<piqp_int, Eigen::Dynamic, 1>>(M->p, M->n + 1);
+        inner = Eigen::Map<const Eigen::Matrix<piqp_int, Eigen::Dynamic, 1>>(M->i, M->p[M->n]);
+    }
+
+    piqp::optional<Eigen::Map<CSparseMat>> map(piqp_float* values)
+    {
+        piqp::optional<Eigen::Map<CSparseMat>> mat;
+        if (values)
+        {
+            mat = Eigen::Map<CSparseMat>(rows, cols, inner.size(), outer.data(), inner.data(), values);
+        }
+        return mat;
+    }
+};
+
+struct SparseSolver : public piqp::DynamicSparseSolver<piqp_float, piqp_int>
+{
+    using piqp::DynamicSparseSolver<piqp_float, piqp_int>::DynamicSparseSolver;
+
+    SparsityPattern P_pattern;
+    SparsityPattern A_pattern;
+    SparsityPattern G_pattern;
+};
+
+struct piqp_async_handle
+{
+    std::future<piqp::Status> future;
+};
 
 piqp_csc* piqp_csc_matrix(piqp_int m, piqp_int n, piqp_int nnz, piqp_int *p, piqp_int *i, piqp_float *x)
 {
@@ -69,6 +119,14 @@ void piqp_update_result(piqp_result* result, const piqp::Result<piqp_float>& sol
     result->info.reg_limit = solver_result.info.reg_limit;
     result->info.no_primal_update = (piqp_int) solver_result.info.no_primal_update;
     result->info.no_dual_update = (piqp_int) solver_result.info.no_dual_update;
+    result->info.kkt_nnz = (piqp_int) solver_result.info.kkt_nnz;
+    result->info.kkt_factor_nnz = (piqp_int) solver_result.info.kkt_factor_nnz;
+    result->info.kkt_fill_ratio = solver_result.info.kkt_fill_ratio;
+    result->info.factor_flops = solver_result.info.factor_flops;
+    result->info.solve_flops = solver_result.info.solve_flops;
+    result->info.etree_height = (piqp_int) solver_result.info.etree_height;
+    result->info.etree_width = (piqp_int) solver_result.info.etree_width;
+    result->info.workspace_bytes = (size_t) solver_result.info.workspace_bytes;
     result->info.setup_time = solver_result.info.setup_time;
     result->info.update_time = solver_result.info.update_time;
     result->info.solve_time = solver_result.info.solve_time;
@@ -92,6 +150,10 @@ void piqp_set_default_settings(piqp_settings* settings)
     settings->reg_finetune_dual_update_threshold = (piqp_int)  default_settings.reg_finetune_dual_update_threshold;
     settings->max_iter = (piqp_int) default_settings.max_iter;
     settings->max_factor_retires = (piqp_int) default_settings.max_factor_retires;
+    settings->time_limit = default_settings.time_limit;
+    settings->real_time = default_settings.real_time;
+    settings->real_time_max_factor_retires = default_settings.real_time_max_factor_retires;
+    settings->real_time_iterative_refinement_max_iter = default_settings.real_time_iterative_refinement_max_iter;
     settings->preconditioner_scale_cost = default_settings.preconditioner_scale_cost;
     settings->preconditioner_iter = (piqp_int) default_settings.preconditioner_iter;
     settings->tau = default_settings.tau;
@@ -104,6 +166,10 @@ void piqp_set_default_settings(piqp_settings* settings)
     settings->iterative_refinement_static_regularization_rel = default_settings.iterative_refinement_static_regularization_rel;
     settings->verbose = default_settings.verbose;
     settings->compute_timings = default_settings.compute_timings;
+    settings->trace_capacity = (piqp_int) default_settings.trace_capacity;
+    settings->n_threads = (piqp_int) default_settings.n_threads;
+    settings->dense_ldlt_tuning = default_settings.dense_ldlt_tuning;
+    settings->kkt_mode = PIQP_KKT_FULL;
 }
 
 piqp::optional<Eigen::Map<CVec>> piqp_optional_vec_map(piqp_float* data, piqp_int n)
@@ -136,6 +202,12 @@ piqp::optional<Eigen::Map<CSparseMat>> piqp_optional_sparse_mat_map(piqp_csc* da
     return mat;
 }
 
+piqp::optional<Eigen::Map<const CVec>> piqp_optional_const_vec_map(const piqp_float* data, piqp_int n)
+{
+    if (!data) return piqp::nullopt;
+    return Eigen::Map<const CVec>(data, n);
+}
+
 void piqp_setup_dense(piqp_workspace** workspace, const piqp_data_dense* data, const piqp_settings* settings)
 {
     auto* work = new piqp_workspace;
@@ -147,7 +219,9 @@ void piqp_setup_dense(piqp_workspace** workspace, const piqp_data_dense* data, c
     work->solver_info.n = data->n;
     work->solver_info.p = data->p;
     work->solver_info.m = data->m;
+    work->solver_info.kkt_mode = PIQP_KKT_FULL;
     work->result = new piqp_result;
+    work->async_handle = nullptr;
 
     if (settings)
     {
@@ -173,13 +247,14 @@ void piqp_setup_sparse(piqp_workspace** workspace, const piqp_data_sparse* data,
     auto* work = new piqp_workspace;
     *workspace = work;
 
-    auto* solver = new piqp::SparseSolver<piqp_float, piqp_int>();
+    auto* solver = new SparseSolver(settings ? settings->kkt_mode : PIQP_KKT_FULL);
     work->solver_handle = reinterpret_cast<piqp_solver_handle*>(solver);
     work->solver_info.is_dense = 0;
     work->solver_info.n = data->n;
     work->solver_info.p = data->p;
     work->solver_info.m = data->m;
     work->result = new piqp_result;
+    work->async_handle = nullptr;
 
     if (settings)
     {
@@ -196,6 +271,10 @@ void piqp_setup_sparse(piqp_workspace** workspace, const piqp_data_sparse* data,
     piqp::optional<Eigen::Map<CVec>> x_ub = piqp_optional_vec_map(data->x_ub, data->n);
 
     solver->setup(P, c, A, b, G, h, x_lb, x_ub);
+    solver->P_pattern.store(data->P);
+    solver->A_pattern.store(data->A);
+    solver->G_pattern.store(data->G);
+    work->solver_info.kkt_mode = (piqp_kkt_mode) solver->kkt_mode();
 
     piqp_update_result(work->result, solver->result());
 }
@@ -219,6 +298,10 @@ void piqp_update_settings(piqp_workspace* workspace, const piqp_settings* settin
         solver->settings().reg_finetune_dual_update_threshold = settings->reg_finetune_dual_update_threshold;
         solver->settings().max_iter = settings->max_iter;
         solver->settings().max_factor_retires = settings->max_factor_retires;
+        solver->settings().time_limit = settings->time_limit;
+        solver->settings().real_time = settings->real_time;
+        solver->settings().real_time_max_factor_retires = settings->real_time_max_factor_retires;
+        solver->settings().real_time_iterative_refinement_max_iter = settings->real_time_iterative_refinement_max_iter;
         solver->settings().preconditioner_scale_cost = settings->preconditioner_scale_cost;
         solver->settings().preconditioner_iter = settings->preconditioner_iter;
         solver->settings().tau = settings->tau;
@@ -231,6 +314,9 @@ void piqp_update_settings(piqp_workspace* workspace, const piqp_settings* settin
         solver->settings().iterative_refinement_static_regularization_rel = settings->iterative_refinement_static_regularization_rel;
         solver->settings().verbose = settings->verbose;
         solver->settings().compute_timings = settings->compute_timings;
+        solver->settings().trace_capacity = settings->trace_capacity;
+        solver->settings().n_threads = settings->n_threads;
+        solver->settings().dense_ldlt_tuning = settings->dense_ldlt_tuning;
     }
     else
     {
@@ -249,6 +335,10 @@ void piqp_update_settings(piqp_workspace* workspace, const piqp_settings* settin
         solver->settings().reg_finetune_dual_update_threshold = settings->reg_finetune_dual_update_threshold;
         solver->settings().max_iter = settings->max_iter;
         solver->settings().max_factor_retires = settings->max_factor_retires;
+        solver->settings().time_limit = settings->time_limit;
+        solver->settings().real_time = settings->real_time;
+        solver->settings().real_time_max_factor_retires = settings->real_time_max_factor_retires;
+        solver->settings().real_time_iterative_refinement_max_iter = settings->real_time_iterative_refinement_max_iter;
         solver->settings().preconditioner_scale_cost = settings->preconditioner_scale_cost;
         solver->settings().preconditioner_iter = settings->preconditioner_iter;
         solver->settings().tau = settings->tau;
@@ -261,6 +351,9 @@ void piqp_update_settings(piqp_workspace* workspace, const piqp_settings* settin
         solver->settings().iterative_refinement_static_regularization_rel = settings->iterative_refinement_static_regularization_rel;
         solver->settings().verbose = settings->verbose;
         solver->settings().compute_timings = settings->compute_timings;
+        solver->settings().trace_capacity = settings->trace_capacity;
+        solver->settings().n_threads = settings->n_threads;
+        solver->settings().dense_ldlt_tuning = settings->dense_ldlt_tuning;
     }
 }
 
@@ -302,6 +395,48 @@ void piqp_update_sparse(piqp_workspace* workspace,
     solver->update(P_, c_, A_, b_, G_, h_, x_lb_, x_ub_);
 }
 
+void piqp_update_sparse_values(piqp_workspace* workspace,
+                               piqp_float* P_x, piqp_float* c,
+                               piqp_float* A_x, piqp_float* b,
+                               piqp_float* G_x, piqp_float* h,
+                               piqp_float* x_lb, piqp_float* x_ub)
+{
+    auto* solver = reinterpret_cast<SparseSolver*>(workspace->solver_handle);
+
+    piqp::optional<Eigen::Map<CSparseMat>> P_ = solver->P_pattern.map(P_x);
+    piqp::optional<Eigen::Map<CVec>> c_ = piqp_optional_vec_map(c, workspace->solver_info.n);
+    piqp::optional<Eigen::Map<CSparseMat>> A_ = solver->A_pattern.map(A_x);
+    piqp::optional<Eigen::Map<CVec>> b_ = piqp_optional_vec_map(b, workspace->solver_info.p);
+    piqp::optional<Eigen::Map<CSparseMat>> G_ = solver->G_pattern.map(G_x);
+    piqp::optional<Eigen::Map<CVec>> h_ = piqp_optional_vec_map(h, workspace->solver_info.m);
+    piqp::optional<Eigen::Map<CVec>> x_lb_ = piqp_optional_vec_map(x_lb, workspace->solver_info.n);
+    piqp::optional<Eigen::Map<CVec>> x_ub_ = piqp_optional_vec_map(x_ub, workspace->solver_info.n);
+
+    solver->update(P_, c_, A_, b_, G_, h_, x_lb_, x_ub_);
+}
+
+void piqp_warm_start(piqp_workspace* workspace,
+                     const piqp_float* x, const piqp_float* y, const piqp_float* z,
+                     const piqp_float* z_lb, const piqp_float* z_ub)
+{
+    piqp::optional<Eigen::Map<const CVec>> x_ = piqp_optional_const_vec_map(x, workspace->solver_info.n);
+    piqp::optional<Eigen::Map<const CVec>> y_ = piqp_optional_const_vec_map(y, workspace->solver_info.p);
+    piqp::optional<Eigen::Map<const CVec>> z_ = piqp_optional_const_vec_map(z, workspace->solver_info.m);
+    piqp::optional<Eigen::Map<const CVec>> z_lb_ = piqp_optional_const_vec_map(z_lb, workspace->solver_info.n);
+    piqp::optional<Eigen::Map<const CVec>> z_ub_ = piqp_optional_const_vec_map(z_ub, workspace->solver_info.n);
+
+    if (workspace->solver_info.is_dense)
+    {
+        auto* solver = reinterpret_cast<DenseSolver*>(workspace->solver_handle);
+        solver->warm_start(x_, y_, z_, z_lb_, z_ub_);
+    }
+    else
+    {
+        auto* solver = reinterpret_cast<SparseSolver*>(workspace->solver_handle);
+        solver->warm_start(x_, y_, z_, z_lb_, z_ub_);
+    }
+}
+
 piqp_status piqp_solve(piqp_workspace* workspace)
 {
     piqp::Status status;
@@ -321,10 +456,134 @@ piqp_status piqp_solve(piqp_workspace* workspace)
     return (piqp_status) status;
 }
 
+void piqp_solve_async(piqp_workspace* workspace, piqp_solve_callback callback, void* user_data)
+{
+    // only one solve can run at a time
+    piqp_wait(workspace);
+
+    auto* handle = new piqp_async_handle;
+    auto on_done = [workspace, callback, user_data](piqp::Status status) {
+        if (workspace->solver_info.is_dense)
+        {
+            piqp_update_result(workspace->result, reinterpret_cast<DenseSolver*>(workspace->solver_handle)->result());
+        }
+        else
+        {
+            piqp_update_result(workspace->result, reinterpret_cast<SparseSolver*>(workspace->solver_handle)->result());
+        }
+        if (callback) callback((piqp_status) status, user_data);
+    };
+    if (workspace->solver_info.is_dense)
+    {
+        handle->future = reinterpret_cast<DenseSolver*>(workspace->solver_handle)->solve_async(on_done);
+    }
+    else
+    {
+        handle->future = reinterpret_cast<SparseSolver*>(workspace->solver_handle)->solve_async(on_done);
+    }
+    workspace->async_handle = handle;
+}
+
+piqp_status piqp_wait(piqp_workspace* workspace)
+{
+    if (workspace->async_handle)
+    {
+        workspace->async_handle->future.wait();
+        delete workspace->async_handle;
+        workspace->async_handle = nullptr;
+    }
+    return workspace->result->info.status;
+}
+
+void piqp_cancel(piqp_workspace* workspace)
+{
+    if (workspace->solver_info.is_dense)
+    {
+        reinterpret_cast<DenseSolver*>(workspace->solver_handle)->cancel();
+    }
+    else
+    {
+        reinterpret_cast<SparseSolver*>(workspace->solver_handle)->cancel();
+    }
+}
+
+void piqp_copy_trace(const piqp::Trace<piqp_float>& trace, piqp_trace_entry* entries, piqp_int n)
+{
+    for (piqp_int i = 0; i < n; i++)
+    {
+        const piqp::TraceEntry<piqp_float>& entry = trace[trace.size() - n + i];
+        entries[i].solve = (piqp_int) entry.solve;
+        entries[i].iter = (piqp_int) entry.iter;
+        entries[i].primal_obj = entry.primal_obj;
+        entries[i].dual_obj = entry.dual_obj;
+        entries[i].duality_gap = entry.duality_gap;
+        entries[i].primal_inf = entry.primal_inf;
+        entries[i].dual_inf = entry.dual_inf;
+        entries[i].rho = entry.rho;
+        entries[i].delta = entry.delta;
+        entries[i].mu = entry.mu;
+        entries[i].sigma = entry.sigma;
+        entries[i].primal_step = entry.primal_step;
+        entries[i].dual_step = entry.dual_step;
+        entries[i].refine_iter = (piqp_int) entry.refine_iter;
+        entries[i].factor_retires = (piqp_int) entry.factor_retires;
+        entries[i].factor_time = entry.factor_time;
+        entries[i].predictor_time = entry.predictor_time;
+        entries[i].corrector_time = entry.corrector_time;
+        entries[i].residual_time = entry.residual_time;
+    }
+}
+
+piqp_int piqp_trace_size(const piqp_workspace* workspace)
+{
+    if (workspace->solver_info.is_dense)
+    {
+        auto* solver = reinterpret_cast<DenseSolver*>(workspace->solver_handle);
+        return (piqp_int) solver->trace().size();
+    }
+    else
+    {
+        auto* solver = reinterpret_cast<SparseSolver*>(workspace->solver_handle);
+        return (piqp_int) solver->trace().size();
+    }
+}
+
+piqp_int piqp_get_trace(const piqp_workspace* workspace, piqp_trace_entry* entries, piqp_int max_entries)
+{
+    // copies the most recent min(max_entries, trace size) entries, oldest first
+    piqp_int n = std::max(piqp_int(0), std::min(max_entries, piqp_trace_size(workspace)));
+    if (workspace->solver_info.is_dense)
+    {
+        auto* solver = reinterpret_cast<DenseSolver*>(workspace->solver_handle);
+        piqp_copy_trace(solver->trace(), entries, n);
+    }
+    else
+    {
+        auto* solver = reinterpret_cast<SparseSolver*>(workspace->solver_handle);
+        piqp_copy_trace(solver->trace(), entries, n);
+    }
+    return n;
+}
+
+void piqp_clear_trace(piqp_workspace* workspace)
+{
+    if (workspace->solver_info.is_dense)
+    {
+        auto* solver = reinterpret_cast<DenseSolver*>(workspace->solver_handle);
+        solver->clear_trace();
+    }
+    else
+    {
+        auto* solver = reinterpret_cast<SparseSolver*>(workspace->solver_handle);
+        solver->clear_trace();
+    }
+}
+
 void piqp_cleanup(piqp_workspace* workspace)
 {
     if (workspace)
     {
+        piqp_wait(workspace);
         if (workspace->solver_info.is_dense)
         {
             auto* solver = reinterpret_cast<DenseSolver*>(workspace->solver_handle);
@@ -339,3 +598,16 @@ void piqp_cleanup(piqp_workspace* workspace)
         delete workspace;
     }
 }
+
+const char* piqp_instruction_set(void)
+{
+#if defined(__AVX512F__)
+    return "avx512";
+#elif defined(__AVX2__)
+    return "avx2";
+#elif defined(__SSE4_2__)
+    return "sse42";
+#else
+    return "baseline";
+#endif
+}
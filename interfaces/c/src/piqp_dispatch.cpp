@@ -0,0 +1,229 @@
+// This file is part of PIQP.
+//
+// Copyright (c) 2024 EPFL
+//
+// This source code is licensed under the BSD 2-Clause License found in the
+// LICENSE file in the root directory of this source tree.
+
+// Entry points of the C interface if it is built with instruction set variants. The actual
+// implementations (piqp.cpp) are compiled once per instruction set into separate modules next
+// to this library, and the best one supported by the CPU is loaded when this library is loaded.
+// If no module can be loaded, setup returns a NULL workspace, solve returns PIQP_UNSOLVED, and
+// piqp_instruction_set() returns "none".
+
+#include <cstdio>
+#include <string>
+
+#include "piqp.h"
+#include "dispatch/instruction_set.hpp"
+
+#define PIQP_C_FUNCTIONS(X)       \
+    X(piqp_csc_matrix)            \
+    X(piqp_set_default_settings)  \
+    X(piqp_setup_dense)           \
+    X(piqp_setup_sparse)          \
+    X(piqp_update_settings)       \
+    X(piqp_update_dense)          \
+    X(piqp_update_sparse)         \
+    X(piqp_update_sparse_values)  \
+    X(piqp_warm_start)            \
+    X(piqp_solve)                 \
+    X(piqp_solve_async)           \
+    X(piqp_wait)                  \
+    X(piqp_cancel)                \
+    X(piqp_trace_size)            \
+    X(piqp_get_trace)             \
+    X(piqp_clear_trace)           \
+    X(piqp_cleanup)               \
+    X(piqp_instruction_set)
+
+namespace {
+
+struct Implementation
+{
+#define PIQP_DECLARE_FUNCTION(name) decltype(&::name) name = nullptr;
+    PIQP_C_FUNCTIONS(PIQP_DECLARE_FUNCTION)
+#undef PIQP_DECLARE_FUNCTION
+};
+
+// implementation is only assigned if the module provides all functions
+bool load(const std::string& path, Implementation& implementation)
+{
+    void* handle = piqp::dispatch::open_module(path);
+    if (!handle) return false;
+
+    Implementation loaded;
+#define PIQP_LOAD_FUNCTION(name) loaded.name = piqp::dispatch::module_function<decltype(&::name)>(handle, #name);
+    PIQP_C_FUNCTIONS(PIQP_LOAD_FUNCTION)
+#undef PIQP_LOAD_FUNCTION
+
+#define PIQP_CHECK_FUNCTION(name) if (!loaded.name) return false;
+    PIQP_C_FUNCTIONS(PIQP_CHECK_FUNCTION)
+#undef PIQP_CHECK_FUNCTION
+    implementation = loaded;
+    return true;
+}
+
+// Loads the best variant supported by the CPU, see piqp::dispatch::load_best_variant. Without a
+// loadable variant, all functions of the returned implementation are null.
+Implementation load_implementation()
+{
+    std::string directory = piqp::dispatch::module_directory();
+    Implementation implementation;
+    const char* loaded = piqp::dispatch::load_best_variant([&](const char* instruction_set) {
+        std::string path = directory + PIQP_C_MODULE_PREFIX + "piqpc_" + instruction_set + PIQP_C_MODULE_SUFFIX;
+        return load(path, implementation);
+    });
+
+    if (!loaded)
+    {
+        std::fprintf(stderr, "piqp: no instruction set variant of the C interface found in '%s'\n", directory.c_str());
+    }
+    return implementation;
+}
+
+const Implementation& implementation()
+{
+    static const Implementation loaded = load_implementation();
+    return loaded;
+}
+
+// select the variant when the library is loaded instead of on the first call
+const bool loaded_on_library_load = (implementation(), true);
+
+bool loaded()
+{
+    return implementation().piqp_instruction_set != nullptr;
+}
+
+} // namespace
+
+piqp_csc* piqp_csc_matrix(piqp_int m, piqp_int n, piqp_int nnz, piqp_int *p, piqp_int *i, piqp_float *x)
+{
+    if (!loaded()) return nullptr;
+    return implementation().piqp_csc_matrix(m, n, nnz, p, i, x);
+}
+
+void piqp_set_default_settings(piqp_settings* settings)
+{
+    if (!loaded()) return;
+    implementation().piqp_set_default_settings(settings);
+}
+
+void piqp_setup_dense(piqp_workspace** workspace, const piqp_data_dense* data, const piqp_settings* settings)
+{
+    if (!loaded())
+    {
+        *workspace = nullptr;
+        return;
+    }
+    implementation().piqp_setup_dense(workspace, data, settings);
+}
+
+void piqp_setup_sparse(piqp_workspace** workspace, const piqp_data_sparse* data, const piqp_settings* settings)
+{
+    if (!loaded())
+    {
+        *workspace = nullptr;
+        return;
+    }
+    implementation().piqp_setup_sparse(workspace, data, settings);
+}
+
+void piqp_update_settings(piqp_workspace* workspace, const piqp_settings* settings)
+{
+    if (!loaded()) return;
+    implementation().piqp_update_settings(workspace, settings);
+}
+
+void piqp_update_dense(piqp_workspace* workspace,
+                       piqp_float* P, piqp_float* c,
+                       piqp_float* A, piqp_float* b,
+                       piqp_float* G, piqp_float* h,
+                       piqp_float* x_lb, piqp_float* x_ub)
+{
+    if (!loaded()) return;
+    implementation().piqp_update_dense(workspace, P, c, A, b, G, h, x_lb, x_ub);
+}
+
+void piqp_update_sparse(piqp_workspace* workspace,
+                        piqp_csc* P, piqp_float* c,
+                        piqp_csc* A, piqp_float* b,
+                        piqp_csc* G, piqp_float* h,
+                        piqp_float* x_lb, piqp_float* x_ub)
+{
+    if (!loaded()) return;
+    implementation().piqp_update_sparse(workspace, P, c, A, b, G, h, x_lb, x_ub);
+}
+
+void piqp_update_sparse_values(piqp_workspace* workspace,
+                               piqp_float* P_x, piqp_float* c,
+                               piqp_float* A_x, piqp_float* b,
+                               piqp_float* G_x, piqp_float* h,
+                               piqp_float* x_lb, piqp_float* x_ub)
+{
+    if (!loaded()) return;
+    implementation().piqp_update_sparse_values(workspace, P_x, c, A_x, b, G_x, h, x_lb, x_ub);
+}
+
+void piqp_warm_start(piqp_workspace* workspace,
+                     const piqp_float* x, const piqp_float* y, const piqp_float* z,
+                     const piqp_float* z_lb, const piqp_float* z_ub)
+{
+    if (!loaded()) return;
+    implementation().piqp_warm_start(workspace, x, y, z, z_lb, z_ub);
+}
+
+piqp_status piqp_solve(piqp_workspace* workspace)
+{
+    if (!loaded()) return PIQP_UNSOLVED;
+    return implementation().piqp_solve(workspace);
+}
+
+void piqp_solve_async(piqp_workspace* workspace, piqp_solve_callback callback, void* user_data)
+{
+    if (!loaded()) return;
+    implementation().piqp_solve_async(workspace, callback, user_data);
+}
+
+piqp_status piqp_wait(piqp_workspace* workspace)
+{
+    if (!loaded()) return PIQP_UNSOLVED;
+    return implementation().piqp_wait(workspace);
+}
+
+void piqp_cancel(piqp_workspace* workspace)
+{
+    if (!loaded()) return;
+    implementation().piqp_cancel(workspace);
+}
+
+piqp_int piqp_trace_size(const piqp_workspace* workspace)
+{
+    if (!loaded()) return 0;
+    return implementation().piqp_trace_size(workspace);
+}
+
+piqp_int piqp_get_trace(const piqp_workspace* workspace, piqp_trace_entry* entries, piqp_int max_entries)
+{
+    if (!loaded()) return 0;
+    return implementation().piqp_get_trace(workspace, entries, max_entries);
+}
+
+void piqp_clear_trace(piqp_workspace* workspace)
+{
+    if (!loaded()) return;
+    implementation().piqp_clear_trace(workspace);
+}
+
+void piqp_cleanup(piqp_workspace* workspace)
+{
+    if (!loaded()) return;
+    implementation().piqp_cleanup(workspace);
+}
+
+const char* piqp_instruction_set(void)
+{
+    if (!loaded()) return "none";
+    return implementation().piqp_instruction_set();
+}
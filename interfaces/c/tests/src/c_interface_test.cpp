@@ -5,7 +5,11 @@
 // This source code is licensed under the BSD 2-Clause License found in the
 // LICENSE file in the root directory of this source tree.
 
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
 
 #include "piqp.h"
 
@@ -61,6 +65,7 @@ TEST(CInterfaceTest, SimpleDenseQPWithUpdate)
     piqp_status status = piqp_solve(work);
 
     ASSERT_EQ(status, PIQP_SOLVED);
+    ASSERT_GT(work->result->info.workspace_bytes, 0u);
     ASSERT_NEAR(work->result->x[0], 0.4285714, 1e-6);
     ASSERT_NEAR(work->result->x[1], 0.2142857, 1e-6);
     ASSERT_NEAR(work->result->y[0], -1.5714286, 1e-6);
@@ -193,3 +198,293 @@ TEST(CInterfaceTest, SimpleSparseQPWithUpdate)
         free(data);
     }
 }
+
+TEST(CInterfaceTest, SparseKKTModesAndValueUpdate)
+{
+    piqp_int n = 2;
+    piqp_int p = 1;
+    piqp_int m = 2;
+
+    piqp_float P_x[2] = {6, 4};
+    piqp_int P_p[3] = {0, 1, 2};
+    piqp_int P_i[2] = {0, 1};
+    piqp_float c[2] = {-1, -4};
+
+    piqp_float A_x[2] = {1, -2};
+    piqp_int A_p[3] = {0, 1, 2};
+    piqp_int A_i[2] = {0, 0};
+    piqp_float b[1] = {0};
+
+    piqp_float G_x[2] = {1, -1};
+    piqp_int G_p[3] = {0, 2, 2};
+    piqp_int G_i[2] = {0, 1};
+    piqp_float h[2] = {1, 1};
+
+    piqp_float x_lb[2] = {-PIQP_INF, -1};
+    piqp_float x_ub[2] = {PIQP_INF, 1};
+
+    piqp_kkt_mode kkt_modes[5] = {PIQP_KKT_FULL, PIQP_KKT_EQ_ELIMINATED, PIQP_KKT_INEQ_ELIMINATED, PIQP_KKT_ALL_ELIMINATED, PIQP_KKT_AUTO};
+    for (piqp_kkt_mode kkt_mode : kkt_modes)
+    {
+        piqp_float P_x_k[2] = {6, 4};
+        piqp_float A_x_k[2] = {1, -2};
+
+        piqp_settings settings;
+        piqp_set_default_settings(&settings);
+        settings.kkt_mode = kkt_mode;
+
+        piqp_csc* P = piqp_csc_matrix(n, n, 2, P_p, P_i, P_x_k);
+        piqp_csc* A = piqp_csc_matrix(p, n, 2, A_p, A_i, A_x_k);
+        piqp_csc* G = piqp_csc_matrix(m, n, 2, G_p, G_i, G_x);
+        piqp_data_sparse data = {n, p, m, P, c, A, b, G, h, x_lb, x_ub};
+
+        piqp_workspace* work;
+        piqp_setup_sparse(&work, &data, &settings);
+        if (kkt_mode == PIQP_KKT_AUTO)
+        {
+            ASSERT_GE(work->solver_info.kkt_mode, PIQP_KKT_FULL);
+        }
+        else
+        {
+            ASSERT_EQ(work->solver_info.kkt_mode, kkt_mode);
+        }
+
+        ASSERT_EQ(piqp_solve(work), PIQP_SOLVED);
+        ASSERT_NEAR(work->result->x[0], 0.4285714, 1e-6);
+        ASSERT_NEAR(work->result->x[1], 0.2142857, 1e-6);
+
+        // same update as in SimpleSparseQPWithUpdate, passing only the values
+        piqp_float P_x_new[2] = {8, 4};
+        piqp_float A_x_new[2] = {1, -3};
+        piqp_float h_new[2] = {2, 1};
+        piqp_float x_ub_new[2] = {PIQP_INF, 2};
+        piqp_update_sparse_values(work, P_x_new, NULL, A_x_new, NULL, NULL, h_new, NULL, x_ub_new);
+
+        ASSERT_EQ(piqp_solve(work), PIQP_SOLVED);
+        ASSERT_NEAR(work->result->x[0], 0.2763157, 1e-6);
+        ASSERT_NEAR(work->result->x[1], 0.0921056, 1e-6);
+        ASSERT_NEAR(work->result->y[0], -1.2105263, 1e-6);
+
+        piqp_cleanup(work);
+        free(P);
+        free(A);
+        free(G);
+    }
+}
+
+TEST(CInterfaceTest, WarmStart)
+{
+    piqp_int n = 2;
+    piqp_int p = 1;
+    piqp_int m = 2;
+
+    piqp_float P[4] = {6, 0, 0, 4};
+    piqp_float c[2] = {-1, -4};
+    piqp_float A[2] = {1, -2};
+    piqp_float b[1] = {0};
+    piqp_float G[4] = {1, 0, -1, 0};
+    piqp_float h[2] = {1, 1};
+    piqp_float x_lb[2] = {-PIQP_INF, -1};
+    piqp_float x_ub[2] = {PIQP_INF, 1};
+
+    piqp_data_dense data = {n, p, m, P, c, A, b, G, h, x_lb, x_ub};
+
+    piqp_workspace* work;
+    piqp_setup_dense(&work, &data, NULL);
+    ASSERT_EQ(piqp_solve(work), PIQP_SOLVED);
+    piqp_int cold_iter = work->result->info.iter;
+
+    piqp_float x[2] = {work->result->x[0], work->result->x[1]};
+    piqp_float y[1] = {work->result->y[0]};
+    piqp_float z[2] = {work->result->z[0], work->result->z[1]};
+    piqp_float z_lb[2] = {work->result->z_lb[0], work->result->z_lb[1]};
+    piqp_float z_ub[2] = {work->result->z_ub[0], work->result->z_ub[1]};
+
+    // starting from the solution converges faster
+    piqp_warm_start(work, x, y, z, z_lb, z_ub);
+    ASSERT_EQ(piqp_solve(work), PIQP_SOLVED);
+    ASSERT_LT(work->result->info.iter, cold_iter);
+    ASSERT_NEAR(work->result->x[0], 0.4285714, 1e-6);
+    ASSERT_NEAR(work->result->x[1], 0.2142857, 1e-6);
+
+    // the duals are optional
+    piqp_warm_start(work, x, NULL, NULL, NULL, NULL);
+    ASSERT_EQ(piqp_solve(work), PIQP_SOLVED);
+    ASSERT_NEAR(work->result->x[0], 0.4285714, 1e-6);
+    ASSERT_NEAR(work->result->x[1], 0.2142857, 1e-6);
+
+    piqp_cleanup(work);
+}
+
+TEST(CInterfaceTest, DenseTrace)
+{
+    piqp_int n = 2;
+    piqp_int p = 1;
+    piqp_int m = 2;
+
+    piqp_float P[4] = {6, 0, 0, 4};
+    piqp_float c[2] = {-1, -4};
+
+    piqp_float A[2] = {1, -2};
+    piqp_float b[1] = {0};
+
+    piqp_float G[4] = {1, 0, -1, 0};
+    piqp_float h[2] = {1, 1};
+
+    piqp_workspace* work;
+    piqp_settings* settings = (piqp_settings*) malloc(sizeof(piqp_settings));
+    piqp_data_dense* data = (piqp_data_dense*) malloc(sizeof(piqp_data_dense));
+
+    piqp_set_default_settings(settings);
+    ASSERT_EQ(settings->trace_capacity, 0);
+    settings->trace_capacity = 100;
+
+    data->n = n;
+    data->p = p;
+    data->m = m;
+    data->P = P;
+    data->c = c;
+    data->A = A;
+    data->b = b;
+    data->G = G;
+    data->h = h;
+    data->x_lb = NULL;
+    data->x_ub = NULL;
+
+    piqp_setup_dense(&work, data, settings);
+    piqp_status status = piqp_solve(work);
+
+    ASSERT_EQ(status, PIQP_SOLVED);
+    piqp_int trace_size = piqp_trace_size(work);
+    ASSERT_EQ(trace_size, work->result->info.iter + 1);
+
+    piqp_trace_entry entries[100];
+    piqp_int n_entries = piqp_get_trace(work, entries, 100);
+    ASSERT_EQ(n_entries, trace_size);
+    ASSERT_EQ(entries[0].iter, 0);
+    ASSERT_EQ(entries[n_entries - 1].iter, work->result->info.iter);
+    ASSERT_EQ(entries[n_entries - 1].primal_obj, work->result->info.primal_obj);
+
+    // only the most recent entries are copied
+    n_entries = piqp_get_trace(work, entries, 2);
+    ASSERT_EQ(n_entries, 2);
+    ASSERT_EQ(entries[1].iter, work->result->info.iter);
+
+    // nothing is copied for a negative count
+    ASSERT_EQ(piqp_get_trace(work, entries, -1), 0);
+
+    piqp_clear_trace(work);
+    ASSERT_EQ(piqp_trace_size(work), 0);
+
+    piqp_cleanup(work);
+    if (settings) free(settings);
+    if (data) free(data);
+}
+
+static void count_solve_callback(piqp_status status, void* user_data)
+{
+    if (status == PIQP_SOLVED) (*(int*) user_data)++;
+}
+
+TEST(CInterfaceTest, DenseAsyncSolveAndTimeLimit)
+{
+    piqp_int n = 2;
+    piqp_int p = 1;
+    piqp_int m = 2;
+
+    piqp_float P[4] = {6, 0, 0, 4};
+    piqp_float c[2] = {-1, -4};
+
+    piqp_float A[2] = {1, -2};
+    piqp_float b[1] = {0};
+
+    piqp_float G[4] = {1, 0, -1, 0};
+    piqp_float h[2] = {1, 1};
+
+    piqp_workspace* work;
+    piqp_settings* settings = (piqp_settings*) malloc(sizeof(piqp_settings));
+    piqp_data_dense* data = (piqp_data_dense*) malloc(sizeof(piqp_data_dense));
+
+    piqp_set_default_settings(settings);
+
+    data->n = n;
+    data->p = p;
+    data->m = m;
+    data->P = P;
+    data->c = c;
+    data->A = A;
+    data->b = b;
+    data->G = G;
+    data->h = h;
+    data->x_lb = NULL;
+    data->x_ub = NULL;
+
+    piqp_setup_dense(&work, data, settings);
+
+    int n_solved = 0;
+    piqp_solve_async(work, count_solve_callback, &n_solved);
+    piqp_status status = piqp_wait(work);
+
+    ASSERT_EQ(status, PIQP_SOLVED);
+    ASSERT_EQ(n_solved, 1);
+    ASSERT_NEAR(work->result->x[0], 0.4285714, 1e-6);
+    ASSERT_NEAR(work->result->x[1], 0.2142857, 1e-6);
+
+    // the time limit is checked at the beginning of every iteration
+    settings->time_limit = 1e-12;
+    piqp_update_settings(work, settings);
+    status = piqp_solve(work);
+
+    ASSERT_EQ(status, PIQP_TIME_LIMIT_REACHED);
+    ASSERT_EQ(work->result->info.iter, 0);
+
+    piqp_cleanup(work);
+    if (settings) free(settings);
+    if (data) free(data);
+}
+
+TEST(CInterfaceTest, InstructionSet)
+{
+    const std::vector<std::string> instruction_sets = {"avx512", "avx2", "sse42", "baseline"};
+
+    const char* instruction_set = piqp_instruction_set();
+    ASSERT_NE(instruction_set, nullptr);
+    auto it = std::find(instruction_sets.begin(), instruction_sets.end(), std::string(instruction_set));
+    ASSERT_NE(it, instruction_sets.end());
+
+    // the selected variant is at most the one requested
+    const char* limit = std::getenv("PIQP_INSTRUCTION_SET");
+    if (limit && std::strlen(limit) > 0)
+    {
+        auto limit_it = std::find(instruction_sets.begin(), instruction_sets.end(), std::string(limit));
+        ASSERT_GE(it, limit_it);
+    }
+}
+
+TEST(CInterfaceTest, NoInstructionSet)
+{
+    // only run with instruction set variants and a limit no module satisfies, e.g., PIQP_INSTRUCTION_SET=none
+    if (std::string(piqp_instruction_set()) != "none") return;
+
+    piqp_float P[1] = {1};
+    piqp_float c[1] = {1};
+
+    piqp_data_dense data;
+    data.n = 1;
+    data.p = 0;
+    data.m = 0;
+    data.P = P;
+    data.c = c;
+    data.A = nullptr;
+    data.b = nullptr;
+    data.G = nullptr;
+    data.h = nullptr;
+    data.x_lb = nullptr;
+    data.x_ub = nullptr;
+
+    piqp_workspace* work = reinterpret_cast<piqp_workspace*>(&data); // not NULL before setup
+    piqp_setup_dense(&work, &data, nullptr);
+    ASSERT_EQ(work, nullptr);
+    ASSERT_EQ(piqp_solve(work), PIQP_UNSOLVED);
+    piqp_cleanup(work);
+}
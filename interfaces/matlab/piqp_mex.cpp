@@ -39,6 +39,10 @@ const char* PIQP_SETTINGS_FIELDS[] = {"rho_init",
                                       "reg_finetune_dual_update_threshold",
                                       "max_iter",
                                       "max_factor_retires",
+                                      "time_limit",
+                                      "real_time",
+                                      "real_time_max_factor_retires",
+                                      "real_time_iterative_refinement_max_iter",
                                       "preconditioner_scale_cost",
                                       "preconditioner_iter",
                                       "tau",
@@ -50,7 +54,10 @@ const char* PIQP_SETTINGS_FIELDS[] = {"rho_init",
                                       "iterative_refinement_static_regularization_eps",
                                       "iterative_refinement_static_regularization_rel",
                                       "verbose",
-                                      "compute_timings"};
+                                      "compute_timings",
+                                      "trace_capacity",
+                                      "n_threads",
+                                      "dense_ldlt_tuning"};
 
 const char* PIQP_INFO_FIELDS[] = {"status",
                                   "status_val",
@@ -73,6 +80,14 @@ const char* PIQP_INFO_FIELDS[] = {"status",
                                   "reg_limit",
                                   "no_primal_update",
                                   "no_dual_update",
+                                  "kkt_nnz",
+                                  "kkt_factor_nnz",
+                                  "kkt_fill_ratio",
+                                  "factor_flops",
+                                  "solve_flops",
+                                  "etree_height",
+                                  "etree_width",
+                                  "workspace_bytes",
                                   "setup_time",
                                   "update_time",
                                   "solve_time",
@@ -166,6 +181,10 @@ mxArray* settings_to_mx_struct(const piqp::Settings<double>& settings)
     mxSetField(mx_ptr, 0, "reg_finetune_dual_update_threshold", mxCreateDoubleScalar((double) settings.reg_finetune_dual_update_threshold));
     mxSetField(mx_ptr, 0, "max_iter", mxCreateDoubleScalar((double) settings.max_iter));
     mxSetField(mx_ptr, 0, "max_factor_retires", mxCreateDoubleScalar((double) settings.max_factor_retires));
+    mxSetField(mx_ptr, 0, "time_limit", mxCreateDoubleScalar(settings.time_limit));
+    mxSetField(mx_ptr, 0, "real_time", mxCreateDoubleScalar(settings.real_time));
+    mxSetField(mx_ptr, 0, "real_time_max_factor_retires", mxCreateDoubleScalar((double) settings.real_time_max_factor_retires));
+    mxSetField(mx_ptr, 0, "real_time_iterative_refinement_max_iter", mxCreateDoubleScalar((double) settings.real_time_iterative_refinement_max_iter));
     mxSetField(mx_ptr, 0, "preconditioner_scale_cost", mxCreateDoubleScalar(settings.preconditioner_scale_cost));
     mxSetField(mx_ptr, 0, "preconditioner_iter", mxCreateDoubleScalar((double) settings.preconditioner_iter));
     mxSetField(mx_ptr, 0, "tau", mxCreateDoubleScalar(settings.tau));
@@ -178,6 +197,9 @@ mxArray* settings_to_mx_struct(const piqp::Settings<double>& settings)
     mxSetField(mx_ptr, 0, "iterative_refinement_static_regularization_rel", mxCreateDoubleScalar(settings.iterative_refinement_static_regularization_rel));
     mxSetField(mx_ptr, 0, "verbose", mxCreateDoubleScalar(settings.verbose));
     mxSetField(mx_ptr, 0, "compute_timings", mxCreateDoubleScalar(settings.compute_timings));
+    mxSetField(mx_ptr, 0, "trace_capacity", mxCreateDoubleScalar((double) settings.trace_capacity));
+    mxSetField(mx_ptr, 0, "n_threads", mxCreateDoubleScalar((double) settings.n_threads));
+    mxSetField(mx_ptr, 0, "dense_ldlt_tuning", mxCreateDoubleScalar(settings.dense_ldlt_tuning));
 
     return mx_ptr;
 }
@@ -197,6 +219,10 @@ void copy_mx_struct_to_settings(const mxArray* mx_ptr, piqp::Settings<double>& s
     settings.reg_finetune_dual_update_threshold = (piqp::isize) mxGetScalar(mxGetField(mx_ptr, 0, "reg_finetune_dual_update_threshold"));
     settings.max_iter = (piqp::isize) mxGetScalar(mxGetField(mx_ptr, 0, "max_iter"));
     settings.max_factor_retires = (piqp::isize) mxGetScalar(mxGetField(mx_ptr, 0, "max_factor_retires"));
+    settings.time_limit = (double) mxGetScalar(mxGetField(mx_ptr, 0, "time_limit"));
+    settings.real_time = (bool) mxGetScalar(mxGetField(mx_ptr, 0, "real_time"));
+    settings.real_time_max_factor_retires = (piqp::isize) mxGetScalar(mxGetField(mx_ptr, 0, "real_time_max_factor_retires"));
+    settings.real_time_iterative_refinement_max_iter = (piqp::isize) mxGetScalar(mxGetField(mx_ptr, 0, "real_time_iterative_refinement_max_iter"));
     settings.preconditioner_scale_cost = (bool) mxGetScalar(mxGetField(mx_ptr, 0, "preconditioner_scale_cost"));
     settings.preconditioner_iter = (piqp::isize) mxGetScalar(mxGetField(mx_ptr, 0, "preconditioner_iter"));
     settings.tau = (double) mxGetScalar(mxGetField(mx_ptr, 0, "tau"));
@@ -209,6 +235,9 @@ void copy_mx_struct_to_settings(const mxArray* mx_ptr, piqp::Settings<double>& s
     settings.iterative_refinement_static_regularization_rel = (double) mxGetScalar(mxGetField(mx_ptr, 0, "iterative_refinement_static_regularization_rel"));
     settings.verbose = (bool) mxGetScalar(mxGetField(mx_ptr, 0, "verbose"));
     settings.compute_timings = (bool) mxGetScalar(mxGetField(mx_ptr, 0, "compute_timings"));
+    settings.trace_capacity = (piqp::isize) mxGetScalar(mxGetField(mx_ptr, 0, "trace_capacity"));
+    settings.n_threads = (piqp::isize) mxGetScalar(mxGetField(mx_ptr, 0, "n_threads"));
+    settings.dense_ldlt_tuning = (bool) mxGetScalar(mxGetField(mx_ptr, 0, "dense_ldlt_tuning"));
 }
 
 mxArray* result_to_mx_struct(const piqp::Result<double>& result)
@@ -237,6 +266,14 @@ mxArray* result_to_mx_struct(const piqp::Result<double>& result)
     mxSetField(mx_info_ptr, 0, "reg_limit", mxCreateDoubleScalar(result.info.reg_limit));
     mxSetField(mx_info_ptr, 0, "no_primal_update", mxCreateDoubleScalar((double) result.info.no_primal_update));
     mxSetField(mx_info_ptr, 0, "no_dual_update", mxCreateDoubleScalar((double) result.info.no_dual_update));
+    mxSetField(mx_info_ptr, 0, "kkt_nnz", mxCreateDoubleScalar((double) result.info.kkt_nnz));
+    mxSetField(mx_info_ptr, 0, "kkt_factor_nnz", mxCreateDoubleScalar((double) result.info.kkt_factor_nnz));
+    mxSetField(mx_info_ptr, 0, "kkt_fill_ratio", mxCreateDoubleScalar(result.info.kkt_fill_ratio));
+    mxSetField(mx_info_ptr, 0, "factor_flops", mxCreateDoubleScalar(result.info.factor_flops));
+    mxSetField(mx_info_ptr, 0, "solve_flops", mxCreateDoubleScalar(result.info.solve_flops));
+    mxSetField(mx_info_ptr, 0, "etree_height", mxCreateDoubleScalar((double) result.info.etree_height));
+    mxSetField(mx_info_ptr, 0, "etree_width", mxCreateDoubleScalar((double) result.info.etree_width));
+    mxSetField(mx_info_ptr, 0, "workspace_bytes", mxCreateDoubleScalar((double) result.info.workspace_bytes));
     mxSetField(mx_info_ptr, 0, "setup_time", mxCreateDoubleScalar(result.info.setup_time));
     mxSetField(mx_info_ptr, 0, "update_time", mxCreateDoubleScalar(result.info.update_time));
     mxSetField(mx_info_ptr, 0, "solve_time", mxCreateDoubleScalar(result.info.solve_time));
@@ -94,6 +94,10 @@ octave_value settings_to_ov_struct(const piqp::Settings<double>& settings)
     ov_struct.assign("reg_finetune_dual_update_threshold", octave_value(settings.reg_finetune_dual_update_threshold));
     ov_struct.assign("max_iter", octave_value(settings.max_iter));
     ov_struct.assign("max_factor_retires", octave_value(settings.max_factor_retires));
+    ov_struct.assign("time_limit", octave_value(settings.time_limit));
+    ov_struct.assign("real_time", octave_value(settings.real_time));
+    ov_struct.assign("real_time_max_factor_retires", octave_value(settings.real_time_max_factor_retires));
+    ov_struct.assign("real_time_iterative_refinement_max_iter", octave_value(settings.real_time_iterative_refinement_max_iter));
     ov_struct.assign("preconditioner_scale_cost", octave_value(settings.preconditioner_scale_cost));
     ov_struct.assign("preconditioner_iter", octave_value(settings.preconditioner_iter));
     ov_struct.assign("tau", octave_value(settings.tau));
@@ -106,6 +110,9 @@ octave_value settings_to_ov_struct(const piqp::Settings<double>& settings)
     ov_struct.assign("iterative_refinement_static_regularization_rel", octave_value(settings.iterative_refinement_static_regularization_rel));
     ov_struct.assign("verbose", octave_value(settings.verbose));
     ov_struct.assign("compute_timings", octave_value(settings.compute_timings));
+    ov_struct.assign("trace_capacity", octave_value(settings.trace_capacity));
+    ov_struct.assign("n_threads", octave_value(settings.n_threads));
+    ov_struct.assign("dense_ldlt_tuning", octave_value(settings.dense_ldlt_tuning));
 
     return octave_value(ov_struct);
 }
@@ -125,6 +132,10 @@ void copy_ov_struct_to_settings(const octave_scalar_map& ov_struct, piqp::Settin
     settings.reg_finetune_dual_update_threshold = ov_struct.getfield("reg_finetune_dual_update_threshold").int_value();
     settings.max_iter = ov_struct.getfield("max_iter").int_value();
     settings.max_factor_retires = ov_struct.getfield("max_factor_retires").int_value();
+    settings.time_limit = ov_struct.getfield("time_limit").double_value();
+    settings.real_time = ov_struct.getfield("real_time").bool_value();
+    settings.real_time_max_factor_retires = ov_struct.getfield("real_time_max_factor_retires").int_value();
+    settings.real_time_iterative_refinement_max_iter = ov_struct.getfield("real_time_iterative_refinement_max_iter").int_value();
     settings.preconditioner_scale_cost = ov_struct.getfield("preconditioner_scale_cost").bool_value();
     settings.preconditioner_iter = ov_struct.getfield("preconditioner_iter").int_value();
     settings.tau = ov_struct.getfield("tau").double_value();
@@ -137,6 +148,9 @@ void copy_ov_struct_to_settings(const octave_scalar_map& ov_struct, piqp::Settin
     settings.iterative_refinement_static_regularization_rel = ov_struct.getfield("iterative_refinement_static_regularization_rel").double_value();
     settings.verbose = ov_struct.getfield("verbose").bool_value();
     settings.compute_timings = ov_struct.getfield("compute_timings").bool_value();
+    settings.trace_capacity = ov_struct.getfield("trace_capacity").int_value();
+    settings.n_threads = ov_struct.getfield("n_threads").int_value();
+    settings.dense_ldlt_tuning = ov_struct.getfield("dense_ldlt_tuning").bool_value();
 }
 
 octave_value result_to_ov_struct(const piqp::Result<double>& result)
@@ -164,6 +178,14 @@ octave_value result_to_ov_struct(const piqp::Result<double>& result)
     ov_info_struct.assign("reg_limit", octave_value(result.info.reg_limit));
     ov_info_struct.assign("no_primal_update", octave_value(result.info.no_primal_update));
     ov_info_struct.assign("no_dual_update", octave_value(result.info.no_dual_update));
+    ov_info_struct.assign("kkt_nnz", octave_value(result.info.kkt_nnz));
+    ov_info_struct.assign("kkt_factor_nnz", octave_value(result.info.kkt_factor_nnz));
+    ov_info_struct.assign("kkt_fill_ratio", octave_value(result.info.kkt_fill_ratio));
+    ov_info_struct.assign("factor_flops", octave_value(result.info.factor_flops));
+    ov_info_struct.assign("solve_flops", octave_value(result.info.solve_flops));
+    ov_info_struct.assign("etree_height", octave_value(result.info.etree_height));
+    ov_info_struct.assign("etree_width", octave_value(result.info.etree_width));
+    ov_info_struct.assign("workspace_bytes", octave_value(result.info.workspace_bytes));
     ov_info_struct.assign("setup_time", octave_value(result.info.setup_time));
     ov_info_struct.assign("update_time", octave_value(result.info.update_time));
     ov_info_struct.assign("solve_time", octave_value(result.info.solve_time));
@@ -4,14 +4,20 @@ import numpy
 import piqp
 import scipy.sparse
 import typing
-__all__ = ['DenseSolver', 'Info', 'PIQP_DUAL_INFEASIBLE', 'PIQP_INVALID_SETTINGS', 'PIQP_MAX_ITER_REACHED', 'PIQP_NUMERICS', 'PIQP_PRIMAL_INFEASIBLE', 'PIQP_SOLVED', 'PIQP_UNSOLVED', 'Result', 'Settings', 'SparseSolver', 'Status']
+__all__ = ['DenseSolver', 'Info', 'KKTMode', 'KKT_ALL_ELIMINATED', 'KKT_AUTO', 'KKT_EQ_ELIMINATED', 'KKT_FULL', 'KKT_INEQ_ELIMINATED', 'PIQP_CANCELLED', 'PIQP_DUAL_INFEASIBLE', 'PIQP_INVALID_SETTINGS', 'PIQP_MAX_ITER_REACHED', 'PIQP_NUMERICS', 'PIQP_PRIMAL_INFEASIBLE', 'PIQP_REAL_TIME_LIMIT_REACHED', 'PIQP_SOLVED', 'PIQP_TIME_LIMIT_REACHED', 'PIQP_UNSOLVED', 'Result', 'Settings', 'SolveFuture', 'SparseSolver', 'Status', 'Trace', 'TraceEntry', 'solve_many']
 class DenseSolver:
     def __init__(self: piqp.DenseSolver) -> None:
         ...
+    def cancel(self: piqp.DenseSolver) -> None:
+        ...
+    def clear_trace(self: piqp.DenseSolver) -> None:
+        ...
     def setup(self: piqp.DenseSolver, P: numpy.ndarray[numpy.float64[m, n], numpy.ndarray.flags.f_contiguous], c: numpy.ndarray[numpy.float64[m, 1]], A: numpy.ndarray[numpy.float64[m, n], numpy.ndarray.flags.f_contiguous] | None = None, b: numpy.ndarray[numpy.float64[m, 1]] | None = None, G: numpy.ndarray[numpy.float64[m, n], numpy.ndarray.flags.f_contiguous] | None = None, h: numpy.ndarray[numpy.float64[m, 1]] | None = None, x_lb: numpy.ndarray[numpy.float64[m, 1]] | None = None, x_ub: numpy.ndarray[numpy.float64[m, 1]] | None = None) -> None:
         ...
     def solve(self: piqp.DenseSolver) -> piqp.Status:
         ...
+    def solve_async(self: piqp.DenseSolver) -> piqp.SolveFuture:
+        ...
     def update(self: piqp.DenseSolver, P: numpy.ndarray[numpy.float64[m, n], numpy.ndarray.flags.f_contiguous] | None = None, c: numpy.ndarray[numpy.float64[m, 1]] | None = None, A: numpy.ndarray[numpy.float64[m, n], numpy.ndarray.flags.f_contiguous] | None = None, b: numpy.ndarray[numpy.float64[m, 1]] | None = None, G: numpy.ndarray[numpy.float64[m, n], numpy.ndarray.flags.f_contiguous] | None = None, h: numpy.ndarray[numpy.float64[m, 1]] | None = None, x_lb: numpy.ndarray[numpy.float64[m, 1]] | None = None, x_ub: numpy.ndarray[numpy.float64[m, 1]] | None = None, reuse_preconditioner: bool = True) -> None:
         ...
     @property
@@ -23,6 +29,55 @@ class DenseSolver:
     @settings.setter
     def settings(self) -> piqp.Settings:
         ...
+    @property
+    def trace(self) -> piqp.Trace:
+        ...
+class KKTMode:
+    """
+    Members:
+    
+      KKT_FULL
+    
+      KKT_EQ_ELIMINATED
+    
+      KKT_INEQ_ELIMINATED
+    
+      KKT_ALL_ELIMINATED
+    
+      KKT_AUTO
+    """
+    KKT_ALL_ELIMINATED: typing.ClassVar[piqp.KKTMode]  # value = <KKTMode.KKT_ALL_ELIMINATED: 3>
+    KKT_AUTO: typing.ClassVar[piqp.KKTMode]  # value = <KKTMode.KKT_AUTO: -1>
+    KKT_EQ_ELIMINATED: typing.ClassVar[piqp.KKTMode]  # value = <KKTMode.KKT_EQ_ELIMINATED: 1>
+    KKT_FULL: typing.ClassVar[piqp.KKTMode]  # value = <KKTMode.KKT_FULL: 0>
+    KKT_INEQ_ELIMINATED: typing.ClassVar[piqp.KKTMode]  # value = <KKTMode.KKT_INEQ_ELIMINATED: 2>
+    __members__: typing.ClassVar[dict[str, piqp.KKTMode]]  # value = {'KKT_FULL': <KKTMode.KKT_FULL: 0>, 'KKT_EQ_ELIMINATED': <KKTMode.KKT_EQ_ELIMINATED: 1>, 'KKT_INEQ_ELIMINATED': <KKTMode.KKT_INEQ_ELIMINATED: 2>, 'KKT_ALL_ELIMINATED': <KKTMode.KKT_ALL_ELIMINATED: 3>, 'KKT_AUTO': <KKTMode.KKT_AUTO: -1>}
+    def __eq__(self, other: typing.Any) -> bool:
+        ...
+    def __getstate__(self) -> int:
+        ...
+    def __hash__(self) -> int:
+        ...
+    def __index__(self: piqp.KKTMode) -> int:
+        ...
+    def __init__(self: piqp.KKTMode, value: int) -> None:
+        ...
+    def __int__(self: piqp.KKTMode) -> int:
+        ...
+    def __ne__(self, other: typing.Any) -> bool:
+        ...
+    def __repr__(self) -> str:
+        ...
+    def __setstate__(self: piqp.KKTMode, state: int) -> None:
+        ...
+    def __str__(self) -> str:
+        ...
+    @property
+    def name(self) -> str:
+        ...
+    @property
+    def value(self) -> int:
+        ...
 class Info:
     delta: float
     dual_inf: float
@@ -31,8 +86,14 @@ class Info:
     dual_step: float
     duality_gap: float
     duality_gap_rel: float
+    etree_height: int
+    etree_width: int
+    factor_flops: float
     factor_retires: int
     iter: int
+    kkt_factor_nnz: int
+    kkt_fill_ratio: float
+    kkt_nnz: int
     mu: float
     no_dual_update: int
     no_primal_update: int
@@ -45,30 +106,57 @@ class Info:
     run_time: float
     setup_time: float
     sigma: float
+    solve_flops: float
     solve_time: float
     status: piqp.Status
     update_time: float
+    workspace_bytes: int
     def __init__(self: piqp.Info) -> None:
         ...
 class Result:
     info: piqp.Info
     lambda: numpy.ndarray[numpy.float64[m, 1]]
-    nu: numpy.ndarray[numpy.float64[m, 1]]
-    nu_lb: numpy.ndarray[numpy.float64[m, 1]]
-    nu_ub: numpy.ndarray[numpy.float64[m, 1]]
-    s: numpy.ndarray[numpy.float64[m, 1]]
-    s_lb: numpy.ndarray[numpy.float64[m, 1]]
-    s_ub: numpy.ndarray[numpy.float64[m, 1]]
-    x: numpy.ndarray[numpy.float64[m, 1]]
-    y: numpy.ndarray[numpy.float64[m, 1]]
-    z: numpy.ndarray[numpy.float64[m, 1]]
-    z_lb: numpy.ndarray[numpy.float64[m, 1]]
-    z_ub: numpy.ndarray[numpy.float64[m, 1]]
-    zeta: numpy.ndarray[numpy.float64[m, 1]]
+    @property
+    def nu(self) -> numpy.ndarray[numpy.float64[m, 1]]:
+        ...
+    @property
+    def nu_lb(self) -> numpy.ndarray[numpy.float64[m, 1]]:
+        ...
+    @property
+    def nu_ub(self) -> numpy.ndarray[numpy.float64[m, 1]]:
+        ...
+    @property
+    def s(self) -> numpy.ndarray[numpy.float64[m, 1]]:
+        ...
+    @property
+    def s_lb(self) -> numpy.ndarray[numpy.float64[m, 1]]:
+        ...
+    @property
+    def s_ub(self) -> numpy.ndarray[numpy.float64[m, 1]]:
+        ...
+    @property
+    def x(self) -> numpy.ndarray[numpy.float64[m, 1]]:
+        ...
+    @property
+    def y(self) -> numpy.ndarray[numpy.float64[m, 1]]:
+        ...
+    @property
+    def z(self) -> numpy.ndarray[numpy.float64[m, 1]]:
+        ...
+    @property
+    def z_lb(self) -> numpy.ndarray[numpy.float64[m, 1]]:
+        ...
+    @property
+    def z_ub(self) -> numpy.ndarray[numpy.float64[m, 1]]:
+        ...
+    @property
+    def zeta(self) -> numpy.ndarray[numpy.float64[m, 1]]:
+        ...
 class Settings:
     check_duality_gap: bool
     compute_timings: bool
     delta_init: float
+    dense_ldlt_tuning: bool
     eps_abs: float
     eps_duality_gap_abs: float
     eps_duality_gap_rel: float
@@ -82,6 +170,7 @@ class Settings:
     iterative_refinement_static_regularization_rel: float
     max_factor_retires: int
     max_iter: int
+    n_threads: int
     preconditioner_iter: int
     preconditioner_scale_cost: bool
     reg_finetune_dual_update_threshold: int
@@ -90,16 +179,37 @@ class Settings:
     reg_lower_limit: float
     rho_init: float
     tau: float
+    time_limit: float
+    real_time: bool
+    real_time_max_factor_retires: int
+    real_time_iterative_refinement_max_iter: int
+    trace_capacity: int
     verbose: bool
+class SolveFuture:
+    def done(self: piqp.SolveFuture) -> bool:
+        ...
+    def result(self: piqp.SolveFuture) -> piqp.Status:
+        ...
 class SparseSolver:
-    def __init__(self: piqp.SparseSolver) -> None:
+    def __init__(self: piqp.SparseSolver, kkt_mode: piqp.KKTMode = piqp.KKTMode.KKT_FULL) -> None:
+        ...
+    def cancel(self: piqp.SparseSolver) -> None:
+        ...
+    def clear_trace(self: piqp.SparseSolver) -> None:
         ...
     def setup(self: piqp.SparseSolver, P: scipy.sparse.csc_matrix, c: numpy.ndarray[numpy.float64[m, 1]], A: scipy.sparse.csc_matrix | None, b: numpy.ndarray[numpy.float64[m, 1]] | None, G: scipy.sparse.csc_matrix | None, h: numpy.ndarray[numpy.float64[m, 1]] | None, x_lb: numpy.ndarray[numpy.float64[m, 1]] | None = None, x_ub: numpy.ndarray[numpy.float64[m, 1]] | None = None) -> None:
         ...
     def solve(self: piqp.SparseSolver) -> piqp.Status:
         ...
+    def solve_async(self: piqp.SparseSolver) -> piqp.SolveFuture:
+        ...
     def update(self: piqp.SparseSolver, P: scipy.sparse.csc_matrix | None = None, c: numpy.ndarray[numpy.float64[m, 1]] | None = None, A: scipy.sparse.csc_matrix | None = None, b: numpy.ndarray[numpy.float64[m, 1]] | None = None, G: scipy.sparse.csc_matrix | None = None, h: numpy.ndarray[numpy.float64[m, 1]] | None = None, x_lb: numpy.ndarray[numpy.float64[m, 1]] | None = None, x_ub: numpy.ndarray[numpy.float64[m, 1]] | None = None, reuse_preconditioner: bool = True) -> None:
         ...
+    def update_values(self: piqp.SparseSolver, P_data: numpy.ndarray[numpy.float64[m, 1]] | None = None, c: numpy.ndarray[numpy.float64[m, 1]] | None = None, A_data: numpy.ndarray[numpy.float64[m, 1]] | None = None, b: numpy.ndarray[numpy.float64[m, 1]] | None = None, G_data: numpy.ndarray[numpy.float64[m, 1]] | None = None, h: numpy.ndarray[numpy.float64[m, 1]] | None = None, x_lb: numpy.ndarray[numpy.float64[m, 1]] | None = None, x_ub: numpy.ndarray[numpy.float64[m, 1]] | None = None, reuse_preconditioner: bool = True) -> None:
+        ...
+    @property
+    def kkt_mode(self) -> piqp.KKTMode:
+        ...
     @property
     def result(self) -> piqp.Result:
         ...
@@ -109,6 +219,9 @@ class SparseSolver:
     @settings.setter
     def settings(self) -> piqp.Settings:
         ...
+    @property
+    def trace(self) -> piqp.Trace:
+        ...
 class Status:
     """
     Members:
@@ -121,20 +234,29 @@ class Status:
     
       PIQP_DUAL_INFEASIBLE
     
+      PIQP_CANCELLED
+    
+      PIQP_TIME_LIMIT_REACHED
+    
+      PIQP_REAL_TIME_LIMIT_REACHED
+    
       PIQP_NUMERICS
     
       PIQP_UNSOLVED
     
       PIQP_INVALID_SETTINGS
     """
+    PIQP_CANCELLED: typing.ClassVar[piqp.Status]  # value = <Status.PIQP_CANCELLED: -4>
     PIQP_DUAL_INFEASIBLE: typing.ClassVar[piqp.Status]  # value = <Status.PIQP_DUAL_INFEASIBLE: -3>
     PIQP_INVALID_SETTINGS: typing.ClassVar[piqp.Status]  # value = <Status.PIQP_INVALID_SETTINGS: -10>
     PIQP_MAX_ITER_REACHED: typing.ClassVar[piqp.Status]  # value = <Status.PIQP_MAX_ITER_REACHED: -1>
     PIQP_NUMERICS: typing.ClassVar[piqp.Status]  # value = <Status.PIQP_NUMERICS: -8>
     PIQP_PRIMAL_INFEASIBLE: typing.ClassVar[piqp.Status]  # value = <Status.PIQP_PRIMAL_INFEASIBLE: -2>
+    PIQP_REAL_TIME_LIMIT_REACHED: typing.ClassVar[piqp.Status]  # value = <Status.PIQP_REAL_TIME_LIMIT_REACHED: -6>
     PIQP_SOLVED: typing.ClassVar[piqp.Status]  # value = <Status.PIQP_SOLVED: 1>
+    PIQP_TIME_LIMIT_REACHED: typing.ClassVar[piqp.Status]  # value = <Status.PIQP_TIME_LIMIT_REACHED: -5>
     PIQP_UNSOLVED: typing.ClassVar[piqp.Status]  # value = <Status.PIQP_UNSOLVED: -9>
-    __members__: typing.ClassVar[dict[str, piqp.Status]]  # value = {'PIQP_SOLVED': <Status.PIQP_SOLVED: 1>, 'PIQP_MAX_ITER_REACHED': <Status.PIQP_MAX_ITER_REACHED: -1>, 'PIQP_PRIMAL_INFEASIBLE': <Status.PIQP_PRIMAL_INFEASIBLE: -2>, 'PIQP_DUAL_INFEASIBLE': <Status.PIQP_DUAL_INFEASIBLE: -3>, 'PIQP_NUMERICS': <Status.PIQP_NUMERICS: -8>, 'PIQP_UNSOLVED': <Status.PIQP_UNSOLVED: -9>, 'PIQP_INVALID_SETTINGS': <Status.PIQP_INVALID_SETTINGS: -10>}
+    __members__: typing.ClassVar[dict[str, piqp.Status]]  # value = {'PIQP_SOLVED': <Status.PIQP_SOLVED: 1>, 'PIQP_MAX_ITER_REACHED': <Status.PIQP_MAX_ITER_REACHED: -1>, 'PIQP_PRIMAL_INFEASIBLE': <Status.PIQP_PRIMAL_INFEASIBLE: -2>, 'PIQP_DUAL_INFEASIBLE': <Status.PIQP_DUAL_INFEASIBLE: -3>, 'PIQP_CANCELLED': <Status.PIQP_CANCELLED: -4>, 'PIQP_TIME_LIMIT_REACHED': <Status.PIQP_TIME_LIMIT_REACHED: -5>, 'PIQP_REAL_TIME_LIMIT_REACHED': <Status.PIQP_REAL_TIME_LIMIT_REACHED: -6>, 'PIQP_NUMERICS': <Status.PIQP_NUMERICS: -8>, 'PIQP_UNSOLVED': <Status.PIQP_UNSOLVED: -9>, 'PIQP_INVALID_SETTINGS': <Status.PIQP_INVALID_SETTINGS: -10>}
     def __eq__(self, other: typing.Any) -> bool:
         ...
     def __getstate__(self) -> int:
@@ -161,11 +283,93 @@ class Status:
     @property
     def value(self) -> int:
         ...
+class Trace:
+    def __getitem__(self: piqp.Trace, arg0: int) -> piqp.TraceEntry:
+        ...
+    def __len__(self: piqp.Trace) -> int:
+        ...
+    def clear(self: piqp.Trace) -> None:
+        ...
+    def to_csv(self: piqp.Trace) -> str:
+        ...
+    def to_json(self: piqp.Trace) -> str:
+        ...
+    @property
+    def capacity(self) -> int:
+        ...
+class TraceEntry:
+    @property
+    def corrector_time(self) -> float:
+        ...
+    @property
+    def delta(self) -> float:
+        ...
+    @property
+    def dual_inf(self) -> float:
+        ...
+    @property
+    def dual_obj(self) -> float:
+        ...
+    @property
+    def dual_step(self) -> float:
+        ...
+    @property
+    def duality_gap(self) -> float:
+        ...
+    @property
+    def factor_retires(self) -> int:
+        ...
+    @property
+    def factor_time(self) -> float:
+        ...
+    @property
+    def iter(self) -> int:
+        ...
+    @property
+    def mu(self) -> float:
+        ...
+    @property
+    def predictor_time(self) -> float:
+        ...
+    @property
+    def primal_inf(self) -> float:
+        ...
+    @property
+    def primal_obj(self) -> float:
+        ...
+    @property
+    def primal_step(self) -> float:
+        ...
+    @property
+    def refine_iter(self) -> int:
+        ...
+    @property
+    def residual_time(self) -> float:
+        ...
+    @property
+    def rho(self) -> float:
+        ...
+    @property
+    def sigma(self) -> float:
+        ...
+    @property
+    def solve(self) -> int:
+        ...
+KKT_ALL_ELIMINATED: piqp.KKTMode  # value = <KKTMode.KKT_ALL_ELIMINATED: 3>
+KKT_AUTO: piqp.KKTMode  # value = <KKTMode.KKT_AUTO: -1>
+KKT_EQ_ELIMINATED: piqp.KKTMode  # value = <KKTMode.KKT_EQ_ELIMINATED: 1>
+KKT_FULL: piqp.KKTMode  # value = <KKTMode.KKT_FULL: 0>
+KKT_INEQ_ELIMINATED: piqp.KKTMode  # value = <KKTMode.KKT_INEQ_ELIMINATED: 2>
+def solve_many(solvers: list, n_threads: int = 0) -> list[piqp.Status]:
+    ...
+PIQP_CANCELLED: piqp.Status  # value = <Status.PIQP_CANCELLED: -4>
 PIQP_DUAL_INFEASIBLE: piqp.Status  # value = <Status.PIQP_DUAL_INFEASIBLE: -3>
 PIQP_INVALID_SETTINGS: piqp.Status  # value = <Status.PIQP_INVALID_SETTINGS: -10>
 PIQP_MAX_ITER_REACHED: piqp.Status  # value = <Status.PIQP_MAX_ITER_REACHED: -1>
 PIQP_NUMERICS: piqp.Status  # value = <Status.PIQP_NUMERICS: -8>
 PIQP_PRIMAL_INFEASIBLE: piqp.Status  # value = <Status.PIQP_PRIMAL_INFEASIBLE: -2>
+PIQP_REAL_TIME_LIMIT_REACHED: piqp.Status  # value = <Status.PIQP_REAL_TIME_LIMIT_REACHED: -6>
 PIQP_SOLVED: piqp.Status  # value = <Status.PIQP_SOLVED: 1>
+PIQP_TIME_LIMIT_REACHED: piqp.Status  # value = <Status.PIQP_TIME_LIMIT_REACHED: -5>
 PIQP_UNSOLVED: piqp.Status  # value = <Status.PIQP_UNSOLVED: -9>
 __version__: str = '0.3.1'
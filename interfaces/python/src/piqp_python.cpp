@@ -6,11 +6,19 @@
 // This source code is licensed under the BSD 2-Clause License found in the
 // LICENSE file in the root directory of this source tree.
 
+#include <algorithm>
+#include <functional>
+#include <future>
+#include <string>
+#include <vector>
+
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 #include <pybind11/eigen.h>
 
 #include "piqp/piqp.hpp"
+#include "piqp/dynamic_sparse_solver.hpp"
+#include "piqp/utils/thread_pool.hpp"
 
 #define STRINGIFY(x) #x
 #define MACRO_STRINGIFY(x) STRINGIFY(x)
@@ -27,17 +35,83 @@ struct py::detail::type_caster<tl::nullopt_t> : public py::detail::void_caster<t
 using T = double;
 using I = int;
 
+// sparsity pattern of a matrix passed to setup, such that updates can pass only the values
+struct SparsityPattern
+{
+    piqp::isize rows = 0;
+    piqp::isize cols = 0;
+    Eigen::Matrix<I, Eigen::Dynamic, 1> outer;
+    Eigen::Matrix<I, Eigen::Dynamic, 1> inner;
+
+    void store(const piqp::optional<piqp::SparseMat<T, I>>& M)
+    {
+        if (!M.has_value())
+        {
+            rows = cols = 0;
+            outer.setZero(1);
+            inner.resize(0);
+            return;
+        }
+        piqp::SparseMat<T, I> compressed;
+        const piqp::SparseMat<T, I>* src = &*M;
+        if (!M->isCompressed())
+        {
+            compressed = *M;
+            compressed.makeCompressed();
+            src = &compressed;
+        }
+        rows = src->rows();
+        cols = src->cols();
+        outer = Eigen::Map<const Eigen::Matrix<I, Eigen::Dynamic, 1>>(src->outerIndexPtr(), cols + 1);
+        inner = Eigen::Map<const Eigen::Matrix<I, Eigen::Dynamic, 1>>(src->innerIndexPtr(), src->nonZeros());
+    }
+
+    // maps the values onto the stored pattern without copying them
+    piqp::optional<piqp::CSparseMatRef<T, I>> map(const char* name, const piqp::optional<piqp::CVecRef<T>>& values) const
+    {
+        if (!values.has_value()) return piqp::nullopt;
+        if (values->size() != inner.size())
+        {
+            throw py::value_error(std::string(name) + " has " + std::to_string(values->size()) +
+                                  " values, but the matrix passed to setup has " + std::to_string(inner.size()) + " non-zeros");
+        }
+        Eigen::Map<const piqp::SparseMat<T, I>> M(rows, cols, inner.size(), outer.data(), inner.data(), values->data());
+        return piqp::CSparseMatRef<T, I>(M);
+    }
+};
+
+class SparseSolver : public piqp::DynamicSparseSolver<T, I>
+{
+public:
+    using piqp::DynamicSparseSolver<T, I>::DynamicSparseSolver;
+
+    SparsityPattern P_pattern;
+    SparsityPattern A_pattern;
+    SparsityPattern G_pattern;
+};
+
 PYBIND11_MODULE(PYTHON_MODULE_NAME, m) {
     py::enum_<piqp::Status>(m, "Status")
         .value("PIQP_SOLVED", piqp::Status::PIQP_SOLVED)
         .value("PIQP_MAX_ITER_REACHED", piqp::Status::PIQP_MAX_ITER_REACHED)
         .value("PIQP_PRIMAL_INFEASIBLE", piqp::Status::PIQP_PRIMAL_INFEASIBLE)
         .value("PIQP_DUAL_INFEASIBLE", piqp::Status::PIQP_DUAL_INFEASIBLE)
+        .value("PIQP_CANCELLED", piqp::Status::PIQP_CANCELLED)
+        .value("PIQP_TIME_LIMIT_REACHED", piqp::Status::PIQP_TIME_LIMIT_REACHED)
+        .value("PIQP_REAL_TIME_LIMIT_REACHED", piqp::Status::PIQP_REAL_TIME_LIMIT_REACHED)
         .value("PIQP_NUMERICS", piqp::Status::PIQP_NUMERICS)
         .value("PIQP_UNSOLVED", piqp::Status::PIQP_UNSOLVED)
         .value("PIQP_INVALID_SETTINGS", piqp::Status::PIQP_INVALID_SETTINGS)
         .export_values();
 
+    py::enum_<piqp::KKTMode>(m, "KKTMode")
+        .value("KKT_FULL", piqp::KKTMode::KKT_FULL)
+        .value("KKT_EQ_ELIMINATED", piqp::KKTMode::KKT_EQ_ELIMINATED)
+        .value("KKT_INEQ_ELIMINATED", piqp::KKTMode::KKT_INEQ_ELIMINATED)
+        .value("KKT_ALL_ELIMINATED", piqp::KKTMode::KKT_ALL_ELIMINATED)
+        .value("KKT_AUTO", piqp::KKTMode::KKT_AUTO)
+        .export_values();
+
     py::class_<piqp::Info<T>>(m, "Info")
         .def(py::init<>())
         .def_readwrite("status", &piqp::Info<T>::status)
@@ -60,25 +134,34 @@ PYBIND11_MODULE(PYTHON_MODULE_NAME, m) {
         .def_readwrite("reg_limit", &piqp::Info<T>::reg_limit)
         .def_readwrite("no_primal_update", &piqp::Info<T>::no_primal_update)
         .def_readwrite("no_dual_update", &piqp::Info<T>::no_dual_update)
+        .def_readwrite("kkt_nnz", &piqp::Info<T>::kkt_nnz)
+        .def_readwrite("kkt_factor_nnz", &piqp::Info<T>::kkt_factor_nnz)
+        .def_readwrite("kkt_fill_ratio", &piqp::Info<T>::kkt_fill_ratio)
+        .def_readwrite("factor_flops", &piqp::Info<T>::factor_flops)
+        .def_readwrite("solve_flops", &piqp::Info<T>::solve_flops)
+        .def_readwrite("etree_height", &piqp::Info<T>::etree_height)
+        .def_readwrite("etree_width", &piqp::Info<T>::etree_width)
+        .def_readwrite("workspace_bytes", &piqp::Info<T>::workspace_bytes)
         .def_readwrite("setup_time", &piqp::Info<T>::setup_time)
         .def_readwrite("update_time", &piqp::Info<T>::update_time)
         .def_readwrite("solve_time", &piqp::Info<T>::solve_time)
         .def_readwrite("run_time", &piqp::Info<T>::run_time);
 
+    // the vectors are read-only numpy views into the solver, which is kept alive by them
     py::class_<piqp::Result<T>>(m, "Result")
-        .def_readwrite("x", &piqp::Result<T>::x)
-        .def_readwrite("y", &piqp::Result<T>::y)
-        .def_readwrite("z", &piqp::Result<T>::z)
-        .def_readwrite("z_lb", &piqp::Result<T>::z_lb)
-        .def_readwrite("z_ub", &piqp::Result<T>::z_ub)
-        .def_readwrite("s", &piqp::Result<T>::s)
-        .def_readwrite("s_lb", &piqp::Result<T>::s_lb)
-        .def_readwrite("s_ub", &piqp::Result<T>::s_ub)
-        .def_readwrite("zeta", &piqp::Result<T>::zeta)
-        .def_readwrite("lambda", &piqp::Result<T>::lambda)
-        .def_readwrite("nu", &piqp::Result<T>::nu)
-        .def_readwrite("nu_lb", &piqp::Result<T>::nu_lb)
-        .def_readwrite("nu_ub", &piqp::Result<T>::nu_ub)
+        .def_readonly("x", &piqp::Result<T>::x)
+        .def_readonly("y", &piqp::Result<T>::y)
+        .def_readonly("z", &piqp::Result<T>::z)
+        .def_readonly("z_lb", &piqp::Result<T>::z_lb)
+        .def_readonly("z_ub", &piqp::Result<T>::z_ub)
+        .def_readonly("s", &piqp::Result<T>::s)
+        .def_readonly("s_lb", &piqp::Result<T>::s_lb)
+        .def_readonly("s_ub", &piqp::Result<T>::s_ub)
+        .def_readonly("zeta", &piqp::Result<T>::zeta)
+        .def_readonly("lambda", &piqp::Result<T>::lambda)
+        .def_readonly("nu", &piqp::Result<T>::nu)
+        .def_readonly("nu_lb", &piqp::Result<T>::nu_lb)
+        .def_readonly("nu_ub", &piqp::Result<T>::nu_ub)
         .def_readwrite("info", &piqp::Result<T>::info);
 
     py::class_<piqp::Settings<T>>(m, "Settings")
@@ -95,6 +178,10 @@ PYBIND11_MODULE(PYTHON_MODULE_NAME, m) {
         .def_readwrite("reg_finetune_dual_update_threshold", &piqp::Settings<T>::reg_finetune_dual_update_threshold)
         .def_readwrite("max_iter", &piqp::Settings<T>::max_iter)
         .def_readwrite("max_factor_retires", &piqp::Settings<T>::max_factor_retires)
+        .def_readwrite("time_limit", &piqp::Settings<T>::time_limit)
+        .def_readwrite("real_time", &piqp::Settings<T>::real_time)
+        .def_readwrite("real_time_max_factor_retires", &piqp::Settings<T>::real_time_max_factor_retires)
+        .def_readwrite("real_time_iterative_refinement_max_iter", &piqp::Settings<T>::real_time_iterative_refinement_max_iter)
         .def_readwrite("preconditioner_scale_cost", &piqp::Settings<T>::preconditioner_scale_cost)
         .def_readwrite("preconditioner_iter", &piqp::Settings<T>::preconditioner_iter)
         .def_readwrite("tau", &piqp::Settings<T>::tau)
@@ -106,13 +193,63 @@ PYBIND11_MODULE(PYTHON_MODULE_NAME, m) {
         .def_readwrite("iterative_refinement_static_regularization_eps", &piqp::Settings<T>::iterative_refinement_static_regularization_eps)
         .def_readwrite("iterative_refinement_static_regularization_rel", &piqp::Settings<T>::iterative_refinement_static_regularization_rel)
         .def_readwrite("verbose", &piqp::Settings<T>::verbose)
-        .def_readwrite("compute_timings", &piqp::Settings<T>::compute_timings);
+        .def_readwrite("compute_timings", &piqp::Settings<T>::compute_timings)
+        .def_readwrite("trace_capacity", &piqp::Settings<T>::trace_capacity)
+        .def_readwrite("n_threads", &piqp::Settings<T>::n_threads)
+        .def_readwrite("dense_ldlt_tuning", &piqp::Settings<T>::dense_ldlt_tuning);
+
+    py::class_<piqp::TraceEntry<T>>(m, "TraceEntry")
+        .def_readonly("solve", &piqp::TraceEntry<T>::solve)
+        .def_readonly("iter", &piqp::TraceEntry<T>::iter)
+        .def_readonly("primal_obj", &piqp::TraceEntry<T>::primal_obj)
+        .def_readonly("dual_obj", &piqp::TraceEntry<T>::dual_obj)
+        .def_readonly("duality_gap", &piqp::TraceEntry<T>::duality_gap)
+        .def_readonly("primal_inf", &piqp::TraceEntry<T>::primal_inf)
+        .def_readonly("dual_inf", &piqp::TraceEntry<T>::dual_inf)
+        .def_readonly("rho", &piqp::TraceEntry<T>::rho)
+        .def_readonly("delta", &piqp::TraceEntry<T>::delta)
+        .def_readonly("mu", &piqp::TraceEntry<T>::mu)
+        .def_readonly("sigma", &piqp::TraceEntry<T>::sigma)
+        .def_readonly("primal_step", &piqp::TraceEntry<T>::primal_step)
+        .def_readonly("dual_step", &piqp::TraceEntry<T>::dual_step)
+        .def_readonly("refine_iter", &piqp::TraceEntry<T>::refine_iter)
+        .def_readonly("factor_retires", &piqp::TraceEntry<T>::factor_retires)
+        .def_readonly("factor_time", &piqp::TraceEntry<T>::factor_time)
+        .def_readonly("predictor_time", &piqp::TraceEntry<T>::predictor_time)
+        .def_readonly("corrector_time", &piqp::TraceEntry<T>::corrector_time)
+        .def_readonly("residual_time", &piqp::TraceEntry<T>::residual_time);
+
+    py::class_<piqp::Trace<T>>(m, "Trace")
+        .def_property_readonly("capacity", &piqp::Trace<T>::capacity)
+        .def("__len__", &piqp::Trace<T>::size)
+        .def("__getitem__",
+             [](const piqp::Trace<T>& trace, piqp::isize i) -> const piqp::TraceEntry<T>&
+             {
+                 if (i < 0) i += trace.size();
+                 if (i < 0 || i >= trace.size()) throw py::index_error();
+                 return trace[i];
+             },
+             py::return_value_policy::reference_internal)
+        .def("clear", &piqp::Trace<T>::clear)
+        .def("to_csv", &piqp::Trace<T>::to_csv)
+        .def("to_json", &piqp::Trace<T>::to_json);
+
+    // the solve runs without the GIL, waiting for the result releases it as well
+    using SolveFuture = std::shared_future<piqp::Status>;
+    py::class_<SolveFuture>(m, "SolveFuture")
+        .def("result", &SolveFuture::get, py::call_guard<py::gil_scoped_release>())
+        .def("done", [](const SolveFuture& future) {
+            return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        });
 
-    using SparseSolver = piqp::SparseSolver<T, I, piqp::KKTMode::KKT_FULL>;
     py::class_<SparseSolver>(m, "SparseSolver")
-        .def(py::init<>())
+        .def(py::init([](piqp::KKTMode kkt_mode) { return new SparseSolver(kkt_mode); }),
+             py::arg("kkt_mode") = piqp::KKTMode::KKT_FULL)
+        .def_property_readonly("kkt_mode", [](const SparseSolver& solver) { return piqp::KKTMode(solver.kkt_mode()); })
         .def_property("settings", &SparseSolver::settings, &SparseSolver::settings)
         .def_property_readonly("result", &SparseSolver::result)
+        .def_property_readonly("trace", &SparseSolver::trace, py::return_value_policy::reference_internal)
+        .def("clear_trace", &SparseSolver::clear_trace)
         .def("setup",
              [](SparseSolver &solver,
                 const piqp::SparseMat<T, I>& P,
@@ -125,9 +262,13 @@ PYBIND11_MODULE(PYTHON_MODULE_NAME, m) {
                 const piqp::optional<piqp::CVecRef<T>>& x_ub = piqp::nullopt)
              {
                  solver.setup(P, c, A, b, G, h, x_lb, x_ub);
+                 solver.P_pattern.store(P);
+                 solver.A_pattern.store(A);
+                 solver.G_pattern.store(G);
              },
              py::arg("P"), py::arg("c"), py::arg("A"), py::arg("b"), py::arg("G"), py::arg("h"),
-             py::arg("x_lb") = piqp::nullopt, py::arg("x_ub") = piqp::nullopt)
+             py::arg("x_lb") = piqp::nullopt, py::arg("x_ub") = piqp::nullopt,
+             py::call_guard<py::gil_scoped_release>())
         .def("update",
              [](SparseSolver &solver,
                 const piqp::optional<piqp::SparseMat<T, I>>& P = piqp::nullopt,
@@ -146,26 +287,108 @@ PYBIND11_MODULE(PYTHON_MODULE_NAME, m) {
              py::arg("A") = piqp::nullopt, py::arg("b") = piqp::nullopt,
              py::arg("G") = piqp::nullopt, py::arg("h") = piqp::nullopt,
              py::arg("x_lb") = piqp::nullopt, py::arg("x_ub") = piqp::nullopt,
+             py::arg("reuse_preconditioner") = true,
+             py::call_guard<py::gil_scoped_release>())
+        // the matrices are given by their values in the CSC order of the matrices passed to setup,
+        // e.g., P.data of a scipy.sparse.csc_matrix, and are used without copying them
+        .def("update_values",
+             [](SparseSolver &solver,
+                const piqp::optional<piqp::CVecRef<T>>& P_data = piqp::nullopt,
+                const piqp::optional<piqp::CVecRef<T>>& c = piqp::nullopt,
+                const piqp::optional<piqp::CVecRef<T>>& A_data = piqp::nullopt,
+                const piqp::optional<piqp::CVecRef<T>>& b = piqp::nullopt,
+                const piqp::optional<piqp::CVecRef<T>>& G_data = piqp::nullopt,
+                const piqp::optional<piqp::CVecRef<T>>& h = piqp::nullopt,
+                const piqp::optional<piqp::CVecRef<T>>& x_lb = piqp::nullopt,
+                const piqp::optional<piqp::CVecRef<T>>& x_ub = piqp::nullopt,
+                bool reuse_preconditioner = true)
+             {
+                 piqp::optional<piqp::CSparseMatRef<T, I>> P = solver.P_pattern.map("P_data", P_data);
+                 piqp::optional<piqp::CSparseMatRef<T, I>> A = solver.A_pattern.map("A_data", A_data);
+                 piqp::optional<piqp::CSparseMatRef<T, I>> G = solver.G_pattern.map("G_data", G_data);
+                 py::gil_scoped_release release;
+                 solver.update(P, c, A, b, G, h, x_lb, x_ub, reuse_preconditioner);
+             },
+             py::arg("P_data") = piqp::nullopt, py::arg("c") = piqp::nullopt,
+             py::arg("A_data") = piqp::nullopt, py::arg("b") = piqp::nullopt,
+             py::arg("G_data") = piqp::nullopt, py::arg("h") = piqp::nullopt,
+             py::arg("x_lb") = piqp::nullopt, py::arg("x_ub") = piqp::nullopt,
              py::arg("reuse_preconditioner") = true)
-        .def("solve", &SparseSolver::solve);
+        .def("solve", &SparseSolver::solve, py::call_guard<py::gil_scoped_release>())
+        .def("solve_async", [](SparseSolver& solver) { return solver.solve_async().share(); }, py::keep_alive<0, 1>())
+        .def("cancel", &SparseSolver::cancel);
 
     using DenseSolver = piqp::DenseSolver<T>;
     py::class_<DenseSolver>(m, "DenseSolver")
         .def(py::init<>())
         .def_property("settings", &DenseSolver::settings, &DenseSolver::settings)
         .def_property_readonly("result", &DenseSolver::result)
+        .def_property_readonly("trace", &DenseSolver::trace, py::return_value_policy::reference_internal)
+        .def("clear_trace", &DenseSolver::clear_trace)
         .def("setup", &DenseSolver::setup,
              py::arg("P"), py::arg("c"),
              py::arg("A") = piqp::nullopt, py::arg("b") = piqp::nullopt,
              py::arg("G") = piqp::nullopt, py::arg("h") = piqp::nullopt,
-             py::arg("x_lb") = piqp::nullopt, py::arg("x_ub") = piqp::nullopt)
+             py::arg("x_lb") = piqp::nullopt, py::arg("x_ub") = piqp::nullopt,
+             py::call_guard<py::gil_scoped_release>())
         .def("update", &DenseSolver::update,
              py::arg("P") = piqp::nullopt, py::arg("c") = piqp::nullopt,
              py::arg("A") = piqp::nullopt, py::arg("b") = piqp::nullopt,
              py::arg("G") = piqp::nullopt, py::arg("h") = piqp::nullopt,
              py::arg("x_lb") = piqp::nullopt, py::arg("x_ub") = piqp::nullopt,
-             py::arg("reuse_preconditioner") = true)
-        .def("solve", &DenseSolver::solve);
+             py::arg("reuse_preconditioner") = true,
+             py::call_guard<py::gil_scoped_release>())
+        .def("solve", &DenseSolver::solve, py::call_guard<py::gil_scoped_release>())
+        .def("solve_async", [](DenseSolver& solver) { return solver.solve_async().share(); }, py::keep_alive<0, 1>())
+        .def("cancel", &DenseSolver::cancel);
+
+    // solves distinct solvers in parallel on native threads without the GIL
+    m.def("solve_many",
+          [](const py::list& solvers, piqp::isize n_threads)
+          {
+              std::vector<std::function<piqp::Status()>> solves;
+              std::vector<const void*> instances;
+              solves.reserve(solvers.size());
+              instances.reserve(solvers.size());
+              for (const py::handle& solver : solvers)
+              {
+                  const void* instance = nullptr;
+                  if (py::isinstance<SparseSolver>(solver))
+                  {
+                      SparseSolver* sparse_solver = solver.cast<SparseSolver*>();
+                      solves.emplace_back([sparse_solver]() { return sparse_solver->solve(); });
+                      instance = sparse_solver;
+                  }
+                  else if (py::isinstance<DenseSolver>(solver))
+                  {
+                      DenseSolver* dense_solver = solver.cast<DenseSolver*>();
+                      solves.emplace_back([dense_solver]() { return dense_solver->solve(); });
+                      instance = dense_solver;
+                  }
+                  else
+                  {
+                      throw py::type_error("solve_many expects a list of SparseSolver or DenseSolver objects");
+                  }
+                  // a solver must not be solved on two threads at the same time
+                  if (std::find(instances.begin(), instances.end(), instance) != instances.end())
+                  {
+                      throw py::value_error("solve_many expects distinct solvers, but a solver appears more than once");
+                  }
+                  instances.push_back(instance);
+              }
+
+              std::vector<piqp::Status> status(solves.size());
+              {
+                  py::gil_scoped_release release;
+                  if (n_threads <= 0) n_threads = piqp::ThreadPool::hardware_threads();
+                  piqp::ThreadPool pool(std::max(piqp::isize(1), std::min(n_threads, piqp::isize(solves.size()))));
+                  pool.parallel_for(piqp::isize(solves.size()), [&](piqp::isize i) {
+                      status[std::size_t(i)] = solves[std::size_t(i)]();
+                  });
+              }
+              return status;
+          },
+          py::arg("solvers"), py::arg("n_threads") = 0);
 
 #ifdef VERSION_INFO
     m.attr("__version__") = MACRO_STRINGIFY(VERSION_INFO);
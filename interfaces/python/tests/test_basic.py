@@ -6,7 +6,9 @@
 # This source code is licensed under the BSD 2-Clause License found in the
 # LICENSE file in the root directory of this source tree.
 
+import gc
 import time
+import pytest
 import numpy as np
 from scipy import sparse
 import piqp
@@ -51,5 +53,142 @@ def test_main():
     print(f'Execution time python dense: {end_time - start_time:.3e}s')
 
 
+def test_async_and_time_limit():
+    P = sparse.csc_matrix([[4, 1], [1, 2]], dtype=np.float64)
+    c = np.array([1, 1], dtype=np.float64)
+    A = sparse.csc_matrix([[1, 1]], dtype=np.float64)
+    b = np.array([1], dtype=np.float64)
+    G = sparse.csc_matrix([[1, 0], [-1, 0]], dtype=np.float64)
+    h = np.array([0.7, 0], dtype=np.float64)
+
+    solver = piqp.SparseSolver()
+    solver.setup(P, c, A, b, G, h)
+    future = solver.solve_async()
+    assert future.result() == piqp.PIQP_SOLVED
+    assert future.done()
+
+    solver.settings.time_limit = 1e-12
+    assert solver.solve() == piqp.PIQP_TIME_LIMIT_REACHED
+
+
+def test_solve_many():
+    P = sparse.csc_matrix([[4, 1], [1, 2]], dtype=np.float64)
+    c = np.array([1, 1], dtype=np.float64)
+    A = sparse.csc_matrix([[1, 1]], dtype=np.float64)
+    b = np.array([1], dtype=np.float64)
+    G = sparse.csc_matrix([[1, 0], [-1, 0]], dtype=np.float64)
+    h = np.array([0.7, 0], dtype=np.float64)
+
+    solvers = []
+    for i in range(4):
+        solver = piqp.SparseSolver()
+        solver.setup(P, c + i, A, b, G, h)
+        solvers.append(solver)
+    dense_solver = piqp.DenseSolver()
+    dense_solver.setup(P.toarray(), c, A.toarray(), b, G.toarray(), h)
+    solvers.append(dense_solver)
+
+    status = piqp.solve_many(solvers, n_threads=2)
+    assert status == [piqp.PIQP_SOLVED] * len(solvers)
+    for solver in solvers[:4]:
+        assert solver.result.info.status == piqp.PIQP_SOLVED
+    assert np.allclose(dense_solver.result.x, solvers[0].result.x, atol=1e-6)
+
+    # the same solver can not be solved on two threads at the same time
+    with pytest.raises(ValueError):
+        piqp.solve_many([solvers[0], dense_solver, solvers[0]])
+    with pytest.raises(TypeError):
+        piqp.solve_many([solvers[0], None])
+
+
+def test_result_views_and_update_values():
+    P = sparse.csc_matrix([[4, 1], [1, 2]], dtype=np.float64)
+    c = np.array([1, 1], dtype=np.float64)
+    A = sparse.csc_matrix([[1, 1]], dtype=np.float64)
+    b = np.array([1], dtype=np.float64)
+    G = sparse.csc_matrix([[1, 0], [-1, 0]], dtype=np.float64)
+    h = np.array([0.7, 0], dtype=np.float64)
+
+    solver = piqp.SparseSolver()
+    solver.setup(P, c, A, b, G, h)
+    assert solver.solve() == piqp.PIQP_SOLVED
+
+    # the result vectors are read-only views into the solver
+    x = solver.result.x
+    assert not x.flags.writeable
+    assert np.shares_memory(x, solver.result.x)
+
+    ref_solver = piqp.SparseSolver()
+    ref_solver.setup(P, c, A, b, G, h)
+    P_new = P.copy()
+    P_new.data *= 2
+    ref_solver.update(P=P_new)
+    assert ref_solver.solve() == piqp.PIQP_SOLVED
+
+    solver.update_values(P_data=P_new.data)
+    assert solver.solve() == piqp.PIQP_SOLVED
+    assert np.allclose(solver.result.x, ref_solver.result.x)
+    assert np.allclose(x, ref_solver.result.x)
+
+    # the views keep the solver alive
+    x_sol = x.copy()
+    del solver
+    gc.collect()
+    assert np.array_equal(x, x_sol)
+    with pytest.raises(ValueError):
+        x[0] = 0
+
+
+def test_update_values_wrong_length():
+    P = sparse.csc_matrix([[4, 1], [1, 2]], dtype=np.float64)
+    c = np.array([1, 1], dtype=np.float64)
+    A = sparse.csc_matrix([[1, 1]], dtype=np.float64)
+    b = np.array([1], dtype=np.float64)
+    G = sparse.csc_matrix([[1, 0], [-1, 0]], dtype=np.float64)
+    h = np.array([0.7, 0], dtype=np.float64)
+
+    solver = piqp.SparseSolver()
+    solver.setup(P, c, A, b, G, h)
+    assert solver.solve() == piqp.PIQP_SOLVED
+    x_sol = solver.result.x.copy()
+
+    with pytest.raises(ValueError):
+        solver.update_values(P_data=np.ones(P.nnz + 1))
+    with pytest.raises(ValueError):
+        solver.update_values(A_data=np.ones(A.nnz - 1))
+    with pytest.raises(ValueError):
+        solver.update_values(G_data=np.ones(G.nnz + 1))
+
+    # the rejected updates leave the problem unchanged
+    assert solver.solve() == piqp.PIQP_SOLVED
+    assert np.allclose(solver.result.x, x_sol)
+
+
+def test_kkt_modes():
+    P = sparse.csc_matrix([[4, 1], [1, 2]], dtype=np.float64)
+    c = np.array([1, 1], dtype=np.float64)
+    A = sparse.csc_matrix([[1, 1]], dtype=np.float64)
+    b = np.array([1], dtype=np.float64)
+    G = sparse.csc_matrix([[1, 0], [-1, 0]], dtype=np.float64)
+    h = np.array([0.7, 0], dtype=np.float64)
+
+    ref_solver = piqp.SparseSolver()
+    ref_solver.setup(P, c, A, b, G, h)
+    assert ref_solver.kkt_mode == piqp.KKT_FULL
+    assert ref_solver.solve() == piqp.PIQP_SOLVED
+
+    for kkt_mode in [piqp.KKT_EQ_ELIMINATED, piqp.KKT_INEQ_ELIMINATED, piqp.KKT_ALL_ELIMINATED, piqp.KKT_AUTO]:
+        solver = piqp.SparseSolver(kkt_mode=kkt_mode)
+        solver.setup(P, c, A, b, G, h)
+        assert solver.kkt_mode != piqp.KKT_AUTO
+        assert solver.solve() == piqp.PIQP_SOLVED
+        assert np.allclose(solver.result.x, ref_solver.result.x, atol=1e-6)
+
+
 if __name__ == '__main__':
     test_main()
+    test_async_and_time_limit()
+    test_solve_many()
+    test_result_views_and_update_values()
+    test_update_values_wrong_length()
+    test_kkt_modes()
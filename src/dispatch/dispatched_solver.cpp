@@ -0,0 +1,128 @@
+// This file is part of PIQP.
+//
+// Copyright (c) 2024 EPFL
+//
+// This source code is licensed under the BSD 2-Clause License found in the
+// LICENSE file in the root directory of this source tree.
+
+// The dispatched solvers of libpiqp. With instruction set variants, the template instantiations
+// are additionally compiled into the modules piqp_<variant> next to libpiqp (module.cpp), and the
+// best one supported by the CPU creates the solvers. The baseline is libpiqp itself.
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "piqp/dispatched_solver.hpp"
+#include "solver_implementation.hpp"
+
+#ifdef PIQP_WITH_ISA_VARIANTS
+#include "instruction_set.hpp"
+#endif
+
+namespace piqp
+{
+
+namespace
+{
+
+using DenseSolverInterface = dispatch::SolverInterface<common::Scalar, CMatRef<common::Scalar>>;
+using SparseSolverInterface = dispatch::SolverInterface<common::Scalar, CSparseMatRef<common::Scalar, common::StorageIndex>>;
+
+struct Module
+{
+    const char* instruction_set = nullptr;
+    // null for the solvers of libpiqp itself
+    DenseSolverInterface* (*create_dense_solver)() = nullptr;
+    SparseSolverInterface* (*create_sparse_solver)() = nullptr;
+};
+
+const char* compiled_instruction_set()
+{
+#if defined(__AVX512F__)
+    return "avx512";
+#elif defined(__AVX2__)
+    return "avx2";
+#elif defined(__SSE4_2__)
+    return "sse42";
+#else
+    return "baseline";
+#endif
+}
+
+Module load_module()
+{
+    Module module;
+#ifdef PIQP_WITH_ISA_VARIANTS
+    std::string directory = dispatch::module_directory();
+    dispatch::load_best_variant([&](const char* instruction_set) {
+        if (std::strcmp(instruction_set, "baseline") == 0) return true;
+
+        std::string path = directory + PIQP_MODULE_PREFIX + "piqp_" + instruction_set + PIQP_MODULE_SUFFIX;
+        void* handle = dispatch::open_module(path);
+        if (!handle)
+        {
+            std::fprintf(stderr, "piqp: could not load the instruction set variant '%s'\n", path.c_str());
+            return false;
+        }
+        auto create_dense_solver = dispatch::module_function<decltype(module.create_dense_solver)>(handle, "piqp_create_dense_solver");
+        auto create_sparse_solver = dispatch::module_function<decltype(module.create_sparse_solver)>(handle, "piqp_create_sparse_solver");
+        if (!create_dense_solver || !create_sparse_solver) return false;
+
+        module.instruction_set = instruction_set;
+        module.create_dense_solver = create_dense_solver;
+        module.create_sparse_solver = create_sparse_solver;
+        return true;
+    });
+#endif
+    if (!module.instruction_set)
+    {
+        module.instruction_set = compiled_instruction_set();
+    }
+    return module;
+}
+
+const Module& module()
+{
+    static const Module loaded = load_module();
+    return loaded;
+}
+
+template<typename MatRef>
+struct SolverFactory;
+
+template<>
+struct SolverFactory<CMatRef<common::Scalar>>
+{
+    static DenseSolverInterface* create()
+    {
+        if (module().create_dense_solver) return module().create_dense_solver();
+        return new dispatch::DenseSolverImplementation();
+    }
+};
+
+template<>
+struct SolverFactory<CSparseMatRef<common::Scalar, common::StorageIndex>>
+{
+    static SparseSolverInterface* create()
+    {
+        if (module().create_sparse_solver) return module().create_sparse_solver();
+        return new dispatch::SparseSolverImplementation();
+    }
+};
+
+} // namespace
+
+template<typename T, typename MatRef>
+DispatchedSolver<T, MatRef>::DispatchedSolver() : m_solver(SolverFactory<MatRef>::create()) {}
+
+template<typename T, typename MatRef>
+const char* DispatchedSolver<T, MatRef>::instruction_set()
+{
+    return module().instruction_set;
+}
+
+template class DispatchedSolver<common::Scalar, CMatRef<common::Scalar>>;
+template class DispatchedSolver<common::Scalar, CSparseMatRef<common::Scalar, common::StorageIndex>>;
+
+} // namespace piqp
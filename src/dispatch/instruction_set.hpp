@@ -0,0 +1,122 @@
+// This file is part of PIQP.
+//
+// Copyright (c) 2024 EPFL
+//
+// This source code is licensed under the BSD 2-Clause License found in the
+// LICENSE file in the root directory of this source tree.
+
+// Selection and loading of the instruction set variants, shared by libpiqp and the C interface.
+// Everything has internal linkage, such that every library resolves its own directory.
+
+#ifndef PIQP_DISPATCH_INSTRUCTION_SET_HPP
+#define PIQP_DISPATCH_INSTRUCTION_SET_HPP
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "cpu_features_macros.h"
+#include "cpuinfo_x86.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+namespace piqp
+{
+
+namespace dispatch
+{
+
+namespace
+{
+
+// instruction set variants from best to worst
+const char* const instruction_sets[] = {"avx512", "avx2", "sse42", "baseline"};
+
+// the feature sets correspond to the x86-64 micro-architecture levels the variants are compiled for
+inline bool cpu_supports(const std::string& instruction_set)
+{
+    const cpu_features::X86Features features = cpu_features::GetX86Info().features;
+    bool sse42 = features.ssse3 && features.sse4_1 && features.sse4_2 && features.popcnt;
+    bool avx2 = sse42 && features.avx && features.avx2 && features.fma3 && features.bmi1 && features.bmi2 &&
+                features.f16c && features.movbe;
+    bool avx512 = avx2 && features.avx512f && features.avx512bw && features.avx512cd && features.avx512dq &&
+                  features.avx512vl;
+
+    if (instruction_set == "avx512") return avx512;
+    if (instruction_set == "avx2") return avx2;
+    if (instruction_set == "sse42") return sse42;
+    return instruction_set == "baseline";
+}
+
+// Calls load(instruction_set) for the variants supported by the CPU from best to worst until it
+// succeeds and returns the loaded variant, or nullptr if none could be loaded. The environment
+// variable PIQP_INSTRUCTION_SET limits the variants to the given one and below, e.g., to compare them.
+template<typename Load>
+const char* load_best_variant(Load&& load)
+{
+    const char* limit = std::getenv("PIQP_INSTRUCTION_SET");
+    bool allowed = !limit || std::strlen(limit) == 0;
+
+    for (const char* instruction_set : instruction_sets)
+    {
+        allowed = allowed || std::strcmp(limit, instruction_set) == 0;
+        if (!allowed || !cpu_supports(instruction_set)) continue;
+        if (load(instruction_set)) return instruction_set;
+    }
+    return nullptr;
+}
+
+// directory of the library this header is compiled into, including the trailing separator
+inline std::string module_directory()
+{
+#if defined(_WIN32)
+    HMODULE handle = nullptr;
+    char path[MAX_PATH];
+    if (!GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+                            reinterpret_cast<LPCSTR>(&module_directory), &handle) ||
+        GetModuleFileNameA(handle, path, MAX_PATH) == 0)
+    {
+        return "";
+    }
+    std::string file(path);
+    return file.substr(0, file.find_last_of("\\/") + 1);
+#else
+    Dl_info info;
+    if (!dladdr(reinterpret_cast<void*>(&module_directory), &info) || !info.dli_fname) return "";
+    std::string file(info.dli_fname);
+    std::size_t separator = file.find_last_of('/');
+    return separator == std::string::npos ? "" : file.substr(0, separator + 1);
+#endif
+}
+
+// the modules are never unloaded, returns nullptr on failure
+inline void* open_module(const std::string& path)
+{
+#if defined(_WIN32)
+    return reinterpret_cast<void*>(LoadLibraryA(path.c_str()));
+#else
+    return dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+#endif
+}
+
+template<typename Function>
+Function module_function(void* module, const char* name)
+{
+#if defined(_WIN32)
+    return reinterpret_cast<Function>(reinterpret_cast<void*>(GetProcAddress(reinterpret_cast<HMODULE>(module), name)));
+#else
+    return reinterpret_cast<Function>(dlsym(module, name));
+#endif
+}
+
+} // namespace
+
+} // namespace dispatch
+
+} // namespace piqp
+
+#endif //PIQP_DISPATCH_INSTRUCTION_SET_HPP
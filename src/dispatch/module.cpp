@@ -0,0 +1,25 @@
+// This file is part of PIQP.
+//
+// Copyright (c) 2024 EPFL
+//
+// This source code is licensed under the BSD 2-Clause License found in the
+// LICENSE file in the root directory of this source tree.
+
+// Entry points of the instruction set modules piqp_<variant>, which are compiled from the template
+// instantiations of libpiqp with the corresponding instruction set, see dispatched_solver.cpp.
+
+#include "solver_implementation.hpp"
+
+extern "C" {
+
+piqp::dispatch::SolverInterface<piqp::common::Scalar, piqp::CMatRef<piqp::common::Scalar>>* piqp_create_dense_solver()
+{
+    return new piqp::dispatch::DenseSolverImplementation();
+}
+
+piqp::dispatch::SolverInterface<piqp::common::Scalar, piqp::CSparseMatRef<piqp::common::Scalar, piqp::common::StorageIndex>>* piqp_create_sparse_solver()
+{
+    return new piqp::dispatch::SparseSolverImplementation();
+}
+
+}
@@ -0,0 +1,78 @@
+// This file is part of PIQP.
+//
+// Copyright (c) 2024 EPFL
+//
+// This source code is licensed under the BSD 2-Clause License found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef PIQP_DISPATCH_SOLVER_IMPLEMENTATION_HPP
+#define PIQP_DISPATCH_SOLVER_IMPLEMENTATION_HPP
+
+#include "piqp/solver.hpp"
+#include "piqp/dispatched_solver.hpp"
+
+namespace piqp
+{
+
+namespace dispatch
+{
+
+// implements the interface of the dispatched solvers by the solver compiled into the current library
+template<typename Solver, typename T, typename MatRef>
+class SolverImplementation : public SolverInterface<T, MatRef>
+{
+protected:
+    Solver m_solver;
+
+public:
+    Settings<T>& settings() override { return m_solver.settings(); }
+
+    const Result<T>& result() const override { return m_solver.result(); }
+
+    void setup(const MatRef& P,
+               const CVecRef<T>& c,
+               const optional<MatRef>& A,
+               const optional<CVecRef<T>>& b,
+               const optional<MatRef>& G,
+               const optional<CVecRef<T>>& h,
+               const optional<CVecRef<T>>& x_lb,
+               const optional<CVecRef<T>>& x_ub) override
+    {
+        m_solver.setup(P, c, A, b, G, h, x_lb, x_ub);
+    }
+
+    void update(const optional<MatRef>& P,
+                const optional<CVecRef<T>>& c,
+                const optional<MatRef>& A,
+                const optional<CVecRef<T>>& b,
+                const optional<MatRef>& G,
+                const optional<CVecRef<T>>& h,
+                const optional<CVecRef<T>>& x_lb,
+                const optional<CVecRef<T>>& x_ub,
+                bool reuse_preconditioner) override
+    {
+        m_solver.update(P, c, A, b, G, h, x_lb, x_ub, reuse_preconditioner);
+    }
+
+    void warm_start(const optional<CVecRef<T>>& x,
+                    const optional<CVecRef<T>>& y,
+                    const optional<CVecRef<T>>& z,
+                    const optional<CVecRef<T>>& z_lb,
+                    const optional<CVecRef<T>>& z_ub) override
+    {
+        m_solver.warm_start(x, y, z, z_lb, z_ub);
+    }
+
+    Status solve() override { return m_solver.solve(); }
+
+    void cancel() override { m_solver.cancel(); }
+};
+
+using DenseSolverImplementation = SolverImplementation<DenseSolver<common::Scalar>, common::Scalar, CMatRef<common::Scalar>>;
+using SparseSolverImplementation = SolverImplementation<SparseSolver<common::Scalar, common::StorageIndex>, common::Scalar, CSparseMatRef<common::Scalar, common::StorageIndex>>;
+
+} // namespace dispatch
+
+} // namespace piqp
+
+#endif //PIQP_DISPATCH_SOLVER_IMPLEMENTATION_HPP
@@ -0,0 +1,20 @@
+// This file is part of PIQP.
+//
+// Copyright (c) 2024 EPFL
+//
+// This source code is licensed under the BSD 2-Clause License found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "piqp/sparse/block_kkt.hpp"
+
+namespace piqp
+{
+
+namespace sparse
+{
+
+template struct BlockKKT<common::Scalar, common::StorageIndex>;
+
+} // namespace sparse
+
+} // namespace piqp
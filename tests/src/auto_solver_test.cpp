@@ -0,0 +1,105 @@
+// This file is part of PIQP.
+//
+// Copyright (c) 2024 EPFL
+//
+// This source code is licensed under the BSD 2-Clause License found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "piqp/auto_solver.hpp"
+#include "piqp/utils/filesystem.hpp"
+#include "piqp/utils/random_utils.hpp"
+
+#include "gtest/gtest.h"
+
+using namespace piqp;
+
+using T = double;
+using I = int;
+
+TEST(AutoSolverTest, ForcedBackendsAgree)
+{
+    isize dim = 30;
+    isize n_eq = 5;
+    isize n_ineq = 10;
+    sparse::Model<T, I> model = rand::sparse_strongly_convex_qp<T, I>(dim, n_eq, n_ineq, 0.2);
+
+    // the dense backend is always chosen if the density threshold is below any density
+    CostModel<T> dense_model;
+    dense_model.dense_density_threshold = 0;
+
+    // the sparse backend is chosen if the dense backend is predicted to be very slow
+    CostModel<T> sparse_model;
+    sparse_model.dense_flops_per_sec = 1;
+    sparse_model.dense_density_threshold = 1.1;
+
+    AutoSolver<T, I> dense_solver;
+    dense_solver.set_cost_model(dense_model);
+    dense_solver.setup(model.P, model.c, model.A, model.b, model.G, model.h, model.x_lb, model.x_ub);
+    ASSERT_EQ(dense_solver.backend(), BACKEND_DENSE);
+    ASSERT_EQ(dense_solver.solve(), Status::PIQP_SOLVED);
+
+    AutoSolver<T, I> sparse_solver;
+    sparse_solver.set_cost_model(sparse_model);
+    sparse_solver.setup(model.P, model.c, model.A, model.b, model.G, model.h, model.x_lb, model.x_ub);
+    ASSERT_EQ(sparse_solver.backend(), BACKEND_SPARSE);
+    ASSERT_GT(sparse_solver.estimated_dense_time(), sparse_solver.estimated_sparse_time());
+    ASSERT_EQ(sparse_solver.solve(), Status::PIQP_SOLVED);
+
+    ASSERT_NEAR(dense_solver.result().info.primal_obj, sparse_solver.result().info.primal_obj, 1e-6);
+
+    // updates are forwarded to the chosen backend
+    model.c.setOnes();
+    dense_solver.update(nullopt, model.c, model.A);
+    sparse_solver.update(nullopt, model.c, model.A);
+    ASSERT_EQ(dense_solver.solve(), Status::PIQP_SOLVED);
+    ASSERT_EQ(sparse_solver.solve(), Status::PIQP_SOLVED);
+    ASSERT_NEAR(dense_solver.result().info.primal_obj, sparse_solver.result().info.primal_obj, 1e-6);
+}
+
+TEST(AutoSolverTest, CostModelSaveLoad)
+{
+    CostModel<T> model;
+    model.dense_flops_per_sec = 1.25e10;
+    model.sparse_flops_per_sec = 3.5e9;
+    model.dense_overhead = 1.5e-6;
+    model.sparse_overhead = 4e-6;
+    model.dense_density_threshold = 0.3;
+
+    std::string path = (fs::temp_directory_path() / "piqp_cost_model_test.txt").string();
+    ASSERT_TRUE(model.save(path));
+
+    CostModel<T> loaded;
+    ASSERT_TRUE(loaded.load(path));
+    ASSERT_EQ(loaded.dense_flops_per_sec, model.dense_flops_per_sec);
+    ASSERT_EQ(loaded.sparse_flops_per_sec, model.sparse_flops_per_sec);
+    ASSERT_EQ(loaded.dense_overhead, model.dense_overhead);
+    ASSERT_EQ(loaded.sparse_overhead, model.sparse_overhead);
+    ASSERT_EQ(loaded.dense_density_threshold, model.dense_density_threshold);
+    fs::remove(path);
+
+    ASSERT_FALSE(loaded.load(path));
+}
+
+TEST(AutoSolverTest, CalibrationIsPositive)
+{
+    CostModel<T> model = CostModel<T>::calibrate();
+    ASSERT_GT(model.dense_flops_per_sec, 0);
+    ASSERT_GT(model.sparse_flops_per_sec, 0);
+    ASSERT_GT(model.dense_overhead, 0);
+    ASSERT_GT(model.sparse_overhead, 0);
+}
+
+TEST(AutoSolverTest, SchurDenseEstimate)
+{
+    // with a positive diagonal P and few constraints, the dense backend factorizes the small Schur complement
+    CostModel<T> model;
+    ASSERT_LT(model.dense_iteration_time(200, 2, 3, true), model.dense_iteration_time(200, 2, 3));
+    ASSERT_EQ(model.dense_iteration_time(10, 20, 30, true), model.dense_iteration_time(10, 20, 30));
+}
+
+TEST(AutoSolverTest, NotSetup)
+{
+    AutoSolver<T, I> solver;
+    ASSERT_EQ(solver.result().info.status, Status::PIQP_UNSOLVED);
+    ASSERT_EQ(solver.solve(), Status::PIQP_UNSOLVED);
+}
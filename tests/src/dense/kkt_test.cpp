@@ -59,6 +59,119 @@ TEST(DenseKKTTest, UpdateScalings)
     assert_dense_triangular_equal<T, Eigen::Lower>(kkt.kkt_mat, kkt2.kkt_mat);
 }
 
+TEST(DenseKKTTest, IncrementalUpdateScalings)
+{
+    isize dim = 40;
+    isize n_eq = 10;
+    isize n_ineq = 80;
+
+    Model<T> qp_model = rand::dense_strongly_convex_qp<T>(dim, n_eq, n_ineq);
+    Data<T> data(qp_model);
+    Settings<T> settings;
+
+    T rho = 0.9;
+    T delta = 1e-2;
+
+    KKT<T> kkt(data, settings);
+    kkt.init(rho, delta);
+
+    Vec<T> s = rand::vector_rand<T>(n_ineq).cwiseAbs();
+    Vec<T> s_lb(dim); s_lb.setConstant(1);
+    Vec<T> s_ub(dim); s_ub.setConstant(1);
+    Vec<T> z = rand::vector_rand<T>(n_ineq).cwiseAbs();
+    Vec<T> z_lb = rand::vector_rand<T>(dim).cwiseAbs();
+    Vec<T> z_ub = rand::vector_rand<T>(dim).cwiseAbs();
+
+    for (int k = 0; k < 6; k++)
+    {
+        if (k % 2 == 0)
+        {
+            // few weights change, low-rank update
+            z(k) *= 10;
+            s(2 * k + 1) *= 0.1;
+        }
+        else
+        {
+            // all weights change
+            z.array() *= 1.5;
+            rho *= 0.5;
+        }
+
+        PIQP_EIGEN_MALLOC_NOT_ALLOWED();
+        kkt.update_scalings(rho, delta, s, s_lb, s_ub, z, z_lb, z_ub);
+        PIQP_EIGEN_MALLOC_ALLOWED();
+
+        ASSERT_EQ(kkt.kkt_incremental_updates, k + 1);
+        Mat<T> kkt_mat_incremental = kkt.kkt_mat.triangularView<Eigen::Lower>();
+
+        kkt.update_kkt();
+        Mat<T> kkt_mat_full = kkt.kkt_mat.triangularView<Eigen::Lower>();
+        ASSERT_TRUE(kkt_mat_incremental.isApprox(kkt_mat_full, 1e-12));
+
+        // continue from incrementally updated matrix
+        kkt.kkt_mat = kkt_mat_incremental;
+        kkt.kkt_incremental_updates = k + 1;
+    }
+
+    // a change of delta rebuilds the matrix
+    kkt.update_scalings(rho, 0.5 * delta, s, s_lb, s_ub, z, z_lb, z_ub);
+    ASSERT_EQ(kkt.kkt_incremental_updates, 0);
+}
+
+TEST(DenseKKTTest, IncrementalUpdateBoundCancellation)
+{
+    isize dim = 20;
+    isize n_eq = 0; // A^T A / delta would dominate the diagonal
+    isize n_ineq = 30;
+
+    Model<T> qp_model = rand::dense_strongly_convex_qp<T>(dim, n_eq, n_ineq);
+    Data<T> data(qp_model);
+    Settings<T> settings;
+    ASSERT_GT(data.n_lb, 0);
+
+    T rho = 1e-8;
+    T delta = 1e-10;
+
+    KKT<T> kkt(data, settings);
+    kkt.init(rho, delta);
+
+    Vec<T> s(n_ineq); s.setConstant(1);
+    Vec<T> s_lb(dim); s_lb.setConstant(1);
+    Vec<T> s_ub(dim); s_ub.setConstant(1);
+    Vec<T> z(n_ineq); z.setConstant(1);
+    Vec<T> z_lb(dim); z_lb.setConstant(1);
+    Vec<T> z_ub(dim); z_ub.setConstant(1);
+
+    kkt.update_scalings(rho, delta, s, s_lb, s_ub, z, z_lb, z_ub);
+    ASSERT_EQ(kkt.kkt_incremental_updates, 1);
+
+    // a bound dual swinging by orders of magnitude could cancel, the matrix is rebuilt
+    z_lb.setConstant(1e12);
+    kkt.update_scalings(rho, delta, s, s_lb, s_ub, z, z_lb, z_ub);
+    ASSERT_EQ(kkt.kkt_incremental_updates, 0);
+}
+
+TEST(DenseKKTTest, UpdateDataRescaledG)
+{
+    isize dim = 10;
+    isize n_eq = 8;
+    isize n_ineq = 9;
+
+    Model<T> qp_model = rand::dense_strongly_convex_qp<T>(dim, n_eq, n_ineq);
+    Data<T> data(qp_model);
+    Settings<T> settings;
+
+    KKT<T> kkt(data, settings);
+    kkt.init(0.9, 1.2);
+    ASSERT_EQ(kkt.formulation, DENSE_KKT_REDUCED);
+
+    // G rescaled by a new preconditioner without being updated
+    data.GT *= 2;
+    kkt.update_data(KKTUpdateOptions::KKT_UPDATE_NONE);
+    Vec<T> G_row_norms_sq = data.GT.colwise().squaredNorm().transpose();
+    ASSERT_TRUE(kkt.G_row_norms_sq.isApprox(G_row_norms_sq));
+}
+
 TEST(DenseKKTTest, UpdateData)
 {
     isize dim = 10;
@@ -10,6 +10,8 @@
 
 #include "piqp/piqp.hpp"
 #include "piqp/dense/ldlt_no_pivot.hpp"
+#include "piqp/dense/ldlt_tuning.hpp"
+#include "piqp/utils/filesystem.hpp"
 #include "piqp/utils/random_utils.hpp"
 
 #include "gtest/gtest.h"
@@ -75,3 +77,122 @@ TEST(DenseLDLT, SolveUpper)
 
     EXPECT_TRUE(b.isApprox(P_full * x, 1e-8));
 }
+
+TEST(DenseLDLT, MultithreadedMatchesSingleThreaded)
+{
+    isize dim = 300;
+
+    Mat<T> P = rand::dense_positive_definite_upper_triangular_rand<T>(dim);
+    P.transposeInPlace();
+
+    LDLTNoPivot<Mat<T>, Eigen::Lower> ldlt(dim);
+    ldlt.compute(P);
+    EXPECT_EQ(ldlt.info(), Eigen::Success);
+
+    ThreadPool pool(4);
+    LDLTNoPivot<Mat<T>, Eigen::Lower> ldlt_mt(dim);
+    ldlt_mt.setThreadPool(&pool);
+    ldlt_mt.compute(P);
+    EXPECT_EQ(ldlt_mt.info(), Eigen::Success);
+
+    Mat<T> L = ldlt.matrixLDLT().triangularView<Eigen::Lower>();
+    Mat<T> L_mt = ldlt_mt.matrixLDLT().triangularView<Eigen::Lower>();
+    EXPECT_TRUE(L.isApprox(L_mt, 1e-10));
+}
+
+TEST(DenseLDLT, RecursiveMatchesBlocked)
+{
+    for (isize dim : {7, 33, 100, 257})
+    {
+        Mat<T> P = rand::dense_positive_definite_upper_triangular_rand<T>(dim);
+        P.transposeInPlace();
+
+        LDLTNoPivot<Mat<T>, Eigen::Lower> ldlt(dim);
+        ldlt.compute(P);
+        EXPECT_EQ(ldlt.info(), Eigen::Success);
+
+        for (isize leaf_size : {0, 8, 16})
+        {
+            LDLTNoPivot<Mat<T>, Eigen::Lower> ldlt_rec(dim);
+            ldlt_rec.setKernel(LDLT_KERNEL_RECURSIVE, leaf_size);
+
+            PIQP_EIGEN_MALLOC_NOT_ALLOWED();
+            ldlt_rec.compute(P);
+            PIQP_EIGEN_MALLOC_ALLOWED();
+            EXPECT_EQ(ldlt_rec.info(), Eigen::Success);
+
+            Mat<T> L = ldlt.matrixLDLT().triangularView<Eigen::Lower>();
+            Mat<T> L_rec = ldlt_rec.matrixLDLT().triangularView<Eigen::Lower>();
+            EXPECT_TRUE(L.isApprox(L_rec, 1e-10));
+        }
+    }
+}
+
+TEST(DenseLDLT, RecursiveUpperAndThreaded)
+{
+    isize dim = 300;
+
+    Mat<T> P = rand::dense_positive_definite_upper_triangular_rand<T>(dim);
+
+    ThreadPool pool(4);
+    LDLTNoPivot<Mat<T>, Eigen::Upper> ldlt(dim);
+    ldlt.setKernel(LDLT_KERNEL_RECURSIVE);
+    ldlt.setThreadPool(&pool);
+    ldlt.compute(P);
+    EXPECT_EQ(ldlt.info(), Eigen::Success);
+
+    Vec<T> b = rand::vector_rand<T>(dim);
+    Vec<T> x = b;
+    ldlt.solveInPlace(x);
+
+    Mat<T> P_full = P + P.transpose();
+    P_full.diagonal().array() -= P.diagonal().array();
+
+    EXPECT_TRUE(b.isApprox(P_full * x, 1e-8));
+}
+
+TEST(DenseLDLT, TuningSaveAndLoad)
+{
+    LDLTTuning<T> tuning = LDLTTuning<T>::tune(96);
+    ASSERT_GE(tuning.block_size, 0);
+
+    std::string path = (fs::temp_directory_path() / "piqp_ldlt_tuning_test.txt").string();
+    fs::remove(path);
+
+    LDLTTuning<T> other;
+    other.kernel = LDLT_KERNEL_RECURSIVE;
+    other.block_size = 48;
+    ASSERT_TRUE(other.save(path, "f64 other cpu"));
+    ASSERT_TRUE(tuning.save(path));
+
+    // the entries of other CPUs are kept
+    LDLTTuning<T> loaded;
+    ASSERT_TRUE(loaded.load(path));
+    ASSERT_EQ(loaded.kernel, tuning.kernel);
+    ASSERT_EQ(loaded.block_size, tuning.block_size);
+    ASSERT_TRUE(loaded.load(path, "f64 other cpu"));
+    ASSERT_EQ(loaded.kernel, LDLT_KERNEL_RECURSIVE);
+    ASSERT_EQ(loaded.block_size, 48);
+    ASSERT_FALSE(loaded.load(path, "f64 unknown cpu"));
+    fs::remove(path);
+
+    ASSERT_FALSE(loaded.load(path));
+}
+
+TEST(DenseLDLT, TuneMachine)
+{
+    std::string path = (fs::temp_directory_path() / "piqp_ldlt_tune_machine_test.txt").string();
+    fs::remove(path);
+
+    // the machine tuning is only changed explicitly and is used by solvers set up afterwards
+    LDLTTuning<T> tuning = LDLTTuning<T>::tune_machine(path);
+    ASSERT_TRUE(fs::exists(path));
+    ASSERT_EQ(LDLTTuning<T>::machine().kernel, tuning.kernel);
+    ASSERT_EQ(LDLTTuning<T>::machine().block_size, tuning.block_size);
+
+    LDLTTuning<T> loaded;
+    ASSERT_TRUE(loaded.load(path));
+    ASSERT_EQ(loaded.kernel, tuning.kernel);
+    ASSERT_EQ(loaded.block_size, tuning.block_size);
+    fs::remove(path);
+}
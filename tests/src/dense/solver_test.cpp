@@ -179,6 +179,72 @@ TEST(DenseSolverTest, StronglyConvexWithEqualityAndInequalities)
     ASSERT_EQ(status, Status::PIQP_SOLVED);
 }
 
+TEST(DenseSolverTest, MultithreadedSameResult)
+{
+    isize dim = 200;
+    isize n_eq = 50;
+    isize n_ineq = 400;
+
+    dense::Model<T> qp_model = rand::dense_strongly_convex_qp<T>(dim, n_eq, n_ineq);
+
+    DenseSolver<T> solver;
+    solver.setup(qp_model.P, qp_model.c, qp_model.A, qp_model.b, qp_model.G, qp_model.h, qp_model.x_lb, qp_model.x_ub);
+    ASSERT_EQ(solver.solve(), Status::PIQP_SOLVED);
+
+    DenseSolver<T> solver_mt;
+    solver_mt.settings().n_threads = 4;
+    solver_mt.setup(qp_model.P, qp_model.c, qp_model.A, qp_model.b, qp_model.G, qp_model.h, qp_model.x_lb, qp_model.x_ub);
+    ASSERT_EQ(solver_mt.solve(), Status::PIQP_SOLVED);
+
+    EXPECT_EQ(solver.result().info.iter, solver_mt.result().info.iter);
+    EXPECT_TRUE(solver.result().x.isApprox(solver_mt.result().x, 1e-8));
+
+    // changing the number of threads between solves
+    solver_mt.settings().n_threads = 2;
+    ASSERT_EQ(solver_mt.solve(), Status::PIQP_SOLVED);
+    EXPECT_TRUE(solver.result().x.isApprox(solver_mt.result().x, 1e-8));
+}
+
+TEST(DenseSolverTest, SchurFormulationSameResult)
+{
+    isize dim = 300;
+    isize n_eq = 5;
+    isize n_ineq = 20;
+
+    dense::Model<T> qp_model = rand::dense_strongly_convex_qp<T>(dim, n_eq, n_ineq);
+    Vec<T> P_diag = qp_model.P.diagonal();
+    qp_model.P = P_diag.asDiagonal();
+
+    DenseSolver<T> solver_reduced;
+    solver_reduced.set_kkt_formulation(DENSE_KKT_REDUCED);
+    solver_reduced.setup(qp_model.P, qp_model.c, qp_model.A, qp_model.b, qp_model.G, qp_model.h, qp_model.x_lb, qp_model.x_ub);
+    ASSERT_EQ(solver_reduced.kkt_formulation(), DENSE_KKT_REDUCED);
+    ASSERT_EQ(solver_reduced.solve(), Status::PIQP_SOLVED);
+
+    DenseSolver<T> solver;
+    solver.setup(qp_model.P, qp_model.c, qp_model.A, qp_model.b, qp_model.G, qp_model.h, qp_model.x_lb, qp_model.x_ub);
+    ASSERT_EQ(solver.kkt_formulation(), DENSE_KKT_SCHUR);
+    EXPECT_EQ(solver.result().info.kkt_nnz, (n_eq + n_ineq) * (n_eq + n_ineq + 1) / 2);
+
+    PIQP_EIGEN_MALLOC_NOT_ALLOWED();
+    Status status = solver.solve();
+    PIQP_EIGEN_MALLOC_ALLOWED();
+
+    ASSERT_EQ(status, Status::PIQP_SOLVED);
+    EXPECT_TRUE(solver.result().x.isApprox(solver_reduced.result().x, 1e-6));
+    EXPECT_NEAR(solver.result().info.primal_obj, solver_reduced.result().info.primal_obj, 1e-6);
+
+    // a non-diagonal P switches back to the reduced formulation
+    dense::Model<T> qp_model_full = rand::dense_strongly_convex_qp<T>(dim, n_eq, n_ineq);
+    solver.update(qp_model_full.P);
+    EXPECT_EQ(solver.kkt_formulation(), DENSE_KKT_REDUCED);
+    ASSERT_EQ(solver.solve(), Status::PIQP_SOLVED);
+
+    solver_reduced.update(qp_model_full.P);
+    ASSERT_EQ(solver_reduced.solve(), Status::PIQP_SOLVED);
+    EXPECT_TRUE(solver.result().x.isApprox(solver_reduced.result().x, 1e-6));
+}
+
 TEST(DenseSolverTest, NonStronglyConvexWithEqualityAndInequalities)
 {
     isize dim = 20;
@@ -300,3 +366,49 @@ TEST(DenseSolverTest, StronglyConvexNoConstraints)
 
     ASSERT_EQ(status, Status::PIQP_SOLVED);
 }
+
+TEST(DenseSolverTest, FactorizationInfo)
+{
+    isize dim = 20;
+    isize n_eq = 10;
+    isize n_ineq = 12;
+
+    dense::Model<T> qp_model = rand::dense_strongly_convex_qp<T>(dim, n_eq, n_ineq);
+
+    DenseSolver<T> solver;
+    solver.setup(qp_model.P, qp_model.c, qp_model.A, qp_model.b, qp_model.G, qp_model.h, qp_model.x_lb, qp_model.x_ub);
+
+    const Info<T>& info = solver.result().info;
+    EXPECT_EQ(info.kkt_nnz, dim * (dim + 1) / 2);
+    EXPECT_EQ(info.kkt_factor_nnz, dim * (dim - 1) / 2);
+    EXPECT_EQ(info.kkt_fill_ratio, T(1));
+    EXPECT_EQ(info.factor_flops, T((dim - 1) * dim * (2 * dim - 1) / 6 + dim * (dim - 1)));
+    EXPECT_EQ(info.etree_height, dim);
+    EXPECT_EQ(info.etree_width, 1);
+    EXPECT_GE(info.workspace_bytes, isize(dim * dim * sizeof(T)));
+}
+
+TEST(DenseSolverTest, Trace)
+{
+    isize dim = 20;
+    isize n_eq = 10;
+    isize n_ineq = 12;
+
+    dense::Model<T> qp_model = rand::dense_strongly_convex_qp<T>(dim, n_eq, n_ineq);
+
+    DenseSolver<T> solver;
+    solver.settings().trace_capacity = 1000;
+    solver.setup(qp_model.P, qp_model.c, qp_model.A, qp_model.b, qp_model.G, qp_model.h, qp_model.x_lb, qp_model.x_ub);
+
+    PIQP_EIGEN_MALLOC_NOT_ALLOWED();
+    Status status = solver.solve();
+    PIQP_EIGEN_MALLOC_ALLOWED();
+
+    ASSERT_EQ(status, Status::PIQP_SOLVED);
+
+    const Trace<T>& trace = solver.trace();
+    ASSERT_EQ(trace.size(), solver.result().info.iter + 1);
+    EXPECT_EQ(trace[0].iter, 0);
+    EXPECT_EQ(trace.back().primal_obj, solver.result().info.primal_obj);
+    EXPECT_EQ(trace.back().mu, solver.result().info.mu);
+}
@@ -0,0 +1,94 @@
+// This file is part of PIQP.
+//
+// Copyright (c) 2024 EPFL
+//
+// This source code is licensed under the BSD 2-Clause License found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "piqp/piqp.hpp"
+#include "piqp/dispatched_solver.hpp"
+#include "piqp/utils/random_utils.hpp"
+
+#include "gtest/gtest.h"
+
+using namespace piqp;
+
+using T = double;
+using I = int;
+
+TEST(DispatchedSolverTest, InstructionSet)
+{
+    const std::vector<std::string> instruction_sets = {"avx512", "avx2", "sse42", "baseline"};
+
+    const char* instruction_set = DispatchedDenseSolver::instruction_set();
+    ASSERT_NE(instruction_set, nullptr);
+    ASSERT_STREQ(instruction_set, DispatchedSparseSolver::instruction_set());
+    auto it = std::find(instruction_sets.begin(), instruction_sets.end(), std::string(instruction_set));
+    ASSERT_NE(it, instruction_sets.end());
+
+    // the selected variant is at most the one requested
+    const char* limit = std::getenv("PIQP_INSTRUCTION_SET");
+    if (limit && std::strlen(limit) > 0)
+    {
+        auto limit_it = std::find(instruction_sets.begin(), instruction_sets.end(), std::string(limit));
+        ASSERT_GE(it, limit_it);
+    }
+}
+
+TEST(DispatchedSolverTest, AgreesWithDenseSolver)
+{
+    isize dim = 20;
+    isize n_eq = 5;
+    isize n_ineq = 10;
+    dense::Model<T> model = rand::dense_strongly_convex_qp<T>(dim, n_eq, n_ineq);
+
+    DenseSolver<T> ref_solver;
+    ref_solver.setup(model.P, model.c, model.A, model.b, model.G, model.h, model.x_lb, model.x_ub);
+    ASSERT_EQ(ref_solver.solve(), Status::PIQP_SOLVED);
+
+    DispatchedDenseSolver solver;
+    solver.settings().verbose = false;
+    solver.setup(model.P, model.c, model.A, model.b, model.G, model.h, model.x_lb, model.x_ub);
+    ASSERT_EQ(solver.solve(), Status::PIQP_SOLVED);
+    ASSERT_NEAR(solver.result().info.primal_obj, ref_solver.result().info.primal_obj, 1e-6);
+    ASSERT_TRUE(solver.result().x.isApprox(ref_solver.result().x, 1e-6));
+
+    model.c.setOnes();
+    ref_solver.update(nullopt, model.c);
+    solver.update(nullopt, model.c);
+    ASSERT_EQ(ref_solver.solve(), Status::PIQP_SOLVED);
+    ASSERT_EQ(solver.solve(), Status::PIQP_SOLVED);
+    ASSERT_NEAR(solver.result().info.primal_obj, ref_solver.result().info.primal_obj, 1e-6);
+}
+
+TEST(DispatchedSolverTest, AgreesWithSparseSolver)
+{
+    isize dim = 40;
+    isize n_eq = 10;
+    isize n_ineq = 20;
+    sparse::Model<T, I> model = rand::sparse_strongly_convex_qp<T, I>(dim, n_eq, n_ineq, 0.2);
+
+    SparseSolver<T, I> ref_solver;
+    ref_solver.setup(model.P, model.c, model.A, model.b, model.G, model.h, model.x_lb, model.x_ub);
+    ASSERT_EQ(ref_solver.solve(), Status::PIQP_SOLVED);
+
+    DispatchedSparseSolver solver;
+    solver.setup(model.P, model.c, model.A, model.b, model.G, model.h, model.x_lb, model.x_ub);
+    ASSERT_EQ(solver.solve(), Status::PIQP_SOLVED);
+    ASSERT_NEAR(solver.result().info.primal_obj, ref_solver.result().info.primal_obj, 1e-6);
+    ASSERT_TRUE(solver.result().x.isApprox(ref_solver.result().x, 1e-6));
+
+    // warm starting from the solution converges immediately
+    Vec<T> x = solver.result().x;
+    Vec<T> y = solver.result().y;
+    Vec<T> z = solver.result().z;
+    solver.warm_start(x, y, z);
+    ASSERT_EQ(solver.solve(), Status::PIQP_SOLVED);
+    ASSERT_LE(solver.result().info.iter, ref_solver.result().info.iter);
+}
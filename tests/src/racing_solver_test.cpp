@@ -0,0 +1,111 @@
+// This file is part of PIQP.
+//
+// Copyright (c) 2024 EPFL
+//
+// This source code is licensed under the BSD 2-Clause License found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "piqp/racing_solver.hpp"
+#include "piqp/utils/random_utils.hpp"
+
+#include "gtest/gtest.h"
+
+using namespace piqp;
+
+using T = double;
+using I = int;
+
+TEST(RacingSolverTest, AgreesWithSparseSolver)
+{
+    isize dim = 40;
+    isize n_eq = 10;
+    isize n_ineq = 20;
+    sparse::Model<T, I> model = rand::sparse_strongly_convex_qp<T, I>(dim, n_eq, n_ineq, 0.2);
+
+    SparseSolver<T, I> ref_solver;
+    ref_solver.setup(model.P, model.c, model.A, model.b, model.G, model.h, model.x_lb, model.x_ub);
+    ASSERT_EQ(ref_solver.solve(), Status::PIQP_SOLVED);
+
+    RacingSolver<T, I> solver;
+    solver.setup(model.P, model.c, model.A, model.b, model.G, model.h, model.x_lb, model.x_ub);
+    ASSERT_EQ(solver.n_contestants(), 4);
+    ASSERT_EQ(solver.solve(), Status::PIQP_SOLVED);
+    ASSERT_GE(solver.winner(), 0);
+    ASSERT_LT(solver.winner(), 4);
+    ASSERT_NEAR(solver.result().info.primal_obj, ref_solver.result().info.primal_obj, 1e-6);
+    ASSERT_TRUE(solver.result().x.isApprox(ref_solver.result().x, 1e-6));
+
+    // updates are applied to all contestants
+    model.c.setOnes();
+    ref_solver.update(nullopt, model.c);
+    solver.update(nullopt, model.c);
+    ASSERT_EQ(ref_solver.solve(), Status::PIQP_SOLVED);
+    ASSERT_EQ(solver.solve(), Status::PIQP_SOLVED);
+    ASSERT_NEAR(solver.result().info.primal_obj, ref_solver.result().info.primal_obj, 1e-6);
+}
+
+TEST(RacingSolverTest, CustomConfigs)
+{
+    isize dim = 30;
+    isize n_eq = 5;
+    isize n_ineq = 10;
+    sparse::Model<T, I> model = rand::sparse_strongly_convex_qp<T, I>(dim, n_eq, n_ineq, 0.2);
+
+    // the first configuration cannot converge in one iteration
+    RacingConfig<T> slow;
+    slow.settings = Settings<T>();
+    slow.settings->max_iter = 1;
+    RacingConfig<T> fast;
+    fast.kkt_mode = KKTMode::KKT_ALL_ELIMINATED;
+    fast.settings = Settings<T>();
+    fast.settings->iterative_refinement_always_enabled = true;
+
+    RacingSolver<T, I> solver;
+    solver.set_configs({slow, fast});
+    solver.setup(model.P, model.c, model.A, model.b, model.G, model.h, model.x_lb, model.x_ub);
+    ASSERT_EQ(solver.solve(), Status::PIQP_SOLVED);
+    ASSERT_EQ(solver.winner(), 1);
+}
+
+TEST(RacingSolverTest, RememberWinner)
+{
+    isize dim = 30;
+    isize n_eq = 5;
+    isize n_ineq = 10;
+    sparse::Model<T, I> model = rand::sparse_strongly_convex_qp<T, I>(dim, n_eq, n_ineq, 0.2);
+
+    std::shared_ptr<RacingMemory> memory = std::make_shared<RacingMemory>();
+
+    RacingSolver<T, I> solver1;
+    solver1.set_memory(memory);
+    solver1.setup(model.P, model.c, model.A, model.b, model.G, model.h, model.x_lb, model.x_ub);
+    ASSERT_EQ(solver1.n_contestants(), 4);
+    ASSERT_EQ(solver1.solve(), Status::PIQP_SOLVED);
+    ASSERT_EQ(memory->winner(solver1.pattern_hash()), solver1.winner());
+
+    // same pattern with different values only sets up the winner
+    model.c.setOnes();
+    RacingSolver<T, I> solver2;
+    solver2.set_memory(memory);
+    solver2.setup(model.P, model.c, model.A, model.b, model.G, model.h, model.x_lb, model.x_ub);
+    ASSERT_EQ(solver2.pattern_hash(), solver1.pattern_hash());
+    ASSERT_EQ(solver2.n_contestants(), 1);
+    ASSERT_EQ(solver2.winner(), solver1.winner());
+    ASSERT_EQ(solver2.solve(), Status::PIQP_SOLVED);
+
+    // a different pattern is raced again
+    sparse::Model<T, I> other_model = rand::sparse_strongly_convex_qp<T, I>(dim + 1, n_eq, n_ineq, 0.2);
+    RacingSolver<T, I> solver3;
+    solver3.set_memory(memory);
+    solver3.setup(other_model.P, other_model.c, other_model.A, other_model.b, other_model.G, other_model.h, other_model.x_lb, other_model.x_ub);
+    ASSERT_NE(solver3.pattern_hash(), solver1.pattern_hash());
+    ASSERT_EQ(solver3.n_contestants(), 4);
+}
+
+TEST(RacingSolverTest, NotSetup)
+{
+    RacingSolver<T, I> solver;
+    ASSERT_EQ(solver.winner(), -1);
+    ASSERT_EQ(solver.result().info.status, Status::PIQP_UNSOLVED);
+    ASSERT_EQ(solver.solve(), Status::PIQP_UNSOLVED);
+}
@@ -77,3 +77,60 @@ TEST(SparseLDLT, Solve)
     EXPECT_TRUE(b.isApprox(P_full * x, 1e-8));
 }
 
+TEST(SparseLDLT, Stats)
+{
+    isize dim = 20;
+    T sparsity_factor = 0.2;
+
+    SparseMat<T, I> P = rand::sparse_positive_definite_upper_triangular_rand<T, I>(dim, sparsity_factor);
+
+    LDLt<T, I> ldlt;
+    ldlt.factorize_symbolic_upper_triangular(P);
+
+    // after the numeric factorization the column counts are equal to the symbolic ones
+    isize n = ldlt.factorize_numeric_upper_triangular(P);
+    EXPECT_EQ(dim, n);
+
+    T factor_flops = 0;
+    for (isize k = 0; k < dim; k++)
+    {
+        factor_flops += T(ldlt.L_nnz[k]) * T(ldlt.L_nnz[k] + 2);
+    }
+    EXPECT_EQ(ldlt.stats.nnz, ldlt.L_nnz.sum());
+    EXPECT_EQ(ldlt.stats.factor_flops, factor_flops);
+    EXPECT_EQ(ldlt.stats.solve_flops, T(4 * ldlt.L_nnz.sum() + dim));
+
+    // brute force height and width of the elimination tree
+    Vec<I> depth(dim);
+    isize height = 0;
+    for (isize k = 0; k < dim; k++)
+    {
+        depth[k] = 0;
+        for (isize i = ldlt.etree[k]; i != -1; i = ldlt.etree[i]) depth[k]++;
+        height = std::max(height, isize(depth[k]) + 1);
+    }
+    isize width = 0;
+    for (isize d = 0; d < height; d++)
+    {
+        width = std::max(width, isize((depth.array() == I(d)).count()));
+    }
+    EXPECT_EQ(ldlt.stats.etree_height, height);
+    EXPECT_EQ(ldlt.stats.etree_width, width);
+    EXPECT_GT(ldlt.memory_bytes(), 0);
+}
+
+TEST(SparseLDLT, StatsDiagonal)
+{
+    isize dim = 10;
+
+    SparseMat<T, I> P(dim, dim);
+    P.setIdentity();
+
+    LDLt<T, I> ldlt;
+    ldlt.factorize_symbolic_upper_triangular(P);
+
+    EXPECT_EQ(ldlt.stats.nnz, 0);
+    EXPECT_EQ(ldlt.stats.factor_flops, 0);
+    EXPECT_EQ(ldlt.stats.etree_height, 1);
+    EXPECT_EQ(ldlt.stats.etree_width, dim);
+}
@@ -9,7 +9,10 @@
 #define PIQP_EIGEN_CHECK_MALLOC
 
 #include "piqp/piqp.hpp"
+#include "piqp/dynamic_sparse_solver.hpp"
+#include "piqp/sparse/kkt_analysis.hpp"
 #include "piqp/utils/random_utils.hpp"
+#include "piqp/utils/structured_problems.hpp"
 
 #include "gtest/gtest.h"
 
@@ -345,3 +348,414 @@ TYPED_TEST(SparseSolverTest, StronglyConvexNoConstraints)
 
     ASSERT_EQ(status, Status::PIQP_SOLVED);
 }
+
+TYPED_TEST(SparseSolverTest, FactorizationInfo)
+{
+    isize dim = 20;
+    isize n_eq = 10;
+    isize n_ineq = 12;
+    T sparsity_factor = 0.2;
+
+    sparse::Model<T, I> qp_model = rand::sparse_strongly_convex_qp<T, I>(dim, n_eq, n_ineq, sparsity_factor);
+
+    SparseSolver<T, I, TypeParam::Mode> solver;
+    solver.setup(qp_model.P, qp_model.c, qp_model.A, qp_model.b, qp_model.G, qp_model.h, qp_model.x_lb, qp_model.x_ub);
+
+    const Info<T>& info = solver.result().info;
+    EXPECT_GT(info.kkt_nnz, 0);
+    EXPECT_GE(info.kkt_fill_ratio, T(1));
+    EXPECT_GE(info.factor_flops, T(info.kkt_factor_nnz));
+    EXPECT_GT(info.solve_flops, T(4 * info.kkt_factor_nnz));
+    EXPECT_GE(info.etree_height, 1);
+    EXPECT_GE(info.etree_width, 1);
+    EXPECT_GT(info.workspace_bytes, 0);
+
+    // the symbolic analysis predicts the same factorization without setting up a solver
+    Info<T> analysis;
+    sparse::analyze_kkt<T, I, TypeParam::Mode>(qp_model.P, qp_model.A, qp_model.G, solver.settings(), analysis);
+    EXPECT_EQ(analysis.kkt_nnz, info.kkt_nnz);
+    EXPECT_EQ(analysis.kkt_factor_nnz, info.kkt_factor_nnz);
+    EXPECT_EQ(analysis.factor_flops, info.factor_flops);
+    EXPECT_EQ(analysis.solve_flops, info.solve_flops);
+
+    PIQP_EIGEN_MALLOC_NOT_ALLOWED();
+    Status status = solver.solve();
+    PIQP_EIGEN_MALLOC_ALLOWED();
+
+    ASSERT_EQ(status, Status::PIQP_SOLVED);
+}
+
+// three independent random problems solved as one problem
+TYPED_TEST(SparseSolverTest, IndependentSubproblemsSameResultMultithreaded)
+{
+    sparse::Model<T, I> qp_model = rand::block_diagonal_qp<T, I>({rand::sparse_strongly_convex_qp<T, I>(20, 8, 10, 0.2),
+                                                                  rand::sparse_strongly_convex_qp<T, I>(35, 5, 20, 0.1),
+                                                                  rand::sparse_strongly_convex_qp<T, I>(10, 3, 6, 0.3)});
+    SparseMat<T, I> P = qp_model.P;
+    SparseMat<T, I> A = qp_model.A;
+    SparseMat<T, I> G = qp_model.G;
+    Vec<T> c = qp_model.c;
+    Vec<T> b = qp_model.b;
+    Vec<T> h = qp_model.h;
+    Vec<T> x_lb = qp_model.x_lb;
+    Vec<T> x_ub = qp_model.x_ub;
+
+    SparseSolver<T, I, TypeParam::Mode> solver_ref;
+    solver_ref.setup(P, c, A, b, G, h, x_lb, x_ub);
+    ASSERT_EQ(solver_ref.solve(), Status::PIQP_SOLVED);
+
+    SparseSolver<T, I, TypeParam::Mode> solver;
+    solver.settings().n_threads = 3;
+    solver.setup(P, c, A, b, G, h, x_lb, x_ub);
+    EXPECT_EQ(solver.result().info.kkt_nnz, solver_ref.result().info.kkt_nnz);
+    EXPECT_GE(solver.result().info.etree_width, solver_ref.result().info.etree_width);
+
+    PIQP_EIGEN_MALLOC_NOT_ALLOWED();
+    Status status = solver.solve();
+    PIQP_EIGEN_MALLOC_ALLOWED();
+
+    ASSERT_EQ(status, Status::PIQP_SOLVED);
+    ASSERT_TRUE(solver.result().x.isApprox(solver_ref.result().x, 1e-6));
+    ASSERT_TRUE(solver.result().y.isApprox(solver_ref.result().y, 1e-6));
+    ASSERT_TRUE(solver.result().z.isApprox(solver_ref.result().z, 1e-6));
+
+    // update values and bounds, the decomposition is kept
+    Eigen::Map<Vec<T>>(G.valuePtr(), G.nonZeros()) *= T(0.5);
+    h *= T(0.5);
+    c.array() += T(0.5);
+    x_lb.array() -= T(0.5);
+    solver_ref.update(nullopt, c, nullopt, nullopt, G, h, x_lb, nullopt);
+    ASSERT_EQ(solver_ref.solve(), Status::PIQP_SOLVED);
+
+    PIQP_EIGEN_MALLOC_NOT_ALLOWED();
+    solver.update(nullopt, c, nullopt, nullopt, G, h, x_lb, nullopt);
+    status = solver.solve();
+    PIQP_EIGEN_MALLOC_ALLOWED();
+
+    ASSERT_EQ(status, Status::PIQP_SOLVED);
+    ASSERT_TRUE(solver.result().x.isApprox(solver_ref.result().x, 1e-6));
+    ASSERT_TRUE(solver.result().z_lb.isApprox(solver_ref.result().z_lb, 1e-6));
+}
+
+TYPED_TEST(SparseSolverTest, Trace)
+{
+    isize dim = 20;
+    isize n_eq = 10;
+    isize n_ineq = 12;
+    T sparsity_factor = 0.2;
+
+    sparse::Model<T, I> qp_model = rand::sparse_strongly_convex_qp<T, I>(dim, n_eq, n_ineq, sparsity_factor);
+
+    SparseSolver<T, I, TypeParam::Mode> solver;
+    solver.settings().trace_capacity = 5;
+    solver.setup(qp_model.P, qp_model.c, qp_model.A, qp_model.b, qp_model.G, qp_model.h, qp_model.x_lb, qp_model.x_ub);
+
+    PIQP_EIGEN_MALLOC_NOT_ALLOWED();
+    Status status = solver.solve();
+    PIQP_EIGEN_MALLOC_ALLOWED();
+
+    ASSERT_EQ(status, Status::PIQP_SOLVED);
+    ASSERT_GT(solver.result().info.iter, 5);
+
+    // ring buffer only keeps the last iterations
+    const Trace<T>& trace = solver.trace();
+    ASSERT_EQ(trace.size(), 5);
+    for (isize i = 0; i < trace.size(); i++)
+    {
+        EXPECT_EQ(trace[i].solve, 1);
+        EXPECT_EQ(trace[i].iter, solver.result().info.iter - 4 + i);
+        EXPECT_LE(trace[i].factor_time, trace[i].corrector_time);
+        EXPECT_LE(trace[i].corrector_time, trace[i].residual_time);
+    }
+    EXPECT_EQ(trace.back().primal_inf, solver.result().info.primal_inf);
+    EXPECT_EQ(trace.back().dual_inf, solver.result().info.dual_inf);
+
+    status = solver.solve();
+    ASSERT_EQ(status, Status::PIQP_SOLVED);
+    EXPECT_EQ(trace.back().solve, 2);
+
+    std::string csv = trace.to_csv();
+    EXPECT_EQ(std::count(csv.begin(), csv.end(), '\n'), 6);
+    std::string json = trace.to_json();
+    EXPECT_EQ(std::count(json.begin(), json.end(), '{'), 5);
+}
+
+TYPED_TEST(SparseSolverTest, AsyncSolveCancel)
+{
+    isize dim = 300;
+    isize n_eq = 100;
+    isize n_ineq = 150;
+    T sparsity_factor = 0.02;
+
+    sparse::Model<T, I> qp_model = rand::sparse_strongly_convex_qp<T, I>(dim, n_eq, n_ineq, sparsity_factor);
+
+    SparseSolver<T, I, TypeParam::Mode> solver;
+    solver.setup(qp_model.P, qp_model.c, qp_model.A, qp_model.b, qp_model.G, qp_model.h, qp_model.x_lb, qp_model.x_ub);
+
+    // the number of iterations before the cancellation is seen depends on the thread timing,
+    // hence the tolerances can not be reached such that the solve does not finish before
+    solver.settings().eps_abs = std::numeric_limits<T>::min();
+    solver.settings().eps_rel = 0;
+    solver.settings().max_iter = std::numeric_limits<isize>::max();
+    std::future<Status> future = solver.solve_async();
+    solver.cancel();
+    ASSERT_EQ(future.get(), Status::PIQP_CANCELLED);
+    ASSERT_EQ(solver.result().info.status, Status::PIQP_CANCELLED);
+
+    // a new solve is not affected by the previous request
+    solver.settings() = Settings<T>();
+    Status status_on_done = Status::PIQP_UNSOLVED;
+    future = solver.solve_async([&](Status status) { status_on_done = status; });
+    ASSERT_EQ(future.get(), Status::PIQP_SOLVED);
+    ASSERT_EQ(status_on_done, Status::PIQP_SOLVED);
+    ASSERT_EQ(solver.solve(), Status::PIQP_SOLVED);
+}
+
+TYPED_TEST(SparseSolverTest, WarmStart)
+{
+    isize dim = 50;
+    isize n_eq = 10;
+    isize n_ineq = 40;
+    T sparsity_factor = 0.2;
+
+    sparse::Model<T, I> qp_model = rand::sparse_strongly_convex_qp<T, I>(dim, n_eq, n_ineq, sparsity_factor);
+
+    SparseSolver<T, I, TypeParam::Mode> solver;
+    solver.setup(qp_model.P, qp_model.c, qp_model.A, qp_model.b, qp_model.G, qp_model.h, qp_model.x_lb, qp_model.x_ub);
+    ASSERT_EQ(solver.solve(), Status::PIQP_SOLVED);
+    Result<T> previous = solver.result();
+
+    // slightly perturbed problem
+    qp_model.c += T(1e-3) * rand::vector_rand<T>(dim);
+    solver.update(nullopt, qp_model.c);
+    ASSERT_EQ(solver.solve(), Status::PIQP_SOLVED);
+    Vec<T> x_sol = solver.result().x;
+    isize cold_iter = solver.result().info.iter;
+
+    // starting from the previous solution needs fewer iterations
+    solver.warm_start(previous.x, previous.y, previous.z, previous.z_lb, previous.z_ub);
+    ASSERT_EQ(solver.solve(), Status::PIQP_SOLVED);
+    ASSERT_LT(solver.result().info.iter, cold_iter);
+    ASSERT_TRUE(solver.result().x.isApprox(x_sol, 1e-6));
+
+    // a partial warm start initializes the remaining vectors as usual
+    solver.warm_start(previous.x);
+    ASSERT_EQ(solver.solve(), Status::PIQP_SOLVED);
+    ASSERT_TRUE(solver.result().x.isApprox(x_sol, 1e-6));
+
+    // the warm start only applies to one solve
+    ASSERT_EQ(solver.solve(), Status::PIQP_SOLVED);
+    ASSERT_EQ(solver.result().info.iter, cold_iter);
+}
+
+TYPED_TEST(SparseSolverTest, WarmStartDiscardedBySetup)
+{
+    isize dim = 50;
+    isize n_eq = 10;
+    isize n_ineq = 40;
+    T sparsity_factor = 0.2;
+
+    sparse::Model<T, I> qp_model = rand::sparse_strongly_convex_qp<T, I>(dim, n_eq, n_ineq, sparsity_factor);
+
+    SparseSolver<T, I, TypeParam::Mode> solver;
+    solver.setup(qp_model.P, qp_model.c, qp_model.A, qp_model.b, qp_model.G, qp_model.h, qp_model.x_lb, qp_model.x_ub);
+    ASSERT_EQ(solver.solve(), Status::PIQP_SOLVED);
+    Result<T> previous = solver.result();
+
+    // the warm start has the dimensions of the first problem
+    solver.warm_start(previous.x, previous.y, previous.z, previous.z_lb, previous.z_ub);
+
+    sparse::Model<T, I> qp_model_small = rand::sparse_strongly_convex_qp<T, I>(dim / 2, n_eq / 2, n_ineq / 2, sparsity_factor);
+    solver.setup(qp_model_small.P, qp_model_small.c, qp_model_small.A, qp_model_small.b, qp_model_small.G, qp_model_small.h, qp_model_small.x_lb, qp_model_small.x_ub);
+    ASSERT_EQ(solver.solve(), Status::PIQP_SOLVED);
+
+    SparseSolver<T, I, TypeParam::Mode> cold_solver;
+    cold_solver.setup(qp_model_small.P, qp_model_small.c, qp_model_small.A, qp_model_small.b, qp_model_small.G, qp_model_small.h, qp_model_small.x_lb, qp_model_small.x_ub);
+    ASSERT_EQ(cold_solver.solve(), Status::PIQP_SOLVED);
+    ASSERT_EQ(solver.result().info.iter, cold_solver.result().info.iter);
+    ASSERT_TRUE(solver.result().x.isApprox(cold_solver.result().x, 1e-6));
+}
+
+TYPED_TEST(SparseSolverTest, Stepwise)
+{
+    isize dim = 20;
+    isize n_eq = 10;
+    isize n_ineq = 12;
+    T sparsity_factor = 0.2;
+
+    sparse::Model<T, I> qp_model1 = rand::sparse_strongly_convex_qp<T, I>(dim, n_eq, n_ineq, sparsity_factor);
+    sparse::Model<T, I> qp_model2 = rand::sparse_strongly_convex_qp<T, I>(dim, n_eq, n_ineq, sparsity_factor);
+
+    SparseSolver<T, I, TypeParam::Mode> solver1;
+    solver1.setup(qp_model1.P, qp_model1.c, qp_model1.A, qp_model1.b, qp_model1.G, qp_model1.h, qp_model1.x_lb, qp_model1.x_ub);
+    SparseSolver<T, I, TypeParam::Mode> solver2;
+    solver2.setup(qp_model2.P, qp_model2.c, qp_model2.A, qp_model2.b, qp_model2.G, qp_model2.h, qp_model2.x_lb, qp_model2.x_ub);
+
+    ASSERT_EQ(solver1.solve(), Status::PIQP_SOLVED);
+    Vec<T> x1 = solver1.result().x;
+    isize iter1 = solver1.result().info.iter;
+    ASSERT_EQ(solver2.solve(), Status::PIQP_SOLVED);
+    Vec<T> x2 = solver2.result().x;
+    isize iter2 = solver2.result().info.iter;
+
+    // interleave both solvers round-robin on one thread
+    PIQP_EIGEN_MALLOC_NOT_ALLOWED();
+    solver1.begin_solve();
+    solver2.begin_solve();
+    bool running1 = true;
+    bool running2 = true;
+    while (running1 || running2)
+    {
+        if (running1) running1 = solver1.step();
+        if (running2) running2 = solver2.step();
+    }
+    Status status1 = solver1.finish();
+    Status status2 = solver2.finish();
+    PIQP_EIGEN_MALLOC_ALLOWED();
+
+    ASSERT_EQ(status1, Status::PIQP_SOLVED);
+    ASSERT_EQ(solver1.result().info.iter, iter1);
+    ASSERT_TRUE(solver1.result().x.isApprox(x1, 1e-12));
+    ASSERT_EQ(status2, Status::PIQP_SOLVED);
+    ASSERT_EQ(solver2.result().info.iter, iter2);
+    ASSERT_TRUE(solver2.result().x.isApprox(x2, 1e-12));
+
+    // finishing again does not change the result
+    ASSERT_EQ(solver1.finish(), Status::PIQP_SOLVED);
+    ASSERT_TRUE(solver1.result().x.isApprox(x1, 1e-12));
+
+    // stopping early returns the current iterate
+    solver1.begin_solve();
+    ASSERT_TRUE(solver1.step());
+    ASSERT_TRUE(solver1.step());
+    ASSERT_EQ(solver1.finish(), Status::PIQP_CANCELLED);
+    ASSERT_EQ(solver1.result().info.iter, 2);
+    ASSERT_FALSE(solver1.step());
+
+    ASSERT_EQ(solver1.solve(), Status::PIQP_SOLVED);
+    ASSERT_EQ(solver1.result().info.iter, iter1);
+
+    // a failed initialization terminates on the first step
+    solver1.settings().max_iter = 0;
+    solver1.begin_solve();
+    ASSERT_FALSE(solver1.step());
+    ASSERT_EQ(solver1.finish(), Status::PIQP_INVALID_SETTINGS);
+}
+
+TYPED_TEST(SparseSolverTest, TimeLimit)
+{
+    isize dim = 20;
+    isize n_eq = 10;
+    isize n_ineq = 12;
+    T sparsity_factor = 0.2;
+
+    sparse::Model<T, I> qp_model = rand::sparse_strongly_convex_qp<T, I>(dim, n_eq, n_ineq, sparsity_factor);
+
+    SparseSolver<T, I, TypeParam::Mode> solver;
+    solver.setup(qp_model.P, qp_model.c, qp_model.A, qp_model.b, qp_model.G, qp_model.h, qp_model.x_lb, qp_model.x_ub);
+
+    ASSERT_EQ(solver.solve(), Status::PIQP_SOLVED);
+    Vec<T> x = solver.result().x;
+    isize iter = solver.result().info.iter;
+
+    // the time limit is checked at the beginning of every iteration
+    solver.settings().time_limit = 1e-12;
+    PIQP_EIGEN_MALLOC_NOT_ALLOWED();
+    Status status = solver.solve();
+    PIQP_EIGEN_MALLOC_ALLOWED();
+    ASSERT_EQ(status, Status::PIQP_TIME_LIMIT_REACHED);
+    ASSERT_EQ(solver.result().info.iter, 0);
+
+    solver.settings().time_limit = 10;
+    ASSERT_EQ(solver.solve(), Status::PIQP_SOLVED);
+    ASSERT_EQ(solver.result().info.iter, iter);
+    ASSERT_TRUE(solver.result().x.isApprox(x, 1e-8));
+
+    solver.settings().time_limit = 0;
+    ASSERT_EQ(solver.solve(), Status::PIQP_INVALID_SETTINGS);
+}
+
+TYPED_TEST(SparseSolverTest, RealTime)
+{
+    isize dim = 20;
+    isize n_eq = 10;
+    isize n_ineq = 12;
+    T sparsity_factor = 0.2;
+
+    sparse::Model<T, I> qp_model = rand::sparse_strongly_convex_qp<T, I>(dim, n_eq, n_ineq, sparsity_factor);
+
+    SparseSolver<T, I, TypeParam::Mode> solver;
+    solver.setup(qp_model.P, qp_model.c, qp_model.A, qp_model.b, qp_model.G, qp_model.h, qp_model.x_lb, qp_model.x_ub);
+
+    ASSERT_EQ(solver.solve(), Status::PIQP_SOLVED);
+    Vec<T> x = solver.result().x;
+    isize iter = solver.result().info.iter;
+
+    solver.settings().real_time = true;
+    ASSERT_EQ(solver.settings().factor_retires_limit(), solver.settings().real_time_max_factor_retires);
+    ASSERT_EQ(solver.settings().iterative_refinement_iter_limit(), solver.settings().real_time_iterative_refinement_max_iter);
+
+    // without time limit only the retries and refinement steps are capped
+    ASSERT_EQ(solver.solve(), Status::PIQP_SOLVED);
+    ASSERT_TRUE(solver.result().x.isApprox(x, 1e-8));
+
+    // the first iteration is already predicted to exceed the limit
+    solver.settings().time_limit = 1e-12;
+    PIQP_EIGEN_MALLOC_NOT_ALLOWED();
+    Status status = solver.solve();
+    PIQP_EIGEN_MALLOC_ALLOWED();
+    ASSERT_EQ(status, Status::PIQP_REAL_TIME_LIMIT_REACHED);
+    ASSERT_EQ(solver.result().info.iter, 0);
+
+    solver.settings().time_limit = 10;
+    ASSERT_EQ(solver.solve(), Status::PIQP_SOLVED);
+    ASSERT_EQ(solver.result().info.iter, iter);
+    ASSERT_TRUE(solver.result().x.isApprox(x, 1e-8));
+
+    solver.settings().real_time_max_factor_retires = -1;
+    ASSERT_EQ(solver.solve(), Status::PIQP_INVALID_SETTINGS);
+}
+
+TEST(DynamicSparseSolverTest, AllModesAgree)
+{
+    isize dim = 30;
+    isize n_eq = 10;
+    isize n_ineq = 12;
+    T sparsity_factor = 0.2;
+
+    sparse::Model<T, I> qp_model = rand::sparse_strongly_convex_qp<T, I>(dim, n_eq, n_ineq, sparsity_factor);
+
+    SparseSolver<T, I> ref_solver;
+    ref_solver.setup(qp_model.P, qp_model.c, qp_model.A, qp_model.b, qp_model.G, qp_model.h, qp_model.x_lb, qp_model.x_ub);
+    ASSERT_EQ(ref_solver.solve(), Status::PIQP_SOLVED);
+
+    DynamicSparseSolver<T, I> solver;
+    ASSERT_EQ(solver.solve(), Status::PIQP_UNSOLVED);
+    ASSERT_EQ(solver.solve_async().get(), Status::PIQP_UNSOLVED);
+
+    isize min_factor_nnz = -1;
+    for (int kkt_mode : {KKTMode::KKT_FULL, KKTMode::KKT_EQ_ELIMINATED, KKTMode::KKT_INEQ_ELIMINATED, KKTMode::KKT_ALL_ELIMINATED})
+    {
+        solver.set_kkt_mode(kkt_mode);
+        solver.setup(qp_model.P, qp_model.c, qp_model.A, qp_model.b, qp_model.G, qp_model.h, qp_model.x_lb, qp_model.x_ub);
+        ASSERT_EQ(solver.kkt_mode(), kkt_mode);
+        ASSERT_EQ(solver.solve(), Status::PIQP_SOLVED);
+        ASSERT_TRUE(solver.result().x.isApprox(ref_solver.result().x, 1e-6));
+        if (min_factor_nnz < 0 || solver.result().info.kkt_factor_nnz < min_factor_nnz)
+        {
+            min_factor_nnz = solver.result().info.kkt_factor_nnz;
+        }
+    }
+
+    // the automatic selection keeps the mode with the smallest factor
+    solver.set_kkt_mode(KKTMode::KKT_AUTO);
+    solver.setup(qp_model.P, qp_model.c, qp_model.A, qp_model.b, qp_model.G, qp_model.h, qp_model.x_lb, qp_model.x_ub);
+    ASSERT_NE(solver.kkt_mode(), KKTMode::KKT_AUTO);
+    ASSERT_EQ(solver.result().info.kkt_factor_nnz, min_factor_nnz);
+    ASSERT_EQ(solver.solve(), Status::PIQP_SOLVED);
+    ASSERT_TRUE(solver.result().x.isApprox(ref_solver.result().x, 1e-6));
+
+    // settings are forwarded to the selected solver
+    solver.settings().max_iter = 1;
+    ASSERT_EQ(solver.solve(), Status::PIQP_MAX_ITER_REACHED);
+}
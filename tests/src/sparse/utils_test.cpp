@@ -135,3 +135,27 @@ TEST(SparseUtils, PostMultDiagonal)
 
     assert_sparse_matrices_equal(A, res);
 }
+
+TEST(SparseUtils, ConnectedComponents)
+{
+    // x0 - x2 coupled by P, x1 - x3 by A, x4 - x2 by G, x5 isolated
+    SparseMat<T, I> P(6, 6);
+    P.insert(0, 2) = 1;
+    P.insert(5, 5) = 1;
+    P.makeCompressed();
+    SparseMat<T, I> A(1, 6);
+    A.insert(0, 1) = 1;
+    A.insert(0, 3) = 1;
+    A.makeCompressed();
+    SparseMat<T, I> G(2, 6);
+    G.insert(0, 2) = 1;
+    G.insert(0, 4) = 1;
+    G.makeCompressed();
+    SparseMat<T, I> AT = A.transpose();
+    SparseMat<T, I> GT = G.transpose();
+
+    Vec<isize> component;
+    ASSERT_EQ((connected_components<T, I>(P, AT, GT, component)), 3);
+    Vec<isize> expected(6); expected << 0, 1, 0, 1, 0, 2;
+    ASSERT_EQ(component, expected);
+}
@@ -0,0 +1,266 @@
+// This file is part of PIQP.
+//
+// Copyright (c) 2024 EPFL
+//
+// This source code is licensed under the BSD 2-Clause License found in the
+// LICENSE file in the root directory of this source tree.
+
+#define PIQP_EIGEN_CHECK_MALLOC
+
+#include "piqp/piqp.hpp"
+#include "piqp/utils/random_utils.hpp"
+#include "piqp/utils/structured_problems.hpp"
+
+#include "gtest/gtest.h"
+
+using namespace piqp;
+
+using T = double;
+using I = int;
+
+TEST(StagewiseSolverTest, MPCSameResultAsSparse)
+{
+    stagewise::Model<T, I> model = rand::stagewise_mpc_qp<T, I>(6, 3, 10, 2);
+    const sparse::Model<T, I>& qp = model.qp;
+
+    SparseSolver<T, I> sparse_solver;
+    sparse_solver.setup(qp.P, qp.c, qp.A, qp.b, qp.G, qp.h, qp.x_lb, qp.x_ub);
+    ASSERT_EQ(sparse_solver.solve(), Status::PIQP_SOLVED);
+
+    StagewiseSolver<T, I> solver;
+    solver.settings().verbose = true;
+    solver.setup(model);
+
+    PIQP_EIGEN_MALLOC_NOT_ALLOWED();
+    Status status = solver.solve();
+    PIQP_EIGEN_MALLOC_ALLOWED();
+
+    ASSERT_EQ(status, Status::PIQP_SOLVED);
+    ASSERT_TRUE(solver.result().x.isApprox(sparse_solver.result().x, 1e-5));
+    ASSERT_TRUE(solver.result().y.isApprox(sparse_solver.result().y, 1e-5));
+    ASSERT_TRUE(solver.result().z.isApprox(sparse_solver.result().z, 1e-5));
+    ASSERT_EQ(solver.result().info.etree_width, 1);
+}
+
+TEST(StagewiseSolverTest, MPCUpdateInitialState)
+{
+    stagewise::Model<T, I> model = rand::stagewise_mpc_qp<T, I>(4, 2, 8, 1);
+
+    StagewiseSolver<T, I> solver;
+    solver.setup(model);
+    ASSERT_EQ(solver.solve(), Status::PIQP_SOLVED);
+
+    // shift the initial state and tighten the state constraints
+    model.qp.b.head(4) *= T(0.5);
+    model.qp.x_ub.array() -= T(0.5);
+
+    PIQP_EIGEN_MALLOC_NOT_ALLOWED();
+    solver.update(model);
+    Status status = solver.solve();
+    PIQP_EIGEN_MALLOC_ALLOWED();
+    ASSERT_EQ(status, Status::PIQP_SOLVED);
+
+    SparseSolver<T, I> sparse_solver;
+    sparse_solver.setup(model.qp.P, model.qp.c, model.qp.A, model.qp.b, model.qp.G, model.qp.h, model.qp.x_lb, model.qp.x_ub);
+    ASSERT_EQ(sparse_solver.solve(), Status::PIQP_SOLVED);
+
+    ASSERT_TRUE(solver.result().x.isApprox(sparse_solver.result().x, 1e-5));
+}
+
+// random problem with coupling of consecutive stages in P, A and G and stages of different size
+TEST(StagewiseSolverTest, GeneralStagesSameResultAsSparse)
+{
+    std::vector<isize> stage_dims = {3, 5, 2, 4, 6, 1};
+    isize n = 0;
+    for (isize n_k : stage_dims) n += n_k;
+    stagewise::IdxVec offsets = stagewise::stage_offsets(stage_dims);
+    isize N = isize(stage_dims.size());
+
+    // dense blocks of two consecutive stages
+    Mat<T> P_dense = Mat<T>::Zero(n, n);
+    Mat<T> A_dense = Mat<T>::Zero(N - 1, n);
+    Mat<T> G_dense = Mat<T>::Zero(2 * N, n);
+    for (isize k = 0; k < N; k++)
+    {
+        isize span = offsets(std::min(k + 2, N)) - offsets(k);
+        Mat<T> M = rand::dense_matrix_rand<T>(span, span);
+        P_dense.block(offsets(k), offsets(k), span, span) += M * M.transpose() / T(span);
+        if (k + 1 < N) A_dense.row(k).segment(offsets(k), span) = rand::vector_rand<T>(span);
+        G_dense.row(2 * k).segment(offsets(k), span) = rand::vector_rand<T>(span);
+        G_dense.row(2 * k + 1).segment(offsets(k), offsets(k + 1) - offsets(k)) = rand::vector_rand<T>(offsets(k + 1) - offsets(k));
+    }
+    P_dense.diagonal().array() += T(0.1);
+
+    SparseMat<T, I> P = P_dense.sparseView();
+    SparseMat<T, I> A = A_dense.sparseView();
+    SparseMat<T, I> G = G_dense.sparseView();
+    Vec<T> c = rand::vector_rand<T>(n);
+    Vec<T> b = A * rand::vector_rand<T>(n);
+    Vec<T> h = Vec<T>::Constant(2 * N, T(1));
+    Vec<T> x_lb = Vec<T>::Constant(n, T(-2));
+    Vec<T> x_ub = Vec<T>::Constant(n, T(2));
+
+    SparseSolver<T, I> sparse_solver;
+    sparse_solver.setup(P, c, A, b, G, h, x_lb, x_ub);
+    ASSERT_EQ(sparse_solver.solve(), Status::PIQP_SOLVED);
+
+    StagewiseSolver<T, I> solver;
+    solver.setup(stage_dims, P, c, A, b, G, h, x_lb, x_ub);
+
+    PIQP_EIGEN_MALLOC_NOT_ALLOWED();
+    Status status = solver.solve();
+    PIQP_EIGEN_MALLOC_ALLOWED();
+
+    ASSERT_EQ(status, Status::PIQP_SOLVED);
+    ASSERT_TRUE(solver.result().x.isApprox(sparse_solver.result().x, 1e-5));
+    ASSERT_TRUE(solver.result().z.isApprox(sparse_solver.result().z, 1e-5));
+}
+
+TEST(StagewiseSolverTest, RejectNonStagewiseStructure)
+{
+    std::vector<isize> stage_dims = {1, 1, 1};
+
+    SparseMat<T, I> P(3, 3);
+    P.insert(0, 0) = 1;
+    P.insert(1, 1) = 1;
+    P.insert(2, 2) = 1;
+    P.makeCompressed();
+    Vec<T> c = Vec<T>::Zero(3);
+
+    // the row couples the stages 0 and 2
+    SparseMat<T, I> A(1, 3);
+    A.insert(0, 0) = 1;
+    A.insert(0, 2) = 1;
+    A.makeCompressed();
+    Vec<T> b(1); b << 1;
+
+    StagewiseSolver<T, I> solver;
+    solver.setup(stage_dims, P, c, A, b);
+    ASSERT_EQ(solver.solve(), Status::PIQP_UNSOLVED);
+
+    // wrong total number of variables
+    solver.setup({1, 1}, P, c);
+    ASSERT_EQ(solver.solve(), Status::PIQP_UNSOLVED);
+
+    // a single stage is always valid
+    solver.setup({3}, P, c, A, b);
+    ASSERT_EQ(solver.solve(), Status::PIQP_SOLVED);
+
+    // A with too few columns is rejected before its columns are assigned to stages
+    SparseMat<T, I> A_short(1, 2);
+    A_short.insert(0, 1) = 1;
+    A_short.makeCompressed();
+    StagewiseSolver<T, I> solver_short;
+    solver_short.setup(stage_dims, P, c, A_short, b);
+    ASSERT_EQ(solver_short.solve(), Status::PIQP_UNSOLVED);
+
+    SparseMat<T, I> P_rect(3, 4);
+    P_rect.insert(0, 0) = 1;
+    P_rect.makeCompressed();
+    StagewiseSolver<T, I> solver_rect;
+    solver_rect.setup(stage_dims, P_rect, c);
+    ASSERT_EQ(solver_rect.solve(), Status::PIQP_UNSOLVED);
+}
+
+TEST(StagewiseSolverTest, RejectUpdateChangingStages)
+{
+    std::vector<isize> stage_dims = {1, 1, 1};
+
+    SparseMat<T, I> P(3, 3);
+    P.insert(0, 0) = 1;
+    P.insert(1, 1) = 1;
+    P.insert(2, 2) = 1;
+    P.makeCompressed();
+    Vec<T> c = Vec<T>::Zero(3);
+
+    // the row is assigned to stage 0
+    SparseMat<T, I> A(1, 3);
+    A.insert(0, 0) = 1;
+    A.insert(0, 1) = 1;
+    A.makeCompressed();
+    Vec<T> b(1); b << 1;
+
+    StagewiseSolver<T, I> solver;
+    solver.setup(stage_dims, P, c, A, b);
+    ASSERT_EQ(solver.solve(), Status::PIQP_SOLVED);
+    Vec<T> x = solver.result().x;
+
+    // same number of nonzeros, but the row now involves the stages 1 and 2
+    SparseMat<T, I> A_shifted(1, 3);
+    A_shifted.insert(0, 1) = 1;
+    A_shifted.insert(0, 2) = 1;
+    A_shifted.makeCompressed();
+    solver.update(nullopt, nullopt, A_shifted);
+    ASSERT_EQ(solver.solve(), Status::PIQP_SOLVED);
+    ASSERT_TRUE(solver.result().x.isApprox(x, 1e-6));
+
+    // entries of the same stages are accepted
+    SparseMat<T, I> A_scaled(1, 3);
+    A_scaled.insert(0, 0) = 2;
+    A_scaled.insert(0, 1) = 2;
+    A_scaled.makeCompressed();
+    solver.update(nullopt, nullopt, A_scaled);
+    ASSERT_EQ(solver.solve(), Status::PIQP_SOLVED);
+    ASSERT_NEAR(solver.result().x(0) + solver.result().x(1), 0.5, 1e-6);
+}
+
+class StagewiseCyclicReductionTest : public testing::TestWithParam<isize> {};
+
+TEST_P(StagewiseCyclicReductionTest, SameResultAsSequential)
+{
+    isize horizon = GetParam();
+    stagewise::Model<T, I> model = rand::stagewise_mpc_qp<T, I>(5, 2, horizon, 1);
+
+    StagewiseSolver<T, I> sequential_solver;
+    sequential_solver.set_kkt_factorization(STAGEWISE_KKT_SEQUENTIAL);
+    sequential_solver.setup(model);
+    ASSERT_EQ(sequential_solver.kkt_factorization(), STAGEWISE_KKT_SEQUENTIAL);
+    ASSERT_EQ(sequential_solver.solve(), Status::PIQP_SOLVED);
+
+    for (isize n_threads : {1, 4})
+    {
+        StagewiseSolver<T, I> solver;
+        solver.settings().n_threads = n_threads;
+        solver.set_kkt_factorization(STAGEWISE_KKT_CYCLIC_REDUCTION);
+        solver.setup(model);
+        ASSERT_EQ(solver.kkt_factorization(), STAGEWISE_KKT_CYCLIC_REDUCTION);
+
+        PIQP_EIGEN_MALLOC_NOT_ALLOWED();
+        Status status = solver.solve();
+        PIQP_EIGEN_MALLOC_ALLOWED();
+
+        ASSERT_EQ(status, Status::PIQP_SOLVED);
+        // both solutions are only accurate up to the termination tolerances, and
+        // the path constraints might all be inactive, i.e., z might be zero
+        ASSERT_TRUE(solver.result().x.isApprox(sequential_solver.result().x, 1e-5));
+        ASSERT_TRUE(solver.result().y.isApprox(sequential_solver.result().y, 1e-5));
+        ASSERT_LT((solver.result().z - sequential_solver.result().z).lpNorm<Eigen::Infinity>(), 1e-5);
+        ASSERT_EQ(solver.result().info.etree_width, (horizon + 1) / 2);
+    }
+}
+
+// odd and non power of two horizons leave unpaired stages on some levels
+INSTANTIATE_TEST_SUITE_P(FromHorizon, StagewiseCyclicReductionTest,
+                         ::testing::Values(1, 2, 3, 7, 8, 13, 32, 50));
+
+TEST(StagewiseSolverTest, CyclicReductionUpdate)
+{
+    stagewise::Model<T, I> model = rand::stagewise_mpc_qp<T, I>(4, 3, 21, 2);
+
+    StagewiseSolver<T, I> solver;
+    solver.settings().n_threads = 3;
+    solver.set_kkt_factorization(STAGEWISE_KKT_CYCLIC_REDUCTION);
+    solver.setup(model);
+    ASSERT_EQ(solver.solve(), Status::PIQP_SOLVED);
+
+    model.qp.b.head(4) *= T(-0.5);
+    solver.update(model);
+    ASSERT_EQ(solver.solve(), Status::PIQP_SOLVED);
+
+    SparseSolver<T, I> sparse_solver;
+    sparse_solver.setup(model.qp.P, model.qp.c, model.qp.A, model.qp.b, model.qp.G, model.qp.h, model.qp.x_lb, model.qp.x_ub);
+    ASSERT_EQ(sparse_solver.solve(), Status::PIQP_SOLVED);
+
+    ASSERT_TRUE(solver.result().x.isApprox(sparse_solver.result().x, 1e-5));
+    ASSERT_TRUE(solver.result().z.isApprox(sparse_solver.result().z, 1e-5));
+}
@@ -0,0 +1,59 @@
+// This file is part of PIQP.
+//
+// Copyright (c) 2024 EPFL
+//
+// This source code is licensed under the BSD 2-Clause License found in the
+// LICENSE file in the root directory of this source tree.
+
+#include <functional>
+
+#include "piqp/piqp.hpp"
+#include "piqp/utils/structured_problems.hpp"
+
+#include "gtest/gtest.h"
+
+using namespace piqp;
+
+using T = double;
+using I = int;
+
+using Generator = std::function<sparse::Model<T, I>()>;
+
+class StructuredProblemsTest : public testing::TestWithParam<std::pair<std::string, Generator>> {};
+
+TEST_P(StructuredProblemsTest, SparseAndDenseSolve)
+{
+    sparse::Model<T, I> model = GetParam().second();
+    dense::Model<T> dense_model = model.dense_model();
+
+    // P has to be upper triangular
+    SparseMat<T, I> P_lower = model.P.template triangularView<Eigen::StrictlyLower>();
+    ASSERT_EQ(P_lower.nonZeros(), 0);
+
+    SparseSolver<T, I> sparse_solver;
+    sparse_solver.setup(model.P, model.c, model.A, model.b, model.G, model.h, model.x_lb, model.x_ub);
+    ASSERT_EQ(sparse_solver.solve(), Status::PIQP_SOLVED);
+
+    DenseSolver<T> dense_solver;
+    dense_solver.setup(dense_model.P, dense_model.c, dense_model.A, dense_model.b,
+                       dense_model.G, dense_model.h, dense_model.x_lb, dense_model.x_ub);
+    ASSERT_EQ(dense_solver.solve(), Status::PIQP_SOLVED);
+
+    ASSERT_NEAR(sparse_solver.result().info.primal_obj, dense_solver.result().info.primal_obj, 1e-5);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Generators,
+    StructuredProblemsTest,
+    ::testing::Values(
+        std::make_pair(std::string("MPC"), Generator([]() { return rand::mpc_qp<T, I>(6, 3, 10); })),
+        std::make_pair(std::string("Portfolio"), Generator([]() { return rand::portfolio_qp<T, I>(50, 5); })),
+        std::make_pair(std::string("Lasso"), Generator([]() { return rand::lasso_qp<T, I>(10, 50); })),
+        std::make_pair(std::string("Huber"), Generator([]() { return rand::huber_qp<T, I>(10, 50); })),
+        std::make_pair(std::string("SVM"), Generator([]() { return rand::svm_qp<T, I>(10, 50); })),
+        std::make_pair(std::string("ControlAllocation"), Generator([]() { return rand::control_allocation_qp<T, I>(16); }))
+    ),
+    [](const ::testing::TestParamInfo<std::pair<std::string, Generator>>& info) {
+        return info.param.first;
+    }
+);
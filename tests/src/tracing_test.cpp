@@ -0,0 +1,89 @@
+// This file is part of PIQP.
+//
+// Copyright (c) 2024 EPFL
+//
+// This source code is licensed under the BSD 2-Clause License found in the
+// LICENSE file in the root directory of this source tree.
+
+// only the tracing primitives are tested here, the solver templates
+// are instantiated in the library which might be built without tracing
+#ifndef PIQP_WITH_TRACING
+#define PIQP_WITH_TRACING
+#endif
+
+#include <sstream>
+#include <thread>
+
+#include "piqp/tracing.hpp"
+
+#include "gtest/gtest.h"
+
+using namespace piqp;
+
+TEST(Tracing, NestedSpans)
+{
+    tracing::Recorder& recorder = tracing::Recorder::instance();
+    recorder.clear();
+
+    {
+        PIQP_TRACE_SOLVER_SCOPE(42);
+        PIQP_TRACE_SCOPE("outer");
+        {
+            PIQP_TRACE_SCOPE("inner");
+        }
+    }
+    EXPECT_EQ(tracing::current_solver_id(), -1);
+
+    std::vector<tracing::Event> events = recorder.events();
+    ASSERT_EQ(events.size(), 2u);
+    // spans are recorded on exit
+    EXPECT_STREQ(events[0].name, "inner");
+    EXPECT_STREQ(events[1].name, "outer");
+    EXPECT_EQ(events[0].solver_id, 42);
+    EXPECT_EQ(events[1].solver_id, 42);
+    EXPECT_GE(events[0].begin, events[1].begin);
+    EXPECT_LE(events[0].begin + events[0].duration, events[1].begin + events[1].duration);
+}
+
+TEST(Tracing, ThreadIds)
+{
+    tracing::Recorder& recorder = tracing::Recorder::instance();
+    recorder.clear();
+
+    std::int64_t id_a = tracing::next_solver_id();
+    std::int64_t id_b = tracing::next_solver_id();
+    EXPECT_NE(id_a, id_b);
+
+    std::thread thread_a([&]() { PIQP_TRACE_SOLVER_SCOPE(id_a); PIQP_TRACE_SCOPE("a"); });
+    thread_a.join();
+    std::thread thread_b([&]() { PIQP_TRACE_SOLVER_SCOPE(id_b); PIQP_TRACE_SCOPE("b"); });
+    thread_b.join();
+
+    std::vector<tracing::Event> events = recorder.events();
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_EQ(events[0].solver_id, id_a);
+    EXPECT_EQ(events[1].solver_id, id_b);
+    EXPECT_NE(events[0].thread_id, events[1].thread_id);
+}
+
+TEST(Tracing, ChromeTraceFormat)
+{
+    tracing::Recorder& recorder = tracing::Recorder::instance();
+    recorder.clear();
+
+    recorder.record({"factorize", 3, 1, 1234567, 2005});
+
+    std::ostringstream os;
+    recorder.write_chrome_trace(os);
+    std::string json = os.str();
+
+    EXPECT_NE(json.find("\"traceEvents\""), std::string::npos);
+    EXPECT_NE(json.find("\"name\": \"factorize\""), std::string::npos);
+    EXPECT_NE(json.find("\"ph\": \"X\""), std::string::npos);
+    EXPECT_NE(json.find("\"ts\": 1234.567"), std::string::npos);
+    EXPECT_NE(json.find("\"dur\": 2.005"), std::string::npos);
+    EXPECT_NE(json.find("\"pid\": 3, \"tid\": 1"), std::string::npos);
+
+    recorder.clear();
+    EXPECT_TRUE(recorder.events().empty());
+}